@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""prefix caching block hashes of a prompt, python against the native hasher.
+
+The python version is vLLM's, one hash_block_tokens with sha256 per block;
+the native one hashes all the blocks in one call, with sha256, checked
+against python, and with the fast hash. Throughput is in blocks per second.
+
+Usage:
+    python benchmarks/host/benchmark_block_hash.py \
+        --prompt-lens 1024 8192 32768 --block-sizes 16 128
+"""
+
+import argparse
+import time
+
+import numpy as np
+from vllm.utils import sha256
+from vllm.v1.core.kv_cache_utils import hash_block_tokens
+
+from vllm_mindspore.v1.core.kv_cache_utils import hash_request_blocks
+
+
+def python_block_hashes(token_ids: list[int], block_size: int,
+                        parent: bytes) -> list[bytes]:
+    block_hashes = []
+    for start in range(0, len(token_ids) - block_size + 1, block_size):
+        parent = hash_block_tokens(sha256, parent,
+                                   token_ids[start:start + block_size])
+        block_hashes.append(parent)
+    return block_hashes
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in microseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--prompt-lens",
+                        type=int,
+                        nargs="+",
+                        default=[1024, 8192, 32768])
+    parser.add_argument("--block-sizes",
+                        type=int,
+                        nargs="+",
+                        default=[16, 128])
+    parser.add_argument("--vocab-size", type=int, default=152064)
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+    assert hash_request_blocks is not None, \
+        "vllm_mindspore._C_host is not built"
+
+    print(f"{'tokens':>7} {'block':>6} {'python(us)':>11} {'sha256(us)':>11} "
+          f"{'fast(us)':>9} {'python(blk/s)':>14} {'sha256(blk/s)':>14} "
+          f"{'fast(blk/s)':>12}")
+    rng = np.random.default_rng(args.seed)
+    parent = sha256("parent")
+    for block_size in args.block_sizes:
+        for prompt_len in args.prompt_lens:
+            token_ids = rng.integers(0, args.vocab_size, prompt_len).tolist()
+            num_blocks = prompt_len // block_size
+            assert hash_request_blocks(
+                token_ids, block_size, parent,
+                algo="sha256") == python_block_hashes(token_ids, block_size,
+                                                      parent)
+            latencies = [
+                timeit(fn, args.warmup, args.iters) for fn in (
+                    lambda: python_block_hashes(token_ids, block_size, parent),
+                    lambda: hash_request_blocks(
+                        token_ids, block_size, parent, algo="sha256"),
+                    lambda: hash_request_blocks(token_ids, block_size, parent),
+                )
+            ]
+            rates = [num_blocks / us * 1e6 for us in latencies]
+            print(f"{prompt_len:>7} {block_size:>6} {latencies[0]:>11.1f} "
+                  f"{latencies[1]:>11.1f} {latencies[2]:>9.1f} "
+                  f"{rates[0]:>14.0f} {rates[1]:>14.0f} {rates[2]:>12.0f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""swap bandwidth and allocation latency of the KV cache host tier.
+
+Swap: the host side of a swap out and in of a batch of blocks, the key and
+value parts of every layer scattered into the host blocks from contiguous
+arrays, as a device gather leaves them, and gathered back; numpy indexing
+into one host array against HostBlockPool, checked equal. Churn: the
+latency of a store of a prefix into a full host tier, evicting the least
+recently used blocks, and of the allocate and free of the pool alone.
+
+Usage:
+    python benchmarks/host/benchmark_kv_offload.py \
+        --num-layers 28 --batch-blocks 16 64 256
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from vllm_mindspore._C_host import HostBlockPool
+from vllm_mindspore.v1.core.kv_offload import HostKVCacheTier
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in microseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--num-layers", type=int, default=28)
+    parser.add_argument("--block-size", type=int, default=16)
+    parser.add_argument("--num-kv-heads", type=int, default=4)
+    parser.add_argument("--head-size", type=int, default=128)
+    parser.add_argument("--host-blocks", type=int, default=512)
+    parser.add_argument("--batch-blocks",
+                        type=int,
+                        nargs="+",
+                        default=[16, 64, 256])
+    parser.add_argument("--tier-blocks", type=int, default=65536)
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(args.seed)
+    part_shape = (args.block_size, args.num_kv_heads, args.head_size)
+    part_bytes = int(np.prod(part_shape)) * 2
+    num_parts = 2 * args.num_layers
+    block_bytes = num_parts * part_bytes
+    pool = HostBlockPool(args.host_blocks, block_bytes)
+    pool.allocate(args.host_blocks)
+    host = np.zeros((args.host_blocks, block_bytes), dtype=np.uint8)
+    print(f"block of {block_bytes / 1024:.0f}KiB, {num_parts} parts of "
+          f"{part_bytes / 1024:.0f}KiB")
+
+    print(f"{'blocks':>7} {'numpy out(GB/s)':>16} {'pool out(GB/s)':>15} "
+          f"{'numpy in(GB/s)':>15} {'pool in(GB/s)':>14}")
+    for num_blocks in args.batch_blocks:
+        ids = rng.choice(args.host_blocks, num_blocks, replace=False).tolist()
+        parts = [
+            rng.standard_normal((num_blocks, *part_shape)).astype(np.float16)
+            for _ in range(num_parts)
+        ]
+        outs = [np.empty_like(part) for part in parts]
+
+        def numpy_swap_out():
+            for i, part in enumerate(parts):
+                host[ids, i * part_bytes:(i + 1) *
+                     part_bytes] = part.reshape(num_blocks, -1).view(np.uint8)
+
+        def pool_swap_out():
+            for i, part in enumerate(parts):
+                pool.write(ids, part, offset=i * part_bytes)
+
+        def numpy_swap_in():
+            for i, out in enumerate(outs):
+                out.reshape(num_blocks, -1).view(np.uint8)[:] = host[
+                    ids, i * part_bytes:(i + 1) * part_bytes]
+
+        def pool_swap_in():
+            for i, out in enumerate(outs):
+                pool.read(ids, out, offset=i * part_bytes)
+
+        latencies = [
+            timeit(fn, args.warmup, args.iters)
+            for fn in (numpy_swap_out, pool_swap_out, numpy_swap_in,
+                       pool_swap_in)
+        ]
+        assert all(np.array_equal(a, b) for a, b in zip(parts, outs))
+        rates = [num_blocks * block_bytes / us / 1e3 for us in latencies]
+        print(f"{num_blocks:>7} {rates[0]:>16.2f} {rates[1]:>15.2f} "
+              f"{rates[2]:>15.2f} {rates[3]:>14.2f}")
+
+    tier = HostKVCacheTier(args.tier_blocks)
+    num_prefixes = 0
+
+    def store_prefix():
+        nonlocal num_prefixes
+        block_hashes = [(num_prefixes, i) for i in range(64)]
+        _, host_ids = tier.prepare_store(block_hashes)
+        tier.complete_store(block_hashes)
+        num_prefixes += 1
+        return host_ids
+
+    while tier.num_free_blocks:
+        store_prefix()
+    store_us = timeit(store_prefix, args.warmup, args.iters * 100)
+    assert tier.num_evicted > 0
+
+    churn_pool = HostBlockPool(args.tier_blocks, 0)
+    held = [churn_pool.allocate(64) for _ in range(args.tier_blocks // 128)]
+
+    def churn():
+        churn_pool.free(held.pop(int(rng.integers(len(held)))))
+        held.append(churn_pool.allocate(64))
+
+    churn_us = timeit(churn, args.warmup, args.iters * 100)
+    print(f"store of 64 blocks into a full tier of {args.tier_blocks}: "
+          f"{store_us:.1f}us, {store_us / 64 * 1e3:.0f}ns per block")
+    print(f"free and allocate of 64 blocks under churn: {churn_us:.1f}us, "
+          f"{churn_us / 64 * 1e3:.0f}ns per block")
+
+
+if __name__ == "__main__":
+    main()
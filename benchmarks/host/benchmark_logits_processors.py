@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Built-in logits processors of a batch, row by row against native.
+
+Every row of a [batch, vocab] float32 batch of logits gets the processors of
+--processors: penalties, bad words, min tokens and allowed token ids. The
+python version applies them one row and processor at a time, as the
+per-sequence callbacks of _apply_logits_processors do; the native engine
+applies them to the whole batch in one call. Both results are checked
+against each other.
+
+Usage:
+    python benchmarks/host/benchmark_logits_processors.py \
+        --batch 256 --vocab 152064 --threads 1 8 0
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from vllm_mindspore import logits_process
+from vllm_mindspore.logits_process import (AllowedTokenIdsLogitsProcessor,
+                                           BadWordsLogitsProcessor,
+                                           MinTokensLogitsProcessor,
+                                           PenaltiesLogitsProcessor,
+                                           apply_builtin_logits_processors)
+
+
+def make_rows(rng, args):
+    rows = []
+    for _ in range(args.batch):
+        processors = []
+        if "penalties" in args.processors:
+            processors.append(PenaltiesLogitsProcessor(1.1, 0.5, 0.2))
+        if "bad_words" in args.processors:
+            processors.append(
+                BadWordsLogitsProcessor([
+                    rng.integers(0, args.vocab, 3).tolist()
+                    for _ in range(args.num_bad_words)
+                ]))
+        if "min_tokens" in args.processors:
+            processors.append(
+                MinTokensLogitsProcessor(args.output_len + 1,
+                                         [args.vocab - 1, args.vocab - 2]))
+        if "allowed" in args.processors:
+            processors.append(
+                AllowedTokenIdsLogitsProcessor(
+                    rng.integers(0, args.vocab, args.num_allowed).tolist()))
+        rows.append((processors, rng.integers(0, args.vocab,
+                                              args.prompt_len).tolist(),
+                     rng.integers(0, args.vocab, args.output_len).tolist()))
+    return rows
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in milliseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e3
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--batch", type=int, default=256)
+    parser.add_argument("--vocab", type=int, default=152064)
+    parser.add_argument("--prompt-len", type=int, default=1024)
+    parser.add_argument("--output-len", type=int, default=256)
+    parser.add_argument("--num-bad-words", type=int, default=16)
+    parser.add_argument("--num-allowed", type=int, default=1024)
+    parser.add_argument(
+        "--processors",
+        nargs="+",
+        choices=["penalties", "bad_words", "min_tokens", "allowed"],
+        default=["penalties", "bad_words", "min_tokens", "allowed"])
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 8, 0])
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    assert logits_process._native_apply_logits_processors is not None, (
+        "vllm_mindspore._C_host is not built")
+    rng = np.random.default_rng(args.seed)
+    rows = make_rows(rng, args)
+    logits = rng.standard_normal((args.batch, args.vocab)).astype(np.float32)
+
+    def run_python():
+        out = logits.copy()
+        for row, (processors, prompt, output) in zip(out, rows):
+            for processor in processors:
+                processor.apply_np(prompt, output, row)
+        return out
+
+    def run_native(threads):
+        out = logits.copy()
+        apply_builtin_logits_processors(out, rows, num_threads=threads)
+        return out
+
+    expected = run_python()
+    # the copy of the logits both versions start from
+    copy_ms = timeit(logits.copy, args.warmup, args.iters)
+    print(f"batch {args.batch} x vocab {args.vocab}, "
+          f"{' '.join(args.processors)}; copy of the logits "
+          f"{copy_ms:.2f} ms included")
+    print(f"{'version':>10} {'ms':>9}")
+    print(f"{'python':>10} {timeit(run_python, 1, 2):>9.2f}")
+    for threads in args.threads:
+        np.testing.assert_array_equal(run_native(threads), expected)
+        native_ms = timeit(lambda: run_native(threads), args.warmup,
+                           args.iters)
+        print(f"{f'native/{threads}t':>10} {native_ms:>9.2f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""host bytes copied to collate the multimodal inputs of an encoder step.
+
+The pixel patches of Qwen2.5-VL images, [t * h * w, 3 * 2 * 14 * 14] fp32
+per image, collated into the batch of a step: numpy concatenation of the
+images, as flat_reduce_data does without the arena, against the MmArena
+the model runner places the images in on arrival. The images of a step
+either arrived together, one span of the arena and a view, or every other
+image of the arena, gathered in one native copy. The arena copies each
+image once, when it arrives, off the step.
+
+Usage:
+    python benchmarks/host/benchmark_mm_collation.py \
+        --images-per-step 1 8 32 --image-size 1024
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from vllm_mindspore._C_host import MmArena
+
+PATCH_DIM = 3 * 2 * 14 * 14
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in microseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def collate(arena: MmArena, views: list[np.ndarray]) -> np.ndarray:
+    """MultiModalArena.collate of images placed in the arena."""
+    address = arena.address
+    offsets = [v.__array_interface__["data"][0] - address for v in views]
+    sizes = [v.nbytes for v in views]
+    shape = (sum(v.shape[0] for v in views), PATCH_DIM)
+    if all(offsets[i] + sizes[i] == offsets[i + 1]
+           for i in range(len(views) - 1)):
+        return np.frombuffer(arena,
+                             dtype=np.float32,
+                             count=sum(sizes) // 4,
+                             offset=offsets[0]).reshape(shape)
+    out = np.empty(shape, dtype=np.float32)
+    arena.gather(offsets, sizes, out)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--images-per-step",
+                        type=int,
+                        nargs="+",
+                        default=[1, 8, 32])
+    # pixels of the longer side; patches of 14 pixels, merged 2x2
+    parser.add_argument("--image-size", type=int, default=1024)
+    parser.add_argument("--arena-mb", type=int, default=4096)
+    parser.add_argument("--lock", action="store_true")
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(args.seed)
+    arena = MmArena(args.arena_mb << 20, lock=args.lock)
+    side = args.image_size // 28 * 2
+    print(f"{'images':>7} {'order':>11} {'MB/step':>8} {'concat(us)':>11} "
+          f"{'arena(us)':>10} {'concat MB copied':>17} "
+          f"{'arena MB copied':>16}")
+    for num_images in args.images_per_step:
+        # heights vary, as the images of a batch do
+        images = [
+            rng.standard_normal(
+                (side * int(rng.integers(side // 2, side + 1)), PATCH_DIM),
+                dtype=np.float32) for _ in range(2 * num_images)
+        ]
+        slots = [arena.place(image, align=4) for image in images]
+        views = [np.frombuffer(slot, dtype=np.float32) for slot in slots]
+        views = [v.reshape(-1, PATCH_DIM) for v in views]
+        for order, step in (("arrival", slice(0, num_images)),
+                            ("interleaved", slice(0, 2 * num_images, 2))):
+            step_images, step_views = images[step], views[step]
+            expected = np.concatenate(step_images)
+            assert np.array_equal(collate(arena, step_views), expected)
+            step_mb = expected.nbytes / 2**20
+            concat_us = timeit(lambda: np.concatenate(step_images),
+                               args.warmup, args.iters)
+            copied = arena.bytes_copied
+            arena_us = timeit(lambda: collate(arena, step_views), args.warmup,
+                              args.iters)
+            arena_mb = (arena.bytes_copied - copied) / 2**20 / (args.warmup +
+                                                                 args.iters)
+            print(f"{num_images:>7} {order:>11} {step_mb:>8.1f} "
+                  f"{concat_us:>11.1f} {arena_us:>10.1f} {step_mb:>17.1f} "
+                  f"{arena_mb:>16.1f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""mrope positions of multimodal prompts, python against the native builder.
+
+Each prompt interleaves text with images and videos; both versions compute
+the positions of the whole prompt and mrope_position_delta, and are checked
+against each other.
+
+Usage:
+    python benchmarks/host/benchmark_mrope_positions.py \
+        --num-images 1 4 16 --num-videos 0 2 --model-type qwen2_5_vl
+"""
+
+import argparse
+import time
+from types import SimpleNamespace
+
+import numpy as np
+
+from vllm_mindspore.model_executor.layers import rotary_embedding
+from vllm_mindspore.model_executor.layers.rotary_embedding import (
+    MRotaryEmbedding)
+
+IMAGE_TOKEN_ID, VIDEO_TOKEN_ID = 151655, 151656
+VISION_START_TOKEN_ID, VISION_END_TOKEN_ID = 151652, 151653
+
+
+def make_prompt(rng, num_images: int, num_videos: int, args):
+    merge = args.spatial_merge_size
+    per_frame = args.model_type == "qwen3_vl"
+    tokens: list[int] = []
+    image_grid_thw, video_grid_thw, second_per_grid_ts = [], [], []
+    items = ["image"] * num_images + ["video"] * num_videos
+    rng.shuffle(items)
+    for item in items:
+        tokens += rng.integers(0, 1000, args.text_len).tolist()
+        h, w = args.grid_hw, args.grid_hw
+        frame_len = h * w // merge**2
+        if item == "image":
+            tokens += ([VISION_START_TOKEN_ID] + [IMAGE_TOKEN_ID] * frame_len +
+                       [VISION_END_TOKEN_ID])
+            image_grid_thw.append([1, h, w])
+            continue
+        t = args.video_frames
+        for frames in ([1] * t if per_frame else [t]):
+            tokens += ([VISION_START_TOKEN_ID] +
+                       [VIDEO_TOKEN_ID] * frames * frame_len +
+                       [VISION_END_TOKEN_ID])
+        video_grid_thw.append([t, h, w])
+        second_per_grid_ts.append(1.0)
+    tokens += rng.integers(0, 1000, args.text_len).tolist()
+    return tokens, image_grid_thw, video_grid_thw, second_per_grid_ts
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in microseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--num-images",
+                        type=int,
+                        nargs="+",
+                        default=[1, 4, 16])
+    parser.add_argument("--num-videos", type=int, nargs="+", default=[0, 2])
+    parser.add_argument("--model-type",
+                        choices=["qwen2_5_vl", "qwen3_vl"],
+                        default="qwen2_5_vl")
+    parser.add_argument("--text-len", type=int, default=128)
+    parser.add_argument("--grid-hw", type=int, default=56)
+    parser.add_argument("--video-frames", type=int, default=8)
+    parser.add_argument("--spatial-merge-size", type=int, default=2)
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--iters", type=int, default=10)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    hf_config = SimpleNamespace(
+        model_type=args.model_type,
+        image_token_id=IMAGE_TOKEN_ID,
+        video_token_id=VIDEO_TOKEN_ID,
+        vision_start_token_id=VISION_START_TOKEN_ID,
+        vision_config=SimpleNamespace(
+            spatial_merge_size=args.spatial_merge_size, tokens_per_second=2))
+    get_positions = (MRotaryEmbedding._qwen3_vl_get_input_positions_tensor
+                     if args.model_type == "qwen3_vl" else
+                     MRotaryEmbedding._vl_get_input_positions_tensor)
+    native = rotary_embedding._native_mrope_positions
+    assert native is not None, "vllm_mindspore._C_host is not built"
+
+    def run(tokens, image_grid_thw, video_grid_thw, second_per_grid_ts):
+        return get_positions(input_tokens=tokens,
+                             hf_config=hf_config,
+                             image_grid_thw=image_grid_thw,
+                             video_grid_thw=video_grid_thw,
+                             second_per_grid_ts=second_per_grid_ts)
+
+    print(f"{'images':>7} {'videos':>7} {'tokens':>8} {'python(us)':>11} "
+          f"{'native(us)':>11}")
+    rng = np.random.default_rng(args.seed)
+    for num_videos in args.num_videos:
+        for num_images in args.num_images:
+            prompt = make_prompt(rng, num_images, num_videos, args)
+            positions, delta = run(*prompt)
+            rotary_embedding._native_mrope_positions = None
+            try:
+                expected, expected_delta = run(*prompt)
+                python_us = timeit(lambda: run(*prompt), args.warmup,
+                                   args.iters)
+            finally:
+                rotary_embedding._native_mrope_positions = native
+            assert delta == expected_delta
+            np.testing.assert_array_equal(positions.asnumpy(),
+                                          expected.asnumpy())
+            native_us = timeit(lambda: run(*prompt), args.warmup, args.iters)
+            print(f"{num_images:>7} {num_videos:>7} {len(prompt[0]):>8} "
+                  f"{python_us:>11.1f} {native_us:>11.1f}")
+
+
+if __name__ == "__main__":
+    main()
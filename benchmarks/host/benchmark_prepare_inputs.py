@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Host batch assembly of _prepare_inputs, numpy against the native pass.
+
+Each batch mixes decode requests (one token) and chunked prefills; both
+versions fill input_ids, positions, query_start_loc, seq_lens and the slot
+mappings of every KV cache group, and are checked against each other.
+
+Usage:
+    python benchmarks/host/benchmark_prepare_inputs.py \
+        --num-reqs 1 16 256 1024 4096 --num-threads 1 4
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from vllm_mindspore._C_host import prepare_inputs
+
+
+class Batch:
+
+    def __init__(self, num_reqs: int, args, seed: int):
+        rng = np.random.default_rng(seed)
+        max_model_len = args.max_model_len
+        self.num_scheduled_tokens = np.where(
+            rng.random(num_reqs) < args.prefill_ratio,
+            rng.integers(1, args.max_prefill_tokens + 1, num_reqs),
+            1).astype(np.int32)
+        self.num_computed_tokens = rng.integers(
+            0, max_model_len - self.num_scheduled_tokens).astype(np.int32)
+        self.token_ids = rng.integers(0, 152064, (num_reqs, max_model_len),
+                                      dtype=np.int32)
+        num_tokens = int(self.num_scheduled_tokens.sum())
+        self.input_ids = np.zeros(num_tokens, dtype=np.int32)
+        self.positions = np.zeros(num_tokens, dtype=np.int64)
+        self.query_start_loc = np.zeros(num_reqs + 1, dtype=np.int32)
+        self.seq_lens = np.zeros(num_reqs, dtype=np.int32)
+        self.block_sizes = args.block_sizes
+        self.block_tables = [
+            rng.integers(0, 1 << 20,
+                         (num_reqs, -(-max_model_len // block_size)),
+                         dtype=np.int32) for block_size in self.block_sizes
+        ]
+        self.slot_mappings = [
+            np.zeros(num_tokens, dtype=np.int64) for _ in self.block_sizes
+        ]
+
+    def outputs(self):
+        return [
+            self.input_ids, self.positions, self.query_start_loc,
+            self.seq_lens, *self.slot_mappings
+        ]
+
+    def run_numpy(self):
+        """The numpy steps of GPUModelRunner._prepare_inputs."""
+        num_reqs = self.num_scheduled_tokens.shape[0]
+        num_tokens = self.input_ids.shape[0]
+        req_indices = np.repeat(np.arange(num_reqs, dtype=np.int32),
+                                self.num_scheduled_tokens)
+        cu_num_tokens = np.cumsum(self.num_scheduled_tokens)
+        arange = np.arange(num_tokens, dtype=np.int32) - np.repeat(
+            cu_num_tokens - self.num_scheduled_tokens,
+            self.num_scheduled_tokens)
+        np.add(self.num_computed_tokens[req_indices],
+               arange,
+               out=self.positions)
+        token_indices = (self.positions +
+                         req_indices * self.token_ids.shape[1])
+        self.input_ids[:] = np.take(self.token_ids.ravel(), token_indices, 0)
+        for block_size, block_table, slot_mapping in zip(
+                self.block_sizes, self.block_tables, self.slot_mappings):
+            block_table_indices = (req_indices * block_table.shape[1] +
+                                   self.positions // block_size)
+            block_numbers = block_table.ravel()[block_table_indices]
+            np.add(block_numbers * block_size,
+                   self.positions % block_size,
+                   out=slot_mapping)
+        self.query_start_loc[0] = 0
+        self.query_start_loc[1:] = cu_num_tokens
+        self.seq_lens[:] = self.num_computed_tokens + self.num_scheduled_tokens
+
+    def run_native(self, num_threads: int):
+        prepare_inputs(self.num_scheduled_tokens,
+                       self.num_computed_tokens,
+                       self.token_ids,
+                       self.input_ids,
+                       self.positions,
+                       self.query_start_loc,
+                       self.seq_lens,
+                       self.block_tables,
+                       self.slot_mappings,
+                       self.block_sizes,
+                       num_threads=num_threads)
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in microseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--num-reqs",
+                        type=int,
+                        nargs="+",
+                        default=[1, 4, 16, 64, 256, 1024, 4096])
+    parser.add_argument("--num-threads", type=int, nargs="+", default=[1, 0])
+    parser.add_argument("--max-model-len", type=int, default=4096)
+    parser.add_argument("--block-sizes", type=int, nargs="+", default=[128])
+    parser.add_argument("--prefill-ratio", type=float, default=0.1)
+    parser.add_argument("--max-prefill-tokens", type=int, default=512)
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--iters", type=int, default=100)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    header = f"{'num_reqs':>9} {'tokens':>8} {'numpy(us)':>10}"
+    for num_threads in args.num_threads:
+        header += f" {f'native-{num_threads}t(us)':>16}"
+    print(header)
+    for num_reqs in args.num_reqs:
+        batch = Batch(num_reqs, args, args.seed)
+        batch.run_numpy()
+        expected = [out.copy() for out in batch.outputs()]
+        line = (f"{num_reqs:>9} {batch.input_ids.shape[0]:>8} "
+                f"{timeit(batch.run_numpy, args.warmup, args.iters):>10.1f}")
+        for num_threads in args.num_threads:
+            for out in batch.outputs():
+                out.fill(-1)
+            batch.run_native(num_threads)
+            for out, ref in zip(batch.outputs(), expected):
+                np.testing.assert_array_equal(out, ref)
+            latency = timeit(lambda: batch.run_native(num_threads),
+                             args.warmup, args.iters)
+            line += f" {latency:>16.1f}"
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""latency of the Punica metadata rebuild of a step of mixed LoRAs.
+
+Metadata: the per token lookup of the slot of every LoRA, the embedding and
+sampler indices and the segments of the batch, as vLLM's convert_mapping
+and compute_meta build them, in Python and numpy, against
+build_punica_metadata, checked equal. SGMV: the reference shrink and expand
+of the segments on the CPU against a numpy matmul per segment.
+
+Usage:
+    python benchmarks/host/benchmark_punica_metadata.py \
+        --num-loras 64 --num-reqs 16 64 256
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from vllm_mindspore._C_host import sgmv_expand, sgmv_shrink
+from vllm_mindspore.lora.punica_wrapper.utils import PunicaMetadataBuilder
+
+
+def timeit(fn, warmup: int, iters: int) -> float:
+    """Return the mean latency in microseconds."""
+    for _ in range(warmup):
+        fn()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def python_metadata(index_mapping, prompt_mapping, lora_index_to_id,
+                    max_loras, vocab_size, extra_vocab_size):
+    lora_indices = np.array([
+        lora_index_to_id.index(x) if x > 0 else -1 for x in index_mapping
+    ],
+                            dtype=np.int64)
+    embedding_indices = np.maximum(lora_indices, 0)
+    embeddings_indices = np.stack([
+        embedding_indices * extra_vocab_size,
+        embedding_indices * (vocab_size + extra_vocab_size)
+    ])
+    sampler_indices = np.array([
+        lora_index_to_id.index(x) if x > 0 else -1 for x in prompt_mapping
+    ],
+                               dtype=np.int64)
+    sampler_indices_padded = np.where(sampler_indices == -1, max_loras - 1,
+                                      sampler_indices)
+    sampler_indices_padded = (np.arange(len(sampler_indices)) +
+                              sampler_indices_padded * len(sampler_indices))
+    run_starts = np.flatnonzero(
+        np.diff(lora_indices, prepend=lora_indices[:1] - 1))
+    seq_lengths = np.diff(run_starts, append=len(lora_indices))
+    return (lora_indices, embeddings_indices, sampler_indices,
+            sampler_indices_padded, run_starts, seq_lengths,
+            lora_indices[run_starts])
+
+
+class Mapping:
+
+    def __init__(self, index_mapping, prompt_mapping):
+        self.index_mapping = index_mapping
+        self.prompt_mapping = prompt_mapping
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--num-loras", type=int, default=64)
+    parser.add_argument("--num-reqs",
+                        type=int,
+                        nargs="+",
+                        default=[16, 64, 256])
+    parser.add_argument("--decode-tokens", type=int, default=1)
+    parser.add_argument("--prefill-tokens", type=int, default=512)
+    parser.add_argument("--vocab-size", type=int, default=151936)
+    parser.add_argument("--hidden-size", type=int, default=2048)
+    parser.add_argument("--rank", type=int, default=16)
+    parser.add_argument("--sgmv-tokens", type=int, default=256)
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--iters", type=int, default=20)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(args.seed)
+    max_loras = args.num_loras + 1
+    lora_index_to_id = list(range(1, args.num_loras + 1)) + [None]
+    builder = PunicaMetadataBuilder(
+        max(args.num_reqs) * args.prefill_tokens, max(args.num_reqs),
+        max_loras)
+
+    print(f"{'reqs':>5} {'tokens':>7} {'python(us)':>11} "
+          f"{'native(us)':>11} {'speedup':>8}")
+    for num_reqs in args.num_reqs:
+        for num_tokens in (args.decode_tokens, args.prefill_tokens):
+            req_lora_ids = rng.integers(0, args.num_loras + 1, num_reqs)
+            mapping = Mapping(tuple(req_lora_ids.repeat(num_tokens).tolist()),
+                              tuple(req_lora_ids.tolist()))
+            call_args = (lora_index_to_id, max_loras, args.vocab_size, 256)
+
+            python_us = timeit(
+                lambda: python_metadata(mapping.index_mapping, mapping.
+                                        prompt_mapping, *call_args),
+                args.warmup, args.iters)
+            native_us = timeit(lambda: builder.build(mapping, *call_args),
+                               args.warmup, args.iters)
+            expected = python_metadata(mapping.index_mapping,
+                                       mapping.prompt_mapping, *call_args)
+            assert np.array_equal(
+                builder.token_lora_indices[:builder.num_tokens], expected[0])
+            assert np.array_equal(builder.embeddings(), expected[1])
+            assert np.array_equal(
+                builder.lora_indices_per_batch[:builder.batch_size],
+                expected[6])
+            print(f"{num_reqs:>5} {builder.num_tokens:>7} "
+                  f"{python_us:>11.1f} {native_us:>11.1f} "
+                  f"{python_us / native_us:>7.1f}x")
+
+    # one segment per request of sgmv_tokens / 16 tokens
+    seq_lengths = np.full(16, args.sgmv_tokens // 16, dtype=np.int64)
+    seq_start_locs = np.cumsum(seq_lengths) - seq_lengths
+    lora_indices = rng.integers(0, args.num_loras, 16)
+    num_tokens = int(seq_lengths.sum())
+    x = rng.standard_normal((num_tokens, args.hidden_size)).astype(np.float32)
+    lora_a = rng.standard_normal((args.num_loras, args.rank,
+                                  args.hidden_size)).astype(np.float32)
+    lora_b = rng.standard_normal((args.num_loras, args.hidden_size,
+                                  args.rank)).astype(np.float32)
+    shrunk = np.zeros((num_tokens, args.rank), dtype=np.float32)
+    out = np.zeros_like(x)
+    expected_out = np.zeros_like(x)
+
+    def numpy_sgmv():
+        expected_out[:] = 0
+        for start, length, lora in zip(seq_start_locs, seq_lengths,
+                                       lora_indices):
+            rows = slice(start, start + length)
+            expected_out[rows] += (x[rows] @ lora_a[lora].T) @ lora_b[lora].T
+
+    def native_sgmv():
+        out[:] = 0
+        sgmv_shrink(x, lora_a, shrunk, seq_start_locs, seq_lengths,
+                    lora_indices, 1.0)
+        sgmv_expand(shrunk, lora_b, out, seq_start_locs, seq_lengths,
+                    lora_indices)
+
+    numpy_us = timeit(numpy_sgmv, args.warmup, args.iters)
+    native_us = timeit(native_sgmv, args.warmup, args.iters)
+    np.testing.assert_allclose(out, expected_out, rtol=1e-3, atol=1e-2)
+    print(f"sgmv of {num_tokens} tokens, hidden {args.hidden_size}, rank "
+          f"{args.rank}: numpy {numpy_us:.1f}us, native {native_us:.1f}us")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Loading a TP shard of a synthetic checkpoint, safe_open against native.
+
+A checkpoint of --num-files shards of --layers decoder layers is written to
+--dir once. Every run walks it with safetensors_weights_iterator and reads
+the slice of one TP rank the way the parallel layers do, column-parallel
+weights along dim 0 and row-parallel ones along dim 1, and reports the
+time to the first tensor, the total time and the GB/s of checkpoint bytes
+read. With --drop-cache the page cache of the files is dropped before every
+run, so that reads come from the disk.
+
+Usage:
+    python benchmarks/host/benchmark_safetensors_loader.py \
+        --dir /tmp/synthetic_ckpt --layers 8 --hidden 4096 --tp 8 \
+        --threads 1 8 0 --drop-cache
+"""
+
+import argparse
+import glob
+import os
+import time
+
+import numpy as np
+from safetensors.numpy import save_file
+
+from vllm_mindspore.model_executor.model_loader import weight_utils
+
+
+def write_checkpoint(args) -> list[str]:
+    files = sorted(glob.glob(os.path.join(args.dir, "*.safetensors")))
+    if files and not args.rewrite:
+        return files
+    os.makedirs(args.dir, exist_ok=True)
+    for path in files:
+        os.remove(path)
+    rng = np.random.default_rng(args.seed)
+    hidden, inter = args.hidden, args.hidden * 3
+    layers_per_file = -(-args.layers // args.num_files)
+    for file_index in range(args.num_files):
+        tensors = {}
+        for layer in range(file_index * layers_per_file,
+                           min(args.layers, (file_index + 1) * layers_per_file)):
+            prefix = f"model.layers.{layer}."
+            for name, shape in (("self_attn.qkv_proj.weight",
+                                 (3 * hidden, hidden)),
+                                ("self_attn.o_proj.weight", (hidden, hidden)),
+                                ("mlp.gate_up_proj.weight",
+                                 (2 * inter, hidden)),
+                                ("mlp.down_proj.weight", (hidden, inter)),
+                                ("input_layernorm.weight", (hidden, ))):
+                tensors[prefix + name] = rng.standard_normal(
+                    shape, dtype=np.float32).astype(np.float16)
+        path = os.path.join(
+            args.dir,
+            f"model-{file_index + 1:05d}-of-{args.num_files:05d}.safetensors")
+        save_file(tensors, path)
+    return sorted(glob.glob(os.path.join(args.dir, "*.safetensors")))
+
+
+def drop_cache(files: list[str]):
+    for path in files:
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+        finally:
+            os.close(fd)
+
+
+def load_rank(files: list[str], tp: int, rank: int):
+    """Return the seconds to the first tensor and in total, and the bytes
+    of the rank's slices."""
+    start = time.perf_counter()
+    first = None
+    nbytes = 0
+    for name, weight in weight_utils.safetensors_weights_iterator(
+            files, False):
+        shape = weight.get_shape()
+        # row-parallel layers split their input dim, the others their output
+        # one; norms are replicated
+        dim = (None if len(shape) == 1 else
+               1 if "o_proj" in name or "down_proj" in name else 0)
+        size = 0 if dim is None else shape[dim] // tp
+        loaded = weight_utils.split_loaded_weight(weight, dim, rank * size,
+                                                  size)
+        nbytes += loaded.nbytes
+        if first is None:
+            first = time.perf_counter() - start
+    return first, time.perf_counter() - start, nbytes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--dir", default="/tmp/vllm_ms_synthetic_ckpt")
+    parser.add_argument("--num-files", type=int, default=4)
+    parser.add_argument("--layers", type=int, default=8)
+    parser.add_argument("--hidden", type=int, default=4096)
+    parser.add_argument("--tp", type=int, default=8)
+    parser.add_argument("--rank", type=int, default=0)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 8, 0])
+    parser.add_argument("--drop-cache", action="store_true")
+    parser.add_argument("--rewrite", action="store_true")
+    parser.add_argument("--iters", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    assert weight_utils.SafetensorsFile is not None, (
+        "vllm_mindspore._C_host is not built")
+    files = write_checkpoint(args)
+    total_bytes = sum(os.path.getsize(path) for path in files)
+    print(f"{len(files)} files, {total_bytes / 1e9:.2f} GB, tp {args.tp}")
+
+    loaders = [("safe_open", False, 1)]
+    loaders += [(f"native/{threads}t", True, threads)
+                for threads in args.threads]
+    print(f"{'loader':>12} {'first(ms)':>10} {'total(s)':>9} "
+          f"{'rank GB/s':>10}")
+    for label, native, threads in loaders:
+        weight_utils._NATIVE_SAFETENSORS = native
+        weight_utils._SAFETENSORS_LOAD_THREADS = threads
+        runs = []
+        for _ in range(args.iters):
+            if args.drop_cache:
+                drop_cache(files)
+            runs.append(load_rank(files, args.tp, args.rank))
+        first = min(run[0] for run in runs)
+        total = min(run[1] for run in runs)
+        nbytes = runs[0][2]
+        print(f"{label:>12} {first * 1e3:>10.2f} {total:>9.3f} "
+              f"{nbytes / total / 1e9:>10.2f}")
+
+
+if __name__ == "__main__":
+    main()
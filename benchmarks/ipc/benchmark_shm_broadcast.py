@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Shared memory broadcast latency, throughput and idle CPU across processes.
+
+One writer process broadcasts through a MessageQueue to reader processes,
+as the scheduler does to the workers, with either the native ring buffer
+queue of _C_host or the Python polling of vLLM:
+- latency: one small message every --interval-us, timed from enqueue to
+  dequeue in each reader;
+- throughput: --num-messages messages of --payload-bytes back to back;
+- idle CPU: the CPU time of the readers blocked in dequeue for --idle-s.
+
+Usage:
+    python benchmarks/ipc/benchmark_shm_broadcast.py --num-readers 8 \
+        --impl native python
+"""
+
+import argparse
+import multiprocessing as mp
+import time
+
+import numpy as np
+
+
+def _set_impl(impl: str):
+    import vllm_mindspore  # noqa: F401, patches shm_broadcast
+    from vllm_mindspore.distributed import shm_broadcast
+    try:
+        from vllm_mindspore._C_host import RingBufferQueue
+    except ImportError:
+        RingBufferQueue = None
+    if impl == "native" and RingBufferQueue is None:
+        raise RuntimeError("vllm_mindspore._C_host is not built")
+    shm_broadcast.RingBufferQueue = RingBufferQueue if impl == "native" \
+        else None
+
+
+def _reader(impl: str, handle, rank: int, args, results):
+    from vllm.distributed.device_communicators.shm_broadcast import (
+        MessageQueue)
+    _set_impl(impl)
+    queue = MessageQueue.create_from_handle(handle, rank)
+    queue.wait_until_ready()
+
+    latencies = []
+    for _ in range(args.num_latency_messages):
+        sent = queue.dequeue()
+        latencies.append(time.perf_counter_ns() - sent)
+
+    queue.dequeue()  # start of the throughput run
+    for _ in range(args.num_messages):
+        queue.dequeue()
+    end = time.perf_counter()
+
+    cpu_start = time.process_time()
+    queue.dequeue()  # sent after --idle-s
+    idle_cpu = time.process_time() - cpu_start
+    results.put((rank, latencies, end, idle_cpu))
+
+
+def bench_one(impl: str, args) -> dict:
+    from vllm.distributed.device_communicators.shm_broadcast import (
+        MessageQueue)
+    _set_impl(impl)
+    queue = MessageQueue(args.num_readers,
+                         args.num_readers,
+                         max_chunk_bytes=max(args.payload_bytes * 2,
+                                             1024 * 1024),
+                         max_chunks=args.max_chunks)
+    handle = queue.export_handle()
+    ctx = mp.get_context("spawn")
+    results = ctx.Queue()
+    readers = [
+        ctx.Process(target=_reader, args=(impl, handle, rank, args, results))
+        for rank in range(args.num_readers)
+    ]
+    for reader in readers:
+        reader.start()
+    queue.wait_until_ready()
+
+    for _ in range(args.num_latency_messages):
+        queue.enqueue(time.perf_counter_ns())
+        time.sleep(args.interval_us * 1e-6)
+
+    payload = b"x" * args.payload_bytes
+    queue.enqueue(None)
+    start = time.perf_counter()
+    for _ in range(args.num_messages):
+        queue.enqueue(payload)
+
+    time.sleep(args.idle_s)
+    queue.enqueue(None)
+    reports = [results.get() for _ in readers]
+    for reader in readers:
+        reader.join()
+
+    latencies = np.concatenate([report[1] for report in reports]) / 1e3
+    elapsed = max(report[2] for report in reports) - start
+    return {
+        "p50_us": np.percentile(latencies, 50),
+        "p99_us": np.percentile(latencies, 99),
+        "msg_per_s": args.num_messages / elapsed,
+        "gb_per_s": args.num_messages * args.payload_bytes / elapsed / 1e9,
+        "idle_cpu": sum(report[3] for report in reports) / len(reports) /
+        args.idle_s,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--impl",
+                        choices=["native", "python"],
+                        nargs="+",
+                        default=["native", "python"])
+    parser.add_argument("--num-readers", type=int, default=8)
+    parser.add_argument("--max-chunks", type=int, default=10)
+    parser.add_argument("--num-latency-messages", type=int, default=2000)
+    parser.add_argument("--interval-us", type=float, default=200)
+    parser.add_argument("--num-messages", type=int, default=5000)
+    parser.add_argument("--payload-bytes", type=int, default=64 * 1024)
+    parser.add_argument("--idle-s", type=float, default=2.0)
+    args = parser.parse_args()
+
+    print(f"{'impl':>8} {'p50(us)':>9} {'p99(us)':>9} {'msg/s':>10} "
+          f"{'GB/s':>7} {'idle CPU/reader':>16}")
+    for impl in args.impl:
+        result = bench_one(impl, args)
+        print(f"{impl:>8} {result['p50_us']:>9.1f} {result['p99_us']:>9.1f} "
+              f"{result['msg_per_s']:>10.0f} {result['gb_per_s']:>7.2f} "
+              f"{result['idle_cpu']:>15.1%}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Msgpack tensor encode/decode throughput, with and without _C_host.
+
+The legacy codec flattens the tensor into a copy on encode and copies the
+received buffer into a bytearray on decode; the zero-copy codec exposes the
+host memory of the tensor on encode and builds the tensor over the received
+frame on decode.
+
+Usage:
+    python benchmarks/ipc/benchmark_tensor_serialization.py \
+        --sizes-mb 1 4 16 64 256
+"""
+
+import argparse
+import time
+
+import mindspore as ms
+import numpy as np
+from vllm.v1.serial_utils import MsgpackDecoder, MsgpackEncoder
+
+import vllm_mindspore  # noqa: F401, patches the msgpack tensor codec
+from vllm_mindspore.v1 import serial_utils
+
+
+def _legacy_encode_tensor(self, obj):
+    arr = obj.numpy().flatten().view(dtype=np.uint8)
+    data = len(self.aux_buffers)
+    self.aux_buffers.append(arr.data)
+    return str(obj.dtype), obj.shape, data
+
+
+def _legacy_decode_tensor(self, arr):
+    dtype, shape, data = arr
+    buffer = bytearray(self.aux_buffers[data])
+    arr = np.frombuffer(buffer, dtype=np.uint8)
+    arr = arr.view(dtype=serial_utils.mstype_str_to_np_type[dtype])
+    return ms.from_numpy(arr.reshape(shape))
+
+
+def bench_one(tensor: ms.Tensor, legacy: bool, warmup: int,
+              iters: int) -> tuple[float, float]:
+    """Return the mean encode and decode time in seconds."""
+    encoder = MsgpackEncoder(size_threshold=256)
+    decoder = MsgpackDecoder(ms.Tensor)
+    if legacy:
+        encoder._encode_tensor = _legacy_encode_tensor.__get__(encoder)
+        decoder._decode_tensor = _legacy_decode_tensor.__get__(decoder)
+    # frames as a zmq receiver gets them, read-only and owned by the message
+    frames = [bytes(frame) for frame in encoder.encode(tensor)]
+
+    for _ in range(warmup):
+        encoder.encode(tensor)
+        decoder.decode(frames)
+    start = time.perf_counter()
+    for _ in range(iters):
+        encoder.encode(tensor)
+    encode_time = (time.perf_counter() - start) / iters
+    start = time.perf_counter()
+    for _ in range(iters):
+        decoder.decode(frames)
+    decode_time = (time.perf_counter() - start) / iters
+    return encode_time, decode_time
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--sizes-mb",
+                        type=int,
+                        nargs="+",
+                        default=[1, 4, 16, 64, 256])
+    parser.add_argument("--dtype",
+                        choices=["float32", "bfloat16"],
+                        default="bfloat16")
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iters", type=int, default=20)
+    args = parser.parse_args()
+
+    if serial_utils.buffer_view is None:
+        print("vllm_mindspore._C_host is not built, "
+              "the zero-copy codec falls back to copies")
+    ms.set_context(device_target="CPU")
+    dtype = getattr(ms, args.dtype)
+    itemsize = np.dtype(np.float32).itemsize if args.dtype == "float32" else 2
+    print(f"{'size(MB)':>9} {'codec':>10} {'encode(GB/s)':>13} "
+          f"{'decode(GB/s)':>13}")
+    for size_mb in args.sizes_mb:
+        nbytes = size_mb << 20
+        tensor = ms.Tensor(np.ones((nbytes // itemsize // 1024, 1024),
+                                   dtype=np.float32),
+                           dtype=dtype)
+        for legacy in (True, False):
+            encode_time, decode_time = bench_one(tensor, legacy, args.warmup,
+                                                 args.iters)
+            print(f"{size_mb:>9} {'legacy' if legacy else 'zero-copy':>10} "
+                  f"{nbytes / encode_time / 1e9:>13.2f} "
+                  f"{nbytes / decode_time / 1e9:>13.2f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Step latency of advance_step_flashattn against the number of sequences.
+
+Usage:
+    python benchmarks/kernels/benchmark_adv_step_flash.py \
+        --num-seqs 1 16 64 256 1024 4096 --block-size 16
+"""
+
+import argparse
+import time
+
+import mindspore as ms
+import numpy as np
+
+from vllm_mindspore._custom_ops import advance_step_flashattn
+
+
+def make_inputs(num_seqs: int, block_size: int, max_blocks_per_seq: int,
+                headroom: int, seed: int):
+    rng = np.random.default_rng(seed)
+    # leave room for the in-place seq_lens growth of every timed step
+    max_len = block_size * max_blocks_per_seq - headroom - 1
+    seq_lens = rng.integers(1, max_len, num_seqs, dtype=np.int32)
+    sampled_token_ids = rng.integers(0, 32000, (num_seqs, 1), dtype=np.int32)
+    block_tables = rng.integers(0, 65536, (num_seqs, max_blocks_per_seq),
+                                dtype=np.int32)
+    return dict(
+        input_tokens=ms.Tensor(np.zeros(num_seqs, dtype=np.int32)),
+        sampled_token_ids=ms.Tensor(sampled_token_ids),
+        input_positions=ms.Tensor(np.zeros(num_seqs, dtype=np.int32)),
+        seq_lens=ms.Tensor(seq_lens),
+        slot_mapping=ms.Tensor(np.zeros(num_seqs, dtype=np.int32)),
+        block_tables=ms.Tensor(block_tables),
+    )
+
+
+def bench_one(num_seqs: int, block_size: int, max_blocks_per_seq: int,
+              warmup: int, iters: int, seed: int) -> float:
+    """Return the mean latency of one step in microseconds."""
+    inputs = make_inputs(num_seqs, block_size, max_blocks_per_seq,
+                         warmup + iters, seed)
+
+    def step():
+        advance_step_flashattn(num_seqs=num_seqs,
+                               num_queries=num_seqs,
+                               block_size=block_size,
+                               **inputs)
+
+    for _ in range(warmup):
+        step()
+    ms.runtime.synchronize()
+    start = time.perf_counter()
+    for _ in range(iters):
+        step()
+    ms.runtime.synchronize()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--num-seqs",
+                        type=int,
+                        nargs="+",
+                        default=[1, 8, 32, 64, 128, 256, 512, 1024, 2048,
+                                 4096])
+    parser.add_argument("--block-size", type=int, default=16)
+    parser.add_argument("--max-blocks-per-seq", type=int, default=512)
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--iters", type=int, default=100)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    ms.set_context(device_target="Ascend")
+    print(f"{'num_seqs':>10} {'latency(us)':>12} {'us/seq':>10}")
+    for num_seqs in args.num_seqs:
+        latency = bench_one(num_seqs, args.block_size,
+                            args.max_blocks_per_seq, args.warmup, args.iters,
+                            args.seed)
+        print(f"{num_seqs:>10} {latency:>12.2f} {latency / num_seqs:>10.3f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright 2025 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+"""Device latency sweep of the custom ops, for the dashboard.
+
+The cases of csrc/cpu/benchmarks/benchmark_ops, run through the pyboost ops
+of _C_ops on the NPU, each call timed between two device events, so that
+the report holds the p50/p99 latency of the AscendC kernels. The report has
+the JSON layout of the host benchmark, with backend "npu", and is ingested
+with dashboard/benchmark_to_dashboard.py --op-bench-json. Without an NPU or
+a custom op build, the host benchmark binary runs instead and its report,
+of the host reference kernels, is written.
+
+Usage:
+    python benchmarks/kernels/benchmark_custom_ops.py --output ops.json \
+        --host-benchmark build/benchmarks/benchmark_ops
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+
+import numpy as np
+
+try:
+    import mindspore as ms
+
+    from vllm_mindspore import _custom_ops
+except ImportError:
+    # the host benchmark needs neither
+    ms = _custom_ops = None
+
+OPS = ("advance_step_flashattn", "rejection_sample", "attention_mask",
+       "eagle_prepare_inputs", "segment_pool")
+
+
+def npu_available() -> bool:
+    """Whether MindSpore runs on an Ascend NPU here, with the custom ops
+    built for it."""
+    if ms is None:
+        return False
+    try:
+        from mindspore.device_context.ascend import is_available
+    except ImportError:
+
+        def is_available():
+            return ms.hal.is_available("Ascend")
+
+    if not is_available():
+        return False
+    ms.set_context(device_target="Ascend")
+    return all(_custom_ops.is_custom_op_available(op) for op in OPS)
+
+
+def measure(args, op: str, params: dict, nbytes: int, fn):
+    """Time every call of fn on the device on its own, between two events
+    of the current stream."""
+    samples = []
+    for i in range(args.warmup + args.iters):
+        start = ms.runtime.Event(enable_timing=True)
+        end = ms.runtime.Event(enable_timing=True)
+        start.record()
+        fn()
+        end.record()
+        end.synchronize()
+        if i >= args.warmup:
+            samples.append(start.elapsed_time(end) * 1e3)
+    samples = np.sort(samples)
+
+    def percentile(q):
+        rank = int(q * (len(samples) - 1) + 0.5)
+        return float(samples[min(rank, len(samples) - 1)])
+
+    return dict(op=op,
+                params=params,
+                p50_us=percentile(0.5),
+                p99_us=percentile(0.99),
+                bytes=nbytes)
+
+
+def bench_adv_step_flash(args, num_seqs, block_size, idx_dtype, len_dtype,
+                         rng):
+    max_blocks_per_seq = 64
+    # leave room for the in-place seq_lens growth of every timed step
+    max_len = block_size * max_blocks_per_seq - args.warmup - args.iters - 2
+    inputs = dict(
+        input_tokens=ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype)),
+        sampled_token_ids=ms.Tensor(
+            rng.integers(0, 151936, (num_seqs, 1), dtype=idx_dtype)),
+        input_positions=ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype)),
+        seq_lens=ms.Tensor(
+            rng.integers(0, max(max_len, 1), num_seqs, dtype=len_dtype)),
+        slot_mapping=ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype)),
+        block_tables=ms.Tensor(
+            rng.integers(0,
+                         65536, (num_seqs, max_blocks_per_seq),
+                         dtype=np.int32)))
+
+    idx_size = np.dtype(idx_dtype).itemsize
+    len_size = np.dtype(len_dtype).itemsize
+    nbytes = num_seqs * (4 * idx_size + 2 * len_size + 4)
+    params = dict(num_seqs=num_seqs,
+                  block_size=block_size,
+                  dtype=f"{np.dtype(idx_dtype)}/{np.dtype(len_dtype)}")
+    return measure(
+        args, "adv_step_flash", params, nbytes,
+        lambda: _custom_ops.advance_step_flashattn(
+            num_seqs=num_seqs,
+            num_queries=num_seqs,
+            block_size=block_size,
+            **inputs))
+
+
+def bench_rejection_sample(args, batch_size, max_spec_len, vocab_size,
+                           greedy, rng):
+    num_tokens = batch_size * max_spec_len
+
+    def random_probs(*shape):
+        return ms.Tensor(
+            rng.random(shape, dtype=np.float32) / np.float32(vocab_size))
+
+    target_probs = random_probs(num_tokens, vocab_size)
+    draft_probs = None if greedy else random_probs(num_tokens, vocab_size)
+    output_token_ids = ms.Tensor(
+        np.full((batch_size, max_spec_len + 1), -1, dtype=np.int32))
+    cu_num_draft_tokens = ms.Tensor(
+        np.arange(1, batch_size + 1, dtype=np.int32) * max_spec_len)
+    draft_token_ids = ms.Tensor(
+        rng.integers(0, vocab_size, num_tokens, dtype=np.int32))
+    bonus_token_ids = ms.Tensor(
+        rng.integers(0, vocab_size, (batch_size, 1), dtype=np.int32))
+    is_greedy = ms.Tensor(np.full(batch_size, greedy, dtype=np.bool_))
+    inputs = (output_token_ids, cu_num_draft_tokens, draft_token_ids,
+              draft_probs, target_probs, bonus_token_ids,
+              random_probs(num_tokens), random_probs(batch_size, vocab_size),
+              is_greedy, max_spec_len)
+
+    # as the host benchmark counts them
+    probs_read = num_tokens * vocab_size if greedy else 3 * num_tokens
+    nbytes = 4 * probs_read + 4 * (num_tokens + batch_size *
+                                   (max_spec_len + 1))
+    params = dict(batch_size=batch_size,
+                  max_spec_len=max_spec_len,
+                  vocab_size=vocab_size,
+                  dtype="float32",
+                  greedy=greedy)
+    return measure(args, "rejection_sample", params, nbytes,
+                   lambda: _custom_ops.rejection_sample(*inputs))
+
+
+def bench_attention_mask(args, num_reqs, max_seq_len, dtype):
+    chunk_len = 128
+    query_lens = np.where(np.arange(num_reqs) % 2 == 0, chunk_len,
+                          1).astype(np.int32)
+    mask_offsets = np.where(query_lens > 1, max_seq_len - query_lens,
+                            max_seq_len).astype(np.int32)
+    num_rows = int(query_lens.sum())
+    mask = ms.Tensor(np.zeros((num_rows, max_seq_len), dtype=dtype))
+    inputs = (mask, ms.Tensor(query_lens), ms.Tensor(mask_offsets), 1.0)
+
+    nbytes = mask.nbytes + 2 * num_reqs * 4
+    params = dict(num_reqs=num_reqs,
+                  max_seq_len=max_seq_len,
+                  dtype=str(np.dtype(dtype)))
+    return measure(args, "attention_mask", params, nbytes,
+                   lambda: _custom_ops.attention_mask(*inputs))
+
+
+def bench_eagle_prepare_inputs(args, num_reqs, max_spec_len, rng):
+    max_gen_len = max_spec_len + 1
+    sampled_token_ids = np.full((num_reqs, max_gen_len), -1, dtype=np.int32)
+    for i, num_sampled in enumerate(
+            rng.integers(0, max_spec_len + 1, num_reqs) + 1):
+        sampled_token_ids[i, :num_sampled] = rng.integers(
+            0, 151936, num_sampled)
+    inputs = (
+        *(ms.Tensor(np.zeros(num_reqs, dtype=np.int32)) for _ in range(3)),
+        ms.Tensor(sampled_token_ids),
+        ms.Tensor(np.arange(1, num_reqs + 1, dtype=np.int32) * max_spec_len),
+        ms.Tensor(np.zeros(num_reqs, dtype=np.bool_)),
+        ms.Tensor(rng.integers(0, 151936, num_reqs, dtype=np.int32)),
+        ms.Tensor(np.arange(num_reqs + 1, dtype=np.int32) * max_gen_len),
+        151936)
+
+    nbytes = sampled_token_ids.nbytes + num_reqs * (7 * 4 + 1)
+    params = dict(num_reqs=num_reqs, max_spec_len=max_spec_len, dtype="int32")
+    return measure(args, "eagle_prepare_inputs", params, nbytes,
+                   lambda: _custom_ops.eagle_prepare_inputs(*inputs))
+
+
+def bench_segment_pool(args, num_reqs, seq_len, hidden_size, pooling_type,
+                       rng):
+    mean = pooling_type == _custom_ops.SEGMENT_POOL_MEAN
+    # bf16 of [0.0078125, 2), as the host benchmark draws them
+    hidden = rng.uniform(0.0078125, 2, (num_reqs * seq_len, hidden_size))
+    hidden_states = ms.Tensor(hidden.astype(np.float32)).astype(ms.bfloat16)
+    pooled = ms.Tensor(np.zeros((num_reqs, hidden_size), dtype=np.float32))
+    if not mean:
+        pooled = pooled.astype(ms.bfloat16)
+    first = np.arange(num_reqs, dtype=np.int32) * seq_len
+    inputs = (pooled,
+              ms.Tensor(np.zeros((num_reqs, hidden_size), dtype=np.float32)),
+              hidden_states, ms.Tensor(first),
+              ms.Tensor(first + seq_len - 1),
+              ms.Tensor(np.full(num_reqs, seq_len, dtype=np.int32)),
+              ms.Tensor(np.zeros(num_reqs, dtype=np.int32)), pooling_type)
+
+    rows_read = num_reqs * seq_len if mean else num_reqs
+    nbytes = rows_read * hidden_size * 2 + num_reqs * (4 * 4 + hidden_size *
+                                                       (4 if mean else 2))
+    params = dict(num_reqs=num_reqs,
+                  seq_len=seq_len,
+                  hidden_size=hidden_size,
+                  pooling_type="mean" if mean else "last",
+                  dtype="bfloat16")
+    return measure(args, "segment_pool", params, nbytes,
+                   lambda: _custom_ops.segment_pool(*inputs))
+
+
+def run_npu(args) -> dict:
+    """The sweep of the host benchmark, on the NPU."""
+    quick = args.quick
+    rng = np.random.default_rng(0)
+    results = []
+    for block_size in [16] if quick else [16, 128]:
+        for num_seqs in ([1, 256] if quick else
+                         [1, 16, 64, 256, 1024, 4096, 16384, 65536]):
+            for idx_dtype, len_dtype in ((np.int32, np.int32),
+                                         (np.int64, np.int32),
+                                         (np.int64, np.int64)):
+                results.append(
+                    bench_adv_step_flash(args, num_seqs, block_size,
+                                         idx_dtype, len_dtype, rng))
+    spec_lens = [2] if quick else [1, 3, 5]
+    for max_spec_len in spec_lens:
+        for batch_size in [1, 8] if quick else [1, 8, 32, 128]:
+            for greedy in (True, False):
+                results.append(
+                    bench_rejection_sample(args, batch_size, max_spec_len,
+                                           1024 if quick else 32000, greedy,
+                                           rng))
+    for max_seq_len in [1024] if quick else [8192, 32768]:
+        for num_reqs in [2] if quick else [2, 16]:
+            for dtype in (np.float16, np.float32):
+                results.append(
+                    bench_attention_mask(args, num_reqs, max_seq_len, dtype))
+    for max_spec_len in spec_lens:
+        for num_reqs in [8] if quick else [1, 16, 64, 256, 1024]:
+            results.append(
+                bench_eagle_prepare_inputs(args, num_reqs, max_spec_len, rng))
+    # short sequences as embedding batches send them
+    for pooling_type in (_custom_ops.SEGMENT_POOL_LAST,
+                         _custom_ops.SEGMENT_POOL_MEAN):
+        for num_reqs in [16] if quick else [1, 64, 1024, 4096]:
+            results.append(
+                bench_segment_pool(args, num_reqs, 32,
+                                   256 if quick else 1024, pooling_type, rng))
+
+    for r in results:
+        r["gbps"] = r["bytes"] / (r["p50_us"] * 1e3) if r["p50_us"] else 0.0
+        print(f"{r['op']:<18} {json.dumps(r['params']):<72} "
+              f"p50 {r['p50_us']:10.2f} us  p99 {r['p99_us']:10.2f} us",
+              file=sys.stderr)
+    return dict(suite="custom_ops",
+                backend="npu",
+                iters=args.iters,
+                results=results)
+
+
+def run_host(args) -> dict:
+    """The report of the host benchmark binary, of the reference kernels."""
+    cmd = [
+        args.host_benchmark, "--iters", str(args.iters), "--warmup",
+        str(args.warmup)
+    ]
+    if args.quick:
+        cmd.append("--quick")
+    output = subprocess.run(cmd, check=True, stdout=subprocess.PIPE).stdout
+    return json.loads(output)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--iters", type=int, default=200)
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--quick", action="store_true")
+    parser.add_argument("--output", default=None)
+    # the fallback without an NPU, built from csrc/cpu
+    parser.add_argument("--host-benchmark",
+                        default="build/benchmarks/benchmark_ops")
+    args = parser.parse_args()
+
+    if npu_available():
+        report = run_npu(args)
+    else:
+        print("No NPU with the custom ops, running the host benchmark",
+              file=sys.stderr)
+        report = run_host(args)
+    if args.output is None:
+        json.dump(report, sys.stdout, indent=2)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
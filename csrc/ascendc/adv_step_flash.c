@@ -15,6 +15,8 @@
  */
 #include "kernel_operator.h"
 
+#include "adv_step_flash_tiling.h"
+
 using namespace AscendC;
 
 template <typename Tp, Tp v>
@@ -41,83 +43,202 @@ __aicore__ inline void DataCopyCustom(const U &dstTensor, const R &srcTensor, co
   }
 }
 
+constexpr int32_t BUFFER_NUM = 2;  // tensor num for each queue
+constexpr int32_t BLOCK_BYTES = 32;
+// UB bytes per token of the tile to stage its block table entries in
+constexpr int32_t STAGING_BYTES_PER_TOKEN = 2 * BLOCK_BYTES;
+
+// The index math runs on int32; int64 tensors are narrowed on load and widened on store inside the kernel.
+template <typename T>
+__aicore__ inline void CastToInt32(const LocalTensor<int32_t> &dst, const LocalTensor<T> &src, const int32_t count) {
+  if constexpr (is_same<T, int32_t>::value) {
+    Adds(dst, src, (int32_t)0, count);
+  } else {
+    Cast(dst, src, RoundMode::CAST_NONE, count);
+  }
+}
+
+template <typename T>
+__aicore__ inline void CastFromInt32(const LocalTensor<T> &dst, const LocalTensor<int32_t> &src, const int32_t count) {
+  if constexpr (is_same<T, int32_t>::value) {
+    Adds(dst, src, (int32_t)0, count);
+  } else {
+    Cast(dst, src, RoundMode::CAST_NONE, count);
+  }
+}
+
+// Bit exact copy of `count` elements of T, whatever the width of T.
+template <typename T>
+__aicore__ inline void CopyLocal(const LocalTensor<T> &dst, const LocalTensor<T> &src, const int32_t count) {
+  constexpr int32_t int32PerElem = sizeof(T) / sizeof(int32_t);
+  Adds(dst.template ReinterpretCast<int32_t>(), src.template ReinterpretCast<int32_t>(), (int32_t)0,
+       count * int32PerElem);
+}
+
+// IdxT: dtype of sampled_token_ids, input_tokens, input_positions and slot_mapping.
+// LenT: dtype of seq_lens.
+// Each of the first num_queries sequences advances by num_tokens_per_seq tokens. Token k of sequence i lands at
+// i * num_tokens_per_seq + k of the token tensors. The padded sequences [num_queries, num_seqs) get token 0,
+// position 0 and slot -1, and keep their seq_lens.
+template <typename IdxT, typename LenT>
 class KernelAdvStepFlash {
 public:
   __aicore__ inline KernelAdvStepFlash(TPipe *pipe) { Ppipe = pipe; }
 
   __aicore__ inline void Init(GM_ADDR sampledTokenIds, GM_ADDR blockTables, GM_ADDR seqLensInput, GM_ADDR inputTokens,
                               GM_ADDR inputPositions, GM_ADDR seqLensOut, GM_ADDR slotMapping, int32_t num_seqs,
-                              int32_t block_size, int32_t block_tables_stride) {
+                              int32_t num_queries, int32_t num_tokens_per_seq, int32_t block_size,
+                              int32_t block_tables_stride, int32_t seqs_per_core, int32_t tile_length) {
     ASSERT(GetBlockNum() != 0 && "Block dim can not be zero!");
     this->blockSize = block_size;
     this->blockTablesStride = block_tables_stride;
-    this->tensorLength = num_seqs;
+    this->tokensPerSeq = num_tokens_per_seq;
+    this->tileLength = tile_length;
+    this->tileTokens = tile_length * num_tokens_per_seq;
 
     this->blockSizeFp = static_cast<float>(this->blockSize);
+    // block sizes are powers of two in practice: the block index is then a shift
+    this->blockSizeShift = -1;
+    for (int32_t shift = 0; shift < 31; shift++) {
+      if ((1 << shift) == block_size) {
+        this->blockSizeShift = shift;
+        break;
+      }
+    }
 
     // get start index for current core, core parallel
-    sampledTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)sampledTokenIds, tensorLength);
-    seqLensInputGm.SetGlobalBuffer((__gm__ int32_t *)seqLensInput, tensorLength);
-    blockTablesGm.SetGlobalBuffer((__gm__ int32_t *)blockTables);  // inf size
-
-    inputTokensGm.SetGlobalBuffer((__gm__ int32_t *)inputTokens, tensorLength);
-    inputPositionsGm.SetGlobalBuffer((__gm__ int32_t *)inputPositions, tensorLength);
-    seqLensOutGm.SetGlobalBuffer((__gm__ int32_t *)seqLensOut, tensorLength);
-    slotMappingGm.SetGlobalBuffer((__gm__ int32_t *)slotMapping, tensorLength);
-
-    // pipe alloc memory to queue, the unit is Bytes
-    Ppipe->InitBuffer(sampledIdsQue, 1, tensorLength * sizeof(int32_t));
-    Ppipe->InitBuffer(seqLenInQue, 1, tensorLength * sizeof(int32_t));
-
-    Ppipe->InitBuffer(inputTokensQue, 1, tensorLength * sizeof(int32_t));
-    Ppipe->InitBuffer(seqLensOutQue, 1, tensorLength * sizeof(int32_t));
-    Ppipe->InitBuffer(inputPositionsQue, 1, tensorLength * sizeof(int32_t));
+    int64_t coreStart = static_cast<int64_t>(GetBlockIdx()) * seqs_per_core;
+    int64_t remain = num_seqs - coreStart;
+    this->coreLength = remain < seqs_per_core ? remain : seqs_per_core;
+    if (this->coreLength <= 0) {
+      this->coreLength = 0;
+      return;
+    }
+    int64_t queriesRemain = num_queries - coreStart;
+    this->validLength = queriesRemain < 0 ? 0 : (queriesRemain < coreLength ? queriesRemain : coreLength);
 
-    Ppipe->InitBuffer(tableOffsetBuf, tensorLength * sizeof(int32_t));
+    int64_t tokenStart = coreStart * tokensPerSeq;
+    int64_t coreTokens = coreLength * tokensPerSeq;
+    sampledTokenIdsGm.SetGlobalBuffer((__gm__ IdxT *)sampledTokenIds + tokenStart, coreTokens);
+    seqLensInputGm.SetGlobalBuffer((__gm__ LenT *)seqLensInput + coreStart, coreLength);
+    blockTablesGm.SetGlobalBuffer((__gm__ int32_t *)blockTables + coreStart * block_tables_stride);  // inf size
 
-    Ppipe->InitBuffer(tmpDivBuf01, tensorLength * sizeof(int32_t));
-    Ppipe->InitBuffer(tmpDivBuf02, tensorLength * sizeof(int32_t));
+    inputTokensGm.SetGlobalBuffer((__gm__ IdxT *)inputTokens + tokenStart, coreTokens);
+    inputPositionsGm.SetGlobalBuffer((__gm__ IdxT *)inputPositions + tokenStart, coreTokens);
+    seqLensOutGm.SetGlobalBuffer((__gm__ LenT *)seqLensOut + coreStart, coreLength);
+    slotMappingGm.SetGlobalBuffer((__gm__ IdxT *)slotMapping + tokenStart, coreTokens);
 
-    Ppipe->InitBuffer(outTableBuf, tensorLength * sizeof(int32_t));
-    Ppipe->InitBuffer(blockTableBuf, 32);
+    // pipe alloc memory to queue, the unit is Bytes
+    Ppipe->InitBuffer(sampledIdsQue, BUFFER_NUM, tileTokens * sizeof(IdxT));
+    Ppipe->InitBuffer(seqLenInQue, BUFFER_NUM, tileLength * sizeof(LenT));
+
+    Ppipe->InitBuffer(inputTokensQue, BUFFER_NUM, tileTokens * sizeof(IdxT));
+    Ppipe->InitBuffer(seqLensOutQue, BUFFER_NUM, tileLength * sizeof(LenT));
+    Ppipe->InitBuffer(inputPositionsQue, BUFFER_NUM, tileTokens * sizeof(IdxT));
+    Ppipe->InitBuffer(slotMappingQue, BUFFER_NUM, tileTokens * sizeof(IdxT));
+
+    Ppipe->InitBuffer(seqLenBuf, tileLength * sizeof(int32_t));
+    Ppipe->InitBuffer(positionsBuf, tileTokens * sizeof(int32_t));
+    Ppipe->InitBuffer(gatherOffsetBuf, tileTokens * sizeof(int32_t));
+    Ppipe->InitBuffer(blockIdxBuf, tileTokens * sizeof(int32_t));
+    Ppipe->InitBuffer(blockOffsetBuf, tileTokens * sizeof(int32_t));
+
+    // tmpDivBuf01 and tmpIntBuf also hold the IdxT padding constants
+    Ppipe->InitBuffer(tmpDivBuf01, tileTokens * sizeof(IdxT));
+    Ppipe->InitBuffer(tmpDivBuf02, tileTokens * sizeof(int32_t));
+    Ppipe->InitBuffer(tmpIntBuf, tileTokens * sizeof(IdxT));
+
+    Ppipe->InitBuffer(outTableBuf, tileTokens * sizeof(int32_t));
+    // the block table window of a tile, a 32B aligned row per sequence
+    this->stagingBytes = static_cast<int64_t>(tileTokens) * STAGING_BYTES_PER_TOKEN;
+    Ppipe->InitBuffer(blockTableBuf, stagingBytes);
+    Ppipe->InitBuffer(colBaseBuf, tileTokens * sizeof(int32_t));
+
+    // token j of a tile belongs to sequence j / tokensPerSeq, and is its (j % tokensPerSeq)-th new token
+    Ppipe->InitBuffer(tokenSeqBuf, tileTokens * sizeof(int32_t));
+    Ppipe->InitBuffer(tokenStepBuf, tileTokens * sizeof(int32_t));
+    Ppipe->InitBuffer(expandOffsetBuf, tileTokens * sizeof(uint32_t));
   }
 
   __aicore__ inline void Process() {
-    CopyIn();
-    Compute();
-    CopyOut();
+    if (coreLength == 0) {
+      return;
+    }
+    InitTileConstants();
+
+    // the queues hold two tiles, so copying in tile i + 1 overlaps with
+    // computing tile i and copying out tile i - 1
+    int64_t tileNum = (validLength + tileLength - 1) / tileLength;
+    for (int64_t i = 0; i < tileNum; i++) {
+      int64_t offset = i * tileLength;
+      int64_t remain = validLength - offset;
+      int32_t length = static_cast<int32_t>(remain < tileLength ? remain : tileLength);
+      CopyIn(offset, length);
+      Compute(offset, length);
+      CopyOut(offset, length);
+    }
+    FillPadding();
   }
 
 private:
-  __aicore__ inline void CopyIn() {
-    LocalTensor<int32_t> sampledIdsLocal = sampledIdsQue.AllocTensor<int32_t>();
-    LocalTensor<int32_t> seqLenInLocal = seqLenInQue.AllocTensor<int32_t>();
+  // Tile invariant constants: the block size divisor and the sequence / step of each token of a tile.
+  __aicore__ inline void InitTileConstants() {
+    LocalTensor<float> blockSizeLocal = tmpDivBuf02.Get<float>();
+    LocalTensor<float> tokensPerSeqLocal = outTableBuf.Get<float>();
+    LocalTensor<int32_t> tokenIndex = colBaseBuf.Get<int32_t>();
+    LocalTensor<int32_t> tokenSeq = tokenSeqBuf.Get<int32_t>();
+    LocalTensor<int32_t> tokenStep = tokenStepBuf.Get<int32_t>();
+    LocalTensor<int32_t> expandOffset = expandOffsetBuf.Get<int32_t>();
+
+    Duplicate(tokensPerSeqLocal, static_cast<float>(tokensPerSeq), tileTokens);
+    CreateVecIndex(tokenIndex, (int32_t)0, tileTokens);
+    PipeBarrier<PIPE_V>();
+    FloorDivMod(tokenSeq, tokenStep, tokenIndex, tokensPerSeq, tokensPerSeqLocal, tileTokens);
+    Muls(expandOffset, tokenSeq, static_cast<int32_t>(sizeof(int32_t)), tileTokens);
+    Duplicate(blockSizeLocal, blockSizeFp, tileTokens);
+    PipeBarrier<PIPE_V>();
+  }
 
-    DataCopyCustom<int32_t>(sampledIdsLocal, sampledTokenIdsGm, tensorLength);
-    DataCopyCustom<int32_t>(seqLenInLocal, seqLensInputGm, tensorLength);
+  __aicore__ inline void CopyIn(int64_t offset, int32_t length) {
+    LocalTensor<IdxT> sampledIdsLocal = sampledIdsQue.AllocTensor<IdxT>();
+    LocalTensor<LenT> seqLenInLocal = seqLenInQue.AllocTensor<LenT>();
+
+    DataCopyCustom<IdxT>(sampledIdsLocal, sampledTokenIdsGm[offset * tokensPerSeq], length * tokensPerSeq);
+    DataCopyCustom<LenT>(seqLenInLocal, seqLensInputGm[offset], length);
 
     sampledIdsQue.EnQue(sampledIdsLocal);
     seqLenInQue.EnQue(seqLenInLocal);
   }
 
-  __aicore__ inline void Compute() {
-    LocalTensor<int32_t> tableOffset = tableOffsetBuf.Get<int32_t>();
-
-    LocalTensor<int32_t> sampledIdsLocal = sampledIdsQue.DeQue<int32_t>();
-    LocalTensor<int32_t> seqLenInLocal = seqLenInQue.DeQue<int32_t>();
-
-    LocalTensor<int32_t> inputTokensLocal = inputTokensQue.AllocTensor<int32_t>();
-    LocalTensor<int32_t> seqLensOutLocal = seqLensOutQue.AllocTensor<int32_t>();
-    LocalTensor<int32_t> inputPositionsLocal = inputPositionsQue.AllocTensor<int32_t>();
-
-    Adds(inputTokensLocal, sampledIdsLocal, (int32_t)0, tensorLength);   // inputTokensLocal <-- sampledIdsLocal
-    Adds(inputPositionsLocal, seqLenInLocal, (int32_t)0, tensorLength);  // inputPositionsLocal <-- seqLenInLocal
-    Adds(seqLensOutLocal, seqLenInLocal, (int32_t)1, tensorLength);      // seqLensOutLocal <-- seqLenInLocal + 1
+  __aicore__ inline void Compute(int64_t offset, int32_t length) {
+    int32_t tokens = length * tokensPerSeq;
+    LocalTensor<int32_t> gatherOffset = gatherOffsetBuf.Get<int32_t>();
+    LocalTensor<int32_t> seqLen = seqLenBuf.Get<int32_t>();
+    LocalTensor<int32_t> positions = positionsBuf.Get<int32_t>();
+    LocalTensor<int32_t> tmpInt = tmpIntBuf.Get<int32_t>();
+    LocalTensor<int32_t> tokenStep = tokenStepBuf.Get<int32_t>();
+    LocalTensor<uint32_t> expandOffset = expandOffsetBuf.Get<uint32_t>();
+
+    LocalTensor<IdxT> sampledIdsLocal = sampledIdsQue.DeQue<IdxT>();
+    LocalTensor<LenT> seqLenInLocal = seqLenInQue.DeQue<LenT>();
+
+    LocalTensor<IdxT> inputTokensLocal = inputTokensQue.AllocTensor<IdxT>();
+    LocalTensor<LenT> seqLensOutLocal = seqLensOutQue.AllocTensor<LenT>();
+    LocalTensor<IdxT> inputPositionsLocal = inputPositionsQue.AllocTensor<IdxT>();
+    LocalTensor<IdxT> slotMappingLocal = slotMappingQue.AllocTensor<IdxT>();
+
+    CopyLocal(inputTokensLocal, sampledIdsLocal, tokens);  // inputTokensLocal <-- sampledIdsLocal
+    CastToInt32(seqLen, seqLenInLocal, length);            // seqLen <-- seqLenInLocal
     PipeBarrier<PIPE_V>();
+    Adds(tmpInt, seqLen, tokensPerSeq, length);
+    Gather(positions, seqLen, expandOffset, (uint32_t)0, tokens);  // positions <-- seqLen[j / tokensPerSeq]
+    PipeBarrier<PIPE_V>();
+    CastFromInt32(seqLensOutLocal, tmpInt, length);  // seqLensOutLocal <-- seqLen + tokensPerSeq
+    Add(positions, positions, tokenStep, tokens);    // positions <-- seqLen[j / tokensPerSeq] + j % tokensPerSeq
+    PipeBarrier<PIPE_V>();
+    CastFromInt32(inputPositionsLocal, positions, tokens);  // inputPositionsLocal <-- positions
 
-    // TODO add Function
-    ComputeTableOffset(tableOffset, inputPositionsLocal);
-    // GetTableValueByOffset(tableOffset, inputPositionsLocal);
+    ComputeTableOffset(gatherOffset, positions, seqLen, slotMappingLocal, offset, length);
 
     sampledIdsQue.FreeTensor(sampledIdsLocal);
     seqLenInQue.FreeTensor(seqLenInLocal);
@@ -125,86 +246,191 @@ private:
     inputTokensQue.EnQue(inputTokensLocal);
     seqLensOutQue.EnQue(seqLensOutLocal);
     inputPositionsQue.EnQue(inputPositionsLocal);
+    slotMappingQue.EnQue(slotMappingLocal);
   }
 
-  __aicore__ inline void CopyOut() {
-    LocalTensor<int32_t> inputTokensLocal = inputTokensQue.DeQue<int32_t>();
-    LocalTensor<int32_t> seqLensOutLocal = seqLensOutQue.DeQue<int32_t>();
-    LocalTensor<int32_t> inputPositionsLocal = inputPositionsQue.DeQue<int32_t>();
+  __aicore__ inline void CopyOut(int64_t offset, int32_t length) {
+    int64_t tokenOffset = offset * tokensPerSeq;
+    int32_t tokens = length * tokensPerSeq;
+    LocalTensor<IdxT> inputTokensLocal = inputTokensQue.DeQue<IdxT>();
+    LocalTensor<LenT> seqLensOutLocal = seqLensOutQue.DeQue<LenT>();
+    LocalTensor<IdxT> inputPositionsLocal = inputPositionsQue.DeQue<IdxT>();
+    LocalTensor<IdxT> slotMappingLocal = slotMappingQue.DeQue<IdxT>();
 
-    DataCopyCustom<int32_t>(inputTokensGm, inputTokensLocal, tensorLength);
-    DataCopyCustom<int32_t>(inputPositionsGm, inputPositionsLocal, tensorLength);
-    DataCopyCustom<int32_t>(seqLensOutGm, seqLensOutLocal, tensorLength);
+    DataCopyCustom<IdxT>(inputTokensGm[tokenOffset], inputTokensLocal, tokens);
+    DataCopyCustom<IdxT>(inputPositionsGm[tokenOffset], inputPositionsLocal, tokens);
+    DataCopyCustom<LenT>(seqLensOutGm[offset], seqLensOutLocal, length);
+    DataCopyCustom<IdxT>(slotMappingGm[tokenOffset], slotMappingLocal, tokens);
 
     inputTokensQue.FreeTensor(inputTokensLocal);
     seqLensOutQue.FreeTensor(seqLensOutLocal);
     inputPositionsQue.FreeTensor(inputPositionsLocal);
+    slotMappingQue.FreeTensor(slotMappingLocal);
   }
 
-  __aicore__ inline void ComputeTableOffset(LocalTensor<int32_t> tableOffset,
-                                            LocalTensor<int32_t> inputPositionsLocal) {
-    LocalTensor<float> tmpBuf01 = tmpDivBuf01.Get<float>();
-    LocalTensor<float> tmpBuf02 = tmpDivBuf02.Get<float>();
-
-    LocalTensor<int32_t> tmpBuf01Int = tmpBuf01.ReinterpretCast<int32_t>();
-    LocalTensor<int32_t> tmpBuf02Int = tmpBuf02.ReinterpretCast<int32_t>();
+  // Padded sequences: input_tokens and input_positions <-- 0, slot_mapping <-- -1 (PADDING_SLOT_ID).
+  // Both constants have the same bit pattern in int32 and int64, so the fill runs on int32 lanes.
+  __aicore__ inline void FillPadding() {
+    if (validLength == coreLength) {
+      return;
+    }
+    constexpr int32_t int32PerElem = sizeof(IdxT) / sizeof(int32_t);
+    LocalTensor<IdxT> zeros = tmpDivBuf01.Get<IdxT>();
+    LocalTensor<IdxT> minusOnes = tmpIntBuf.Get<IdxT>();
+    int32_t fillTokens = tileTokens;
+    PipeBarrier<PIPE_V>();
+    Duplicate(zeros.template ReinterpretCast<int32_t>(), (int32_t)0, fillTokens * int32PerElem);
+    Duplicate(minusOnes.template ReinterpretCast<int32_t>(), (int32_t)-1, fillTokens * int32PerElem);
+    PIPE_V_MTE3();
+
+    int64_t padStart = validLength * tokensPerSeq;
+    int64_t padEnd = coreLength * tokensPerSeq;
+    for (int64_t offset = padStart; offset < padEnd; offset += fillTokens) {
+      int32_t count = static_cast<int32_t>(padEnd - offset < fillTokens ? padEnd - offset : fillTokens);
+      DataCopyCustom<IdxT>(inputTokensGm[offset], zeros, count);
+      DataCopyCustom<IdxT>(inputPositionsGm[offset], zeros, count);
+      DataCopyCustom<IdxT>(slotMappingGm[offset], minusOnes, count);
+    }
+  }
 
-    LocalTensor<int32_t> outTableValue = outTableBuf.Get<int32_t>();
-    LocalTensor<int32_t> blockTableLocal = blockTableBuf.Get<int32_t>();
+  // quot <-- floor(src / divisor), rem <-- src % divisor, divisorLocal holds divisor as fp32.
+  // The fp32 quotient is only an estimate once src exceeds 2^24, so it is corrected once with the
+  // exact int32 remainder, which is small enough for fp32 to divide exactly.
+  __aicore__ inline void FloorDivMod(LocalTensor<int32_t> quot, LocalTensor<int32_t> rem, LocalTensor<int32_t> src,
+                                     int32_t divisor, LocalTensor<float> divisorLocal, int32_t length) {
+    LocalTensor<float> tmpFp = tmpDivBuf01.Get<float>();
+    LocalTensor<int32_t> tmpInt = tmpIntBuf.Get<int32_t>();
 
-    // floor div
-    Cast(tmpBuf01, inputPositionsLocal, RoundMode::CAST_RINT, tensorLength);
-    Duplicate(tmpBuf02, blockSizeFp, tensorLength);
+    Cast(tmpFp, src, RoundMode::CAST_RINT, length);
     PipeBarrier<PIPE_V>();
-    Div(tmpBuf01, tmpBuf01, tmpBuf02, tensorLength);  // <-- inputPositionsLocal / blockSize
+    Div(tmpFp, tmpFp, divisorLocal, length);
     PipeBarrier<PIPE_V>();
-    Cast(tmpBuf02Int, tmpBuf01, RoundMode::CAST_TRUNC, tensorLength);
-
-    CreateVecIndex(tableOffset, (int32_t)0, tensorLength);  // tableOffset <--- 0, 1, 2, 3, .... tensorLength -1
+    Cast(quot, tmpFp, RoundMode::CAST_FLOOR, length);
     PipeBarrier<PIPE_V>();
-
-    Muls(tableOffset, tableOffset, this->blockTablesStride,
-         tensorLength);  // tableOffset <--- curt_offset * block_stride
+    Muls(tmpInt, quot, divisor, length);
+    PipeBarrier<PIPE_V>();
+    Sub(rem, src, tmpInt, length);
     PipeBarrier<PIPE_V>();
-    Add(tableOffset, tableOffset, tmpBuf02Int,
-        tensorLength);  // tableOffset <--- curt_offset * block_stride + inputPositionsLocal / blockSize
 
-    PIPE_V_S();
+    Cast(tmpFp, rem, RoundMode::CAST_RINT, length);
+    PipeBarrier<PIPE_V>();
+    Div(tmpFp, tmpFp, divisorLocal, length);
+    PipeBarrier<PIPE_V>();
+    Cast(tmpInt, tmpFp, RoundMode::CAST_FLOOR, length);
+    PipeBarrier<PIPE_V>();
+    Add(quot, quot, tmpInt, length);
+    PipeBarrier<PIPE_V>();
+    Muls(tmpInt, quot, divisor, length);
+    PipeBarrier<PIPE_V>();
+    Sub(rem, src, tmpInt, length);
+    PipeBarrier<PIPE_V>();
+  }
 
-    for (int32_t idx = 0; idx < tensorLength; idx++) {
-      int32_t blockTableIdx = tableOffset.GetValue(idx);
+  // quot <-- src / blockSize, rem <-- src % blockSize, exact; a shift when blockSize is a power of two.
+  __aicore__ inline void BlockDivMod(LocalTensor<int32_t> quot, LocalTensor<int32_t> rem, LocalTensor<int32_t> src,
+                                     int32_t length) {
+    if (blockSizeShift < 0) {
+      FloorDivMod(quot, rem, src, blockSize, tmpDivBuf02.Get<float>(), length);
+      return;
+    }
+    ShiftRight(quot, src, blockSizeShift, length);
+    PipeBarrier<PIPE_V>();
+    ShiftLeft(rem, quot, blockSizeShift, length);
+    PipeBarrier<PIPE_V>();
+    Sub(rem, src, rem, length);
+    PipeBarrier<PIPE_V>();
+  }
 
-      PIPE_S_MTE2();
+  __aicore__ inline int32_t BlockOf(int32_t position) const {
+    return blockSizeShift < 0 ? position / blockSize : position >> blockSizeShift;
+  }
 
-      DataCopyCustom<int32_t>(blockTableLocal, blockTablesGm[blockTableIdx], 1);
+  // slot <-- block_tables[seq][pos / blockSize] * blockSize + pos % blockSize for the tokens of `length` sequences.
+  // The block table entries are staged with one strided copy of the window of columns the sequences of the tile
+  // span, a 32B aligned row per sequence. When the lengths are too far apart for the window to fit the staging
+  // buffer, each sequence copies the columns of its own tokens instead, one copy per sequence. A vector Gather
+  // then picks the entry of every token.
+  __aicore__ inline void ComputeTableOffset(LocalTensor<int32_t> gatherOffset, LocalTensor<int32_t> positions,
+                                            LocalTensor<int32_t> seqLen, LocalTensor<IdxT> slotMappingLocal,
+                                            int64_t offset, int32_t length) {
+    int32_t tokens = length * tokensPerSeq;
+    LocalTensor<int32_t> blockIdx = blockIdxBuf.Get<int32_t>();
+    LocalTensor<int32_t> blockOffset = blockOffsetBuf.Get<int32_t>();
+    LocalTensor<int32_t> outTableValue = outTableBuf.Get<int32_t>();
+    LocalTensor<int32_t> blockTableLocal = blockTableBuf.Get<int32_t>();
+    LocalTensor<int32_t> colBase = colBaseBuf.Get<int32_t>();
+    LocalTensor<int32_t> tokenSeq = tokenSeqBuf.Get<int32_t>();
+    LocalTensor<uint32_t> expandOffset = expandOffsetBuf.Get<uint32_t>();
 
-      PIPE_MTE2_S();
+    // V_S makes seqLen readable, and guarantees the previous tile has finished gathering from the staging buffer.
+    PIPE_V_S();
+    int32_t minLen = seqLen.GetValue(0);
+    int32_t maxLen = minLen;
+    for (int32_t idx = 1; idx < length; idx++) {
+      int32_t len = seqLen.GetValue(idx);
+      minLen = len < minLen ? len : minLen;
+      maxLen = len > maxLen ? len : maxLen;
+    }
+    int32_t firstCol = BlockOf(minLen);
+    int64_t windowCols = BlockOf(maxLen + tokensPerSeq - 1) - firstCol + 1;
+    int64_t rowBytes = (windowCols * sizeof(int32_t) + BLOCK_BYTES - 1) / BLOCK_BYTES * BLOCK_BYTES;
+    bool tileWindow = rowBytes * length <= stagingBytes;
+    if (tileWindow) {
+      DataCopyExtParams copyParams{static_cast<uint16_t>(length), static_cast<uint32_t>(windowCols * sizeof(int32_t)),
+                                   static_cast<uint32_t>((blockTablesStride - windowCols) * sizeof(int32_t)), 0, 0};
+      DataCopyPadExtParams<int32_t> padParams{false, 0, 0, 0};
+      DataCopyPad(blockTableLocal, blockTablesGm[offset * blockTablesStride + firstCol], copyParams, padParams);
+    } else {
+      // the tokens of a sequence span at most tokensPerSeq + 1 columns, which fit in its tokensPerSeq 32B blocks
+      rowBytes = static_cast<int64_t>(tokensPerSeq) * BLOCK_BYTES;
+      for (int32_t idx = 0; idx < length; idx++) {
+        int32_t len = seqLen.GetValue(idx);
+        int32_t col = BlockOf(len);
+        DataCopyCustom<int32_t>(blockTableLocal[idx * rowBytes / sizeof(int32_t)],
+                                blockTablesGm[(offset + idx) * blockTablesStride + col],
+                                BlockOf(len + tokensPerSeq - 1) - col + 1);
+      }
+    }
 
-      int32_t blockTableValue = blockTableLocal.GetValue(0);
-      int32_t block_offset = inputPositionsLocal.GetValue(idx) % this->blockSize;
-      blockTableValue = blockTableValue * this->blockSize + block_offset;
-      outTableValue.SetValue(idx, blockTableValue);
+    // colBase <--- the first staged column of the row of each token
+    if (tileWindow) {
+      Duplicate(colBase, firstCol, tokens);
+    } else {
+      BlockDivMod(blockIdx, blockOffset, seqLen, length);  // blockIdx <--- seqLen / blockSize
+      Gather(colBase, blockIdx, expandOffset, (uint32_t)0, tokens);
     }
-    PIPE_S_MTE3();
-    DataCopyCustom<int32_t>(slotMappingGm, outTableValue, tensorLength);
-  }
+    PipeBarrier<PIPE_V>();
+    // blockIdx <--- positions / blockSize, blockOffset <--- positions % blockSize
+    BlockDivMod(blockIdx, blockOffset, positions, tokens);
 
-  __aicore__ inline void PIPE_S_MTE3() {
-    event_t event_S_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::S_MTE3));
-    SetFlag<HardEvent::S_MTE3>(event_S_MTE3);
-    WaitFlag<HardEvent::S_MTE3>(event_S_MTE3);
+    // gatherOffset <--- byte offset of the entry of each token: its row, then its column within the row
+    Sub(gatherOffset, blockIdx, colBase, tokens);
+    Muls(outTableValue, tokenSeq, static_cast<int32_t>(rowBytes), tokens);
+    PipeBarrier<PIPE_V>();
+    Muls(gatherOffset, gatherOffset, static_cast<int32_t>(sizeof(int32_t)), tokens);
+    PipeBarrier<PIPE_V>();
+    Add(gatherOffset, gatherOffset, outTableValue, tokens);
+    PIPE_MTE2_V();
+
+    Gather(outTableValue, blockTableLocal, gatherOffset.template ReinterpretCast<uint32_t>(), (uint32_t)0, tokens);
+    PipeBarrier<PIPE_V>();
+    Muls(outTableValue, outTableValue, this->blockSize, tokens);
+    PipeBarrier<PIPE_V>();
+    Add(outTableValue, outTableValue, blockOffset, tokens);  // slot <--- block * blockSize + blockOffset
+    PipeBarrier<PIPE_V>();
+    CastFromInt32(slotMappingLocal, outTableValue, tokens);
   }
 
-  __aicore__ inline void PIPE_S_MTE2() {
-    event_t event_S_MTE2 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::S_MTE2));
-    SetFlag<HardEvent::S_MTE2>(event_S_MTE2);
-    WaitFlag<HardEvent::S_MTE2>(event_S_MTE2);
+  __aicore__ inline void PIPE_MTE2_V() {
+    event_t event_MTE2_V = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE2_V));
+    SetFlag<HardEvent::MTE2_V>(event_MTE2_V);
+    WaitFlag<HardEvent::MTE2_V>(event_MTE2_V);
   }
 
-  __aicore__ inline void PIPE_MTE2_S() {
-    event_t event_MTE2_S = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE2_S));
-    SetFlag<HardEvent::MTE2_S>(event_MTE2_S);
-    WaitFlag<HardEvent::MTE2_S>(event_MTE2_S);
+  __aicore__ inline void PIPE_V_MTE3() {
+    event_t event_V_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::V_MTE3));
+    SetFlag<HardEvent::V_MTE3>(event_V_MTE3);
+    WaitFlag<HardEvent::V_MTE3>(event_V_MTE3);
   }
 
   __aicore__ inline void PIPE_V_S() {
@@ -216,53 +442,108 @@ private:
 private:
   TPipe *Ppipe = nullptr;
   // create queues for input, in this case depth is equal to buffer num
-  TQue<QuePosition::VECIN, 1> sampledIdsQue, seqLenInQue;
+  TQue<QuePosition::VECIN, BUFFER_NUM> sampledIdsQue, seqLenInQue;
   // create queues for output, in this case depth is equal to buffer num
-  TQue<QuePosition::VECOUT, 1> inputTokensQue, seqLensOutQue, inputPositionsQue;
+  TQue<QuePosition::VECOUT, BUFFER_NUM> inputTokensQue, seqLensOutQue, inputPositionsQue, slotMappingQue;
 
-  TBuf<TPosition::VECCALC> tableOffsetBuf;
+  TBuf<TPosition::VECCALC> seqLenBuf;
+  TBuf<TPosition::VECCALC> positionsBuf;
+  TBuf<TPosition::VECCALC> gatherOffsetBuf;
+  TBuf<TPosition::VECCALC> blockIdxBuf;
+  TBuf<TPosition::VECCALC> blockOffsetBuf;
   TBuf<TPosition::VECCALC> tmpDivBuf01;
   TBuf<TPosition::VECCALC> tmpDivBuf02;
+  TBuf<TPosition::VECCALC> tmpIntBuf;
   TBuf<TPosition::VECCALC> outTableBuf;
   TBuf<TPosition::VECCALC> blockTableBuf;
+  TBuf<TPosition::VECCALC> colBaseBuf;
+  TBuf<TPosition::VECCALC> tokenSeqBuf;
+  TBuf<TPosition::VECCALC> tokenStepBuf;
+  TBuf<TPosition::VECCALC> expandOffsetBuf;
 
   // inputs
-  GlobalTensor<int32_t> sampledTokenIdsGm;
-  GlobalTensor<int32_t> seqLensInputGm;
+  GlobalTensor<IdxT> sampledTokenIdsGm;
+  GlobalTensor<LenT> seqLensInputGm;
   GlobalTensor<int32_t> blockTablesGm;
   // outs
-  GlobalTensor<int32_t> inputTokensGm;
-  GlobalTensor<int32_t> inputPositionsGm;
-  GlobalTensor<int32_t> seqLensOutGm;
-  GlobalTensor<int32_t> slotMappingGm;
+  GlobalTensor<IdxT> inputTokensGm;
+  GlobalTensor<IdxT> inputPositionsGm;
+  GlobalTensor<LenT> seqLensOutGm;
+  GlobalTensor<IdxT> slotMappingGm;
 
   int32_t blockSize;
   int32_t blockTablesStride;
-  int64_t tensorLength;  // number of calculations rows on each core
+  int32_t tokensPerSeq;  // new tokens per sequence
+  int32_t tileLength;    // number of sequences in one UB tile
+  int32_t tileTokens;    // number of tokens in one UB tile
+  int64_t coreLength;    // number of sequences on each core
+  int64_t validLength;   // number of sequences on each core that are not padding
+  int64_t stagingBytes;  // bytes of the block table staging buffer
 
   float blockSizeFp;
+  int32_t blockSizeShift;  // log2(blockSize), -1 if it is not a power of two
 };
 
-extern "C" __global__ __aicore__ void adv_step_flash_impl(GM_ADDR sampledTokenIds, GM_ADDR blockTables,
-                                                          GM_ADDR seqLensInput, GM_ADDR inputTokens,
-                                                          GM_ADDR inputPositions, GM_ADDR seqLensOut,
-                                                          GM_ADDR slotMapping, int32_t num_seqs, int32_t block_size,
-                                                          int32_t block_tables_stride) {
+template <typename IdxT, typename LenT>
+__aicore__ inline void AdvStepFlashImpl(GM_ADDR sampledTokenIds, GM_ADDR blockTables, GM_ADDR seqLensInput,
+                                        GM_ADDR inputTokens, GM_ADDR inputPositions, GM_ADDR seqLensOut,
+                                        GM_ADDR slotMapping, int32_t num_seqs, int32_t num_queries,
+                                        int32_t num_tokens_per_seq, int32_t block_size, int32_t block_tables_stride,
+                                        int32_t seqs_per_core, int32_t tile_length) {
   TPipe pipe;
 
-  KernelAdvStepFlash op(&pipe);
+  KernelAdvStepFlash<IdxT, LenT> op(&pipe);
   op.Init(sampledTokenIds, blockTables, seqLensInput, inputTokens, inputPositions, seqLensOut, slotMapping, num_seqs,
-          block_size, block_tables_stride);
+          num_queries, num_tokens_per_seq, block_size, block_tables_stride, seqs_per_core, tile_length);
   op.Process();
 }
 
+// adv_step_flash_<IdxT>_<LenT>
+#define ADV_STEP_FLASH_KERNEL(idx_name, IdxT, len_name, LenT)                                                         \
+  extern "C" __global__ __aicore__ void adv_step_flash_##idx_name##_##len_name(                                       \
+      GM_ADDR sampledTokenIds, GM_ADDR blockTables, GM_ADDR seqLensInput, GM_ADDR inputTokens, GM_ADDR inputPositions, \
+      GM_ADDR seqLensOut, GM_ADDR slotMapping, int32_t num_seqs, int32_t num_queries, int32_t num_tokens_per_seq,     \
+      int32_t block_size, int32_t block_tables_stride, int32_t seqs_per_core, int32_t tile_length) {                  \
+    AdvStepFlashImpl<IdxT, LenT>(sampledTokenIds, blockTables, seqLensInput, inputTokens, inputPositions, seqLensOut,  \
+                                 slotMapping, num_seqs, num_queries, num_tokens_per_seq, block_size,                  \
+                                 block_tables_stride, seqs_per_core, tile_length);                                    \
+  }
+
+ADV_STEP_FLASH_KERNEL(int32, int32_t, int32, int32_t)
+ADV_STEP_FLASH_KERNEL(int32, int32_t, int64, int64_t)
+ADV_STEP_FLASH_KERNEL(int64, int64_t, int32, int32_t)
+ADV_STEP_FLASH_KERNEL(int64, int64_t, int64, int64_t)
+
 #ifndef __CCE_KT_TEST__
-void AdvStepFlashKernelEntry(uint32_t blockDims, void *l2ctrl, void *aclStream, uint8_t *sampledTokenIds,
-                             uint8_t *blockTables, uint8_t *seqLensInput, uint8_t *inputTokens, uint8_t *inputPositions,
-                             uint8_t *seqLensOut, uint8_t *slotMapping, int32_t num_seqs, int32_t block_size,
-                             int32_t block_tables_stride) {
-  adv_step_flash_impl<<<blockDims, l2ctrl, aclStream>>>(sampledTokenIds, blockTables, seqLensInput, inputTokens,
-                                                        inputPositions, seqLensOut, slotMapping, num_seqs, block_size,
-                                                        block_tables_stride);
+template <typename IdxT, typename LenT>
+void AdvStepFlashKernelEntry(void *l2ctrl, void *aclStream, uint8_t *sampledTokenIds, uint8_t *blockTables,
+                             uint8_t *seqLensInput, uint8_t *inputTokens, uint8_t *inputPositions, uint8_t *seqLensOut,
+                             uint8_t *slotMapping, int32_t block_size, int32_t block_tables_stride,
+                             const AdvStepFlashTilingData &tiling) {
+#define ADV_STEP_FLASH_LAUNCH(kernel)                                                                               \
+  kernel<<<tiling.usedCoreNum, l2ctrl, aclStream>>>(sampledTokenIds, blockTables, seqLensInput, inputTokens,        \
+                                                    inputPositions, seqLensOut, slotMapping, tiling.numSeqs,        \
+                                                    tiling.numQueries, tiling.numTokensPerSeq, block_size,         \
+                                                    block_tables_stride, tiling.seqsPerCore, tiling.tileLength)
+  if constexpr (is_same<IdxT, int64_t>::value && is_same<LenT, int64_t>::value) {
+    ADV_STEP_FLASH_LAUNCH(adv_step_flash_int64_int64);
+  } else if constexpr (is_same<IdxT, int64_t>::value) {
+    ADV_STEP_FLASH_LAUNCH(adv_step_flash_int64_int32);
+  } else if constexpr (is_same<LenT, int64_t>::value) {
+    ADV_STEP_FLASH_LAUNCH(adv_step_flash_int32_int64);
+  } else {
+    ADV_STEP_FLASH_LAUNCH(adv_step_flash_int32_int32);
+  }
+#undef ADV_STEP_FLASH_LAUNCH
 }
+
+#define ADV_STEP_FLASH_KERNEL_ENTRY_INSTANTIATE(IdxT, LenT)                                                          \
+  template void AdvStepFlashKernelEntry<IdxT, LenT>(void *, void *, uint8_t *, uint8_t *, uint8_t *, uint8_t *,       \
+                                                    uint8_t *, uint8_t *, uint8_t *, int32_t, int32_t,                \
+                                                    const AdvStepFlashTilingData &)
+
+ADV_STEP_FLASH_KERNEL_ENTRY_INSTANTIATE(int32_t, int32_t);
+ADV_STEP_FLASH_KERNEL_ENTRY_INSTANTIATE(int32_t, int64_t);
+ADV_STEP_FLASH_KERNEL_ENTRY_INSTANTIATE(int64_t, int32_t);
+ADV_STEP_FLASH_KERNEL_ENTRY_INSTANTIATE(int64_t, int64_t);
 #endif
@@ -16,10 +16,20 @@
 #ifndef VLLM_MINDSPORE_CSRC_ASCENDC_ADV_STEP_FLASH_H
 #define VLLM_MINDSPORE_CSRC_ASCENDC_ADV_STEP_FLASH_H
 
-extern void AdvStepFlashKernelEntry(
-    uint32_t blockDims, void *l2ctrl, void *aclStream, uint8_t *sampledTokenIds,
+#include <cstdint>
+
+#include "ascendc/adv_step_flash_tiling.h"
+
+// Launches tiling.usedCoreNum cores, each advancing tiling.seqsPerCore
+// sequences in tiles of tiling.tileLength.
+// IdxT is the dtype of sampled_token_ids, input_tokens, input_positions and
+// slot_mapping, LenT the dtype of seq_lens; both are int32_t or int64_t.
+template <typename IdxT, typename LenT>
+void AdvStepFlashKernelEntry(
+    void *l2ctrl, void *aclStream, uint8_t *sampledTokenIds,
     uint8_t *blockTables, uint8_t *seqLensInput, uint8_t *inputTokens,
     uint8_t *inputPositions, uint8_t *seqLensOut, uint8_t *slotMapping,
-    int32_t num_seqs, int32_t block_size, int32_t block_tables_stride);
+    int32_t block_size, int32_t block_tables_stride,
+    const AdvStepFlashTilingData &tiling);
 
 #endif // VLLM_MINDSPORE_CSRC_ASCENDC_ADV_STEP_FLASH_H
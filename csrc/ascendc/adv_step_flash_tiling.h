@@ -0,0 +1,74 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_ADV_STEP_FLASH_TILING_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_ADV_STEP_FLASH_TILING_H
+
+#include <cstdint>
+
+// Sequences handled by one core are aligned to one 32B block of int32.
+constexpr int32_t kAdvStepFlashSeqAlign = 8;
+// Below this many sequences per core, the launch cost of an extra core
+// outweighs the work it takes over.
+constexpr int32_t kAdvStepFlashMinSeqsPerCore = 32;
+// Tokens processed per UB tile. With double-buffered int64 queues and 64B of
+// block table staging per token, each token costs up to about 185B of UB, so
+// one tile stays well below the UB capacity.
+constexpr int32_t kAdvStepFlashMaxTileTokens = 512;
+
+struct AdvStepFlashTilingData {
+  int32_t numSeqs{0};
+  int32_t numQueries{0};       // sequences past numQueries are padding
+  int32_t numTokensPerSeq{1};  // new tokens of each sequence
+  int32_t usedCoreNum{1};
+  int32_t seqsPerCore{0};  // the last core takes the remainder
+  int32_t tileLength{0};   // sequences per UB tile
+};
+
+inline int32_t AdvStepFlashCeilDiv(int32_t a, int32_t b) { return (a + b - 1) / b; }
+
+inline int32_t AdvStepFlashAlignUp(int32_t a, int32_t align) { return AdvStepFlashCeilDiv(a, align) * align; }
+
+// Split `num_seqs` sequences across at most `max_core_num` cores, so that each
+// core gets at least kAdvStepFlashMinSeqsPerCore sequences, and cut each core's
+// share into tiles of at most `max_tile_tokens` tokens (at least
+// kAdvStepFlashSeqAlign sequences).
+inline AdvStepFlashTilingData ComputeAdvStepFlashTiling(int32_t num_seqs, int32_t num_queries,
+                                                        int32_t num_tokens_per_seq, int32_t max_core_num,
+                                                        int32_t max_tile_tokens = kAdvStepFlashMaxTileTokens) {
+  AdvStepFlashTilingData tiling;
+  tiling.numSeqs = num_seqs;
+  tiling.numQueries = num_queries < num_seqs ? num_queries : num_seqs;
+  tiling.numTokensPerSeq = num_tokens_per_seq > 0 ? num_tokens_per_seq : 1;
+  if (num_seqs <= 0) {
+    return tiling;
+  }
+  max_core_num = max_core_num > 0 ? max_core_num : 1;
+  max_tile_tokens = max_tile_tokens > 0 ? max_tile_tokens : kAdvStepFlashMaxTileTokens;
+
+  int32_t core_num = num_seqs / kAdvStepFlashMinSeqsPerCore;
+  core_num = core_num < 1 ? 1 : core_num;
+  core_num = core_num > max_core_num ? max_core_num : core_num;
+
+  tiling.seqsPerCore = AdvStepFlashAlignUp(AdvStepFlashCeilDiv(num_seqs, core_num), kAdvStepFlashSeqAlign);
+  tiling.usedCoreNum = AdvStepFlashCeilDiv(num_seqs, tiling.seqsPerCore);
+
+  int32_t max_tile_length = max_tile_tokens / tiling.numTokensPerSeq / kAdvStepFlashSeqAlign * kAdvStepFlashSeqAlign;
+  max_tile_length = max_tile_length < kAdvStepFlashSeqAlign ? kAdvStepFlashSeqAlign : max_tile_length;
+  tiling.tileLength = tiling.seqsPerCore < max_tile_length ? tiling.seqsPerCore : max_tile_length;
+  return tiling;
+}
+
+#endif  // VLLM_MINDSPORE_CSRC_ASCENDC_ADV_STEP_FLASH_TILING_H
@@ -0,0 +1,192 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_operator.h"
+
+#include "attention_mask_tiling.h"
+
+using namespace AscendC;
+
+template <typename Tp, Tp v>
+struct integral_constant {
+  static constexpr Tp value = v;
+};
+using true_type = integral_constant<bool, true>;
+using false_type = integral_constant<bool, false>;
+template <typename, typename>
+struct is_same : public false_type {};
+template <typename Tp>
+struct is_same<Tp, Tp> : public true_type {};
+
+template <typename T, typename U, typename R>
+__aicore__ inline void DataCopyCustom(const U &dstTensor, const R &srcTensor, const uint32_t count) {
+  DataCopyParams copyParams;
+  copyParams.blockLen = count * sizeof(T);
+  copyParams.blockCount = 1;
+  if constexpr (is_same<U, AscendC::LocalTensor<T>>::value) {
+    DataCopyPadParams padParams;
+    DataCopyPad(dstTensor, srcTensor, copyParams, padParams);
+  } else {
+    DataCopyPad(dstTensor, srcTensor, copyParams);
+  }
+}
+
+// The causal mask of a batch of chunked prefill and decode requests, [num_rows, max_seq_len].
+// Request i owns the next query_lens[i] rows; its row t is 0 up to column mask_offsets[i] + t and fill_bits after
+// it. Rows past the last request are all 0.
+// Nothing is computed per element: every row is the head of a UB tile of zeros followed by the head of a UB tile of
+// fill_bits, both filled once per core, so each row costs two to a few DMA writes to GM.
+template <typename T>
+class KernelAttentionMask {
+public:
+  __aicore__ inline KernelAttentionMask(TPipe *pipe) { Ppipe = pipe; }
+
+  __aicore__ inline void Init(GM_ADDR queryLens, GM_ADDR maskOffsets, GM_ADDR mask, int32_t num_reqs,
+                              int32_t num_rows, int32_t max_seq_len, T fill_bits, int32_t rows_per_core,
+                              int32_t tile_length) {
+    ASSERT(GetBlockNum() != 0 && "Block dim can not be zero!");
+    this->numReqs = num_reqs;
+    this->maxSeqLen = max_seq_len;
+    this->fillBits = fill_bits;
+    this->tileLength = tile_length;
+
+    // get the rows of current core, core parallel
+    this->rowStart = static_cast<int64_t>(GetBlockIdx()) * rows_per_core;
+    int64_t remain = num_rows - rowStart;
+    this->rowEnd = rowStart + (remain < rows_per_core ? remain : rows_per_core);
+    if (rowEnd <= rowStart) {
+      this->rowEnd = rowStart;
+      return;
+    }
+
+    queryLensGm.SetGlobalBuffer((__gm__ int32_t *)queryLens, num_reqs);
+    maskOffsetsGm.SetGlobalBuffer((__gm__ int32_t *)maskOffsets, num_reqs);
+    maskGm.SetGlobalBuffer((__gm__ T *)mask, static_cast<int64_t>(num_rows) * max_seq_len);
+
+    // pipe alloc memory to queue, the unit is Bytes
+    Ppipe->InitBuffer(zeroBuf, tileLength * sizeof(T));
+    Ppipe->InitBuffer(fillBuf, tileLength * sizeof(T));
+  }
+
+  __aicore__ inline void Process() {
+    if (rowEnd <= rowStart) {
+      return;
+    }
+    LocalTensor<T> zeros = zeroBuf.Get<T>();
+    LocalTensor<T> fills = fillBuf.Get<T>();
+    Duplicate(zeros, static_cast<T>(0), tileLength);
+    Duplicate(fills, fillBits, tileLength);
+    PIPE_V_MTE3();
+
+    // walk the requests up to the one owning the first row of this core
+    int32_t req = 0;
+    int64_t reqRow = 0;  // first row of req
+    int64_t reqLen = numReqs > 0 ? QueryLen(0) : 0;
+    for (int64_t row = rowStart; row < rowEnd; ++row) {
+      while (req < numReqs && row >= reqRow + reqLen) {
+        reqRow += reqLen;
+        ++req;
+        reqLen = req < numReqs ? QueryLen(req) : 0;
+      }
+      int64_t visible = maxSeqLen;
+      if (req < numReqs) {
+        visible = static_cast<int64_t>(maskOffsetsGm.GetValue(req)) + (row - reqRow) + 1;
+        visible = visible < 0 ? 0 : (visible < maxSeqLen ? visible : maxSeqLen);
+      }
+      int64_t rowOffset = row * maxSeqLen;
+      CopyOutSpan(zeros, rowOffset, visible);
+      CopyOutSpan(fills, rowOffset + visible, maxSeqLen - visible);
+    }
+  }
+
+private:
+  __aicore__ inline int64_t QueryLen(int32_t req) {
+    int32_t len = queryLensGm.GetValue(req);
+    return len > 0 ? len : 0;
+  }
+
+  __aicore__ inline void CopyOutSpan(const LocalTensor<T> &src, int64_t offset, int64_t count) {
+    for (int64_t done = 0; done < count; done += tileLength) {
+      int64_t n = count - done < tileLength ? count - done : tileLength;
+      DataCopyCustom<T>(maskGm[offset + done], src, static_cast<uint32_t>(n));
+    }
+  }
+
+  __aicore__ inline void PIPE_V_MTE3() {
+    event_t event_V_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::V_MTE3));
+    SetFlag<HardEvent::V_MTE3>(event_V_MTE3);
+    WaitFlag<HardEvent::V_MTE3>(event_V_MTE3);
+  }
+
+private:
+  TPipe *Ppipe = nullptr;
+  TBuf<TPosition::VECCALC> zeroBuf, fillBuf;
+
+  GlobalTensor<int32_t> queryLensGm, maskOffsetsGm;
+  GlobalTensor<T> maskGm;
+
+  int64_t rowStart;
+  int64_t rowEnd;
+  int32_t numReqs;
+  int32_t maxSeqLen;
+  int32_t tileLength;
+  T fillBits;
+};
+
+template <typename T>
+__aicore__ inline void AttentionMaskImpl(GM_ADDR queryLens, GM_ADDR maskOffsets, GM_ADDR mask, int32_t num_reqs,
+                                         int32_t num_rows, int32_t max_seq_len, T fill_bits, int32_t rows_per_core,
+                                         int32_t tile_length) {
+  TPipe pipe;
+
+  KernelAttentionMask<T> op(&pipe);
+  op.Init(queryLens, maskOffsets, mask, num_reqs, num_rows, max_seq_len, fill_bits, rows_per_core, tile_length);
+  op.Process();
+}
+
+// attention_mask_<element bits>
+#define ATTENTION_MASK_KERNEL(name, T)                                                                             \
+  extern "C" __global__ __aicore__ void attention_mask_##name(GM_ADDR queryLens, GM_ADDR maskOffsets, GM_ADDR mask, \
+                                                              int32_t num_reqs, int32_t num_rows,                  \
+                                                              int32_t max_seq_len, T fill_bits,                    \
+                                                              int32_t rows_per_core, int32_t tile_length) {        \
+    AttentionMaskImpl<T>(queryLens, maskOffsets, mask, num_reqs, num_rows, max_seq_len, fill_bits, rows_per_core,   \
+                         tile_length);                                                                             \
+  }
+
+ATTENTION_MASK_KERNEL(b16, uint16_t)
+ATTENTION_MASK_KERNEL(b32, uint32_t)
+
+#ifndef __CCE_KT_TEST__
+template <typename T>
+void AttentionMaskKernelEntry(void *l2ctrl, void *aclStream, uint8_t *queryLens, uint8_t *maskOffsets, uint8_t *mask,
+                              T fill_bits, const AttentionMaskTilingData &tiling) {
+#define ATTENTION_MASK_LAUNCH(kernel)                                                                      \
+  kernel<<<tiling.usedCoreNum, l2ctrl, aclStream>>>(queryLens, maskOffsets, mask, tiling.numReqs,         \
+                                                    tiling.numRows, tiling.maxSeqLen, fill_bits,          \
+                                                    tiling.rowsPerCore, tiling.tileLength)
+  if constexpr (is_same<T, uint32_t>::value) {
+    ATTENTION_MASK_LAUNCH(attention_mask_b32);
+  } else {
+    ATTENTION_MASK_LAUNCH(attention_mask_b16);
+  }
+#undef ATTENTION_MASK_LAUNCH
+}
+
+template void AttentionMaskKernelEntry<uint16_t>(void *, void *, uint8_t *, uint8_t *, uint8_t *, uint16_t,
+                                                 const AttentionMaskTilingData &);
+template void AttentionMaskKernelEntry<uint32_t>(void *, void *, uint8_t *, uint8_t *, uint8_t *, uint32_t,
+                                                 const AttentionMaskTilingData &);
+#endif
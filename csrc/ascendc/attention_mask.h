@@ -0,0 +1,33 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_ATTENTION_MASK_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_ATTENTION_MASK_H
+
+#include <cstdint>
+
+#include "ascendc/attention_mask_tiling.h"
+
+// Launches tiling.usedCoreNum cores, each writing tiling.rowsPerCore rows of
+// the mask. T is uint16_t for fp16 and bf16 masks and uint32_t for fp32 ones,
+// fill_bits the bits of the masked value. query_lens and mask_offsets are
+// int32.
+template <typename T>
+void AttentionMaskKernelEntry(void *l2ctrl, void *aclStream,
+                              uint8_t *queryLens, uint8_t *maskOffsets,
+                              uint8_t *mask, T fill_bits,
+                              const AttentionMaskTilingData &tiling);
+
+#endif // VLLM_MINDSPORE_CSRC_ASCENDC_ATTENTION_MASK_H
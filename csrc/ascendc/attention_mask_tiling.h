@@ -0,0 +1,62 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_ATTENTION_MASK_TILING_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_ATTENTION_MASK_TILING_H
+
+#include <cstdint>
+
+// Bytes of each of the two constant UB tiles rows are copied from, one of 0
+// and one of the fill value. A DataCopyPad moves at most 64KB at once.
+constexpr int32_t kAttentionMaskTileBytes = 16384;
+// Below this many rows per core, the launch cost of an extra core outweighs
+// the rows it writes.
+constexpr int32_t kAttentionMaskMinRowsPerCore = 4;
+
+struct AttentionMaskTilingData {
+  int32_t numReqs{0};
+  int32_t numRows{0};  // rows past the last request are padding
+  int32_t maxSeqLen{0};
+  int32_t usedCoreNum{1};
+  int32_t rowsPerCore{0};  // the last core takes the remainder
+  int32_t tileLength{0};   // mask elements per UB tile
+};
+
+// Rows are independent and the kernel only writes, so they are spread evenly
+// across at most `max_core_num` cores whatever request they belong to; a long
+// prefill chunk is shared by several cores.
+inline AttentionMaskTilingData ComputeAttentionMaskTiling(int32_t num_reqs, int32_t num_rows, int32_t max_seq_len,
+                                                          int32_t elem_bytes, int32_t max_core_num) {
+  AttentionMaskTilingData tiling;
+  tiling.numReqs = num_reqs;
+  tiling.numRows = num_rows;
+  tiling.maxSeqLen = max_seq_len;
+  if (num_rows <= 0 || max_seq_len <= 0) {
+    return tiling;
+  }
+  max_core_num = max_core_num > 0 ? max_core_num : 1;
+  int32_t core_num = (num_rows + kAttentionMaskMinRowsPerCore - 1) / kAttentionMaskMinRowsPerCore;
+  core_num = core_num < max_core_num ? core_num : max_core_num;
+  tiling.rowsPerCore = (num_rows + core_num - 1) / core_num;
+  tiling.usedCoreNum = (num_rows + tiling.rowsPerCore - 1) / tiling.rowsPerCore;
+  // UB tiles are sized in whole 32B blocks
+  int32_t per_block = 32 / elem_bytes;
+  int32_t row_align = (max_seq_len + per_block - 1) / per_block * per_block;
+  int32_t max_tile = kAttentionMaskTileBytes / elem_bytes;
+  tiling.tileLength = row_align < max_tile ? row_align : max_tile;
+  return tiling;
+}
+
+#endif  // VLLM_MINDSPORE_CSRC_ASCENDC_ATTENTION_MASK_TILING_H
@@ -0,0 +1,229 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_operator.h"
+
+#include "eagle_prepare_inputs_tiling.h"
+
+using namespace AscendC;
+
+template <typename Tp, Tp v>
+struct integral_constant {
+  static constexpr Tp value = v;
+};
+using true_type = integral_constant<bool, true>;
+using false_type = integral_constant<bool, false>;
+template <typename, typename>
+struct is_same : public false_type {};
+template <typename Tp>
+struct is_same<Tp, Tp> : public true_type {};
+
+template <typename T, typename U, typename R>
+__aicore__ inline void DataCopyCustom(const U &dstTensor, const R &srcTensor, const uint32_t count) {
+  DataCopyParams copyParams;
+  copyParams.blockLen = count * sizeof(T);
+  copyParams.blockCount = 1;
+  if constexpr (is_same<U, AscendC::LocalTensor<T>>::value) {
+    DataCopyPadParams padParams;
+    DataCopyPad(dstTensor, srcTensor, copyParams, padParams);
+  } else {
+    DataCopyPad(dstTensor, srcTensor, copyParams);
+  }
+}
+
+constexpr int32_t BLOCK_BYTES = 32;
+constexpr int32_t INT32_PER_BLOCK = BLOCK_BYTES / sizeof(int32_t);
+
+// The inputs of the EAGLE draft model of a speculative step, from the rows the rejection sampler left.
+// Request i owns row i of sampled_token_ids [num_reqs, max_gen_len], its valid tokens (in [0, vocab_size)) first and
+// -1 after them. For every request the kernel writes the number of valid tokens (0 for a discarded partial prefill),
+// the token at that count - 1 or the backup token when there is none, and the token to sample the draft from:
+// query_start_loc[i + 1] - 1, less the rejected tokens of a request with draft tokens.
+// Each core walks its requests in tiles of whole rows: one DMA in per tensor, scalar compares on UB, one DMA out per
+// output.
+class KernelEaglePrepareInputs {
+public:
+  __aicore__ inline KernelEaglePrepareInputs(TPipe *pipe) { Ppipe = pipe; }
+
+  __aicore__ inline void Init(GM_ADDR sampledTokenIds, GM_ADDR cuNumDraftTokens, GM_ADDR discardMask,
+                              GM_ADDR backupNextTokenIds, GM_ADDR queryStartLoc, GM_ADDR nextTokenIds,
+                              GM_ADDR validSampledTokensCount, GM_ADDR tokenIndicesToSample, int32_t num_reqs,
+                              int32_t max_gen_len, int32_t vocab_size, int32_t reqs_per_core, int32_t tile_reqs) {
+    ASSERT(GetBlockNum() != 0 && "Block dim can not be zero!");
+    this->maxGenLen = max_gen_len;
+    this->vocabSize = vocab_size;
+    this->tileReqs = tile_reqs;
+
+    // get the requests of current core, core parallel
+    this->reqStart = static_cast<int64_t>(GetBlockIdx()) * reqs_per_core;
+    int64_t remain = num_reqs - reqStart;
+    this->reqEnd = reqStart + (remain < reqs_per_core ? remain : reqs_per_core);
+    if (reqEnd <= reqStart) {
+      this->reqEnd = reqStart;
+      return;
+    }
+
+    sampledTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)sampledTokenIds,
+                                      static_cast<int64_t>(num_reqs) * max_gen_len);
+    cuNumDraftTokensGm.SetGlobalBuffer((__gm__ int32_t *)cuNumDraftTokens, num_reqs);
+    discardMaskGm.SetGlobalBuffer((__gm__ int8_t *)discardMask, num_reqs);
+    backupNextTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)backupNextTokenIds, num_reqs);
+    queryStartLocGm.SetGlobalBuffer((__gm__ int32_t *)queryStartLoc, num_reqs + 1);
+    nextTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)nextTokenIds, num_reqs);
+    validSampledTokensCountGm.SetGlobalBuffer((__gm__ int32_t *)validSampledTokensCount, num_reqs);
+    tokenIndicesToSampleGm.SetGlobalBuffer((__gm__ int32_t *)tokenIndicesToSample, num_reqs);
+
+    // pipe alloc memory to queue, the unit is Bytes
+    int32_t rowsLength = (tileReqs * max_gen_len + INT32_PER_BLOCK - 1) / INT32_PER_BLOCK * INT32_PER_BLOCK;
+    Ppipe->InitBuffer(sampledBuf, rowsLength * sizeof(int32_t));
+    Ppipe->InitBuffer(cuBuf, tileReqs * sizeof(int32_t));
+    Ppipe->InitBuffer(discardBuf, (tileReqs + BLOCK_BYTES - 1) / BLOCK_BYTES * BLOCK_BYTES);
+    Ppipe->InitBuffer(backupBuf, tileReqs * sizeof(int32_t));
+    // query_start_loc of the tile and of the request after it
+    Ppipe->InitBuffer(qslBuf, (tileReqs + INT32_PER_BLOCK) * sizeof(int32_t));
+    Ppipe->InitBuffer(nextBuf, tileReqs * sizeof(int32_t));
+    Ppipe->InitBuffer(validBuf, tileReqs * sizeof(int32_t));
+    Ppipe->InitBuffer(sampleBuf, tileReqs * sizeof(int32_t));
+  }
+
+  __aicore__ inline void Process() {
+    if (reqEnd <= reqStart) {
+      return;
+    }
+    // cumulative draft tokens of the requests before the first one of this core
+    int32_t prevCu = reqStart == 0 ? 0 : cuNumDraftTokensGm.GetValue(reqStart - 1);
+    for (int64_t tileStart = reqStart; tileStart < reqEnd; tileStart += tileReqs) {
+      int32_t count = reqEnd - tileStart < tileReqs ? static_cast<int32_t>(reqEnd - tileStart) : tileReqs;
+      CopyIn(tileStart, count);
+      PIPE_MTE2_S();
+      prevCu = Compute(count, prevCu);
+      PIPE_S_MTE3();
+      CopyOut(tileStart, count);
+      // the outputs are rewritten and the inputs reloaded by the next tile
+      PIPE_MTE3_S();
+      PIPE_S_MTE2();
+    }
+  }
+
+private:
+  __aicore__ inline void CopyIn(int64_t tileStart, int32_t count) {
+    DataCopyCustom<int32_t>(sampledBuf.Get<int32_t>(), sampledTokenIdsGm[tileStart * maxGenLen], count * maxGenLen);
+    DataCopyCustom<int32_t>(cuBuf.Get<int32_t>(), cuNumDraftTokensGm[tileStart], count);
+    DataCopyCustom<int8_t>(discardBuf.Get<int8_t>(), discardMaskGm[tileStart], count);
+    DataCopyCustom<int32_t>(backupBuf.Get<int32_t>(), backupNextTokenIdsGm[tileStart], count);
+    DataCopyCustom<int32_t>(qslBuf.Get<int32_t>(), queryStartLocGm[tileStart], count + 1);
+  }
+
+  __aicore__ inline int32_t Compute(int32_t count, int32_t prevCu) {
+    LocalTensor<int32_t> sampled = sampledBuf.Get<int32_t>();
+    LocalTensor<int32_t> cu = cuBuf.Get<int32_t>();
+    LocalTensor<int8_t> discard = discardBuf.Get<int8_t>();
+    LocalTensor<int32_t> backup = backupBuf.Get<int32_t>();
+    LocalTensor<int32_t> qsl = qslBuf.Get<int32_t>();
+    LocalTensor<int32_t> next = nextBuf.Get<int32_t>();
+    LocalTensor<int32_t> valid = validBuf.Get<int32_t>();
+    LocalTensor<int32_t> sample = sampleBuf.Get<int32_t>();
+    for (int32_t i = 0; i < count; ++i) {
+      int32_t rowOffset = i * maxGenLen;
+      int32_t numValid = 0;
+      if (discard.GetValue(i) == 0) {
+        for (int32_t j = 0; j < maxGenLen; ++j) {
+          int32_t token = sampled.GetValue(rowOffset + j);
+          numValid += token >= 0 && token < vocabSize ? 1 : 0;
+        }
+      }
+      next.SetValue(i, numValid > 0 ? sampled.GetValue(rowOffset + numValid - 1) : backup.GetValue(i));
+      valid.SetValue(i, numValid);
+
+      int32_t cuDraft = cu.GetValue(i);
+      int32_t numDraft = cuDraft - prevCu;
+      prevCu = cuDraft;
+      int32_t numRejected = numDraft > 0 ? numDraft + 1 - numValid : 0;
+      sample.SetValue(i, qsl.GetValue(i + 1) - 1 - numRejected);
+    }
+    return prevCu;
+  }
+
+  __aicore__ inline void CopyOut(int64_t tileStart, int32_t count) {
+    DataCopyCustom<int32_t>(nextTokenIdsGm[tileStart], nextBuf.Get<int32_t>(), count);
+    DataCopyCustom<int32_t>(validSampledTokensCountGm[tileStart], validBuf.Get<int32_t>(), count);
+    DataCopyCustom<int32_t>(tokenIndicesToSampleGm[tileStart], sampleBuf.Get<int32_t>(), count);
+  }
+
+  __aicore__ inline void PIPE_MTE2_S() {
+    event_t event_MTE2_S = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE2_S));
+    SetFlag<HardEvent::MTE2_S>(event_MTE2_S);
+    WaitFlag<HardEvent::MTE2_S>(event_MTE2_S);
+  }
+
+  __aicore__ inline void PIPE_S_MTE2() {
+    event_t event_S_MTE2 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::S_MTE2));
+    SetFlag<HardEvent::S_MTE2>(event_S_MTE2);
+    WaitFlag<HardEvent::S_MTE2>(event_S_MTE2);
+  }
+
+  __aicore__ inline void PIPE_S_MTE3() {
+    event_t event_S_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::S_MTE3));
+    SetFlag<HardEvent::S_MTE3>(event_S_MTE3);
+    WaitFlag<HardEvent::S_MTE3>(event_S_MTE3);
+  }
+
+  __aicore__ inline void PIPE_MTE3_S() {
+    event_t event_MTE3_S = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE3_S));
+    SetFlag<HardEvent::MTE3_S>(event_MTE3_S);
+    WaitFlag<HardEvent::MTE3_S>(event_MTE3_S);
+  }
+
+private:
+  TPipe *Ppipe = nullptr;
+  TBuf<TPosition::VECCALC> sampledBuf, cuBuf, discardBuf, backupBuf, qslBuf, nextBuf, validBuf, sampleBuf;
+
+  GlobalTensor<int32_t> sampledTokenIdsGm, cuNumDraftTokensGm, backupNextTokenIdsGm, queryStartLocGm;
+  GlobalTensor<int32_t> nextTokenIdsGm, validSampledTokensCountGm, tokenIndicesToSampleGm;
+  GlobalTensor<int8_t> discardMaskGm;
+
+  int64_t reqStart;
+  int64_t reqEnd;
+  int32_t maxGenLen;
+  int32_t vocabSize;
+  int32_t tileReqs;
+};
+
+extern "C" __global__ __aicore__ void eagle_prepare_inputs(GM_ADDR sampledTokenIds, GM_ADDR cuNumDraftTokens,
+                                                           GM_ADDR discardMask, GM_ADDR backupNextTokenIds,
+                                                           GM_ADDR queryStartLoc, GM_ADDR nextTokenIds,
+                                                           GM_ADDR validSampledTokensCount,
+                                                           GM_ADDR tokenIndicesToSample, int32_t num_reqs,
+                                                           int32_t max_gen_len, int32_t vocab_size,
+                                                           int32_t reqs_per_core, int32_t tile_reqs) {
+  TPipe pipe;
+
+  KernelEaglePrepareInputs op(&pipe);
+  op.Init(sampledTokenIds, cuNumDraftTokens, discardMask, backupNextTokenIds, queryStartLoc, nextTokenIds,
+          validSampledTokensCount, tokenIndicesToSample, num_reqs, max_gen_len, vocab_size, reqs_per_core, tile_reqs);
+  op.Process();
+}
+
+#ifndef __CCE_KT_TEST__
+void EaglePrepareInputsKernelEntry(void *l2ctrl, void *aclStream, uint8_t *sampledTokenIds,
+                                   uint8_t *cuNumDraftTokens, uint8_t *discardMask, uint8_t *backupNextTokenIds,
+                                   uint8_t *queryStartLoc, uint8_t *nextTokenIds, uint8_t *validSampledTokensCount,
+                                   uint8_t *tokenIndicesToSample, const EaglePrepareInputsTilingData &tiling) {
+  eagle_prepare_inputs<<<tiling.usedCoreNum, l2ctrl, aclStream>>>(
+      sampledTokenIds, cuNumDraftTokens, discardMask, backupNextTokenIds, queryStartLoc, nextTokenIds,
+      validSampledTokensCount, tokenIndicesToSample, tiling.numReqs, tiling.maxGenLen, tiling.vocabSize,
+      tiling.reqsPerCore, tiling.tileReqs);
+}
+#endif
@@ -0,0 +1,36 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_EAGLE_PREPARE_INPUTS_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_EAGLE_PREPARE_INPUTS_H
+
+#include <cstdint>
+
+#include "ascendc/eagle_prepare_inputs_tiling.h"
+
+// Launches tiling.usedCoreNum cores, each handling tiling.reqsPerCore
+// requests. discardMask is bool, every other tensor int32.
+void EaglePrepareInputsKernelEntry(void *l2ctrl, void *aclStream,
+                                   uint8_t *sampledTokenIds,
+                                   uint8_t *cuNumDraftTokens,
+                                   uint8_t *discardMask,
+                                   uint8_t *backupNextTokenIds,
+                                   uint8_t *queryStartLoc,
+                                   uint8_t *nextTokenIds,
+                                   uint8_t *validSampledTokensCount,
+                                   uint8_t *tokenIndicesToSample,
+                                   const EaglePrepareInputsTilingData &tiling);
+
+#endif // VLLM_MINDSPORE_CSRC_ASCENDC_EAGLE_PREPARE_INPUTS_H
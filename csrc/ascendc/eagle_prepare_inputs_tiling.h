@@ -0,0 +1,61 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_EAGLE_PREPARE_INPUTS_TILING_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_EAGLE_PREPARE_INPUTS_TILING_H
+
+#include <cstdint>
+
+// Bytes of sampled token ids per UB tile of requests; the per-request inputs
+// and outputs of the tile take another 25 bytes a request.
+constexpr int32_t kEaglePrepareInputsTileBytes = 32768;
+// A request is a few scalar compares, so below this many requests per core
+// the launch cost of an extra core outweighs the requests it handles.
+constexpr int32_t kEaglePrepareInputsMinReqsPerCore = 64;
+
+struct EaglePrepareInputsTilingData {
+  int32_t numReqs{0};
+  int32_t maxGenLen{0};
+  int32_t vocabSize{0};
+  int32_t usedCoreNum{1};
+  int32_t reqsPerCore{0};  // the last core takes the remainder
+  int32_t tileReqs{0};     // requests per UB tile, a multiple of 8
+};
+
+// Requests are independent, so they are spread evenly across at most
+// `max_core_num` cores, and walked in tiles of whole rows.
+inline EaglePrepareInputsTilingData ComputeEaglePrepareInputsTiling(int32_t num_reqs, int32_t max_gen_len,
+                                                                    int32_t vocab_size, int32_t max_core_num) {
+  EaglePrepareInputsTilingData tiling;
+  tiling.numReqs = num_reqs;
+  tiling.maxGenLen = max_gen_len;
+  tiling.vocabSize = vocab_size;
+  if (num_reqs <= 0 || max_gen_len <= 0) {
+    return tiling;
+  }
+  max_core_num = max_core_num > 0 ? max_core_num : 1;
+  int32_t core_num = (num_reqs + kEaglePrepareInputsMinReqsPerCore - 1) / kEaglePrepareInputsMinReqsPerCore;
+  core_num = core_num < max_core_num ? core_num : max_core_num;
+  tiling.reqsPerCore = (num_reqs + core_num - 1) / core_num;
+  tiling.usedCoreNum = (num_reqs + tiling.reqsPerCore - 1) / tiling.reqsPerCore;
+  // UB buffers are sized in whole 32B blocks of int32, 8 requests at least
+  int32_t tile_reqs = kEaglePrepareInputsTileBytes / static_cast<int32_t>(sizeof(int32_t)) / max_gen_len / 8 * 8;
+  int32_t reqs_align = (tiling.reqsPerCore + 7) / 8 * 8;
+  tile_reqs = tile_reqs > 8 ? tile_reqs : 8;
+  tiling.tileReqs = tile_reqs < reqs_align ? tile_reqs : reqs_align;
+  return tiling;
+}
+
+#endif  // VLLM_MINDSPORE_CSRC_ASCENDC_EAGLE_PREPARE_INPUTS_TILING_H
@@ -0,0 +1,306 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_operator.h"
+
+#include "rejection_sample_tiling.h"
+
+using namespace AscendC;
+
+template <typename Tp, Tp v>
+struct integral_constant {
+  static constexpr Tp value = v;
+};
+using true_type = integral_constant<bool, true>;
+using false_type = integral_constant<bool, false>;
+template <typename, typename>
+struct is_same : public false_type {};
+template <typename Tp>
+struct is_same<Tp, Tp> : public true_type {};
+
+template <typename T, typename U, typename R>
+__aicore__ inline void DataCopyCustom(const U &dstTensor, const R &srcTensor, const uint32_t count) {
+  DataCopyParams copyParams;
+  copyParams.blockLen = count * sizeof(T);
+  copyParams.blockCount = 1;
+  if constexpr (is_same<U, AscendC::LocalTensor<T>>::value) {
+    DataCopyPadParams padParams;
+    DataCopyPad(dstTensor, srcTensor, copyParams, padParams);
+  } else {
+    DataCopyPad(dstTensor, srcTensor, copyParams);
+  }
+}
+
+constexpr int32_t BUFFER_NUM = 2;  // tensor num for each queue
+constexpr int32_t BLOCK_BYTES = 32;
+constexpr int32_t INT32_PER_BLOCK = BLOCK_BYTES / sizeof(int32_t);
+constexpr int32_t PLACEHOLDER_TOKEN_ID = -1;
+
+// Rejection sampling of speculative draft tokens, greedy and random requests in the same batch.
+// Request i owns the draft tokens [cu_num_draft_tokens[i - 1], cu_num_draft_tokens[i]) and row i of
+// output_token_ids, which holds max_spec_len + 1 entries: the accepted draft tokens, then the target token (greedy)
+// or the recovered token (random) at the first rejection, or the bonus token once every draft token is accepted.
+// The rest of the row is PLACEHOLDER_TOKEN_ID.
+// Each core walks its requests one by one; the vocabulary rows are streamed through UB in tiles.
+class KernelRejectionSample {
+public:
+  __aicore__ inline KernelRejectionSample(TPipe *pipe) { Ppipe = pipe; }
+
+  __aicore__ inline void Init(GM_ADDR cuNumDraftTokens, GM_ADDR draftTokenIds, GM_ADDR draftProbs, GM_ADDR targetProbs,
+                              GM_ADDR bonusTokenIds, GM_ADDR uniformProbs, GM_ADDR recoveryNoise, GM_ADDR isGreedy,
+                              GM_ADDR outputTokenIds, int32_t batch_size, int32_t max_spec_len, int32_t vocab_size,
+                              int32_t use_draft_probs, int32_t reqs_per_core, int32_t tile_length) {
+    ASSERT(GetBlockNum() != 0 && "Block dim can not be zero!");
+    this->maxSpecLen = max_spec_len;
+    this->vocabSize = vocab_size;
+    this->useDraftProbs = use_draft_probs != 0;
+    this->tileLength = tile_length;
+
+    // get the requests of current core, core parallel
+    this->reqStart = static_cast<int64_t>(GetBlockIdx()) * reqs_per_core;
+    int64_t remain = batch_size - reqStart;
+    this->reqEnd = reqStart + (remain < reqs_per_core ? remain : reqs_per_core);
+    if (reqEnd <= reqStart) {
+      this->reqEnd = reqStart;
+      return;
+    }
+
+    // requests index their own draft tokens, so the tensors are not offset per core
+    cuNumDraftTokensGm.SetGlobalBuffer((__gm__ int32_t *)cuNumDraftTokens, batch_size);
+    draftTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)draftTokenIds);  // inf size
+    draftProbsGm.SetGlobalBuffer((__gm__ float *)draftProbs);          // inf size
+    targetProbsGm.SetGlobalBuffer((__gm__ float *)targetProbs);        // inf size
+    bonusTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)bonusTokenIds, batch_size);
+    uniformProbsGm.SetGlobalBuffer((__gm__ float *)uniformProbs);      // inf size
+    recoveryNoiseGm.SetGlobalBuffer((__gm__ float *)recoveryNoise);    // inf size
+    isGreedyGm.SetGlobalBuffer((__gm__ int8_t *)isGreedy, batch_size);
+    outputTokenIdsGm.SetGlobalBuffer((__gm__ int32_t *)outputTokenIds,
+                                     static_cast<int64_t>(batch_size) * (max_spec_len + 1));
+
+    // pipe alloc memory to queue, the unit is Bytes
+    Ppipe->InitBuffer(targetQue, BUFFER_NUM, tileLength * sizeof(float));
+    Ppipe->InitBuffer(draftQue, BUFFER_NUM, tileLength * sizeof(float));
+    Ppipe->InitBuffer(noiseQue, BUFFER_NUM, tileLength * sizeof(float));
+    Ppipe->InitBuffer(ratioBuf, tileLength * sizeof(float));
+    Ppipe->InitBuffer(workBuf, tileLength * sizeof(float));
+    Ppipe->InitBuffer(maxBuf, BLOCK_BYTES);
+    int32_t rowLength = (max_spec_len + 1 + INT32_PER_BLOCK - 1) / INT32_PER_BLOCK * INT32_PER_BLOCK;
+    Ppipe->InitBuffer(outRowBuf, rowLength * sizeof(int32_t));
+  }
+
+  __aicore__ inline void Process() {
+    for (int64_t req = reqStart; req < reqEnd; ++req) {
+      SampleRequest(req);
+    }
+  }
+
+private:
+  __aicore__ inline void SampleRequest(int64_t req) {
+    int64_t start = req == 0 ? 0 : cuNumDraftTokensGm.GetValue(req - 1);
+    int64_t numDraft = cuNumDraftTokensGm.GetValue(req) - start;
+    bool greedy = isGreedyGm.GetValue(req) != 0;
+
+    LocalTensor<int32_t> outRow = outRowBuf.Get<int32_t>();
+    // the row of the previous request may still be on its way to GM
+    PIPE_MTE3_S();
+    for (int32_t i = 0; i <= maxSpecLen; ++i) {
+      outRow.SetValue(i, PLACEHOLDER_TOKEN_ID);
+    }
+
+    bool rejected = false;
+    for (int64_t pos = 0; pos < numDraft && !rejected; ++pos) {
+      int64_t token = start + pos;
+      int32_t draftId = draftTokenIdsGm.GetValue(token);
+      int32_t outId = draftId;
+      if (greedy) {
+        outId = ArgMax(token, req, draftId, false);
+        rejected = outId != draftId;
+      } else {
+        int64_t probOffset = token * vocabSize + draftId;
+        float draftProb = useDraftProbs ? draftProbsGm.GetValue(probOffset) : 1.0f;
+        float targetProb = targetProbsGm.GetValue(probOffset);
+        float uniformProb = uniformProbsGm.GetValue(token);
+        if (!(draftProb > 0.0f && targetProb / draftProb >= uniformProb)) {
+          outId = ArgMax(token, req, draftId, true);
+          rejected = true;
+        }
+      }
+      outRow.SetValue(pos, outId);
+    }
+    if (!rejected) {
+      outRow.SetValue(numDraft, bonusTokenIdsGm.GetValue(req));
+    }
+
+    PIPE_S_MTE3();
+    DataCopyCustom<int32_t>(outputTokenIdsGm[req * (maxSpecLen + 1)], outRow, maxSpecLen + 1);
+  }
+
+  // Greedy: argmax of the target row. Recovery: argmax of max(target - draft, 0) / noise, or of target / noise with
+  // the draft token zeroed when there are no draft probs. Ties go to the lowest index, as with mint.argmax.
+  __aicore__ inline int32_t ArgMax(int64_t token, int64_t req, int32_t draftId, bool recovery) {
+    int32_t tileNum = (vocabSize + tileLength - 1) / tileLength;
+    float best = 0.0f;
+    int32_t bestId = 0;
+    // the queues hold two tiles, so copying in tile t + 1 overlaps with reducing tile t
+    CopyInTile(token, req, 0, recovery);
+    for (int32_t t = 0; t < tileNum; ++t) {
+      if (t + 1 < tileNum) {
+        CopyInTile(token, req, (t + 1) * tileLength, recovery);
+      }
+      int32_t offset = t * tileLength;
+      float value;
+      int32_t index;
+      ReduceTile(offset, draftId, recovery, value, index);
+      if (t == 0 || value > best) {
+        best = value;
+        bestId = offset + index;
+      }
+    }
+    return bestId;
+  }
+
+  __aicore__ inline int32_t TileCount(int32_t offset) {
+    return vocabSize - offset < tileLength ? vocabSize - offset : tileLength;
+  }
+
+  __aicore__ inline void CopyInTile(int64_t token, int64_t req, int32_t offset, bool recovery) {
+    int32_t count = TileCount(offset);
+    LocalTensor<float> targetLocal = targetQue.AllocTensor<float>();
+    DataCopyCustom<float>(targetLocal, targetProbsGm[token * vocabSize + offset], count);
+    targetQue.EnQue(targetLocal);
+    if (!recovery) {
+      return;
+    }
+    LocalTensor<float> noiseLocal = noiseQue.AllocTensor<float>();
+    DataCopyCustom<float>(noiseLocal, recoveryNoiseGm[req * vocabSize + offset], count);
+    noiseQue.EnQue(noiseLocal);
+    if (useDraftProbs) {
+      LocalTensor<float> draftLocal = draftQue.AllocTensor<float>();
+      DataCopyCustom<float>(draftLocal, draftProbsGm[token * vocabSize + offset], count);
+      draftQue.EnQue(draftLocal);
+    }
+  }
+
+  __aicore__ inline void ReduceTile(int32_t offset, int32_t draftId, bool recovery, float &value, int32_t &index) {
+    int32_t count = TileCount(offset);
+    LocalTensor<float> targetLocal = targetQue.DeQue<float>();
+    LocalTensor<float> srcLocal = targetLocal;
+    if (recovery) {
+      LocalTensor<float> noiseLocal = noiseQue.DeQue<float>();
+      LocalTensor<float> ratioLocal = ratioBuf.Get<float>();
+      if (useDraftProbs) {
+        LocalTensor<float> draftLocal = draftQue.DeQue<float>();
+        Sub(ratioLocal, targetLocal, draftLocal, count);
+        PipeBarrier<PIPE_V>();
+        Maxs(ratioLocal, ratioLocal, 0.0f, count);
+        draftQue.FreeTensor(draftLocal);
+      } else {
+        Adds(ratioLocal, targetLocal, 0.0f, count);
+      }
+      PipeBarrier<PIPE_V>();
+      Div(ratioLocal, ratioLocal, noiseLocal, count);
+      noiseQue.FreeTensor(noiseLocal);
+      // zeroing the draft token after the division is the same as before it, the noise is positive
+      if (!useDraftProbs && draftId >= offset && draftId < offset + count) {
+        PIPE_V_S();
+        ratioLocal.SetValue(draftId - offset, 0.0f);
+        PIPE_S_V();
+      }
+      srcLocal = ratioLocal;
+    }
+    PipeBarrier<PIPE_V>();
+
+    LocalTensor<float> maxLocal = maxBuf.Get<float>();
+    LocalTensor<float> workLocal = workBuf.Get<float>();
+    ReduceMax<float>(maxLocal, srcLocal, workLocal, count, true);
+    targetQue.FreeTensor(targetLocal);
+
+    PIPE_V_S();
+    value = maxLocal.GetValue(0);
+    float indexBits = maxLocal.GetValue(1);
+    index = *reinterpret_cast<int32_t *>(&indexBits);
+    // maxLocal and ratioLocal are rewritten by the next tile
+    PIPE_S_V();
+  }
+
+  __aicore__ inline void PIPE_V_S() {
+    event_t event_V_S = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::V_S));
+    SetFlag<HardEvent::V_S>(event_V_S);
+    WaitFlag<HardEvent::V_S>(event_V_S);
+  }
+
+  __aicore__ inline void PIPE_S_V() {
+    event_t event_S_V = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::S_V));
+    SetFlag<HardEvent::S_V>(event_S_V);
+    WaitFlag<HardEvent::S_V>(event_S_V);
+  }
+
+  __aicore__ inline void PIPE_S_MTE3() {
+    event_t event_S_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::S_MTE3));
+    SetFlag<HardEvent::S_MTE3>(event_S_MTE3);
+    WaitFlag<HardEvent::S_MTE3>(event_S_MTE3);
+  }
+
+  __aicore__ inline void PIPE_MTE3_S() {
+    event_t event_MTE3_S = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE3_S));
+    SetFlag<HardEvent::MTE3_S>(event_MTE3_S);
+    WaitFlag<HardEvent::MTE3_S>(event_MTE3_S);
+  }
+
+private:
+  TPipe *Ppipe = nullptr;
+  // create queues for input, in this case depth is equal to buffer num
+  TQue<QuePosition::VECIN, BUFFER_NUM> targetQue, draftQue, noiseQue;
+  TBuf<TPosition::VECCALC> ratioBuf, workBuf, maxBuf, outRowBuf;
+
+  GlobalTensor<int32_t> cuNumDraftTokensGm, draftTokenIdsGm, bonusTokenIdsGm, outputTokenIdsGm;
+  GlobalTensor<float> draftProbsGm, targetProbsGm, uniformProbsGm, recoveryNoiseGm;
+  GlobalTensor<int8_t> isGreedyGm;
+
+  int64_t reqStart;
+  int64_t reqEnd;
+  int32_t maxSpecLen;
+  int32_t vocabSize;
+  int32_t tileLength;
+  bool useDraftProbs;
+};
+
+extern "C" __global__ __aicore__ void rejection_sample(GM_ADDR cuNumDraftTokens, GM_ADDR draftTokenIds,
+                                                       GM_ADDR draftProbs, GM_ADDR targetProbs, GM_ADDR bonusTokenIds,
+                                                       GM_ADDR uniformProbs, GM_ADDR recoveryNoise, GM_ADDR isGreedy,
+                                                       GM_ADDR outputTokenIds, int32_t batch_size,
+                                                       int32_t max_spec_len, int32_t vocab_size,
+                                                       int32_t use_draft_probs, int32_t reqs_per_core,
+                                                       int32_t tile_length) {
+  TPipe pipe;
+
+  KernelRejectionSample op(&pipe);
+  op.Init(cuNumDraftTokens, draftTokenIds, draftProbs, targetProbs, bonusTokenIds, uniformProbs, recoveryNoise,
+          isGreedy, outputTokenIds, batch_size, max_spec_len, vocab_size, use_draft_probs, reqs_per_core, tile_length);
+  op.Process();
+}
+
+#ifndef __CCE_KT_TEST__
+void RejectionSampleKernelEntry(void *l2ctrl, void *aclStream, uint8_t *cuNumDraftTokens, uint8_t *draftTokenIds,
+                                uint8_t *draftProbs, uint8_t *targetProbs, uint8_t *bonusTokenIds,
+                                uint8_t *uniformProbs, uint8_t *recoveryNoise, uint8_t *isGreedy,
+                                uint8_t *outputTokenIds, bool use_draft_probs,
+                                const RejectionSampleTilingData &tiling) {
+  rejection_sample<<<tiling.usedCoreNum, l2ctrl, aclStream>>>(
+      cuNumDraftTokens, draftTokenIds, draftProbs, targetProbs, bonusTokenIds, uniformProbs, recoveryNoise, isGreedy,
+      outputTokenIds, tiling.batchSize, tiling.maxSpecLen, tiling.vocabSize, use_draft_probs ? 1 : 0,
+      tiling.reqsPerCore, tiling.tileLength);
+}
+#endif
@@ -0,0 +1,34 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_REJECTION_SAMPLE_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_REJECTION_SAMPLE_H
+
+#include <cstdint>
+
+#include "ascendc/rejection_sample_tiling.h"
+
+// Launches tiling.usedCoreNum cores, each sampling tiling.reqsPerCore
+// requests. Token ids and cu_num_draft_tokens are int32, probabilities and
+// the recovery noise fp32, is_greedy bool. draftProbs is not read unless
+// use_draft_probs is set.
+void RejectionSampleKernelEntry(
+    void *l2ctrl, void *aclStream, uint8_t *cuNumDraftTokens,
+    uint8_t *draftTokenIds, uint8_t *draftProbs, uint8_t *targetProbs,
+    uint8_t *bonusTokenIds, uint8_t *uniformProbs, uint8_t *recoveryNoise,
+    uint8_t *isGreedy, uint8_t *outputTokenIds, bool use_draft_probs,
+    const RejectionSampleTilingData &tiling);
+
+#endif // VLLM_MINDSPORE_CSRC_ASCENDC_REJECTION_SAMPLE_H
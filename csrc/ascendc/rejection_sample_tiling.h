@@ -0,0 +1,56 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_REJECTION_SAMPLE_TILING_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_REJECTION_SAMPLE_TILING_H
+
+#include <cstdint>
+
+// Vocabulary entries per UB tile. The target, draft and noise rows are double
+// buffered, next to one tile each for the recovery ratio and the ReduceMax
+// workspace, 128KB of UB in total.
+constexpr int32_t kRejectionSampleTileLength = 4096;
+
+struct RejectionSampleTilingData {
+  int32_t batchSize{0};
+  int32_t maxSpecLen{0};
+  int32_t vocabSize{0};
+  int32_t usedCoreNum{1};
+  int32_t reqsPerCore{0};  // the last core takes the remainder
+  int32_t tileLength{0};   // vocabulary entries per UB tile
+};
+
+// Requests are independent and each one walks its draft tokens in order, so
+// they are spread evenly across at most `max_core_num` cores.
+inline RejectionSampleTilingData ComputeRejectionSampleTiling(int32_t batch_size, int32_t max_spec_len,
+                                                              int32_t vocab_size, int32_t max_core_num) {
+  RejectionSampleTilingData tiling;
+  tiling.batchSize = batch_size;
+  tiling.maxSpecLen = max_spec_len;
+  tiling.vocabSize = vocab_size;
+  if (batch_size <= 0) {
+    return tiling;
+  }
+  max_core_num = max_core_num > 0 ? max_core_num : 1;
+  int32_t core_num = batch_size < max_core_num ? batch_size : max_core_num;
+  tiling.reqsPerCore = (batch_size + core_num - 1) / core_num;
+  tiling.usedCoreNum = (batch_size + tiling.reqsPerCore - 1) / tiling.reqsPerCore;
+  // UB buffers are sized in whole 32B blocks of fp32
+  int32_t vocab_align = (vocab_size + 7) / 8 * 8;
+  tiling.tileLength = vocab_align < kRejectionSampleTileLength ? vocab_align : kRejectionSampleTileLength;
+  return tiling;
+}
+
+#endif  // VLLM_MINDSPORE_CSRC_ASCENDC_REJECTION_SAMPLE_TILING_H
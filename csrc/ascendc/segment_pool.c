@@ -0,0 +1,341 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_operator.h"
+
+#include "segment_pool_tiling.h"
+
+using namespace AscendC;
+
+template <typename Tp, Tp v>
+struct integral_constant {
+  static constexpr Tp value = v;
+};
+using true_type = integral_constant<bool, true>;
+using false_type = integral_constant<bool, false>;
+template <typename, typename>
+struct is_same : public false_type {};
+template <typename Tp>
+struct is_same<Tp, Tp> : public true_type {};
+
+template <typename T, typename U, typename R>
+__aicore__ inline void DataCopyCustom(const U &dstTensor, const R &srcTensor, const uint32_t count) {
+  DataCopyParams copyParams;
+  copyParams.blockLen = count * sizeof(T);
+  copyParams.blockCount = 1;
+  if constexpr (is_same<U, AscendC::LocalTensor<T>>::value) {
+    DataCopyPadParams padParams;
+    DataCopyPad(dstTensor, srcTensor, copyParams, padParams);
+  } else {
+    DataCopyPad(dstTensor, srcTensor, copyParams);
+  }
+}
+
+constexpr int32_t BUFFER_NUM = 2;
+constexpr int32_t BLOCK_BYTES = 32;
+
+// Pooling of the hidden states of a batch of requests, [num_tokens, hidden_size] in T, into one row per request.
+// Request i owns the tokens [first_token_indices[i], last_token_indices[i]] of this step, after the
+// num_prev_tokens[i] tokens of its prompt pooled in earlier steps. CLS and LAST rows are copies of a token row, in T;
+// the CLS row of a prompt whose first token came in an earlier step is carried in fp32 in partial_sums. MEAN rows
+// are fp32: the token rows are added one after the other, after the carried sum of earlier steps, and scaled by
+// 1 / prompt_lens[i]. CLS and MEAN write the carried row of requests whose prompt goes on in a later step.
+// The work is split in (request, column tile) pairs, so a core handles a tile of columns of a request at a time;
+// MEAN loads the token rows of a tile in blocks of tile_rows with one strided DMA each, the next block loading while
+// the current one is added.
+template <typename T>
+class KernelSegmentPool {
+public:
+  __aicore__ inline KernelSegmentPool(TPipe *pipe) { Ppipe = pipe; }
+
+  __aicore__ inline void Init(GM_ADDR hiddenStates, GM_ADDR firstTokenIndices, GM_ADDR lastTokenIndices,
+                              GM_ADDR promptLens, GM_ADDR numPrevTokens, GM_ADDR pooled, GM_ADDR partialSums,
+                              int32_t num_reqs, int32_t hidden_size, int32_t pooling_type, int32_t items_per_core,
+                              int32_t tile_cols, int32_t tile_rows) {
+    ASSERT(GetBlockNum() != 0 && "Block dim can not be zero!");
+    this->hiddenSize = hidden_size;
+    this->poolingType = pooling_type;
+    this->tileCols = tile_cols;
+    this->tileRows = tile_rows;
+    this->colTiles = (hidden_size + tile_cols - 1) / tile_cols;
+
+    // get the (request, column tile) pairs of current core, core parallel
+    int64_t numItems = static_cast<int64_t>(num_reqs) * colTiles;
+    this->itemStart = static_cast<int64_t>(GetBlockIdx()) * items_per_core;
+    int64_t remain = numItems - itemStart;
+    this->itemEnd = itemStart + (remain < items_per_core ? remain : items_per_core);
+    if (itemEnd <= itemStart) {
+      this->itemEnd = itemStart;
+      return;
+    }
+
+    int64_t pooledSize = static_cast<int64_t>(num_reqs) * hidden_size;
+    hiddenStatesGm.SetGlobalBuffer((__gm__ T *)hiddenStates);  // inf size
+    firstTokenIndicesGm.SetGlobalBuffer((__gm__ int32_t *)firstTokenIndices, num_reqs);
+    lastTokenIndicesGm.SetGlobalBuffer((__gm__ int32_t *)lastTokenIndices, num_reqs);
+    promptLensGm.SetGlobalBuffer((__gm__ int32_t *)promptLens, num_reqs);
+    numPrevTokensGm.SetGlobalBuffer((__gm__ int32_t *)numPrevTokens, num_reqs);
+    // the pooled rows are T for CLS and LAST, fp32 for MEAN
+    pooledGm.SetGlobalBuffer((__gm__ T *)pooled, pooledSize);
+    pooledFloatGm.SetGlobalBuffer((__gm__ float *)pooled, pooledSize);
+    partialSumsGm.SetGlobalBuffer((__gm__ float *)partialSums, pooledSize);
+
+    // pipe alloc memory to queue, the unit is Bytes
+    if (poolingType == kSegmentPoolMean) {
+      Ppipe->InitBuffer(rowsQue, BUFFER_NUM, tileRows * tileCols * sizeof(T));
+      if constexpr (!is_same<T, float>::value) {
+        Ppipe->InitBuffer(castBuf, tileRows * tileCols * sizeof(float));
+      }
+    }
+    Ppipe->InitBuffer(accBuf, tileCols * sizeof(float));
+    Ppipe->InitBuffer(outBuf, tileCols * sizeof(T));
+  }
+
+  __aicore__ inline void Process() {
+    for (int64_t item = itemStart; item < itemEnd; ++item) {
+      int64_t req = item / colTiles;
+      int32_t col = static_cast<int32_t>(item % colTiles) * tileCols;
+      int32_t count = hiddenSize - col < tileCols ? hiddenSize - col : tileCols;
+      PoolTile(req, col, count);
+      // accBuf and outBuf are rewritten by the next tile
+      PIPE_MTE3_MTE2();
+      PIPE_MTE3_V();
+    }
+  }
+
+private:
+  __aicore__ inline void PoolTile(int64_t req, int32_t col, int32_t count) {
+    int32_t first = firstTokenIndicesGm.GetValue(req);
+    int32_t last = lastTokenIndicesGm.GetValue(req);
+    int32_t numPrev = numPrevTokensGm.GetValue(req);
+    int32_t promptLen = promptLensGm.GetValue(req);
+    bool carryIn = numPrev > 0;
+    bool carryOut = numPrev + (last - first + 1) < promptLen;
+    int64_t rowOffset = req * hiddenSize + col;
+
+    if (poolingType == kSegmentPoolMean) {
+      MeanTile(first, last, col, count, rowOffset, promptLen, carryIn, carryOut);
+    } else if (poolingType == kSegmentPoolCls && carryIn) {
+      CarriedClsTile(count, rowOffset);
+    } else {
+      CopyRowTile(poolingType == kSegmentPoolCls ? first : last, col, count, rowOffset,
+                  poolingType == kSegmentPoolCls && carryOut);
+    }
+  }
+
+  // the row of one token, and for the first chunk of a CLS prompt that goes on, its fp32 copy to carry
+  __aicore__ inline void CopyRowTile(int32_t token, int32_t col, int32_t count, int64_t rowOffset, bool carryOut) {
+    LocalTensor<T> out = outBuf.Get<T>();
+    DataCopyCustom<T>(out, hiddenStatesGm[static_cast<int64_t>(token) * hiddenSize + col], count);
+    PIPE_MTE2_MTE3();
+    DataCopyCustom<T>(pooledGm[rowOffset], out, count);
+    if (!carryOut) {
+      return;
+    }
+    if constexpr (is_same<T, float>::value) {
+      DataCopyCustom<float>(partialSumsGm[rowOffset], out, count);
+    } else {
+      LocalTensor<float> acc = accBuf.Get<float>();
+      PIPE_MTE2_V();
+      Cast(acc, out, RoundMode::CAST_NONE, count);
+      PIPE_V_MTE3();
+      DataCopyCustom<float>(partialSumsGm[rowOffset], acc, count);
+    }
+  }
+
+  // the CLS row of a prompt whose first token came in an earlier step, back from its fp32 carry
+  __aicore__ inline void CarriedClsTile(int32_t count, int64_t rowOffset) {
+    LocalTensor<float> acc = accBuf.Get<float>();
+    DataCopyCustom<float>(acc, partialSumsGm[rowOffset], count);
+    if constexpr (is_same<T, float>::value) {
+      PIPE_MTE2_MTE3();
+      DataCopyCustom<float>(pooledFloatGm[rowOffset], acc, count);
+    } else {
+      LocalTensor<T> out = outBuf.Get<T>();
+      PIPE_MTE2_V();
+      Cast(out, acc, RoundMode::CAST_RINT, count);
+      PIPE_V_MTE3();
+      DataCopyCustom<T>(pooledGm[rowOffset], out, count);
+    }
+  }
+
+  __aicore__ inline void MeanTile(int32_t first, int32_t last, int32_t col, int32_t count, int64_t rowOffset,
+                                  int32_t promptLen, bool carryIn, bool carryOut) {
+    LocalTensor<float> acc = accBuf.Get<float>();
+    if (carryIn) {
+      DataCopyCustom<float>(acc, partialSumsGm[rowOffset], count);
+      PIPE_MTE2_V();
+    } else {
+      Duplicate(acc, 0.0f, count);
+    }
+    PipeBarrier<PIPE_V>();
+
+    int32_t numRows = last - first + 1;
+    if (numRows > 0) {
+      CopyInRows(first, col, count, numRows < tileRows ? numRows : tileRows);
+    }
+    for (int32_t done = 0; done < numRows; done += tileRows) {
+      int32_t rows = numRows - done < tileRows ? numRows - done : tileRows;
+      int32_t next = done + tileRows;
+      if (next < numRows) {
+        CopyInRows(first + next, col, count, numRows - next < tileRows ? numRows - next : tileRows);
+      }
+      AddRows(acc, count, rows);
+    }
+
+    if (carryOut) {
+      PIPE_V_MTE3();
+      DataCopyCustom<float>(partialSumsGm[rowOffset], acc, count);
+      PIPE_MTE3_V();
+    }
+    Muls(acc, acc, 1.0f / static_cast<float>(promptLen), count);
+    PIPE_V_MTE3();
+    DataCopyCustom<float>(pooledFloatGm[rowOffset], acc, count);
+  }
+
+  // UB rows of a block start on 32B blocks
+  __aicore__ inline int32_t RowStride(int32_t count) {
+    constexpr int32_t perBlock = BLOCK_BYTES / sizeof(T);
+    return (count + perBlock - 1) / perBlock * perBlock;
+  }
+
+  __aicore__ inline void CopyInRows(int32_t token, int32_t col, int32_t count, int32_t rows) {
+    LocalTensor<T> rowsLocal = rowsQue.AllocTensor<T>();
+    DataCopyExtParams copyParams{static_cast<uint16_t>(rows), static_cast<uint32_t>(count * sizeof(T)),
+                                 static_cast<uint32_t>((hiddenSize - count) * sizeof(T)), 0, 0};
+    DataCopyPadExtParams<T> padParams{false, 0, 0, 0};
+    DataCopyPad(rowsLocal, hiddenStatesGm[static_cast<int64_t>(token) * hiddenSize + col], copyParams, padParams);
+    rowsQue.EnQue(rowsLocal);
+  }
+
+  // the rows of the block added to acc one after the other, so that the sums are the same whatever the tiling
+  __aicore__ inline void AddRows(const LocalTensor<float> &acc, int32_t count, int32_t rows) {
+    LocalTensor<T> rowsLocal = rowsQue.DeQue<T>();
+    int32_t stride = RowStride(count);
+    LocalTensor<float> rowsFloat;
+    if constexpr (is_same<T, float>::value) {
+      rowsFloat = rowsLocal;
+    } else {
+      rowsFloat = castBuf.Get<float>();
+      Cast(rowsFloat, rowsLocal, RoundMode::CAST_NONE, rows * stride);
+      PipeBarrier<PIPE_V>();
+    }
+    for (int32_t r = 0; r < rows; ++r) {
+      Add(acc, acc, rowsFloat[r * stride], count);
+      PipeBarrier<PIPE_V>();
+    }
+    rowsQue.FreeTensor(rowsLocal);
+  }
+
+  __aicore__ inline void PIPE_MTE2_V() {
+    event_t event_MTE2_V = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE2_V));
+    SetFlag<HardEvent::MTE2_V>(event_MTE2_V);
+    WaitFlag<HardEvent::MTE2_V>(event_MTE2_V);
+  }
+
+  __aicore__ inline void PIPE_MTE2_MTE3() {
+    event_t event_MTE2_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE2_MTE3));
+    SetFlag<HardEvent::MTE2_MTE3>(event_MTE2_MTE3);
+    WaitFlag<HardEvent::MTE2_MTE3>(event_MTE2_MTE3);
+  }
+
+  __aicore__ inline void PIPE_V_MTE3() {
+    event_t event_V_MTE3 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::V_MTE3));
+    SetFlag<HardEvent::V_MTE3>(event_V_MTE3);
+    WaitFlag<HardEvent::V_MTE3>(event_V_MTE3);
+  }
+
+  __aicore__ inline void PIPE_MTE3_V() {
+    event_t event_MTE3_V = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE3_V));
+    SetFlag<HardEvent::MTE3_V>(event_MTE3_V);
+    WaitFlag<HardEvent::MTE3_V>(event_MTE3_V);
+  }
+
+  __aicore__ inline void PIPE_MTE3_MTE2() {
+    event_t event_MTE3_MTE2 = static_cast<event_t>(GetTPipePtr()->FetchEventID(HardEvent::MTE3_MTE2));
+    SetFlag<HardEvent::MTE3_MTE2>(event_MTE3_MTE2);
+    WaitFlag<HardEvent::MTE3_MTE2>(event_MTE3_MTE2);
+  }
+
+private:
+  TPipe *Ppipe = nullptr;
+  // create queues for input, in this case depth is equal to buffer num
+  TQue<QuePosition::VECIN, BUFFER_NUM> rowsQue;
+  TBuf<TPosition::VECCALC> castBuf, accBuf, outBuf;
+
+  GlobalTensor<T> hiddenStatesGm, pooledGm;
+  GlobalTensor<float> pooledFloatGm, partialSumsGm;
+  GlobalTensor<int32_t> firstTokenIndicesGm, lastTokenIndicesGm, promptLensGm, numPrevTokensGm;
+
+  int64_t itemStart;
+  int64_t itemEnd;
+  int32_t hiddenSize;
+  int32_t poolingType;
+  int32_t tileCols;
+  int32_t tileRows;
+  int32_t colTiles;
+};
+
+template <typename T>
+__aicore__ inline void SegmentPoolImpl(GM_ADDR hiddenStates, GM_ADDR firstTokenIndices, GM_ADDR lastTokenIndices,
+                                       GM_ADDR promptLens, GM_ADDR numPrevTokens, GM_ADDR pooled,
+                                       GM_ADDR partialSums, int32_t num_reqs, int32_t hidden_size,
+                                       int32_t pooling_type, int32_t items_per_core, int32_t tile_cols,
+                                       int32_t tile_rows) {
+  TPipe pipe;
+
+  KernelSegmentPool<T> op(&pipe);
+  op.Init(hiddenStates, firstTokenIndices, lastTokenIndices, promptLens, numPrevTokens, pooled, partialSums, num_reqs,
+          hidden_size, pooling_type, items_per_core, tile_cols, tile_rows);
+  op.Process();
+}
+
+// segment_pool_<hidden states dtype>
+#define SEGMENT_POOL_KERNEL(name, T)                                                                                  \
+  extern "C" __global__ __aicore__ void segment_pool_##name(                                                          \
+      GM_ADDR hiddenStates, GM_ADDR firstTokenIndices, GM_ADDR lastTokenIndices, GM_ADDR promptLens,                  \
+      GM_ADDR numPrevTokens, GM_ADDR pooled, GM_ADDR partialSums, int32_t num_reqs, int32_t hidden_size,              \
+      int32_t pooling_type, int32_t items_per_core, int32_t tile_cols, int32_t tile_rows) {                           \
+    SegmentPoolImpl<T>(hiddenStates, firstTokenIndices, lastTokenIndices, promptLens, numPrevTokens, pooled,          \
+                       partialSums, num_reqs, hidden_size, pooling_type, items_per_core, tile_cols, tile_rows);       \
+  }
+
+SEGMENT_POOL_KERNEL(f16, half)
+SEGMENT_POOL_KERNEL(bf16, bfloat16_t)
+SEGMENT_POOL_KERNEL(f32, float)
+
+#ifndef __CCE_KT_TEST__
+void SegmentPoolKernelEntry(void *l2ctrl, void *aclStream, uint8_t *hiddenStates, uint8_t *firstTokenIndices,
+                            uint8_t *lastTokenIndices, uint8_t *promptLens, uint8_t *numPrevTokens, uint8_t *pooled,
+                            uint8_t *partialSums, SegmentPoolDtype dtype, const SegmentPoolTilingData &tiling) {
+#define SEGMENT_POOL_LAUNCH(kernel)                                                                                 \
+  kernel<<<tiling.usedCoreNum, l2ctrl, aclStream>>>(hiddenStates, firstTokenIndices, lastTokenIndices, promptLens, \
+                                                    numPrevTokens, pooled, partialSums, tiling.numReqs,            \
+                                                    tiling.hiddenSize, tiling.poolingType, tiling.itemsPerCore,    \
+                                                    tiling.tileCols, tiling.tileRows)
+  switch (dtype) {
+    case SegmentPoolDtype::kFloat16:
+      SEGMENT_POOL_LAUNCH(segment_pool_f16);
+      break;
+    case SegmentPoolDtype::kBFloat16:
+      SEGMENT_POOL_LAUNCH(segment_pool_bf16);
+      break;
+    default:
+      SEGMENT_POOL_LAUNCH(segment_pool_f32);
+      break;
+  }
+#undef SEGMENT_POOL_LAUNCH
+}
+#endif
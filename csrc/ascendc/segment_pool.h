@@ -0,0 +1,34 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_SEGMENT_POOL_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_SEGMENT_POOL_H
+
+#include <cstdint>
+
+#include "ascendc/segment_pool_tiling.h"
+
+// Launches tiling.usedCoreNum cores, each pooling tiling.itemsPerCore
+// (request, column tile) pairs. hiddenStates is fp16, bf16 or fp32 as dtype,
+// pooled the same for CLS and LAST and fp32 for MEAN, partialSums fp32, every
+// other tensor int32.
+void SegmentPoolKernelEntry(void *l2ctrl, void *aclStream,
+                            uint8_t *hiddenStates, uint8_t *firstTokenIndices,
+                            uint8_t *lastTokenIndices, uint8_t *promptLens,
+                            uint8_t *numPrevTokens, uint8_t *pooled,
+                            uint8_t *partialSums, SegmentPoolDtype dtype,
+                            const SegmentPoolTilingData &tiling);
+
+#endif // VLLM_MINDSPORE_CSRC_ASCENDC_SEGMENT_POOL_H
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_ASCENDC_SEGMENT_POOL_TILING_H
+#define VLLM_MINDSPORE_CSRC_ASCENDC_SEGMENT_POOL_TILING_H
+
+#include <cstdint>
+
+// Pooling of the tokens of every request, as pooling_type of segment_pool.
+enum SegmentPoolType : int32_t {
+  kSegmentPoolCls = 0,
+  kSegmentPoolLast = 1,
+  kSegmentPoolMean = 2,
+};
+
+// Element type of the hidden states, and of the pooled rows but for MEAN.
+enum class SegmentPoolDtype : int32_t {
+  kFloat32 = 0,
+  kFloat16 = 1,
+  kBFloat16 = 2,
+};
+
+// Columns of a row per UB tile; the fp32 accumulator and the output row of a
+// tile take 8 bytes a column at most.
+constexpr int32_t kSegmentPoolMaxTileCols = 2048;
+// fp32 bytes of the block of token rows loaded in one DMA; the queue holds two
+// blocks, and fp16 and bf16 blocks are cast into one more.
+constexpr int32_t kSegmentPoolBlockBytes = 32768;
+constexpr int32_t kSegmentPoolMaxTileRows = 64;
+// A (request, column tile) pair of CLS or LAST is one row moved, so below this
+// many pairs per core the launch cost of an extra core outweighs them.
+constexpr int32_t kSegmentPoolMinItemsPerCore = 4;
+
+struct SegmentPoolTilingData {
+  int32_t numReqs{0};
+  int32_t hiddenSize{0};
+  int32_t poolingType{kSegmentPoolLast};
+  int32_t usedCoreNum{1};
+  int32_t itemsPerCore{0};  // (request, column tile) pairs, the last core takes the remainder
+  int32_t tileCols{0};      // columns per tile, a multiple of 16
+  int32_t tileRows{0};      // token rows per DMA of MEAN
+};
+
+// Requests and the column tiles of their rows are independent, so the pairs of
+// them are spread evenly across at most `max_core_num` cores, and one long
+// prompt still spreads over as many cores as its row has column tiles.
+inline SegmentPoolTilingData ComputeSegmentPoolTiling(int32_t num_reqs, int32_t hidden_size, int32_t pooling_type,
+                                                      int32_t max_core_num) {
+  SegmentPoolTilingData tiling;
+  tiling.numReqs = num_reqs;
+  tiling.hiddenSize = hidden_size;
+  tiling.poolingType = pooling_type;
+  if (num_reqs <= 0 || hidden_size <= 0) {
+    return tiling;
+  }
+  // 16 columns are a 32B block of fp16 and bf16 rows, and two of fp32 ones
+  int32_t cols_align = (hidden_size + 15) / 16 * 16;
+  tiling.tileCols = cols_align < kSegmentPoolMaxTileCols ? cols_align : kSegmentPoolMaxTileCols;
+  int32_t rows = kSegmentPoolBlockBytes / static_cast<int32_t>(sizeof(float)) / tiling.tileCols;
+  rows = rows < kSegmentPoolMaxTileRows ? rows : kSegmentPoolMaxTileRows;
+  tiling.tileRows = rows > 1 ? rows : 1;
+
+  int64_t col_tiles = (hidden_size + tiling.tileCols - 1) / tiling.tileCols;
+  int64_t num_items = static_cast<int64_t>(num_reqs) * col_tiles;
+  max_core_num = max_core_num > 0 ? max_core_num : 1;
+  int64_t core_num = (num_items + kSegmentPoolMinItemsPerCore - 1) / kSegmentPoolMinItemsPerCore;
+  core_num = core_num < max_core_num ? core_num : max_core_num;
+  tiling.itemsPerCore = static_cast<int32_t>((num_items + core_num - 1) / core_num);
+  tiling.usedCoreNum = static_cast<int32_t>((num_items + tiling.itemsPerCore - 1) / tiling.itemsPerCore);
+  return tiling;
+}
+
+#endif  // VLLM_MINDSPORE_CSRC_ASCENDC_SEGMENT_POOL_TILING_H
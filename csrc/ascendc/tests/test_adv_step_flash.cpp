@@ -0,0 +1,254 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "tikicpulib.h"
+
+#include "adv_step_flash_tiling.h"
+
+#define DECLARE_ADV_STEP_FLASH_KERNEL(name)                                                                      \
+  extern "C" __global__ __aicore__ void name(GM_ADDR sampledTokenIds, GM_ADDR blockTables, GM_ADDR seqLensInput, \
+                                             GM_ADDR inputTokens, GM_ADDR inputPositions, GM_ADDR seqLensOut,   \
+                                             GM_ADDR slotMapping, int32_t num_seqs, int32_t num_queries,        \
+                                             int32_t num_tokens_per_seq, int32_t block_size,                    \
+                                             int32_t block_tables_stride, int32_t seqs_per_core,                \
+                                             int32_t tile_length)
+
+DECLARE_ADV_STEP_FLASH_KERNEL(adv_step_flash_int32_int32);
+DECLARE_ADV_STEP_FLASH_KERNEL(adv_step_flash_int32_int64);
+DECLARE_ADV_STEP_FLASH_KERNEL(adv_step_flash_int64_int32);
+DECLARE_ADV_STEP_FLASH_KERNEL(adv_step_flash_int64_int64);
+
+namespace {
+struct AdvStepFlashCase {
+  int32_t num_seqs;
+  int32_t num_queries;
+  int32_t num_tokens_per_seq;
+  int32_t block_size;
+  int32_t max_blocks_per_seq;
+  int32_t max_core_num;
+  int32_t max_tile_tokens;
+};
+
+// values are kept as int64 on host and stored at the tested dtype on device
+struct AdvStepFlashInputs {
+  std::vector<int64_t> sampled_token_ids;
+  std::vector<int64_t> seq_lens;
+  std::vector<int64_t> block_tables;
+};
+
+struct AdvStepFlashOutputs {
+  std::vector<int64_t> input_tokens;
+  std::vector<int64_t> input_positions;
+  std::vector<int64_t> seq_lens;
+  std::vector<int64_t> slot_mapping;
+};
+
+AdvStepFlashInputs MakeInputs(const AdvStepFlashCase &c, std::mt19937 *gen) {
+  AdvStepFlashInputs in;
+  std::uniform_int_distribution<int32_t> token_dist(0, 151935);
+  std::uniform_int_distribution<int32_t> len_dist(0, c.block_size * c.max_blocks_per_seq - c.num_tokens_per_seq);
+  std::uniform_int_distribution<int32_t> block_dist(0, 65535);
+  for (int32_t i = 0; i < c.num_seqs * c.num_tokens_per_seq; ++i) {
+    in.sampled_token_ids.push_back(token_dist(*gen));
+  }
+  for (int32_t i = 0; i < c.num_seqs; ++i) {
+    in.seq_lens.push_back(len_dist(*gen));
+  }
+  for (int32_t i = 0; i < c.num_seqs * c.max_blocks_per_seq; ++i) {
+    in.block_tables.push_back(block_dist(*gen));
+  }
+  return in;
+}
+
+AdvStepFlashOutputs RunGolden(const AdvStepFlashCase &c, const AdvStepFlashInputs &in) {
+  AdvStepFlashOutputs out;
+  const int32_t k_tokens = c.num_tokens_per_seq;
+  for (int32_t i = 0; i < c.num_seqs; ++i) {
+    if (i >= c.num_queries) {
+      // padded sequences, as vLLM's advance_step_flashattn pads them
+      out.input_tokens.insert(out.input_tokens.end(), k_tokens, 0);
+      out.input_positions.insert(out.input_positions.end(), k_tokens, 0);
+      out.slot_mapping.insert(out.slot_mapping.end(), k_tokens, -1);
+      out.seq_lens.push_back(in.seq_lens[i]);
+      continue;
+    }
+    for (int32_t k = 0; k < k_tokens; ++k) {
+      int64_t pos = in.seq_lens[i] + k;
+      int64_t block = in.block_tables[i * c.max_blocks_per_seq + pos / c.block_size];
+      out.input_tokens.push_back(in.sampled_token_ids[i * k_tokens + k]);
+      out.input_positions.push_back(pos);
+      out.slot_mapping.push_back(block * c.block_size + pos % c.block_size);
+    }
+    out.seq_lens.push_back(in.seq_lens[i] + k_tokens);
+  }
+  return out;
+}
+
+template <typename T>
+uint8_t *ToGm(const std::vector<int64_t> &data) {
+  std::vector<T> typed(data.begin(), data.end());
+  size_t size = typed.size() * sizeof(T);
+  auto *gm = static_cast<uint8_t *>(AscendC::GmAlloc(size));
+  std::memcpy(gm, typed.data(), size);
+  return gm;
+}
+
+template <typename T>
+std::vector<int64_t> FromGm(uint8_t *gm, int32_t count) {
+  std::vector<T> typed(count);
+  std::memcpy(typed.data(), gm, count * sizeof(T));
+  AscendC::GmFree(gm);
+  return std::vector<int64_t>(typed.begin(), typed.end());
+}
+
+template <typename IdxT, typename LenT>
+AdvStepFlashOutputs RunKernel(const AdvStepFlashCase &c, const AdvStepFlashInputs &in,
+                              const AdvStepFlashTilingData &tiling) {
+  const int32_t num_tokens = c.num_seqs * c.num_tokens_per_seq;
+  // outputs start from garbage, so that the padding fill is checked too
+  std::vector<int64_t> garbage(num_tokens, 7);
+  uint8_t *sampled_token_ids = ToGm<IdxT>(in.sampled_token_ids);
+  uint8_t *block_tables = ToGm<int32_t>(in.block_tables);
+  uint8_t *seq_lens = ToGm<LenT>(in.seq_lens);  // updated in place, as the op does
+  uint8_t *input_tokens = ToGm<IdxT>(garbage);
+  uint8_t *input_positions = ToGm<IdxT>(garbage);
+  uint8_t *slot_mapping = ToGm<IdxT>(garbage);
+
+#define RUN_ADV_STEP_FLASH_KERNEL(kernel)                                                                    \
+  ICPU_RUN_KF(kernel, tiling.usedCoreNum, sampled_token_ids, block_tables, seq_lens, input_tokens,           \
+              input_positions, seq_lens, slot_mapping, tiling.numSeqs, tiling.numQueries,                  \
+              tiling.numTokensPerSeq, c.block_size, c.max_blocks_per_seq, tiling.seqsPerCore, tiling.tileLength)
+  AscendC::SetKernelMode(KernelMode::AIV_MODE);
+  if constexpr (std::is_same_v<IdxT, int64_t> && std::is_same_v<LenT, int64_t>) {
+    RUN_ADV_STEP_FLASH_KERNEL(adv_step_flash_int64_int64);
+  } else if constexpr (std::is_same_v<IdxT, int64_t>) {
+    RUN_ADV_STEP_FLASH_KERNEL(adv_step_flash_int64_int32);
+  } else if constexpr (std::is_same_v<LenT, int64_t>) {
+    RUN_ADV_STEP_FLASH_KERNEL(adv_step_flash_int32_int64);
+  } else {
+    RUN_ADV_STEP_FLASH_KERNEL(adv_step_flash_int32_int32);
+  }
+#undef RUN_ADV_STEP_FLASH_KERNEL
+
+  AdvStepFlashOutputs out;
+  out.input_tokens = FromGm<IdxT>(input_tokens, num_tokens);
+  out.input_positions = FromGm<IdxT>(input_positions, num_tokens);
+  out.seq_lens = FromGm<LenT>(seq_lens, c.num_seqs);
+  out.slot_mapping = FromGm<IdxT>(slot_mapping, num_tokens);
+  AscendC::GmFree(sampled_token_ids);
+  AscendC::GmFree(block_tables);
+  return out;
+}
+
+bool Expect(const char *what, const AdvStepFlashCase &c, const std::vector<int64_t> &expect,
+            const std::vector<int64_t> &actual) {
+  for (size_t i = 0; i < expect.size(); ++i) {
+    if (expect[i] != actual[i]) {
+      std::printf("[FAILED] num_seqs=%d num_queries=%d num_tokens_per_seq=%d block_size=%d: %s[%zu] expect %ld, got %ld\n",
+                  c.num_seqs, c.num_queries, c.num_tokens_per_seq, c.block_size, what, i,
+                  static_cast<long>(expect[i]), static_cast<long>(actual[i]));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ExpectSame(const char *run, const char *dtypes, const AdvStepFlashCase &c, const AdvStepFlashOutputs &expect,
+                const AdvStepFlashOutputs &actual) {
+  std::printf("checking %s run (%s), num_seqs=%d num_queries=%d num_tokens_per_seq=%d\n", run, dtypes, c.num_seqs,
+              c.num_queries, c.num_tokens_per_seq);
+  return Expect("input_tokens", c, expect.input_tokens, actual.input_tokens) &&
+         Expect("input_positions", c, expect.input_positions, actual.input_positions) &&
+         Expect("seq_lens", c, expect.seq_lens, actual.seq_lens) &&
+         Expect("slot_mapping", c, expect.slot_mapping, actual.slot_mapping);
+}
+
+template <typename IdxT, typename LenT>
+bool RunCase(const char *dtypes, const AdvStepFlashCase &c, const AdvStepFlashInputs &inputs,
+             const AdvStepFlashOutputs &golden) {
+  bool ok = true;
+  auto tiling =
+      ComputeAdvStepFlashTiling(c.num_seqs, c.num_queries, c.num_tokens_per_seq, c.max_core_num, c.max_tile_tokens);
+  auto tiled_out = RunKernel<IdxT, LenT>(c, inputs, tiling);
+  ok = ExpectSame("tiled", dtypes, c, golden, tiled_out) && ok;
+
+  // the former launch, one core with the whole batch in one tile, only fits UB for small batches
+  if (c.num_seqs * c.num_tokens_per_seq <= kAdvStepFlashMaxTileTokens) {
+    AdvStepFlashTilingData single_core;
+    single_core.numSeqs = c.num_seqs;
+    single_core.numQueries = c.num_queries;
+    single_core.numTokensPerSeq = c.num_tokens_per_seq;
+    single_core.usedCoreNum = 1;
+    single_core.seqsPerCore = c.num_seqs;
+    single_core.tileLength = c.num_seqs;
+    auto single_core_out = RunKernel<IdxT, LenT>(c, inputs, single_core);
+    ok = ExpectSame("single-core", dtypes, c, golden, single_core_out) && ok;
+    ok = ExpectSame("tiled vs single-core", dtypes, c, single_core_out, tiled_out) && ok;
+  }
+  return ok;
+}
+}  // namespace
+
+int main() {
+  const AdvStepFlashCase cases[] = {
+      {1, 1, 1, 16, 4, 8, kAdvStepFlashMaxTileTokens},
+      {37, 37, 1, 16, 8, 8, kAdvStepFlashMaxTileTokens},
+      {256, 256, 1, 128, 64, 8, kAdvStepFlashMaxTileTokens},
+      {1024, 1024, 1, 16, 512, 40, kAdvStepFlashMaxTileTokens},
+      // several tiles per core, with a ragged last tile and a ragged last core
+      {1000, 1000, 1, 32, 16, 4, 56},
+      {4099, 4099, 1, 64, 8, 8, kAdvStepFlashMaxTileTokens},
+      // positions beyond 2^24, where an fp32 quotient alone is no longer exact
+      {16, 16, 1, 1024, 65536, 8, kAdvStepFlashMaxTileTokens},
+      // padded sequences, ending mid-tile, on a tile boundary and on a core boundary
+      {37, 29, 1, 16, 8, 8, kAdvStepFlashMaxTileTokens},
+      {1000, 392, 1, 32, 16, 4, 56},
+      {1024, 256, 1, 16, 64, 4, kAdvStepFlashMaxTileTokens},
+      {64, 0, 1, 16, 4, 8, kAdvStepFlashMaxTileTokens},
+      // several tokens per sequence, e.g. speculative draft tokens, crossing block boundaries
+      {37, 37, 4, 16, 8, 8, kAdvStepFlashMaxTileTokens},
+      {1000, 777, 3, 16, 16, 4, 120},
+      {4099, 4000, 5, 64, 8, 8, kAdvStepFlashMaxTileTokens},
+      {16, 16, 8, 1024, 65536, 8, kAdvStepFlashMaxTileTokens},
+      // lengths close enough for one block table window per tile, and too far apart for it
+      {512, 512, 1, 16, 4, 8, kAdvStepFlashMaxTileTokens},
+      {512, 500, 2, 128, 16, 8, kAdvStepFlashMaxTileTokens},
+      {512, 512, 1, 16, 4096, 8, kAdvStepFlashMaxTileTokens},
+      // block sizes that are not a power of two
+      {37, 37, 1, 48, 8, 8, kAdvStepFlashMaxTileTokens},
+      {1000, 777, 3, 24, 16, 4, 120},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (const auto &c : cases) {
+    auto inputs = MakeInputs(c, &gen);
+    auto golden = RunGolden(c, inputs);
+
+    ok = RunCase<int32_t, int32_t>("int32/int32", c, inputs, golden) && ok;
+    ok = RunCase<int32_t, int64_t>("int32/int64", c, inputs, golden) && ok;
+    ok = RunCase<int64_t, int32_t>("int64/int32", c, inputs, golden) && ok;
+    ok = RunCase<int64_t, int64_t>("int64/int64", c, inputs, golden) && ok;
+  }
+  std::printf(ok ? "[PASSED] adv_step_flash\n" : "[FAILED] adv_step_flash\n");
+  return ok ? 0 : 1;
+}
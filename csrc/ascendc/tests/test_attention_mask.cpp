@@ -0,0 +1,156 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tikicpulib.h"
+
+#include "attention_mask_tiling.h"
+
+extern "C" __global__ __aicore__ void attention_mask_b16(GM_ADDR queryLens, GM_ADDR maskOffsets, GM_ADDR mask,
+                                                         int32_t num_reqs, int32_t num_rows, int32_t max_seq_len,
+                                                         uint16_t fill_bits, int32_t rows_per_core,
+                                                         int32_t tile_length);
+extern "C" __global__ __aicore__ void attention_mask_b32(GM_ADDR queryLens, GM_ADDR maskOffsets, GM_ADDR mask,
+                                                         int32_t num_reqs, int32_t num_rows, int32_t max_seq_len,
+                                                         uint32_t fill_bits, int32_t rows_per_core,
+                                                         int32_t tile_length);
+
+namespace {
+struct AttentionMaskCase {
+  int32_t num_reqs;
+  int32_t max_query_len;
+  int32_t max_context_len;
+  int32_t decode_every;  // every n-th request has one query token, 0 for none
+  int32_t pad_rows;      // rows past the last request
+  int32_t max_core_num;
+};
+
+// The mask of LowerTriangularMask.create_mask: the rows of a request with more than one query token are fill from
+// the context onwards, and then 0 again on and below the diagonal of the [q_len, q_len] block right of the context.
+template <typename T>
+std::vector<T> RunGolden(const std::vector<int32_t> &query_lens, const std::vector<int32_t> &seq_lens,
+                         int64_t num_rows, int32_t max_seq_len, T fill_bits) {
+  std::vector<T> mask(num_rows * max_seq_len, T{0});
+  int64_t row = 0;
+  for (size_t i = 0; i < query_lens.size(); ++i) {
+    int32_t q_len = query_lens[i];
+    int32_t context_len = seq_lens[i] - q_len;
+    if (q_len > 1) {
+      for (int32_t t = 0; t < q_len; ++t) {
+        for (int32_t c = context_len; c < max_seq_len; ++c) {
+          mask[(row + t) * max_seq_len + c] = fill_bits;
+        }
+        for (int32_t c = context_len; c <= context_len + t; ++c) {
+          mask[(row + t) * max_seq_len + c] = T{0};
+        }
+      }
+    }
+    row += q_len;
+  }
+  return mask;
+}
+
+template <typename T>
+uint8_t *ToGm(const std::vector<T> &data) {
+  size_t size = std::max<size_t>(data.size() * sizeof(T), 32);
+  auto *gm = static_cast<uint8_t *>(AscendC::GmAlloc(size));
+  std::memcpy(gm, data.data(), data.size() * sizeof(T));
+  return gm;
+}
+
+template <typename T>
+bool RunCase(const AttentionMaskCase &c, T fill_bits, std::mt19937 *gen) {
+  std::printf("checking num_reqs=%d max_query_len=%d max_context_len=%d decode_every=%d pad_rows=%d bytes=%zu\n",
+              c.num_reqs, c.max_query_len, c.max_context_len, c.decode_every, c.pad_rows, sizeof(T));
+  std::uniform_int_distribution<int32_t> query_dist(2, c.max_query_len);
+  std::uniform_int_distribution<int32_t> context_dist(0, c.max_context_len);
+  std::vector<int32_t> query_lens(c.num_reqs), seq_lens(c.num_reqs);
+  int32_t total_q_len = 0;
+  int32_t max_seq_len = 0;
+  for (int32_t i = 0; i < c.num_reqs; ++i) {
+    query_lens[i] = c.decode_every > 0 && i % c.decode_every == 0 ? 1 : query_dist(*gen);
+    seq_lens[i] = query_lens[i] + context_dist(*gen);
+    total_q_len += query_lens[i];
+    max_seq_len = std::max(max_seq_len, seq_lens[i]);
+  }
+  // the per-request offsets of causal_mask_offsets in attention_mask.py
+  std::vector<int32_t> mask_offsets(c.num_reqs);
+  for (int32_t i = 0; i < c.num_reqs; ++i) {
+    mask_offsets[i] = query_lens[i] > 1 ? seq_lens[i] - query_lens[i] : max_seq_len;
+  }
+  int32_t num_rows = total_q_len + c.pad_rows;
+  auto golden = RunGolden<T>(query_lens, seq_lens, num_rows, max_seq_len, fill_bits);
+  auto tiling = ComputeAttentionMaskTiling(c.num_reqs, num_rows, max_seq_len, sizeof(T), c.max_core_num);
+
+  uint8_t *query_lens_gm = ToGm(query_lens);
+  uint8_t *mask_offsets_gm = ToGm(mask_offsets);
+  uint8_t *mask_gm = ToGm(std::vector<T>(golden.size(), T{7}));
+
+  AscendC::SetKernelMode(KernelMode::AIV_MODE);
+  if constexpr (sizeof(T) == 4) {
+    ICPU_RUN_KF(attention_mask_b32, tiling.usedCoreNum, query_lens_gm, mask_offsets_gm, mask_gm, tiling.numReqs,
+                tiling.numRows, tiling.maxSeqLen, fill_bits, tiling.rowsPerCore, tiling.tileLength);
+  } else {
+    ICPU_RUN_KF(attention_mask_b16, tiling.usedCoreNum, query_lens_gm, mask_offsets_gm, mask_gm, tiling.numReqs,
+                tiling.numRows, tiling.maxSeqLen, fill_bits, tiling.rowsPerCore, tiling.tileLength);
+  }
+
+  std::vector<T> mask(golden.size());
+  std::memcpy(mask.data(), mask_gm, mask.size() * sizeof(T));
+  for (uint8_t *gm : {query_lens_gm, mask_offsets_gm, mask_gm}) {
+    AscendC::GmFree(gm);
+  }
+
+  for (size_t i = 0; i < golden.size(); ++i) {
+    if (golden[i] != mask[i]) {
+      std::printf("[FAILED] mask[%zu, %zu] expect %u, got %u\n", i / max_seq_len, i % max_seq_len,
+                  static_cast<uint32_t>(golden[i]), static_cast<uint32_t>(mask[i]));
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  const AttentionMaskCase cases[] = {
+      {1, 2, 0, 0, 0, 8},
+      {1, 3, 3, 0, 0, 8},
+      // decode requests in between chunked prefill ones, and padded rows, with a request split across cores
+      {16, 64, 300, 3, 5, 8},
+      {33, 17, 1000, 2, 0, 40},
+      // decodes only, the mask is all 0
+      {8, 2, 50, 1, 2, 8},
+      // rows spanning several UB tiles, with a ragged last one
+      {2, 40, 20000, 0, 0, 8},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (const auto &c : cases) {
+    // -10000.0 in fp16, 1.0 in bf16 and -10000.0 in fp32
+    ok = RunCase<uint16_t>(c, 0xf0e2, &gen) && ok;
+    ok = RunCase<uint16_t>(c, 0x3f80, &gen) && ok;
+    ok = RunCase<uint32_t>(c, 0xc61c4000, &gen) && ok;
+  }
+  std::printf(ok ? "[PASSED] attention_mask\n" : "[FAILED] attention_mask\n");
+  return ok ? 0 : 1;
+}
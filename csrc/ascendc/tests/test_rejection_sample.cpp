@@ -0,0 +1,213 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tikicpulib.h"
+
+#include "rejection_sample_tiling.h"
+
+extern "C" __global__ __aicore__ void rejection_sample(GM_ADDR cuNumDraftTokens, GM_ADDR draftTokenIds,
+                                                       GM_ADDR draftProbs, GM_ADDR targetProbs, GM_ADDR bonusTokenIds,
+                                                       GM_ADDR uniformProbs, GM_ADDR recoveryNoise, GM_ADDR isGreedy,
+                                                       GM_ADDR outputTokenIds, int32_t batch_size,
+                                                       int32_t max_spec_len, int32_t vocab_size,
+                                                       int32_t use_draft_probs, int32_t reqs_per_core,
+                                                       int32_t tile_length);
+
+namespace {
+struct RejectionSampleCase {
+  int32_t batch_size;
+  int32_t max_spec_len;
+  int32_t vocab_size;
+  bool use_draft_probs;
+  int32_t greedy_every;  // every n-th request is greedy, 0 for none
+  float peak;            // the probability mass put on one token per row, so that drafts get accepted
+  int32_t max_core_num;
+};
+
+struct RejectionSampleInputs {
+  std::vector<int32_t> cu_num_draft_tokens;
+  std::vector<int32_t> draft_token_ids;
+  std::vector<float> draft_probs;
+  std::vector<float> target_probs;
+  std::vector<int32_t> bonus_token_ids;
+  std::vector<float> uniform_probs;
+  std::vector<float> recovery_noise;
+  std::vector<int8_t> is_greedy;
+};
+
+void FillProbs(std::vector<float> *probs, int32_t vocab_size, int32_t peak_id, float peak, std::mt19937 *gen) {
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> row(vocab_size);
+  float sum = 0.0f;
+  for (auto &p : row) {
+    p = dist(*gen);
+    sum += p;
+  }
+  for (auto &p : row) {
+    p = p / sum * (1.0f - peak);
+  }
+  row[peak_id] += peak;
+  probs->insert(probs->end(), row.begin(), row.end());
+}
+
+RejectionSampleInputs MakeInputs(const RejectionSampleCase &c, std::mt19937 *gen) {
+  RejectionSampleInputs in;
+  std::uniform_int_distribution<int32_t> num_draft_dist(0, c.max_spec_len);
+  std::uniform_int_distribution<int32_t> token_dist(0, c.vocab_size - 1);
+  std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
+  std::exponential_distribution<float> noise_dist(1.0f);
+  int32_t num_tokens = 0;
+  for (int32_t i = 0; i < c.batch_size; ++i) {
+    num_tokens += num_draft_dist(*gen);
+    in.cu_num_draft_tokens.push_back(num_tokens);
+    in.bonus_token_ids.push_back(token_dist(*gen));
+    in.is_greedy.push_back(c.greedy_every > 0 && i % c.greedy_every == 0);
+    for (int32_t v = 0; v < c.vocab_size; ++v) {
+      in.recovery_noise.push_back(noise_dist(*gen) + 1e-6f);
+    }
+  }
+  for (int32_t t = 0; t < num_tokens; ++t) {
+    int32_t peak_id = token_dist(*gen);
+    // half of the drafts hit the peak of the target distribution
+    in.draft_token_ids.push_back(t % 2 == 0 ? peak_id : token_dist(*gen));
+    FillProbs(&in.target_probs, c.vocab_size, peak_id, c.peak, gen);
+    if (c.use_draft_probs) {
+      FillProbs(&in.draft_probs, c.vocab_size, in.draft_token_ids.back(), c.peak, gen);
+    }
+    in.uniform_probs.push_back(uniform_dist(*gen));
+  }
+  return in;
+}
+
+// The reference walks full probability rows, as the Python implementation does.
+std::vector<int32_t> RunGolden(const RejectionSampleCase &c, const RejectionSampleInputs &in) {
+  std::vector<int32_t> out(static_cast<size_t>(c.batch_size) * (c.max_spec_len + 1), -1);
+  for (int32_t req = 0; req < c.batch_size; ++req) {
+    int32_t start = req == 0 ? 0 : in.cu_num_draft_tokens[req - 1];
+    int32_t end = in.cu_num_draft_tokens[req];
+    int32_t *row = out.data() + req * (c.max_spec_len + 1);
+    bool rejected = false;
+    for (int32_t token = start; token < end && !rejected; ++token) {
+      const float *target = in.target_probs.data() + static_cast<size_t>(token) * c.vocab_size;
+      int32_t draft_id = in.draft_token_ids[token];
+      if (in.is_greedy[req]) {
+        row[token - start] = static_cast<int32_t>(std::max_element(target, target + c.vocab_size) - target);
+        rejected = row[token - start] != draft_id;
+        continue;
+      }
+      const float *draft = c.use_draft_probs ? in.draft_probs.data() + static_cast<size_t>(token) * c.vocab_size
+                                             : nullptr;
+      float p_draft = draft == nullptr ? 1.0f : draft[draft_id];
+      if (p_draft > 0.0f && target[draft_id] / p_draft >= in.uniform_probs[token]) {
+        row[token - start] = draft_id;
+        continue;
+      }
+      std::vector<float> prob(target, target + c.vocab_size);
+      for (int32_t v = 0; v < c.vocab_size; ++v) {
+        prob[v] = draft == nullptr ? prob[v] : std::max(prob[v] - draft[v], 0.0f);
+      }
+      if (draft == nullptr) {
+        prob[draft_id] = 0.0f;
+      }
+      const float *noise = in.recovery_noise.data() + static_cast<size_t>(req) * c.vocab_size;
+      for (int32_t v = 0; v < c.vocab_size; ++v) {
+        prob[v] /= noise[v];
+      }
+      row[token - start] = static_cast<int32_t>(std::max_element(prob.begin(), prob.end()) - prob.begin());
+      rejected = true;
+    }
+    if (!rejected) {
+      row[end - start] = in.bonus_token_ids[req];
+    }
+  }
+  return out;
+}
+
+template <typename T>
+uint8_t *ToGm(const std::vector<T> &data) {
+  size_t size = std::max<size_t>(data.size() * sizeof(T), 32);
+  auto *gm = static_cast<uint8_t *>(AscendC::GmAlloc(size));
+  std::memcpy(gm, data.data(), data.size() * sizeof(T));
+  return gm;
+}
+
+bool RunCase(const RejectionSampleCase &c, std::mt19937 *gen) {
+  std::printf("checking batch_size=%d max_spec_len=%d vocab_size=%d use_draft_probs=%d greedy_every=%d\n",
+              c.batch_size, c.max_spec_len, c.vocab_size, c.use_draft_probs, c.greedy_every);
+  auto in = MakeInputs(c, gen);
+  auto golden = RunGolden(c, in);
+  auto tiling = ComputeRejectionSampleTiling(c.batch_size, c.max_spec_len, c.vocab_size, c.max_core_num);
+
+  uint8_t *cu_num_draft_tokens = ToGm(in.cu_num_draft_tokens);
+  uint8_t *draft_token_ids = ToGm(in.draft_token_ids);
+  uint8_t *draft_probs = ToGm(in.draft_probs);
+  uint8_t *target_probs = ToGm(in.target_probs);
+  uint8_t *bonus_token_ids = ToGm(in.bonus_token_ids);
+  uint8_t *uniform_probs = ToGm(in.uniform_probs);
+  uint8_t *recovery_noise = ToGm(in.recovery_noise);
+  uint8_t *is_greedy = ToGm(in.is_greedy);
+  uint8_t *output_token_ids = ToGm(std::vector<int32_t>(golden.size(), 7));
+
+  AscendC::SetKernelMode(KernelMode::AIV_MODE);
+  ICPU_RUN_KF(rejection_sample, tiling.usedCoreNum, cu_num_draft_tokens, draft_token_ids, draft_probs, target_probs,
+              bonus_token_ids, uniform_probs, recovery_noise, is_greedy, output_token_ids, tiling.batchSize,
+              tiling.maxSpecLen, tiling.vocabSize, c.use_draft_probs ? 1 : 0, tiling.reqsPerCore, tiling.tileLength);
+
+  std::vector<int32_t> out(golden.size());
+  std::memcpy(out.data(), output_token_ids, out.size() * sizeof(int32_t));
+  for (uint8_t *gm : {cu_num_draft_tokens, draft_token_ids, draft_probs, target_probs, bonus_token_ids,
+                      uniform_probs, recovery_noise, is_greedy, output_token_ids}) {
+    AscendC::GmFree(gm);
+  }
+
+  for (size_t i = 0; i < golden.size(); ++i) {
+    if (golden[i] != out[i]) {
+      std::printf("[FAILED] output_token_ids[%zu / %d] expect %d, got %d\n", i / (c.max_spec_len + 1),
+                  static_cast<int32_t>(i % (c.max_spec_len + 1)), golden[i], out[i]);
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  const RejectionSampleCase cases[] = {
+      {1, 1, 16, false, 0, 0.5f, 8},
+      // greedy only, random only and mixed batches, with fewer cores than requests
+      {64, 4, 1000, false, 1, 0.5f, 8},
+      {64, 4, 1000, true, 0, 0.5f, 8},
+      {37, 4, 5003, true, 3, 0.9f, 8},
+      {37, 4, 5003, false, 2, 0.9f, 40},
+      // flat distributions reject early, with rows spanning several UB tiles and a ragged last tile
+      {16, 8, 10000, true, 4, 0.0f, 8},
+      {16, 8, 10000, false, 4, 0.0f, 8},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (const auto &c : cases) {
+    ok = RunCase(c, &gen) && ok;
+  }
+  std::printf(ok ? "[PASSED] rejection_sample\n" : "[FAILED] rejection_sample\n");
+  return ok ? 0 : 1;
+}
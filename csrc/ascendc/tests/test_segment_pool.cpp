@@ -0,0 +1,259 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tikicpulib.h"
+
+#include "segment_pool_tiling.h"
+
+#define SEGMENT_POOL_KERNEL_DECL(name)                                                                              \
+  extern "C" __global__ __aicore__ void segment_pool_##name(                                                        \
+      GM_ADDR hiddenStates, GM_ADDR firstTokenIndices, GM_ADDR lastTokenIndices, GM_ADDR promptLens,                \
+      GM_ADDR numPrevTokens, GM_ADDR pooled, GM_ADDR partialSums, int32_t num_reqs, int32_t hidden_size,            \
+      int32_t pooling_type, int32_t items_per_core, int32_t tile_cols, int32_t tile_rows)
+SEGMENT_POOL_KERNEL_DECL(f16);
+SEGMENT_POOL_KERNEL_DECL(bf16);
+SEGMENT_POOL_KERNEL_DECL(f32);
+
+namespace {
+struct SegmentPoolCase {
+  int32_t num_reqs;
+  int32_t hidden_size;
+  int32_t max_prompt_len;
+  SegmentPoolDtype dtype;
+  int32_t max_core_num;
+};
+
+// Prompts of random length, laid out one after the other as in hidden_states.
+struct PoolBatch {
+  std::vector<int32_t> prompt_lens, prompt_starts;
+  std::vector<uint32_t> hidden;  // element bits, the low 16 for fp16 and bf16
+};
+
+float ToFloat(uint32_t bits, SegmentPoolDtype dtype) {
+  if (dtype == SegmentPoolDtype::kFloat16) {
+    int32_t exp = (bits >> 10) & 0x1f;
+    int32_t mant = bits & 0x3ff;
+    float v = exp == 0 ? std::ldexp(static_cast<float>(mant), -24)
+                       : std::ldexp(static_cast<float>(mant + 1024), exp - 25);
+    return (bits & 0x8000) ? -v : v;
+  }
+  float v;
+  bits = dtype == SegmentPoolDtype::kBFloat16 ? bits << 16 : bits;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+size_t ElemBytes(SegmentPoolDtype dtype) { return dtype == SegmentPoolDtype::kFloat32 ? 4 : 2; }
+
+// Finite values of every magnitude the dtype holds, small enough for the sums to stay finite.
+uint32_t RandomBits(SegmentPoolDtype dtype, std::mt19937 *gen) {
+  uint32_t sign = (*gen)() & 1u;
+  uint32_t mant = (*gen)();
+  switch (dtype) {
+    case SegmentPoolDtype::kFloat16:
+      return (sign << 15) | (std::uniform_int_distribution<uint32_t>(0, 25)(*gen) << 10) | (mant & 0x3ffu);
+    case SegmentPoolDtype::kBFloat16:
+      return (sign << 15) | (std::uniform_int_distribution<uint32_t>(100, 140)(*gen) << 7) | (mant & 0x7fu);
+    default:
+      return (sign << 31) | (std::uniform_int_distribution<uint32_t>(100, 140)(*gen) << 23) | (mant & 0x7fffffu);
+  }
+}
+
+PoolBatch MakeBatch(const SegmentPoolCase &c, std::mt19937 *gen) {
+  PoolBatch batch;
+  std::uniform_int_distribution<int32_t> len_dist(1, c.max_prompt_len);
+  int32_t num_tokens = 0;
+  for (int32_t i = 0; i < c.num_reqs; ++i) {
+    batch.prompt_starts.push_back(num_tokens);
+    batch.prompt_lens.push_back(len_dist(*gen));
+    num_tokens += batch.prompt_lens.back();
+  }
+  batch.hidden.resize(static_cast<size_t>(num_tokens) * c.hidden_size);
+  for (auto &bits : batch.hidden) {
+    bits = RandomBits(c.dtype, gen);
+  }
+  return batch;
+}
+
+// The first or last token of every prompt, or the fp32 sum of its tokens in order times 1 / its length, as bits of
+// the pooled dtype.
+std::vector<uint32_t> RunGolden(const PoolBatch &batch, const SegmentPoolCase &c, int32_t pooling_type) {
+  std::vector<uint32_t> golden(static_cast<size_t>(c.num_reqs) * c.hidden_size);
+  for (int32_t i = 0; i < c.num_reqs; ++i) {
+    for (int32_t h = 0; h < c.hidden_size; ++h) {
+      auto at = [&](int32_t token) { return batch.hidden[static_cast<size_t>(token) * c.hidden_size + h]; };
+      uint32_t &out = golden[static_cast<size_t>(i) * c.hidden_size + h];
+      if (pooling_type == kSegmentPoolCls) {
+        out = at(batch.prompt_starts[i]);
+      } else if (pooling_type == kSegmentPoolLast) {
+        out = at(batch.prompt_starts[i] + batch.prompt_lens[i] - 1);
+      } else {
+        float acc = 0.0f;
+        for (int32_t t = 0; t < batch.prompt_lens[i]; ++t) {
+          acc += ToFloat(at(batch.prompt_starts[i] + t), c.dtype);
+        }
+        float mean = acc * (1.0f / static_cast<float>(batch.prompt_lens[i]));
+        std::memcpy(&out, &mean, sizeof(out));
+      }
+    }
+  }
+  return golden;
+}
+
+template <typename T>
+uint8_t *ToGm(const std::vector<T> &data, size_t elem_bytes = sizeof(T)) {
+  size_t size = std::max<size_t>(data.size() * elem_bytes, 32);
+  auto *gm = static_cast<uint8_t *>(AscendC::GmAlloc(size));
+  for (size_t i = 0; i < data.size(); ++i) {
+    std::memcpy(gm + i * elem_bytes, &data[i], elem_bytes);  // little endian: the low bytes
+  }
+  return gm;
+}
+
+void Launch(const SegmentPoolCase &c, const SegmentPoolTilingData &tiling, uint8_t *hidden_gm, uint8_t *first_gm,
+            uint8_t *last_gm, uint8_t *prompt_lens_gm, uint8_t *num_prev_gm, uint8_t *pooled_gm,
+            uint8_t *partial_sums_gm) {
+  AscendC::SetKernelMode(KernelMode::AIV_MODE);
+#define SEGMENT_POOL_RUN(kernel)                                                                                   \
+  ICPU_RUN_KF(kernel, tiling.usedCoreNum, hidden_gm, first_gm, last_gm, prompt_lens_gm, num_prev_gm, pooled_gm,   \
+              partial_sums_gm, tiling.numReqs, tiling.hiddenSize, tiling.poolingType, tiling.itemsPerCore,       \
+              tiling.tileCols, tiling.tileRows)
+  switch (c.dtype) {
+    case SegmentPoolDtype::kFloat16:
+      SEGMENT_POOL_RUN(segment_pool_f16);
+      break;
+    case SegmentPoolDtype::kBFloat16:
+      SEGMENT_POOL_RUN(segment_pool_bf16);
+      break;
+    default:
+      SEGMENT_POOL_RUN(segment_pool_f32);
+      break;
+  }
+#undef SEGMENT_POOL_RUN
+}
+
+// The prompts in num_steps chunked prefill steps, each scheduling a slice of every prompt still running, with the
+// partial sums carried from step to step. The last step gives the pooled rows.
+std::vector<uint8_t> RunSteps(const PoolBatch &batch, const SegmentPoolCase &c, int32_t pooling_type,
+                              int32_t num_steps) {
+  const size_t out_bytes = pooling_type == kSegmentPoolMean ? 4 : ElemBytes(c.dtype);
+  const size_t row_elems = static_cast<size_t>(c.num_reqs) * c.hidden_size;
+  std::vector<uint8_t> final_pooled(row_elems * out_bytes, 0x7);
+  std::vector<float> carry(row_elems, NAN);
+  std::vector<int32_t> done(c.num_reqs, 0);
+  for (int32_t step = 0; step < num_steps; ++step) {
+    std::vector<int32_t> reqs, first, last, prompt_lens, num_prev;
+    std::vector<uint32_t> hidden;
+    std::vector<float> partial_sums;
+    for (int32_t i = 0; i < c.num_reqs; ++i) {
+      int32_t left = batch.prompt_lens[i] - done[i];
+      if (left <= 0) {
+        continue;
+      }
+      int32_t n = step + 1 == num_steps ? left : std::min(left, std::max(1, batch.prompt_lens[i] / num_steps));
+      int32_t token = static_cast<int32_t>(hidden.size() / c.hidden_size);
+      reqs.push_back(i);
+      first.push_back(token);
+      last.push_back(token + n - 1);
+      prompt_lens.push_back(batch.prompt_lens[i]);
+      num_prev.push_back(done[i]);
+      auto src = batch.hidden.begin() + static_cast<int64_t>(batch.prompt_starts[i] + done[i]) * c.hidden_size;
+      hidden.insert(hidden.end(), src, src + static_cast<int64_t>(n) * c.hidden_size);
+      partial_sums.insert(partial_sums.end(), carry.begin() + static_cast<int64_t>(i) * c.hidden_size,
+                          carry.begin() + static_cast<int64_t>(i + 1) * c.hidden_size);
+      done[i] += n;
+    }
+    auto num_step_reqs = static_cast<int32_t>(reqs.size());
+    auto tiling = ComputeSegmentPoolTiling(num_step_reqs, c.hidden_size, pooling_type, c.max_core_num);
+    uint8_t *hidden_gm = ToGm(hidden, ElemBytes(c.dtype));
+    uint8_t *first_gm = ToGm(first);
+    uint8_t *last_gm = ToGm(last);
+    uint8_t *prompt_lens_gm = ToGm(prompt_lens);
+    uint8_t *num_prev_gm = ToGm(num_prev);
+    uint8_t *pooled_gm = ToGm(std::vector<uint8_t>(num_step_reqs * c.hidden_size * out_bytes, 0x7));
+    uint8_t *partial_sums_gm = ToGm(partial_sums);
+    Launch(c, tiling, hidden_gm, first_gm, last_gm, prompt_lens_gm, num_prev_gm, pooled_gm, partial_sums_gm);
+
+    for (int32_t j = 0; j < num_step_reqs; ++j) {
+      const size_t src = static_cast<size_t>(j) * c.hidden_size;
+      const size_t dst = static_cast<size_t>(reqs[j]) * c.hidden_size;
+      std::memcpy(carry.data() + dst, partial_sums_gm + src * sizeof(float), c.hidden_size * sizeof(float));
+      if (done[reqs[j]] == batch.prompt_lens[reqs[j]]) {
+        std::memcpy(final_pooled.data() + dst * out_bytes, pooled_gm + src * out_bytes, c.hidden_size * out_bytes);
+      }
+    }
+    for (uint8_t *gm : {hidden_gm, first_gm, last_gm, prompt_lens_gm, num_prev_gm, pooled_gm, partial_sums_gm}) {
+      AscendC::GmFree(gm);
+    }
+  }
+  return final_pooled;
+}
+
+bool Check(const char *name, const std::vector<uint32_t> &golden, const std::vector<uint8_t> &pooled,
+           size_t elem_bytes) {
+  for (size_t i = 0; i < golden.size(); ++i) {
+    uint32_t out = 0;
+    std::memcpy(&out, pooled.data() + i * elem_bytes, elem_bytes);
+    if (out != golden[i]) {
+      std::printf("[FAILED] %s[%zu] expect 0x%x, got 0x%x\n", name, i, golden[i], out);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RunCase(const SegmentPoolCase &c, std::mt19937 *gen) {
+  std::printf("checking num_reqs=%d hidden_size=%d max_prompt_len=%d dtype=%d max_core_num=%d\n", c.num_reqs,
+              c.hidden_size, c.max_prompt_len, static_cast<int32_t>(c.dtype), c.max_core_num);
+  auto batch = MakeBatch(c, gen);
+  bool ok = true;
+  for (int32_t pooling_type : {kSegmentPoolCls, kSegmentPoolLast, kSegmentPoolMean}) {
+    auto golden = RunGolden(batch, c, pooling_type);
+    const size_t out_bytes = pooling_type == kSegmentPoolMean ? 4 : ElemBytes(c.dtype);
+    ok = Check("one step", golden, RunSteps(batch, c, pooling_type, 1), out_bytes) && ok;
+    ok = Check("chunked", golden, RunSteps(batch, c, pooling_type, 3), out_bytes) && ok;
+  }
+  return ok;
+}
+}  // namespace
+
+int main() {
+  const SegmentPoolCase cases[] = {
+      {1, 16, 1, SegmentPoolDtype::kFloat32, 8},
+      {3, 40, 7, SegmentPoolDtype::kFloat16, 8},
+      // hidden sizes that are not a multiple of 16, and rows of several column tiles
+      {9, 1000, 9, SegmentPoolDtype::kBFloat16, 40},
+      {2, 4100, 5, SegmentPoolDtype::kFloat32, 40},
+      // many short sequences on few cores, and a long prompt loaded in several blocks of rows
+      {200, 64, 6, SegmentPoolDtype::kFloat16, 2},
+      {1, 256, 300, SegmentPoolDtype::kBFloat16, 8},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (const auto &c : cases) {
+    ok = RunCase(c, &gen) && ok;
+  }
+  std::printf(ok ? "[PASSED] segment_pool\n" : "[FAILED] segment_pool\n");
+  return ok ? 0 : 1;
+}
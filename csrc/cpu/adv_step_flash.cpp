@@ -0,0 +1,106 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cpu/adv_step_flash.h"
+
+#include <algorithm>
+
+namespace {
+// Below this many tokens a parallel region costs more than the whole step.
+constexpr int64_t kAdvStepFlashCpuMinParallelTokens = 16384;
+
+// Block sizes are powers of two in practice, where the block index and the
+// offset in the block are a shift and a mask, which vectorize; a generic
+// integer division does not.
+template <bool kPow2Block> struct BlockDivider {
+  explicit BlockDivider(int32_t block_size)
+      : size(block_size), shift(__builtin_ctz(static_cast<uint32_t>(block_size))) {}
+  int64_t Div(int64_t pos) const { return kPow2Block ? pos >> shift : pos / size; }
+  int64_t Mod(int64_t pos) const { return kPow2Block ? pos & (size - 1) : pos % size; }
+  int64_t size;
+  int32_t shift;
+};
+
+template <typename IdxT, typename LenT, bool kPow2Block>
+void AdvanceQueries(const IdxT *sampled_token_ids, const int32_t *block_tables, LenT *seq_lens, IdxT *input_tokens,
+                    IdxT *input_positions, IdxT *slot_mapping, int64_t num_queries, int32_t num_tokens_per_seq,
+                    int64_t block_tables_stride, const BlockDivider<kPow2Block> &block) {
+  const int64_t num_tokens = num_queries * num_tokens_per_seq;
+  if (num_tokens_per_seq == 1) {
+    // decode: one token per sequence, vectorized across sequences
+#pragma omp parallel for simd schedule(static) if (num_tokens >= kAdvStepFlashCpuMinParallelTokens)
+    for (int64_t i = 0; i < num_queries; ++i) {
+      int64_t pos = seq_lens[i];
+      int64_t block_id = block_tables[i * block_tables_stride + block.Div(pos)];
+      input_tokens[i] = sampled_token_ids[i];
+      input_positions[i] = static_cast<IdxT>(pos);
+      slot_mapping[i] = static_cast<IdxT>(block_id * block.size + block.Mod(pos));
+      seq_lens[i] = static_cast<LenT>(pos + 1);
+    }
+    return;
+  }
+
+#pragma omp parallel for schedule(static) if (num_tokens >= kAdvStepFlashCpuMinParallelTokens)
+  for (int64_t i = 0; i < num_queries; ++i) {
+    const int64_t seq_len = seq_lens[i];
+    const int64_t first = i * num_tokens_per_seq;
+    const int32_t *table = block_tables + i * block_tables_stride;
+#pragma omp simd
+    for (int32_t k = 0; k < num_tokens_per_seq; ++k) {
+      int64_t pos = seq_len + k;
+      input_tokens[first + k] = sampled_token_ids[first + k];
+      input_positions[first + k] = static_cast<IdxT>(pos);
+      slot_mapping[first + k] = static_cast<IdxT>(table[block.Div(pos)] * block.size + block.Mod(pos));
+    }
+    seq_lens[i] = static_cast<LenT>(seq_len + num_tokens_per_seq);
+  }
+}
+}  // namespace
+
+template <typename IdxT, typename LenT>
+void AdvStepFlashCpu(const IdxT *sampled_token_ids, const int32_t *block_tables, LenT *seq_lens, IdxT *input_tokens,
+                     IdxT *input_positions, IdxT *slot_mapping, int32_t num_seqs, int32_t num_queries,
+                     int32_t num_tokens_per_seq, int32_t block_size, int64_t block_tables_stride) {
+  if (num_seqs <= 0 || block_size <= 0) {
+    return;
+  }
+  const int64_t queries = std::clamp(num_queries, 0, num_seqs);
+  const int32_t k_tokens = std::max(num_tokens_per_seq, 1);
+  if ((block_size & (block_size - 1)) == 0) {
+    AdvanceQueries<IdxT, LenT, true>(sampled_token_ids, block_tables, seq_lens, input_tokens, input_positions,
+                                     slot_mapping, queries, k_tokens, block_tables_stride,
+                                     BlockDivider<true>(block_size));
+  } else {
+    AdvanceQueries<IdxT, LenT, false>(sampled_token_ids, block_tables, seq_lens, input_tokens, input_positions,
+                                      slot_mapping, queries, k_tokens, block_tables_stride,
+                                      BlockDivider<false>(block_size));
+  }
+
+  // padded sequences: input_tokens and input_positions <-- 0, slot_mapping <-- -1 (PADDING_SLOT_ID)
+  const int64_t pad_start = queries * k_tokens;
+  const int64_t pad_end = static_cast<int64_t>(num_seqs) * k_tokens;
+  std::fill(input_tokens + pad_start, input_tokens + pad_end, IdxT{0});
+  std::fill(input_positions + pad_start, input_positions + pad_end, IdxT{0});
+  std::fill(slot_mapping + pad_start, slot_mapping + pad_end, IdxT{-1});
+}
+
+#define ADV_STEP_FLASH_CPU_INSTANTIATE(IdxT, LenT)                                                                  \
+  template void AdvStepFlashCpu<IdxT, LenT>(const IdxT *, const int32_t *, LenT *, IdxT *, IdxT *, IdxT *, int32_t, \
+                                            int32_t, int32_t, int32_t, int64_t)
+
+ADV_STEP_FLASH_CPU_INSTANTIATE(int32_t, int32_t);
+ADV_STEP_FLASH_CPU_INSTANTIATE(int32_t, int64_t);
+ADV_STEP_FLASH_CPU_INSTANTIATE(int64_t, int32_t);
+ADV_STEP_FLASH_CPU_INSTANTIATE(int64_t, int64_t);
@@ -0,0 +1,35 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_CPU_ADV_STEP_FLASH_H
+#define VLLM_MINDSPORE_CSRC_CPU_ADV_STEP_FLASH_H
+
+#include <cstdint>
+
+// Host implementation of advance_step_flashattn, bit-exact with the AscendC
+// kernel. Each of the first num_queries sequences advances by
+// num_tokens_per_seq tokens, the rest are padded with token 0, position 0 and
+// slot -1. seq_lens is updated in place.
+// IdxT is the dtype of sampled_token_ids, input_tokens, input_positions and
+// slot_mapping, LenT the dtype of seq_lens; both are int32_t or int64_t.
+// block_tables_stride is the row stride of block_tables in elements.
+template <typename IdxT, typename LenT>
+void AdvStepFlashCpu(const IdxT *sampled_token_ids, const int32_t *block_tables,
+                     LenT *seq_lens, IdxT *input_tokens, IdxT *input_positions,
+                     IdxT *slot_mapping, int32_t num_seqs, int32_t num_queries,
+                     int32_t num_tokens_per_seq, int32_t block_size,
+                     int64_t block_tables_stride);
+
+#endif // VLLM_MINDSPORE_CSRC_CPU_ADV_STEP_FLASH_H
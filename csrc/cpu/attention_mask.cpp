@@ -0,0 +1,57 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cpu/attention_mask.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+// Below this many mask elements a parallel region costs more than the fill.
+constexpr int64_t kAttentionMaskCpuMinParallelElems = 1 << 18;
+}  // namespace
+
+template <typename T>
+void AttentionMaskCpu(const int32_t *query_lens, const int32_t *mask_offsets, T *mask, int32_t num_reqs,
+                      int64_t num_rows, int32_t max_seq_len, T fill_bits) {
+  if (num_rows <= 0 || max_seq_len <= 0) {
+    return;
+  }
+  // first row of every request, and past the last one the rows left over
+  std::vector<int64_t> row_starts(static_cast<size_t>(std::max(num_reqs, 0)) + 1, 0);
+  for (int32_t i = 0; i < num_reqs; ++i) {
+    row_starts[i + 1] = row_starts[i] + std::max(query_lens[i], 0);
+  }
+  const int64_t total = num_rows * max_seq_len;
+
+  // rows rather than requests are split across threads: one long chunked prefill request can own most of the rows
+#pragma omp parallel for schedule(static) if (total >= kAttentionMaskCpuMinParallelElems)
+  for (int64_t row = 0; row < num_rows; ++row) {
+    int64_t visible = max_seq_len;
+    if (row < row_starts[num_reqs]) {
+      auto req = std::upper_bound(row_starts.begin(), row_starts.end(), row) - row_starts.begin() - 1;
+      visible = std::clamp<int64_t>(static_cast<int64_t>(mask_offsets[req]) + (row - row_starts[req]) + 1, 0,
+                                    max_seq_len);
+    }
+    T *out = mask + row * max_seq_len;
+    std::fill(out, out + visible, T{0});
+    std::fill(out + visible, out + max_seq_len, fill_bits);
+  }
+}
+
+template void AttentionMaskCpu<uint16_t>(const int32_t *, const int32_t *, uint16_t *, int32_t, int64_t, int32_t,
+                                         uint16_t);
+template void AttentionMaskCpu<uint32_t>(const int32_t *, const int32_t *, uint32_t *, int32_t, int64_t, int32_t,
+                                         uint32_t);
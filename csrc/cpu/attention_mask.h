@@ -0,0 +1,32 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_CPU_ATTENTION_MASK_H
+#define VLLM_MINDSPORE_CSRC_CPU_ATTENTION_MASK_H
+
+#include <cstdint>
+
+// Host implementation of attention_mask, bit-exact with the AscendC kernel.
+// Writes the whole mask [num_rows, max_seq_len] of 2 or 4 byte elements, T
+// holding their bits, so that fp16, bf16 and fp32 masks share one kernel.
+// Request i owns the next query_lens[i] rows; its row t is 0 up to column
+// mask_offsets[i] + t and fill_bits after it. Rows past the last request are
+// all 0.
+template <typename T>
+void AttentionMaskCpu(const int32_t *query_lens, const int32_t *mask_offsets,
+                      T *mask, int32_t num_reqs, int64_t num_rows,
+                      int32_t max_seq_len, T fill_bits);
+
+#endif // VLLM_MINDSPORE_CSRC_CPU_ATTENTION_MASK_H
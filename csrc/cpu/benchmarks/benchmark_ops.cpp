@@ -0,0 +1,376 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// Latency sweep of the host kernels of the custom ops, for the dashboard on
+// hosts without an NPU (benchmarks/kernels/benchmark_custom_ops.py runs the
+// same cases on the device, or else this binary):
+//   benchmark_ops [--iters N] [--warmup N] [--quick] [--output file.json]
+// Every op is swept over batch size, block size (or speculative length, or
+// sequence length) and dtype. The report holds p50/p99 latency and the bytes
+// each call moves, and is ingested with
+// dashboard/benchmark_to_dashboard.py --op-bench-json.
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cpu/adv_step_flash.h"
+#include "cpu/attention_mask.h"
+#include "cpu/eagle_prepare_inputs.h"
+#include "cpu/rejection_sample.h"
+#include "cpu/segment_pool.h"
+
+namespace {
+struct BenchOptions {
+  int warmup{10};
+  int iters{200};
+  bool quick{false};
+  const char *output{nullptr};
+};
+
+struct BenchResult {
+  std::string op;
+  std::string params;  // JSON object of the swept parameters
+  double p50_us;
+  double p99_us;
+  int64_t bytes;
+};
+
+double Percentile(std::vector<double> sorted, double q) {
+  std::sort(sorted.begin(), sorted.end());
+  size_t rank = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// Time every call of fn on its own; setup runs before each call, untimed, to
+// restore the inputs the op updates in place
+BenchResult Measure(const BenchOptions &opts, const std::string &op, const std::string &params, int64_t bytes,
+                    const std::function<void()> &setup, const std::function<void()> &fn) {
+  for (int i = 0; i < opts.warmup; ++i) {
+    setup();
+    fn();
+  }
+  std::vector<double> samples;
+  samples.reserve(opts.iters);
+  for (int i = 0; i < opts.iters; ++i) {
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  return {op, params, Percentile(samples, 0.5), Percentile(samples, 0.99), bytes};
+}
+
+template <typename T>
+const char *DtypeName() {
+  return sizeof(T) == 8 ? "int64" : "int32";
+}
+
+template <typename IdxT, typename LenT>
+BenchResult BenchAdvStepFlash(const BenchOptions &opts, int32_t num_seqs, int32_t block_size, std::mt19937 *gen) {
+  constexpr int32_t kMaxBlocksPerSeq = 64;
+  std::uniform_int_distribution<int32_t> token_dist(0, 151935);
+  std::uniform_int_distribution<int32_t> len_dist(0, block_size * kMaxBlocksPerSeq - 2);
+  std::uniform_int_distribution<int32_t> block_dist(0, 65535);
+  std::vector<IdxT> sampled_token_ids(num_seqs);
+  std::vector<LenT> seq_lens_init(num_seqs);
+  std::vector<int32_t> block_tables(static_cast<size_t>(num_seqs) * kMaxBlocksPerSeq);
+  for (auto &t : sampled_token_ids) {
+    t = token_dist(*gen);
+  }
+  for (auto &l : seq_lens_init) {
+    l = len_dist(*gen);
+  }
+  for (auto &b : block_tables) {
+    b = block_dist(*gen);
+  }
+  std::vector<LenT> seq_lens(num_seqs);
+  std::vector<IdxT> input_tokens(num_seqs), input_positions(num_seqs), slot_mapping(num_seqs);
+
+  // sampled tokens, seq_lens and one block table entry in; tokens, positions,
+  // slots and seq_lens out
+  int64_t bytes = static_cast<int64_t>(num_seqs) * (4 * sizeof(IdxT) + 2 * sizeof(LenT) + sizeof(int32_t));
+  std::string params = "{\"num_seqs\": " + std::to_string(num_seqs) + ", \"block_size\": " +
+                       std::to_string(block_size) + ", \"dtype\": \"" + DtypeName<IdxT>() + "/" +
+                       DtypeName<LenT>() + "\"}";
+  return Measure(
+      opts, "adv_step_flash", params, bytes, [&] { seq_lens = seq_lens_init; },
+      [&] {
+        AdvStepFlashCpu<IdxT, LenT>(sampled_token_ids.data(), block_tables.data(), seq_lens.data(),
+                                    input_tokens.data(), input_positions.data(), slot_mapping.data(), num_seqs,
+                                    num_seqs, 1, block_size, kMaxBlocksPerSeq);
+      });
+}
+
+BenchResult BenchRejectionSample(const BenchOptions &opts, int32_t batch_size, int32_t max_spec_len,
+                                 int32_t vocab_size, bool greedy, std::mt19937 *gen) {
+  std::uniform_int_distribution<int32_t> token_dist(0, vocab_size - 1);
+  std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
+  int32_t num_tokens = batch_size * max_spec_len;
+  std::vector<int32_t> cu_num_draft_tokens(batch_size);
+  std::vector<int32_t> bonus_token_ids(batch_size);
+  std::unique_ptr<bool[]> is_greedy(new bool[batch_size]);
+  for (int32_t i = 0; i < batch_size; ++i) {
+    cu_num_draft_tokens[i] = (i + 1) * max_spec_len;
+    bonus_token_ids[i] = token_dist(*gen);
+    is_greedy[i] = greedy;
+  }
+  std::vector<int32_t> draft_token_ids(num_tokens);
+  for (auto &t : draft_token_ids) {
+    t = token_dist(*gen);
+  }
+  auto random_probs = [&](size_t n) {
+    std::vector<float> probs(n);
+    for (auto &p : probs) {
+      p = uniform_dist(*gen) / static_cast<float>(vocab_size);
+    }
+    return probs;
+  };
+  std::vector<float> target_probs = random_probs(static_cast<size_t>(num_tokens) * vocab_size);
+  std::vector<float> draft_probs = greedy ? std::vector<float>() : random_probs(target_probs.size());
+  std::vector<float> uniform_probs = random_probs(num_tokens);
+  std::vector<float> recovery_noise = random_probs(static_cast<size_t>(batch_size) * vocab_size);
+  std::vector<int32_t> output_token_ids(static_cast<size_t>(batch_size) * (max_spec_len + 1));
+
+  // the bytes every call touches: greedy requests take the argmax of whole
+  // target rows, random ones read the draft, target and uniform probs of each
+  // draft token, and whole rows only to recover a rejected token
+  int64_t probs_read = greedy ? static_cast<int64_t>(target_probs.size()) : 3 * static_cast<int64_t>(num_tokens);
+  int64_t bytes = static_cast<int64_t>(sizeof(float)) * probs_read +
+                  static_cast<int64_t>(sizeof(int32_t)) * (num_tokens + output_token_ids.size());
+  std::string params = "{\"batch_size\": " + std::to_string(batch_size) + ", \"max_spec_len\": " +
+                       std::to_string(max_spec_len) + ", \"vocab_size\": " + std::to_string(vocab_size) +
+                       ", \"dtype\": \"float32\", \"greedy\": " + (greedy ? "true" : "false") + "}";
+  return Measure(
+      opts, "rejection_sample", params, bytes, [] {},
+      [&] {
+        RejectionSampleCpu(cu_num_draft_tokens.data(), draft_token_ids.data(),
+                           greedy ? nullptr : draft_probs.data(), target_probs.data(), bonus_token_ids.data(),
+                           uniform_probs.data(), recovery_noise.data(), is_greedy.get(), output_token_ids.data(),
+                           batch_size, max_spec_len, vocab_size);
+      });
+}
+
+// A mixed batch at max_seq_len: every other request a decode, the rest prefill chunks of kChunkLen tokens
+template <typename T>
+BenchResult BenchAttentionMask(const BenchOptions &opts, int32_t num_reqs, int32_t max_seq_len) {
+  constexpr int32_t kChunkLen = 128;
+  std::vector<int32_t> query_lens(num_reqs), mask_offsets(num_reqs);
+  int64_t num_rows = 0;
+  for (int32_t i = 0; i < num_reqs; ++i) {
+    query_lens[i] = i % 2 == 0 ? kChunkLen : 1;
+    mask_offsets[i] = query_lens[i] > 1 ? max_seq_len - query_lens[i] : max_seq_len;
+    num_rows += query_lens[i];
+  }
+  std::vector<T> mask(static_cast<size_t>(num_rows) * max_seq_len);
+
+  int64_t bytes = static_cast<int64_t>(mask.size() * sizeof(T)) + 2 * num_reqs * static_cast<int64_t>(sizeof(int32_t));
+  std::string params = "{\"num_reqs\": " + std::to_string(num_reqs) + ", \"max_seq_len\": " +
+                       std::to_string(max_seq_len) + ", \"dtype\": \"" + (sizeof(T) == 2 ? "float16" : "float32") +
+                       "\"}";
+  return Measure(opts, "attention_mask", params, bytes, [] {}, [&] {
+    AttentionMaskCpu<T>(query_lens.data(), mask_offsets.data(), mask.data(), num_reqs, num_rows, max_seq_len,
+                        T{1});
+  });
+}
+
+// A decode batch of max_spec_len draft tokens per request, about half of them accepted
+BenchResult BenchEaglePrepareInputs(const BenchOptions &opts, int32_t num_reqs, int32_t max_spec_len,
+                                    std::mt19937 *gen) {
+  const int32_t max_gen_len = max_spec_len + 1;
+  std::uniform_int_distribution<int32_t> token_dist(0, 151935);
+  std::uniform_int_distribution<int32_t> accepted_dist(0, max_spec_len);
+  std::vector<int32_t> sampled_token_ids(static_cast<size_t>(num_reqs) * max_gen_len, -1);
+  std::vector<int32_t> cu_num_draft_tokens(num_reqs), backup_next_token_ids(num_reqs), query_start_loc(num_reqs + 1);
+  std::unique_ptr<bool[]> discard_mask(new bool[num_reqs]);
+  for (int32_t i = 0; i < num_reqs; ++i) {
+    int32_t num_sampled = accepted_dist(*gen) + 1;
+    for (int32_t j = 0; j < num_sampled; ++j) {
+      sampled_token_ids[static_cast<size_t>(i) * max_gen_len + j] = token_dist(*gen);
+    }
+    cu_num_draft_tokens[i] = (i + 1) * max_spec_len;
+    backup_next_token_ids[i] = token_dist(*gen);
+    query_start_loc[i + 1] = (i + 1) * max_gen_len;
+    discard_mask[i] = false;
+  }
+  std::vector<int32_t> next_token_ids(num_reqs), valid_sampled_tokens_count(num_reqs),
+      token_indices_to_sample(num_reqs);
+
+  // the sampled rows and four int32 and a bool per request in, three int32 per request out
+  int64_t bytes = static_cast<int64_t>(sampled_token_ids.size() * sizeof(int32_t)) +
+                  static_cast<int64_t>(num_reqs) * (7 * sizeof(int32_t) + sizeof(bool));
+  std::string params = "{\"num_reqs\": " + std::to_string(num_reqs) + ", \"max_spec_len\": " +
+                       std::to_string(max_spec_len) + ", \"dtype\": \"int32\"}";
+  return Measure(opts, "eagle_prepare_inputs", params, bytes, [] {}, [&] {
+    EaglePrepareInputsCpu(sampled_token_ids.data(), cu_num_draft_tokens.data(), discard_mask.get(),
+                          backup_next_token_ids.data(), query_start_loc.data(), next_token_ids.data(),
+                          valid_sampled_tokens_count.data(), token_indices_to_sample.data(), num_reqs, max_gen_len,
+                          151936);
+  });
+}
+
+// An embedding batch: num_reqs whole prompts of seq_len tokens each, bf16 hidden states
+BenchResult BenchSegmentPool(const BenchOptions &opts, int32_t num_reqs, int32_t seq_len, int32_t hidden_size,
+                             int32_t pooling_type, std::mt19937 *gen) {
+  std::uniform_int_distribution<uint32_t> bits_dist(0x3c00u, 0x3fffu);  // bf16 of [0.0078125, 2)
+  std::vector<uint16_t> hidden_states(static_cast<size_t>(num_reqs) * seq_len * hidden_size);
+  for (auto &bits : hidden_states) {
+    bits = static_cast<uint16_t>(bits_dist(*gen));
+  }
+  std::vector<int32_t> first_token_indices(num_reqs), last_token_indices(num_reqs), prompt_lens(num_reqs, seq_len),
+      num_prev_tokens(num_reqs, 0);
+  for (int32_t i = 0; i < num_reqs; ++i) {
+    first_token_indices[i] = i * seq_len;
+    last_token_indices[i] = (i + 1) * seq_len - 1;
+  }
+  const bool mean = pooling_type == kSegmentPoolMean;
+  std::vector<float> pooled(static_cast<size_t>(num_reqs) * hidden_size), partial_sums(pooled.size());
+
+  // MEAN reads every token row, CLS and LAST one row per request; one pooled row per request out
+  int64_t rows_read = mean ? static_cast<int64_t>(num_reqs) * seq_len : num_reqs;
+  int64_t bytes = rows_read * hidden_size * static_cast<int64_t>(sizeof(uint16_t)) +
+                  static_cast<int64_t>(num_reqs) * (4 * sizeof(int32_t) +
+                                                    hidden_size * (mean ? sizeof(float) : sizeof(uint16_t)));
+  const char *type_name = pooling_type == kSegmentPoolCls ? "cls" : (mean ? "mean" : "last");
+  std::string params = "{\"num_reqs\": " + std::to_string(num_reqs) + ", \"seq_len\": " + std::to_string(seq_len) +
+                       ", \"hidden_size\": " + std::to_string(hidden_size) + ", \"pooling_type\": \"" +
+                       type_name + "\", \"dtype\": \"bfloat16\"}";
+  return Measure(opts, "segment_pool", params, bytes, [] {}, [&] {
+    SegmentPoolCpu(hidden_states.data(), first_token_indices.data(), last_token_indices.data(), prompt_lens.data(),
+                   num_prev_tokens.data(), pooled.data(), partial_sums.data(), num_reqs, hidden_size, pooling_type,
+                   SegmentPoolDtype::kBFloat16);
+  });
+}
+
+bool ParseArgs(int argc, char **argv, BenchOptions *opts) {
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--iters") == 0 && has_value) {
+      opts->iters = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--warmup") == 0 && has_value) {
+      opts->warmup = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+      opts->output = argv[++i];
+    } else if (std::strcmp(argv[i], "--quick") == 0) {
+      opts->quick = true;
+    } else {
+      return false;
+    }
+  }
+  return opts->iters > 0 && opts->warmup >= 0;
+}
+
+void WriteJson(std::FILE *f, const BenchOptions &opts, const std::vector<BenchResult> &results) {
+  std::fprintf(f, "{\n  \"suite\": \"custom_ops\",\n  \"backend\": \"cpu\",\n");
+  std::fprintf(f, "  \"num_threads\": %d,\n  \"iters\": %d,\n  \"results\": [\n", omp_get_max_threads(),
+               opts.iters);
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto &r = results[i];
+    double gbps = r.p50_us > 0 ? static_cast<double>(r.bytes) / (r.p50_us * 1e3) : 0.0;
+    std::fprintf(f,
+                 "    {\"op\": \"%s\", \"params\": %s, \"p50_us\": %.3f, \"p99_us\": %.3f, "
+                 "\"bytes\": %lld, \"gbps\": %.3f}%s\n",
+                 r.op.c_str(), r.params.c_str(), r.p50_us, r.p99_us, static_cast<long long>(r.bytes), gbps,
+                 i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(f, "  ]\n}\n");
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  BenchOptions opts;
+  if (!ParseArgs(argc, argv, &opts)) {
+    std::fprintf(stderr, "usage: %s [--iters N] [--warmup N] [--quick] [--output file.json]\n", argv[0]);
+    return 2;
+  }
+
+  const std::vector<int32_t> num_seqs_list =
+      opts.quick ? std::vector<int32_t>{1, 256} : std::vector<int32_t>{1, 16, 64, 256, 1024, 4096, 16384, 65536};
+  const std::vector<int32_t> block_sizes = opts.quick ? std::vector<int32_t>{16} : std::vector<int32_t>{16, 128};
+  const std::vector<int32_t> batch_sizes =
+      opts.quick ? std::vector<int32_t>{1, 8} : std::vector<int32_t>{1, 8, 32, 128};
+  const std::vector<int32_t> spec_lens = opts.quick ? std::vector<int32_t>{2} : std::vector<int32_t>{1, 3, 5};
+  const int32_t vocab_size = opts.quick ? 1024 : 32000;
+  const std::vector<int32_t> mask_reqs = opts.quick ? std::vector<int32_t>{2} : std::vector<int32_t>{2, 16};
+  const std::vector<int32_t> mask_seq_lens =
+      opts.quick ? std::vector<int32_t>{1024} : std::vector<int32_t>{8192, 32768};
+  const std::vector<int32_t> eagle_reqs =
+      opts.quick ? std::vector<int32_t>{8} : std::vector<int32_t>{1, 16, 64, 256, 1024};
+  const std::vector<int32_t> pool_reqs =
+      opts.quick ? std::vector<int32_t>{16} : std::vector<int32_t>{1, 64, 1024, 4096};
+  const int32_t pool_hidden_size = opts.quick ? 256 : 1024;
+
+  std::mt19937 gen(0);
+  std::vector<BenchResult> results;
+  for (int32_t block_size : block_sizes) {
+    for (int32_t num_seqs : num_seqs_list) {
+      results.push_back(BenchAdvStepFlash<int32_t, int32_t>(opts, num_seqs, block_size, &gen));
+      results.push_back(BenchAdvStepFlash<int64_t, int32_t>(opts, num_seqs, block_size, &gen));
+      results.push_back(BenchAdvStepFlash<int64_t, int64_t>(opts, num_seqs, block_size, &gen));
+    }
+  }
+  for (int32_t max_spec_len : spec_lens) {
+    for (int32_t batch_size : batch_sizes) {
+      for (bool greedy : {true, false}) {
+        results.push_back(BenchRejectionSample(opts, batch_size, max_spec_len, vocab_size, greedy, &gen));
+      }
+    }
+  }
+
+  for (int32_t max_seq_len : mask_seq_lens) {
+    for (int32_t num_reqs : mask_reqs) {
+      results.push_back(BenchAttentionMask<uint16_t>(opts, num_reqs, max_seq_len));
+      results.push_back(BenchAttentionMask<uint32_t>(opts, num_reqs, max_seq_len));
+    }
+  }
+
+  for (int32_t max_spec_len : spec_lens) {
+    for (int32_t num_reqs : eagle_reqs) {
+      results.push_back(BenchEaglePrepareInputs(opts, num_reqs, max_spec_len, &gen));
+    }
+  }
+
+  // short sequences as embedding batches send them
+  for (int32_t pooling_type : {kSegmentPoolLast, kSegmentPoolMean}) {
+    for (int32_t num_reqs : pool_reqs) {
+      results.push_back(BenchSegmentPool(opts, num_reqs, 32, pool_hidden_size, pooling_type, &gen));
+    }
+  }
+
+  for (const auto &r : results) {
+    std::fprintf(stderr, "%-18s %-72s p50 %10.2f us  p99 %10.2f us\n", r.op.c_str(), r.params.c_str(), r.p50_us,
+                 r.p99_us);
+  }
+  std::FILE *f = opts.output == nullptr ? stdout : std::fopen(opts.output, "w");
+  if (f == nullptr) {
+    std::perror(opts.output);
+    return 1;
+  }
+  WriteJson(f, opts, results);
+  if (f != stdout) {
+    std::fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cpu/eagle_prepare_inputs.h"
+
+namespace {
+// A request is a handful of compares; below this many a parallel region costs more than the batch.
+constexpr int32_t kEaglePrepareInputsCpuMinParallelReqs = 1 << 14;
+}  // namespace
+
+void EaglePrepareInputsCpu(const int32_t *sampled_token_ids, const int32_t *cu_num_draft_tokens,
+                           const bool *discard_mask, const int32_t *backup_next_token_ids,
+                           const int32_t *query_start_loc, int32_t *next_token_ids,
+                           int32_t *valid_sampled_tokens_count, int32_t *token_indices_to_sample, int32_t num_reqs,
+                           int32_t max_gen_len, int32_t vocab_size) {
+#pragma omp parallel for schedule(static) if (num_reqs >= kEaglePrepareInputsCpuMinParallelReqs)
+  for (int32_t req = 0; req < num_reqs; ++req) {
+    const int32_t *row = sampled_token_ids + static_cast<int64_t>(req) * max_gen_len;
+    int32_t valid = 0;
+    if (!discard_mask[req]) {
+      for (int32_t j = 0; j < max_gen_len; ++j) {
+        valid += row[j] >= 0 && row[j] < vocab_size ? 1 : 0;
+      }
+    }
+    next_token_ids[req] = valid > 0 ? row[valid - 1] : backup_next_token_ids[req];
+    valid_sampled_tokens_count[req] = valid;
+
+    const int32_t num_draft = cu_num_draft_tokens[req] - (req == 0 ? 0 : cu_num_draft_tokens[req - 1]);
+    const int32_t num_rejected = num_draft > 0 ? num_draft + 1 - valid : 0;
+    token_indices_to_sample[req] = query_start_loc[req + 1] - 1 - num_rejected;
+  }
+}
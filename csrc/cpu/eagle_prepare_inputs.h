@@ -0,0 +1,42 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_CPU_EAGLE_PREPARE_INPUTS_H
+#define VLLM_MINDSPORE_CSRC_CPU_EAGLE_PREPARE_INPUTS_H
+
+#include <cstdint>
+
+// Host implementation of eagle_prepare_inputs, bit-exact with the AscendC
+// kernel. Request i owns row i of sampled_token_ids [num_reqs, max_gen_len],
+// its valid tokens (in [0, vocab_size)) first and -1 after them, as the
+// rejection sampler leaves them. For every request it writes:
+//   valid_sampled_tokens_count[i]: valid tokens of the row, 0 if discarded
+//   next_token_ids[i]: the token at valid - 1, or backup_next_token_ids[i]
+//                      when there is none
+//   token_indices_to_sample[i]: query_start_loc[i + 1] - 1 minus the
+//                      rejected tokens, num_draft + 1 - valid for requests
+//                      with num_draft > 0 draft tokens, 0 otherwise
+// cu_num_draft_tokens [num_reqs] is inclusive, query_start_loc [num_reqs + 1].
+void EaglePrepareInputsCpu(const int32_t *sampled_token_ids,
+                           const int32_t *cu_num_draft_tokens,
+                           const bool *discard_mask,
+                           const int32_t *backup_next_token_ids,
+                           const int32_t *query_start_loc,
+                           int32_t *next_token_ids,
+                           int32_t *valid_sampled_tokens_count,
+                           int32_t *token_indices_to_sample, int32_t num_reqs,
+                           int32_t max_gen_len, int32_t vocab_size);
+
+#endif // VLLM_MINDSPORE_CSRC_CPU_EAGLE_PREPARE_INPUTS_H
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cpu/rejection_sample.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr int32_t kPlaceholderTokenId = -1;
+// Rows are reduced in chunks that stay in L1 between the max pass and the index pass.
+constexpr int32_t kArgMaxChunk = 2048;
+
+// Index of the first maximum of f(v) over [0, vocab_size). Each chunk is reduced with SIMD, then scanned again for
+// the first index reaching the chunk maximum, so ties go to the lowest index as with mint.argmax.
+template <typename F>
+int32_t ArgMax(int32_t vocab_size, F f) {
+  float best = -std::numeric_limits<float>::infinity();
+  int32_t best_id = 0;
+  for (int32_t begin = 0; begin < vocab_size; begin += kArgMaxChunk) {
+    const int32_t end = std::min(begin + kArgMaxChunk, vocab_size);
+    float chunk_max = -std::numeric_limits<float>::infinity();
+#pragma omp simd reduction(max : chunk_max)
+    for (int32_t v = begin; v < end; ++v) {
+      chunk_max = std::max(chunk_max, f(v));
+    }
+    if (begin == 0 || chunk_max > best) {
+      int32_t v = begin;
+      while (v < end - 1 && f(v) != chunk_max) {
+        ++v;
+      }
+      best = chunk_max;
+      best_id = v;
+    }
+  }
+  return best_id;
+}
+
+int32_t RecoverToken(const float *draft_prob, const float *target_prob, const float *noise, int32_t draft_id,
+                     int32_t vocab_size) {
+  if (draft_prob != nullptr) {
+    return ArgMax(vocab_size, [=](int32_t v) { return std::max(target_prob[v] - draft_prob[v], 0.0f) / noise[v]; });
+  }
+  // zeroing the draft token after the division is the same as before it, the noise is positive
+  return ArgMax(vocab_size, [=](int32_t v) { return v == draft_id ? 0.0f : target_prob[v] / noise[v]; });
+}
+}  // namespace
+
+void RejectionSampleCpu(const int32_t *cu_num_draft_tokens, const int32_t *draft_token_ids, const float *draft_probs,
+                        const float *target_probs, const int32_t *bonus_token_ids, const float *uniform_probs,
+                        const float *recovery_noise, const bool *is_greedy, int32_t *output_token_ids,
+                        int32_t batch_size, int32_t max_spec_len, int32_t vocab_size) {
+  const int64_t row_length = static_cast<int64_t>(max_spec_len) + 1;
+  // requests cost anything from one scalar compare to several full-vocabulary passes
+#pragma omp parallel for schedule(dynamic, 1) if (batch_size > 1)
+  for (int32_t req = 0; req < batch_size; ++req) {
+    const int64_t start = req == 0 ? 0 : cu_num_draft_tokens[req - 1];
+    const int64_t num_draft = cu_num_draft_tokens[req] - start;
+    int32_t *out_row = output_token_ids + req * row_length;
+    std::fill(out_row, out_row + row_length, kPlaceholderTokenId);
+
+    bool rejected = false;
+    for (int64_t pos = 0; pos < num_draft && !rejected; ++pos) {
+      const int64_t token = start + pos;
+      const int32_t draft_id = draft_token_ids[token];
+      const float *target_prob = target_probs + token * vocab_size;
+      const float *draft_prob = draft_probs == nullptr ? nullptr : draft_probs + token * vocab_size;
+      int32_t out_id = draft_id;
+      if (is_greedy[req]) {
+        out_id = ArgMax(vocab_size, [=](int32_t v) { return target_prob[v]; });
+        rejected = out_id != draft_id;
+      } else {
+        const float p_draft = draft_prob == nullptr ? 1.0f : draft_prob[draft_id];
+        const float p_target = target_prob[draft_id];
+        if (!(p_draft > 0.0f && p_target / p_draft >= uniform_probs[token])) {
+          out_id = RecoverToken(draft_prob, target_prob, recovery_noise + static_cast<int64_t>(req) * vocab_size,
+                                draft_id, vocab_size);
+          rejected = true;
+        }
+      }
+      out_row[pos] = out_id;
+    }
+    if (!rejected) {
+      out_row[num_draft] = bonus_token_ids[req];
+    }
+  }
+}
@@ -0,0 +1,40 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_CPU_REJECTION_SAMPLE_H
+#define VLLM_MINDSPORE_CSRC_CPU_REJECTION_SAMPLE_H
+
+#include <cstdint>
+
+// Host implementation of rejection_sample, bit-exact with the AscendC kernel.
+// Request i owns the draft tokens [cu_num_draft_tokens[i - 1],
+// cu_num_draft_tokens[i]) and row i of output_token_ids
+// [batch_size, max_spec_len + 1], which is fully written: accepted draft
+// tokens, then the target argmax (greedy) or the recovered token (random) at
+// the first rejection, or the bonus token, then -1.
+// draft_probs may be null, then every draft token has probability 1 and the
+// recovered token is drawn from the target probs without the draft token.
+// uniform_probs and recovery_noise [batch_size, vocab_size] are only read for
+// requests that are not greedy.
+void RejectionSampleCpu(const int32_t *cu_num_draft_tokens,
+                        const int32_t *draft_token_ids,
+                        const float *draft_probs, const float *target_probs,
+                        const int32_t *bonus_token_ids,
+                        const float *uniform_probs,
+                        const float *recovery_noise, const bool *is_greedy,
+                        int32_t *output_token_ids, int32_t batch_size,
+                        int32_t max_spec_len, int32_t vocab_size);
+
+#endif // VLLM_MINDSPORE_CSRC_CPU_REJECTION_SAMPLE_H
@@ -0,0 +1,199 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cpu/segment_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Columns of a row pooled together; the fp32 accumulator of a tile stays in L1 while the tokens stream by.
+constexpr int32_t kSegmentPoolCpuCols = 512;
+// Below this many elements read a parallel region costs more than the pooling.
+constexpr int64_t kSegmentPoolCpuMinParallelElems = 1 << 18;
+
+inline float BitsToFloat(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline uint32_t FloatToBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Loads an element as fp32 and stores fp32 back rounded to nearest even, as the casts of the AscendC kernel do.
+template <SegmentPoolDtype D>
+struct SegmentPoolElem;
+
+template <>
+struct SegmentPoolElem<SegmentPoolDtype::kFloat32> {
+  using T = float;
+  static float Load(float v) { return v; }
+  static float Store(float v) { return v; }
+};
+
+template <>
+struct SegmentPoolElem<SegmentPoolDtype::kBFloat16> {
+  using T = uint16_t;
+  static float Load(uint16_t v) { return BitsToFloat(static_cast<uint32_t>(v) << 16); }
+  static uint16_t Store(float v) {
+    uint32_t bits = FloatToBits(v);
+    if ((bits & 0x7fffffffu) > 0x7f800000u) {
+      return static_cast<uint16_t>((bits >> 16) | 0x40u);  // quiet NaN
+    }
+    return static_cast<uint16_t>((bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16);
+  }
+};
+
+template <>
+struct SegmentPoolElem<SegmentPoolDtype::kFloat16> {
+  using T = uint16_t;
+  // Branchless, so that it vectorizes: the exponent is rebiased by a multiply, which also normalizes subnormals,
+  // and inf and NaN keep their payload.
+  static float Load(uint16_t v) {
+    uint32_t em = (static_cast<uint32_t>(v) & 0x7fffu) << 13;
+    uint32_t bits = FloatToBits(BitsToFloat(em) * 0x1p112f);
+    bits = em >= (0x7c00u << 13) ? (em | 0x7f800000u) : bits;
+    return BitsToFloat(bits | ((static_cast<uint32_t>(v) & 0x8000u) << 16));
+  }
+  static uint16_t Store(float v) {
+    uint32_t bits = FloatToBits(v);
+    uint32_t abs = bits & 0x7fffffffu;
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    if (abs > 0x7f800000u) {
+      return static_cast<uint16_t>(sign | 0x7e00u);
+    }
+    if (abs >= 0x477ff000u) {  // 65520 and up round to inf
+      return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    if (abs < 0x38800000u) {  // below 2^-14: subnormal, in units of 2^-24
+      return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(std::fabs(v) * 0x1p24f)));
+    }
+    abs += 0xfffu + ((abs >> 13) & 1u);
+    return static_cast<uint16_t>(sign | ((abs - 0x38000000u) >> 13));
+  }
+};
+
+// Columns [col, col + count) of request req.
+template <SegmentPoolDtype D>
+void PoolTile(const typename SegmentPoolElem<D>::T *hidden, const int32_t *first_token_indices,
+              const int32_t *last_token_indices, const int32_t *prompt_lens, const int32_t *num_prev_tokens,
+              void *pooled, float *partial_sums, int32_t hidden_size, int32_t pooling_type, int32_t req, int32_t col,
+              int32_t count) {
+  using Elem = SegmentPoolElem<D>;
+  using T = typename Elem::T;
+  const int64_t row_offset = static_cast<int64_t>(req) * hidden_size + col;
+  const int32_t first = first_token_indices[req];
+  const int32_t last = last_token_indices[req];
+  const bool carry_in = num_prev_tokens[req] > 0;
+  const bool carry_out = num_prev_tokens[req] + (last - first + 1) < prompt_lens[req];
+  float *carry = partial_sums + row_offset;
+
+  if (pooling_type == kSegmentPoolMean) {
+    float acc[kSegmentPoolCpuCols];
+    for (int32_t h = 0; h < count; ++h) {
+      acc[h] = carry_in ? carry[h] : 0.0f;
+    }
+    // token after token, as the kernel adds the rows, so that the sums are bit-exact
+    for (int32_t token = first; token <= last; ++token) {
+      const T *src = hidden + static_cast<int64_t>(token) * hidden_size + col;
+#pragma omp simd
+      for (int32_t h = 0; h < count; ++h) {
+        acc[h] += Elem::Load(src[h]);
+      }
+    }
+    if (carry_out) {
+      std::copy(acc, acc + count, carry);
+    }
+    const float scale = 1.0f / static_cast<float>(prompt_lens[req]);
+    float *out = static_cast<float *>(pooled) + row_offset;
+#pragma omp simd
+    for (int32_t h = 0; h < count; ++h) {
+      out[h] = acc[h] * scale;
+    }
+    return;
+  }
+
+  T *out = static_cast<T *>(pooled) + row_offset;
+  if (pooling_type == kSegmentPoolCls && carry_in) {
+    for (int32_t h = 0; h < count; ++h) {
+      out[h] = Elem::Store(carry[h]);
+    }
+    return;
+  }
+  const int32_t token = pooling_type == kSegmentPoolCls ? first : last;
+  const T *src = hidden + static_cast<int64_t>(token) * hidden_size + col;
+  std::copy(src, src + count, out);
+  if (pooling_type == kSegmentPoolCls && carry_out) {
+    for (int32_t h = 0; h < count; ++h) {
+      carry[h] = Elem::Load(src[h]);
+    }
+  }
+}
+
+template <SegmentPoolDtype D>
+void SegmentPoolImpl(const void *hidden_states, const int32_t *first_token_indices, const int32_t *last_token_indices,
+                     const int32_t *prompt_lens, const int32_t *num_prev_tokens, void *pooled, float *partial_sums,
+                     int32_t num_reqs, int32_t hidden_size, int32_t pooling_type) {
+  const auto *hidden = static_cast<const typename SegmentPoolElem<D>::T *>(hidden_states);
+  const int32_t col_tiles = (hidden_size + kSegmentPoolCpuCols - 1) / kSegmentPoolCpuCols;
+  const int64_t num_items = static_cast<int64_t>(num_reqs) * col_tiles;
+  int64_t rows_read = num_reqs;
+  if (pooling_type == kSegmentPoolMean) {
+    for (int32_t i = 0; i < num_reqs; ++i) {
+      rows_read += std::max(last_token_indices[i] - first_token_indices[i], 0);
+    }
+  }
+
+  // (request, column tile) pairs rather than requests are split across threads, so that one long prompt is pooled
+  // by all of them; segments differ in length, hence the dynamic schedule
+#pragma omp parallel for schedule(dynamic, 4) if (rows_read * hidden_size >= kSegmentPoolCpuMinParallelElems)
+  for (int64_t item = 0; item < num_items; ++item) {
+    const auto req = static_cast<int32_t>(item / col_tiles);
+    const auto col = static_cast<int32_t>(item % col_tiles) * kSegmentPoolCpuCols;
+    PoolTile<D>(hidden, first_token_indices, last_token_indices, prompt_lens, num_prev_tokens, pooled, partial_sums,
+                hidden_size, pooling_type, req, col, std::min(kSegmentPoolCpuCols, hidden_size - col));
+  }
+}
+}  // namespace
+
+void SegmentPoolCpu(const void *hidden_states, const int32_t *first_token_indices, const int32_t *last_token_indices,
+                    const int32_t *prompt_lens, const int32_t *num_prev_tokens, void *pooled, float *partial_sums,
+                    int32_t num_reqs, int32_t hidden_size, int32_t pooling_type, SegmentPoolDtype dtype) {
+  if (num_reqs <= 0 || hidden_size <= 0) {
+    return;
+  }
+  switch (dtype) {
+    case SegmentPoolDtype::kFloat16:
+      SegmentPoolImpl<SegmentPoolDtype::kFloat16>(hidden_states, first_token_indices, last_token_indices, prompt_lens,
+                                                  num_prev_tokens, pooled, partial_sums, num_reqs, hidden_size,
+                                                  pooling_type);
+      break;
+    case SegmentPoolDtype::kBFloat16:
+      SegmentPoolImpl<SegmentPoolDtype::kBFloat16>(hidden_states, first_token_indices, last_token_indices,
+                                                   prompt_lens, num_prev_tokens, pooled, partial_sums, num_reqs,
+                                                   hidden_size, pooling_type);
+      break;
+    default:
+      SegmentPoolImpl<SegmentPoolDtype::kFloat32>(hidden_states, first_token_indices, last_token_indices, prompt_lens,
+                                                  num_prev_tokens, pooled, partial_sums, num_reqs, hidden_size,
+                                                  pooling_type);
+      break;
+  }
+}
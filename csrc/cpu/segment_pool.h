@@ -0,0 +1,58 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_CPU_SEGMENT_POOL_H
+#define VLLM_MINDSPORE_CSRC_CPU_SEGMENT_POOL_H
+
+#include <cstdint>
+
+// Pooling of the tokens of every request, as pooling_type of segment_pool.
+enum SegmentPoolType : int32_t {
+  kSegmentPoolCls = 0,
+  kSegmentPoolLast = 1,
+  kSegmentPoolMean = 2,
+};
+
+// Element type of the hidden states, and of the pooled rows but for MEAN.
+enum class SegmentPoolDtype : int32_t {
+  kFloat32 = 0,
+  kFloat16 = 1,
+  kBFloat16 = 2,
+};
+
+// Host implementation of segment_pool, bit-exact with the AscendC kernel.
+// Request i owns the tokens [first_token_indices[i], last_token_indices[i]]
+// of hidden_states [num_tokens, hidden_size] in this step, after the
+// num_prev_tokens[i] tokens of its prompt pooled in earlier steps. Row i of
+// pooled [num_reqs, hidden_size] gets:
+//   CLS:  the first token of the prompt, from partial_sums[i] if it was
+//         pooled earlier
+//   LAST: the last token of the step
+//   MEAN: in fp32, the sum of the tokens of the prompt so far, earlier ones
+//         from partial_sums[i], over prompt_lens[i]
+// For CLS and MEAN, requests whose prompt goes on in a later step
+// (num_prev_tokens + tokens of the step < prompt_lens) get that row in fp32
+// in partial_sums [num_reqs, hidden_size]; other rows are left alone, and
+// partial_sums is not read for rows without num_prev_tokens.
+void SegmentPoolCpu(const void *hidden_states,
+                    const int32_t *first_token_indices,
+                    const int32_t *last_token_indices,
+                    const int32_t *prompt_lens,
+                    const int32_t *num_prev_tokens, void *pooled,
+                    float *partial_sums, int32_t num_reqs,
+                    int32_t hidden_size, int32_t pooling_type,
+                    SegmentPoolDtype dtype);
+
+#endif // VLLM_MINDSPORE_CSRC_CPU_SEGMENT_POOL_H
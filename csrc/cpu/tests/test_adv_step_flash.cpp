@@ -0,0 +1,178 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <omp.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "cpu/adv_step_flash.h"
+
+namespace {
+struct AdvStepFlashCase {
+  int32_t num_seqs;
+  int32_t num_queries;
+  int32_t num_tokens_per_seq;
+  int32_t block_size;
+  int32_t max_blocks_per_seq;
+  int32_t block_tables_stride;
+};
+
+// values are kept as int64 on host and stored at the tested dtype for the kernel
+struct AdvStepFlashInputs {
+  std::vector<int64_t> sampled_token_ids;
+  std::vector<int64_t> seq_lens;
+  std::vector<int32_t> block_tables;
+};
+
+struct AdvStepFlashOutputs {
+  std::vector<int64_t> input_tokens;
+  std::vector<int64_t> input_positions;
+  std::vector<int64_t> seq_lens;
+  std::vector<int64_t> slot_mapping;
+};
+
+AdvStepFlashInputs MakeInputs(const AdvStepFlashCase &c, std::mt19937 *gen) {
+  AdvStepFlashInputs in;
+  std::uniform_int_distribution<int32_t> token_dist(0, 151935);
+  std::uniform_int_distribution<int32_t> len_dist(0, c.block_size * c.max_blocks_per_seq - c.num_tokens_per_seq);
+  std::uniform_int_distribution<int32_t> block_dist(0, 65535);
+  for (int32_t i = 0; i < c.num_seqs * c.num_tokens_per_seq; ++i) {
+    in.sampled_token_ids.push_back(token_dist(*gen));
+  }
+  for (int32_t i = 0; i < c.num_seqs; ++i) {
+    in.seq_lens.push_back(len_dist(*gen));
+  }
+  for (int32_t i = 0; i < c.num_seqs * c.block_tables_stride; ++i) {
+    in.block_tables.push_back(block_dist(*gen));
+  }
+  return in;
+}
+
+AdvStepFlashOutputs RunGolden(const AdvStepFlashCase &c, const AdvStepFlashInputs &in) {
+  AdvStepFlashOutputs out;
+  const int32_t k_tokens = c.num_tokens_per_seq;
+  for (int32_t i = 0; i < c.num_seqs; ++i) {
+    if (i >= c.num_queries) {
+      out.input_tokens.insert(out.input_tokens.end(), k_tokens, 0);
+      out.input_positions.insert(out.input_positions.end(), k_tokens, 0);
+      out.slot_mapping.insert(out.slot_mapping.end(), k_tokens, -1);
+      out.seq_lens.push_back(in.seq_lens[i]);
+      continue;
+    }
+    for (int32_t k = 0; k < k_tokens; ++k) {
+      int64_t pos = in.seq_lens[i] + k;
+      int64_t block = in.block_tables[i * c.block_tables_stride + pos / c.block_size];
+      out.input_tokens.push_back(in.sampled_token_ids[i * k_tokens + k]);
+      out.input_positions.push_back(pos);
+      out.slot_mapping.push_back(block * c.block_size + pos % c.block_size);
+    }
+    out.seq_lens.push_back(in.seq_lens[i] + k_tokens);
+  }
+  return out;
+}
+
+template <typename IdxT, typename LenT>
+AdvStepFlashOutputs RunKernel(const AdvStepFlashCase &c, const AdvStepFlashInputs &in) {
+  const size_t num_tokens = static_cast<size_t>(c.num_seqs) * c.num_tokens_per_seq;
+  std::vector<IdxT> sampled_token_ids(in.sampled_token_ids.begin(), in.sampled_token_ids.end());
+  std::vector<LenT> seq_lens(in.seq_lens.begin(), in.seq_lens.end());
+  // outputs start from garbage, so that the padding fill is checked too
+  std::vector<IdxT> input_tokens(num_tokens, 7);
+  std::vector<IdxT> input_positions(num_tokens, 7);
+  std::vector<IdxT> slot_mapping(num_tokens, 7);
+  AdvStepFlashCpu<IdxT, LenT>(sampled_token_ids.data(), in.block_tables.data(), seq_lens.data(), input_tokens.data(),
+                              input_positions.data(), slot_mapping.data(), c.num_seqs, c.num_queries,
+                              c.num_tokens_per_seq, c.block_size, c.block_tables_stride);
+
+  AdvStepFlashOutputs out;
+  out.input_tokens.assign(input_tokens.begin(), input_tokens.end());
+  out.input_positions.assign(input_positions.begin(), input_positions.end());
+  out.seq_lens.assign(seq_lens.begin(), seq_lens.end());
+  out.slot_mapping.assign(slot_mapping.begin(), slot_mapping.end());
+  return out;
+}
+
+bool Expect(const char *what, const AdvStepFlashCase &c, const std::vector<int64_t> &expect,
+            const std::vector<int64_t> &actual) {
+  if (expect.size() != actual.size()) {
+    std::printf("[FAILED] %s: expect %zu elements, got %zu\n", what, expect.size(), actual.size());
+    return false;
+  }
+  for (size_t i = 0; i < expect.size(); ++i) {
+    if (expect[i] != actual[i]) {
+      std::printf("[FAILED] num_seqs=%d num_queries=%d num_tokens_per_seq=%d block_size=%d: %s[%zu] expect %ld, got %ld\n",
+                  c.num_seqs, c.num_queries, c.num_tokens_per_seq, c.block_size, what, i,
+                  static_cast<long>(expect[i]), static_cast<long>(actual[i]));
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename IdxT, typename LenT>
+bool RunCase(const char *dtypes, const AdvStepFlashCase &c, const AdvStepFlashInputs &inputs,
+             const AdvStepFlashOutputs &golden) {
+  std::printf("checking %s, num_seqs=%d num_queries=%d num_tokens_per_seq=%d block_size=%d\n", dtypes, c.num_seqs,
+              c.num_queries, c.num_tokens_per_seq, c.block_size);
+  auto out = RunKernel<IdxT, LenT>(c, inputs);
+  return Expect("input_tokens", c, golden.input_tokens, out.input_tokens) &&
+         Expect("input_positions", c, golden.input_positions, out.input_positions) &&
+         Expect("seq_lens", c, golden.seq_lens, out.seq_lens) &&
+         Expect("slot_mapping", c, golden.slot_mapping, out.slot_mapping);
+}
+}  // namespace
+
+int main() {
+  const AdvStepFlashCase cases[] = {
+      {1, 1, 1, 16, 4, 4},
+      {37, 37, 1, 16, 8, 8},
+      {1024, 1024, 1, 128, 64, 64},
+      // large enough to run in parallel
+      {65536, 65536, 1, 16, 8, 8},
+      // block size that is not a power of two, and block tables with padded rows
+      {1000, 1000, 1, 48, 16, 20},
+      // positions beyond 2^24
+      {16, 16, 1, 1024, 65536, 65536},
+      // padded sequences
+      {37, 29, 1, 16, 8, 8},
+      {64, 0, 1, 16, 4, 4},
+      {65536, 40000, 1, 64, 8, 8},
+      // several tokens per sequence, crossing block boundaries
+      {37, 37, 4, 16, 8, 8},
+      {1000, 777, 3, 48, 16, 16},
+      {8192, 8000, 5, 16, 8, 8},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (int threads : {1, omp_get_max_threads()}) {
+    omp_set_num_threads(threads);
+    std::printf("running with %d threads\n", threads);
+    for (const auto &c : cases) {
+      auto inputs = MakeInputs(c, &gen);
+      auto golden = RunGolden(c, inputs);
+
+      ok = RunCase<int32_t, int32_t>("int32/int32", c, inputs, golden) && ok;
+      ok = RunCase<int32_t, int64_t>("int32/int64", c, inputs, golden) && ok;
+      ok = RunCase<int64_t, int32_t>("int64/int32", c, inputs, golden) && ok;
+      ok = RunCase<int64_t, int64_t>("int64/int64", c, inputs, golden) && ok;
+    }
+  }
+  std::printf(ok ? "[PASSED] adv_step_flash\n" : "[FAILED] adv_step_flash\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <omp.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cpu/eagle_prepare_inputs.h"
+
+namespace {
+constexpr int32_t kVocabSize = 1000;
+
+struct EaglePrepareInputsCase {
+  int32_t num_reqs;
+  int32_t max_spec_len;  // rows hold max_spec_len + 1 sampled tokens
+  int32_t prefill_every;  // every n-th request is a prefill chunk without draft tokens, 0 for none
+  int32_t discard_every;  // every n-th prefill chunk is partial and discarded, 0 for none
+};
+
+struct EagleBatch {
+  std::vector<int32_t> sampled_token_ids, cu_num_draft_tokens, backup_next_token_ids, query_start_loc;
+  std::unique_ptr<bool[]> discard_mask;
+};
+
+struct EagleOutputs {
+  std::vector<int32_t> next_token_ids, valid_sampled_tokens_count, token_indices_to_sample;
+};
+
+// A batch as the rejection sampler and _prepare_inputs leave it: a decode request with n draft tokens is scheduled
+// n + 1 tokens and its row holds the accepted ones and the bonus or recovered token; a prefill chunk has one sampled
+// token, -1 once discarded.
+EagleBatch MakeBatch(const EaglePrepareInputsCase &c, std::mt19937 *gen) {
+  const int32_t max_gen_len = c.max_spec_len + 1;
+  std::uniform_int_distribution<int32_t> token_dist(0, kVocabSize - 1);
+  std::uniform_int_distribution<int32_t> draft_dist(0, c.max_spec_len);
+  std::uniform_int_distribution<int32_t> chunk_dist(1, 300);
+  EagleBatch batch;
+  batch.sampled_token_ids.assign(static_cast<size_t>(c.num_reqs) * max_gen_len, -1);
+  batch.cu_num_draft_tokens.resize(c.num_reqs);
+  batch.backup_next_token_ids.resize(c.num_reqs);
+  batch.query_start_loc.assign(c.num_reqs + 1, 0);
+  batch.discard_mask.reset(new bool[c.num_reqs]);
+  int32_t num_prefills = 0;
+  for (int32_t i = 0; i < c.num_reqs; ++i) {
+    bool prefill = c.prefill_every > 0 && i % c.prefill_every == 0;
+    bool discard = prefill && c.discard_every > 0 && num_prefills++ % c.discard_every == 0;
+    int32_t num_draft = prefill ? 0 : draft_dist(*gen);
+    int32_t num_sampled = discard ? 0 : std::uniform_int_distribution<int32_t>(1, num_draft + 1)(*gen);
+    int32_t *row = batch.sampled_token_ids.data() + static_cast<int64_t>(i) * max_gen_len;
+    for (int32_t j = 0; j < num_sampled; ++j) {
+      row[j] = token_dist(*gen);
+    }
+    batch.discard_mask[i] = discard;
+    batch.backup_next_token_ids[i] = token_dist(*gen);
+    batch.cu_num_draft_tokens[i] = (i == 0 ? 0 : batch.cu_num_draft_tokens[i - 1]) + num_draft;
+    batch.query_start_loc[i + 1] = batch.query_start_loc[i] + (prefill ? chunk_dist(*gen) : num_draft + 1);
+  }
+  return batch;
+}
+
+// prepare_next_token_ids_padded and the token_indices_to_sample of prepare_inputs_padded in eagle.py, element by
+// element
+EagleOutputs RunGolden(const EagleBatch &batch, int32_t num_reqs, int32_t max_gen_len) {
+  EagleOutputs golden{std::vector<int32_t>(num_reqs), std::vector<int32_t>(num_reqs), std::vector<int32_t>(num_reqs)};
+  for (int32_t i = 0; i < num_reqs; ++i) {
+    const int32_t *row = batch.sampled_token_ids.data() + static_cast<int64_t>(i) * max_gen_len;
+    int32_t count = 0;
+    for (int32_t j = 0; j < max_gen_len && !batch.discard_mask[i]; ++j) {
+      if (row[j] != -1 && row[j] < kVocabSize) {
+        ++count;
+      }
+    }
+    golden.valid_sampled_tokens_count[i] = count;
+    golden.next_token_ids[i] = count > 0 ? row[count - 1] : batch.backup_next_token_ids[i];
+    int32_t num_draft = batch.cu_num_draft_tokens[i] - (i == 0 ? 0 : batch.cu_num_draft_tokens[i - 1]);
+    int32_t num_rejected = num_draft > 0 ? num_draft + 1 - count : 0;
+    golden.token_indices_to_sample[i] = batch.query_start_loc[i + 1] - 1 - num_rejected;
+  }
+  return golden;
+}
+
+bool Check(const char *name, const std::vector<int32_t> &golden, const std::vector<int32_t> &out) {
+  for (size_t i = 0; i < golden.size(); ++i) {
+    if (golden[i] != out[i]) {
+      std::printf("[FAILED] %s[%zu] expect %d, got %d\n", name, i, golden[i], out[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RunCase(const EaglePrepareInputsCase &c, std::mt19937 *gen) {
+  std::printf("checking num_reqs=%d max_spec_len=%d prefill_every=%d discard_every=%d\n", c.num_reqs,
+              c.max_spec_len, c.prefill_every, c.discard_every);
+  const int32_t max_gen_len = c.max_spec_len + 1;
+  auto batch = MakeBatch(c, gen);
+  auto golden = RunGolden(batch, c.num_reqs, max_gen_len);
+  EagleOutputs out{std::vector<int32_t>(c.num_reqs, 7), std::vector<int32_t>(c.num_reqs, 7),
+                   std::vector<int32_t>(c.num_reqs, 7)};
+  EaglePrepareInputsCpu(batch.sampled_token_ids.data(), batch.cu_num_draft_tokens.data(), batch.discard_mask.get(),
+                        batch.backup_next_token_ids.data(), batch.query_start_loc.data(), out.next_token_ids.data(),
+                        out.valid_sampled_tokens_count.data(), out.token_indices_to_sample.data(), c.num_reqs,
+                        max_gen_len, kVocabSize);
+  return Check("next_token_ids", golden.next_token_ids, out.next_token_ids) &&
+         Check("valid_sampled_tokens_count", golden.valid_sampled_tokens_count, out.valid_sampled_tokens_count) &&
+         Check("token_indices_to_sample", golden.token_indices_to_sample, out.token_indices_to_sample);
+}
+}  // namespace
+
+int main() {
+  const EaglePrepareInputsCase cases[] = {
+      {1, 1, 0, 0},
+      {1, 3, 1, 1},
+      // decodes only, the first step after a prefill has no draft tokens at all
+      {64, 0, 0, 0},
+      {64, 4, 0, 0},
+      // prefill chunks in between, some of them partial
+      {37, 2, 3, 2},
+      {256, 5, 4, 1},
+      // big enough to be split across threads
+      {40000, 3, 7, 3},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (int threads : {1, omp_get_max_threads()}) {
+    omp_set_num_threads(threads);
+    std::printf("running with %d threads\n", threads);
+    for (const auto &c : cases) {
+      ok = RunCase(c, &gen) && ok;
+    }
+  }
+  std::printf(ok ? "[PASSED] eagle_prepare_inputs\n" : "[FAILED] eagle_prepare_inputs\n");
+  return ok ? 0 : 1;
+}
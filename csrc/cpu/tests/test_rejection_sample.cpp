@@ -0,0 +1,183 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cpu/rejection_sample.h"
+
+namespace {
+struct RejectionSampleCase {
+  int32_t batch_size;
+  int32_t max_spec_len;
+  int32_t vocab_size;
+  bool use_draft_probs;
+  int32_t greedy_every;  // every n-th request is greedy, 0 for none
+  float peak;            // the probability mass put on one token per row, so that drafts get accepted
+};
+
+struct RejectionSampleInputs {
+  std::vector<int32_t> cu_num_draft_tokens;
+  std::vector<int32_t> draft_token_ids;
+  std::vector<float> draft_probs;
+  std::vector<float> target_probs;
+  std::vector<int32_t> bonus_token_ids;
+  std::vector<float> uniform_probs;
+  std::vector<float> recovery_noise;
+  std::unique_ptr<bool[]> is_greedy;
+};
+
+void FillProbs(std::vector<float> *probs, int32_t vocab_size, int32_t peak_id, float peak, std::mt19937 *gen) {
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> row(vocab_size);
+  float sum = 0.0f;
+  for (auto &p : row) {
+    p = dist(*gen);
+    sum += p;
+  }
+  for (auto &p : row) {
+    p = p / sum * (1.0f - peak);
+  }
+  row[peak_id] += peak;
+  probs->insert(probs->end(), row.begin(), row.end());
+}
+
+RejectionSampleInputs MakeInputs(const RejectionSampleCase &c, std::mt19937 *gen) {
+  RejectionSampleInputs in;
+  std::uniform_int_distribution<int32_t> num_draft_dist(0, c.max_spec_len);
+  std::uniform_int_distribution<int32_t> token_dist(0, c.vocab_size - 1);
+  std::uniform_real_distribution<float> uniform_dist(0.0f, 1.0f);
+  std::exponential_distribution<float> noise_dist(1.0f);
+  in.is_greedy.reset(new bool[c.batch_size]);
+  int32_t num_tokens = 0;
+  for (int32_t i = 0; i < c.batch_size; ++i) {
+    num_tokens += num_draft_dist(*gen);
+    in.cu_num_draft_tokens.push_back(num_tokens);
+    in.bonus_token_ids.push_back(token_dist(*gen));
+    in.is_greedy[i] = c.greedy_every > 0 && i % c.greedy_every == 0;
+    for (int32_t v = 0; v < c.vocab_size; ++v) {
+      in.recovery_noise.push_back(noise_dist(*gen) + 1e-6f);
+    }
+  }
+  for (int32_t t = 0; t < num_tokens; ++t) {
+    int32_t peak_id = token_dist(*gen);
+    // half of the drafts hit the peak of the target distribution
+    in.draft_token_ids.push_back(t % 2 == 0 ? peak_id : token_dist(*gen));
+    FillProbs(&in.target_probs, c.vocab_size, peak_id, c.peak, gen);
+    if (c.use_draft_probs) {
+      FillProbs(&in.draft_probs, c.vocab_size, in.draft_token_ids.back(), c.peak, gen);
+    }
+    in.uniform_probs.push_back(uniform_dist(*gen));
+  }
+  return in;
+}
+
+// The reference walks full probability rows, as the Python implementation does.
+std::vector<int32_t> RunGolden(const RejectionSampleCase &c, const RejectionSampleInputs &in) {
+  std::vector<int32_t> out(static_cast<size_t>(c.batch_size) * (c.max_spec_len + 1), -1);
+  for (int32_t req = 0; req < c.batch_size; ++req) {
+    int32_t start = req == 0 ? 0 : in.cu_num_draft_tokens[req - 1];
+    int32_t end = in.cu_num_draft_tokens[req];
+    int32_t *row = out.data() + req * (c.max_spec_len + 1);
+    bool rejected = false;
+    for (int32_t token = start; token < end && !rejected; ++token) {
+      const float *target = in.target_probs.data() + static_cast<size_t>(token) * c.vocab_size;
+      int32_t draft_id = in.draft_token_ids[token];
+      if (in.is_greedy[req]) {
+        row[token - start] = static_cast<int32_t>(std::max_element(target, target + c.vocab_size) - target);
+        rejected = row[token - start] != draft_id;
+        continue;
+      }
+      const float *draft = c.use_draft_probs ? in.draft_probs.data() + static_cast<size_t>(token) * c.vocab_size
+                                             : nullptr;
+      float p_draft = draft == nullptr ? 1.0f : draft[draft_id];
+      if (p_draft > 0.0f && target[draft_id] / p_draft >= in.uniform_probs[token]) {
+        row[token - start] = draft_id;
+        continue;
+      }
+      std::vector<float> prob(target, target + c.vocab_size);
+      for (int32_t v = 0; v < c.vocab_size; ++v) {
+        prob[v] = draft == nullptr ? prob[v] : std::max(prob[v] - draft[v], 0.0f);
+      }
+      if (draft == nullptr) {
+        prob[draft_id] = 0.0f;
+      }
+      const float *noise = in.recovery_noise.data() + static_cast<size_t>(req) * c.vocab_size;
+      for (int32_t v = 0; v < c.vocab_size; ++v) {
+        prob[v] /= noise[v];
+      }
+      row[token - start] = static_cast<int32_t>(std::max_element(prob.begin(), prob.end()) - prob.begin());
+      rejected = true;
+    }
+    if (!rejected) {
+      row[end - start] = in.bonus_token_ids[req];
+    }
+  }
+  return out;
+}
+
+bool RunCase(const RejectionSampleCase &c, std::mt19937 *gen) {
+  std::printf("checking batch_size=%d max_spec_len=%d vocab_size=%d use_draft_probs=%d greedy_every=%d\n",
+              c.batch_size, c.max_spec_len, c.vocab_size, c.use_draft_probs, c.greedy_every);
+  auto in = MakeInputs(c, gen);
+  auto golden = RunGolden(c, in);
+  std::vector<int32_t> out(golden.size(), 7);
+  RejectionSampleCpu(in.cu_num_draft_tokens.data(), in.draft_token_ids.data(),
+                     c.use_draft_probs ? in.draft_probs.data() : nullptr, in.target_probs.data(),
+                     in.bonus_token_ids.data(), in.uniform_probs.data(), in.recovery_noise.data(), in.is_greedy.get(),
+                     out.data(), c.batch_size, c.max_spec_len, c.vocab_size);
+  for (size_t i = 0; i < golden.size(); ++i) {
+    if (golden[i] != out[i]) {
+      std::printf("[FAILED] output_token_ids[%zu / %d] expect %d, got %d\n", i / (c.max_spec_len + 1),
+                  static_cast<int32_t>(i % (c.max_spec_len + 1)), golden[i], out[i]);
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  const RejectionSampleCase cases[] = {
+      {1, 1, 16, false, 0, 0.5f},
+      // greedy only, random only and mixed batches
+      {64, 4, 1000, false, 1, 0.5f},
+      {64, 4, 1000, false, 0, 0.5f},
+      {64, 4, 1000, true, 0, 0.5f},
+      {128, 4, 5003, true, 3, 0.9f},
+      {128, 4, 5003, false, 2, 0.9f},
+      // flat distributions reject early, with rows spanning several reduction chunks
+      {32, 8, 32000, true, 4, 0.0f},
+      {32, 8, 32000, false, 4, 0.0f},
+  };
+
+  std::mt19937 gen(0);
+  bool ok = true;
+  for (int threads : {1, omp_get_max_threads()}) {
+    omp_set_num_threads(threads);
+    std::printf("running with %d threads\n", threads);
+    for (const auto &c : cases) {
+      ok = RunCase(c, &gen) && ok;
+    }
+  }
+  std::printf(ok ? "[PASSED] rejection_sample\n" : "[FAILED] rejection_sample\n");
+  return ok ? 0 : 1;
+}
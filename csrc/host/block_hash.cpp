@@ -0,0 +1,673 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "host/module.h"
+
+// hash_request_blocks: the chained hashes of all the full blocks of a
+// request's token ids in one call, for prefix caching. The hash of a block
+// covers the hash of the block before it (the parent), its token ids and its
+// extra keys (LoRA name, multimodal hashes, cache salt), so it names the
+// whole prefix up to the block.
+//
+// Two hashes are offered:
+// - "sha256" is the hash of vLLM's hash_block_tokens with the sha256 hash
+//   function, sha256 of pickle.dumps((parent, tuple(token_ids), extra_keys),
+//   protocol=5), byte for byte, so the block hashes stay interchangeable
+//   with other vLLM instances, e.g. through a KV connector. The pickle is
+//   written here rather than by pickle, with the extra keys pickled by the
+//   caller.
+// - "fast" is a 128-bit non-cryptographic hash in the manner of XXH3's
+//   long-input loop: eight 64-bit lanes, each taking a 32 x 32 -> 64-bit
+//   product per 8-byte word, which compilers vectorize. It hashes the parent,
+//   the token ids as int32 and the pickled extra keys.
+//
+// The token ids and extra keys are read with the GIL held and the hashes
+// computed without it.
+namespace {
+constexpr uint64_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint64_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint64_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+constexpr int kLanes = 8;
+constexpr size_t kStripeBytes = kLanes * sizeof(uint64_t);
+constexpr int kStripesPerRound = 16;
+constexpr int kSecretWords = 32;
+
+constexpr std::array<uint64_t, kSecretWords> MakeSecret() {
+  // splitmix64
+  std::array<uint64_t, kSecretWords> secret{};
+  uint64_t state = kPrime64_3;
+  for (auto &word : secret) {
+    state += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    word = z ^ (z >> 31);
+  }
+  return secret;
+}
+constexpr std::array<uint64_t, kSecretWords> kSecret = MakeSecret();
+
+inline uint64_t Read64(const uint8_t *p) {
+  // little-endian hosts only, as the block hashes are compared as bytes
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline void Accumulate(uint64_t *acc, const uint8_t *stripe,
+                       const uint64_t *key) {
+  for (int l = 0; l < kLanes; ++l) {
+    uint64_t data = Read64(stripe + l * sizeof(uint64_t));
+    uint64_t data_key = data ^ key[l];
+    acc[l ^ 1] += data;
+    acc[l] += (data_key & 0xFFFFFFFFULL) * (data_key >> 32);
+  }
+}
+
+inline void Scramble(uint64_t *acc, const uint64_t *key) {
+  for (int l = 0; l < kLanes; ++l) {
+    acc[l] = ((acc[l] ^ (acc[l] >> 47)) ^ key[l]) * kPrime32_1;
+  }
+}
+
+inline uint64_t Avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= 0x165667919E3779F9ULL;
+  return h ^ (h >> 32);
+}
+
+inline uint64_t Merge(const uint64_t *acc, uint64_t start,
+                      const uint64_t *key) {
+  uint64_t result = start;
+  for (int l = 0; l < kLanes; l += 2) {
+    __uint128_t product =
+        static_cast<__uint128_t>(acc[l] ^ key[l]) * (acc[l + 1] ^ key[l + 1]);
+    result += static_cast<uint64_t>(product) ^
+              static_cast<uint64_t>(product >> 64);
+  }
+  return Avalanche(result);
+}
+
+// The 128-bit fast hash of data[0, len), written little-endian to out[16]
+void FastHash128(const uint8_t *data, size_t len, uint8_t *out) {
+  uint64_t acc[kLanes] = {kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3,
+                          kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1};
+  size_t num_stripes = len / kStripeBytes;
+  for (size_t s = 0; s < num_stripes; ++s) {
+    Accumulate(acc, data + s * kStripeBytes,
+               kSecret.data() + s % kStripesPerRound);
+    if (s % kStripesPerRound == kStripesPerRound - 1) {
+      Scramble(acc, kSecret.data() + kSecretWords - kLanes);
+    }
+  }
+  size_t tail = len - num_stripes * kStripeBytes;
+  if (tail > 0) {
+    // zero padded, the length below tells the padding from zero bytes
+    uint8_t last[kStripeBytes] = {};
+    std::memcpy(last, data + num_stripes * kStripeBytes, tail);
+    Accumulate(acc, last, kSecret.data() + kStripesPerRound + 1);
+  }
+  uint64_t lo = Merge(acc, len * kPrime64_1, kSecret.data() + 11);
+  uint64_t hi = Merge(acc, ~(len * kPrime64_2), kSecret.data() + 3);
+  std::memcpy(out, &lo, sizeof(lo));
+  std::memcpy(out + sizeof(lo), &hi, sizeof(hi));
+}
+
+// FIPS 180-4 SHA-256, portable
+class Sha256 {
+public:
+  static constexpr size_t kDigestSize = 32;
+
+  void Update(const uint8_t *data, size_t len) {
+    total_ += len;
+    if (buffered_ > 0) {
+      size_t n = std::min(len, sizeof(buffer_) - buffered_);
+      std::memcpy(buffer_ + buffered_, data, n);
+      buffered_ += n;
+      data += n;
+      len -= n;
+      if (buffered_ < sizeof(buffer_)) {
+        return;
+      }
+      Compress(buffer_);
+      buffered_ = 0;
+    }
+    for (; len >= sizeof(buffer_); data += sizeof(buffer_)) {
+      Compress(data);
+      len -= sizeof(buffer_);
+    }
+    std::memcpy(buffer_, data, len);
+    buffered_ = len;
+  }
+
+  void Final(uint8_t *out) {
+    uint64_t bits = total_ * 8;
+    uint8_t pad[sizeof(buffer_) + 8] = {0x80};
+    size_t pad_len = (buffered_ < 56 ? 56 : 120) - buffered_;
+    for (int i = 0; i < 8; ++i) {
+      pad[pad_len + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+    Update(pad, pad_len + 8);
+    for (int i = 0; i < 8; ++i) {
+      for (int b = 0; b < 4; ++b) {
+        out[4 * i + b] = static_cast<uint8_t>(state_[i] >> (24 - 8 * b));
+      }
+    }
+  }
+
+private:
+  static uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  void Compress(const uint8_t *block) {
+    static constexpr uint32_t kRound[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+        0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+        0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+        0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+        0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+        0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = (static_cast<uint32_t>(block[4 * i]) << 24) |
+             (static_cast<uint32_t>(block[4 * i + 1]) << 16) |
+             (static_cast<uint32_t>(block[4 * i + 2]) << 8) |
+             static_cast<uint32_t>(block[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) +
+                    ((e & f) ^ (~e & g)) + kRound[i] + w[i];
+      uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) +
+                    ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+  }
+
+  uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  uint8_t buffer_[64];
+  size_t buffered_ = 0;
+  uint64_t total_ = 0;
+};
+
+// SHA256_Init, _Update and _Final of OpenSSL's libcrypto, the library
+// hashlib uses, which hash with the SHA instructions of the CPU. Looked up
+// at run time so that _C_host needs no OpenSSL to build; Sha256 above is
+// used when none is found.
+class LibcryptoSha256 {
+public:
+  static const LibcryptoSha256 &Instance() {
+    static const LibcryptoSha256 instance;
+    return instance;
+  }
+
+  bool available() const { return final_ != nullptr; }
+
+  // One message given in parts
+  void Hash(const std::pair<const uint8_t *, size_t> *parts, int num_parts,
+            uint8_t *out) const {
+    // room for any SHA256_CTX, 112 bytes
+    alignas(16) unsigned char ctx[256];
+    init_(ctx);
+    for (int i = 0; i < num_parts; ++i) {
+      update_(ctx, parts[i].first, parts[i].second);
+    }
+    final_(out, ctx);
+  }
+
+private:
+  LibcryptoSha256() {
+    for (const char *name : {"libcrypto.so.3", "libcrypto.so.1.1",
+                             "libcrypto.so"}) {
+      void *lib = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+      if (lib == nullptr) {
+        continue;
+      }
+      init_ = reinterpret_cast<InitFn>(dlsym(lib, "SHA256_Init"));
+      update_ = reinterpret_cast<UpdateFn>(dlsym(lib, "SHA256_Update"));
+      final_ = reinterpret_cast<FinalFn>(dlsym(lib, "SHA256_Final"));
+      if (init_ != nullptr && update_ != nullptr && final_ != nullptr) {
+        return; // kept loaded
+      }
+      init_ = nullptr;
+      update_ = nullptr;
+      final_ = nullptr;
+      dlclose(lib);
+    }
+  }
+
+  using InitFn = int (*)(void *);
+  using UpdateFn = int (*)(void *, const void *, size_t);
+  using FinalFn = int (*)(unsigned char *, void *);
+  InitFn init_ = nullptr;
+  UpdateFn update_ = nullptr;
+  FinalFn final_ = nullptr;
+};
+
+// sha256 of a message given in parts
+void Sha256Digest(const std::pair<const uint8_t *, size_t> *parts,
+                  int num_parts, uint8_t *out) {
+  const LibcryptoSha256 &libcrypto = LibcryptoSha256::Instance();
+  if (libcrypto.available()) {
+    libcrypto.Hash(parts, num_parts, out);
+    return;
+  }
+  Sha256 sha;
+  for (int i = 0; i < num_parts; ++i) {
+    sha.Update(parts[i].first, parts[i].second);
+  }
+  sha.Final(out);
+}
+
+// Pickle opcodes, protocol 5
+constexpr char kProto = '\x80';
+constexpr char kFrame = '\x95';
+constexpr char kShortBinBytes = 'C';
+constexpr char kBinBytes = 'B';
+constexpr char kMemoize = '\x94';
+constexpr char kMark = '(';
+constexpr char kEmptyTuple = ')';
+constexpr char kTuple = 't';
+constexpr char kTuple1 = '\x85';
+constexpr char kTuple3 = '\x87';
+constexpr char kBinInt = 'J';
+constexpr char kBinInt1 = 'K';
+constexpr char kBinInt2 = 'M';
+constexpr char kLong1 = '\x8a';
+constexpr char kNone = 'N';
+constexpr char kStop = '.';
+// pickle starts a new frame past this size, which is not written here
+constexpr size_t kFrameSizeTarget = 64 * 1024;
+
+// The pickle writers below write at p and return the end of what they wrote
+char *PutLE(uint64_t value, int num_bytes, char *p) {
+  for (int i = 0; i < num_bytes; ++i) {
+    *p++ = static_cast<char>(value >> (8 * i));
+  }
+  return p;
+}
+
+// Longest pickled int: LONG1, its length and 9 bytes
+constexpr size_t kMaxPickledIntSize = 11;
+
+// An int as pickle.dumps writes it
+char *PickleInt(int64_t value, char *p) {
+  if (value >= 0 && value <= 0xFF) {
+    *p++ = kBinInt1;
+    return PutLE(value, 1, p);
+  }
+  if (value >= 0 && value <= 0xFFFF) {
+    *p++ = kBinInt2;
+    return PutLE(value, 2, p);
+  }
+  if (value >= INT32_MIN && value <= INT32_MAX) {
+    *p++ = kBinInt;
+    return PutLE(static_cast<uint64_t>(value), 4, p);
+  }
+  // the shortest little-endian two's complement that keeps the sign
+  auto byte = [value](int i) {
+    return static_cast<uint8_t>(i < 8 ? value >> (8 * i) : value >> 63);
+  };
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value)
+                                 : static_cast<uint64_t>(value);
+  int num_bytes = (64 - __builtin_clzll(magnitude)) / 8 + 1;
+  if (value < 0 && byte(num_bytes - 1) == 0xFF &&
+      (byte(num_bytes - 2) & 0x80) != 0) {
+    --num_bytes;
+  }
+  *p++ = kLong1;
+  *p++ = static_cast<char>(num_bytes);
+  for (int i = 0; i < num_bytes; ++i) {
+    *p++ = static_cast<char>(byte(i));
+  }
+  return p;
+}
+
+// A tuple of ints, memoized as pickle does all non-empty tuples
+char *PickleTokens(const int64_t *tokens, int64_t n, char *p) {
+  if (n == 0) {
+    *p++ = kEmptyTuple;
+    return p;
+  }
+  if (n > 3) {
+    *p++ = kMark;
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    p = PickleInt(tokens[i], p);
+  }
+  *p++ = n > 3 ? kTuple : static_cast<char>(kTuple1 + n - 1);
+  *p++ = kMemoize;
+  return p;
+}
+
+char *PickleBytesHeader(size_t len, char *p) {
+  if (len < 256) {
+    *p++ = kShortBinBytes;
+    return PutLE(len, 1, p);
+  }
+  *p++ = kBinBytes;
+  return PutLE(len, 4, p);
+}
+
+enum class BlockHashAlgo { kFast, kSha256 };
+
+struct BlockInputs {
+  std::vector<int64_t> tokens;    // token ids from `start` on
+  std::vector<std::string> extra; // pickled extra keys per block
+  std::vector<bool> has_extra;
+};
+
+// Reads the token ids from `start` on and the extra keys of each block;
+// returns false with a Python exception set
+bool ReadInputs(PyObject *token_ids, int64_t start, int64_t block_size,
+                PyObject *extra_keys, int64_t *num_blocks,
+                BlockInputs *inputs) {
+  PyObject *seq =
+      PySequence_Fast(token_ids, "token_ids must be a sequence of int");
+  if (seq == NULL) {
+    return false;
+  }
+  int64_t n = PySequence_Fast_GET_SIZE(seq);
+  if (start < 0 || start > n) {
+    Py_DECREF(seq);
+    PyErr_SetString(PyExc_ValueError,
+                    "hash_request_blocks: start must be in [0, "
+                    "len(token_ids)]");
+    return false;
+  }
+  *num_blocks = (n - start) / block_size;
+  inputs->tokens.resize(*num_blocks * block_size);
+  PyObject **items = PySequence_Fast_ITEMS(seq);
+  for (size_t i = 0; i < inputs->tokens.size(); ++i) {
+    inputs->tokens[i] = PyLong_AsLongLong(items[start + i]);
+    if (inputs->tokens[i] == -1 && PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return false;
+    }
+  }
+  Py_DECREF(seq);
+
+  inputs->extra.assign(*num_blocks, std::string());
+  inputs->has_extra.assign(*num_blocks, false);
+  if (extra_keys == Py_None) {
+    return true;
+  }
+  seq = PySequence_Fast(extra_keys,
+                        "extra_keys must be a sequence of bytes or None");
+  if (seq == NULL) {
+    return false;
+  }
+  if (PySequence_Fast_GET_SIZE(seq) != *num_blocks) {
+    Py_DECREF(seq);
+    PyErr_SetString(PyExc_ValueError,
+                    "hash_request_blocks: extra_keys must hold one entry "
+                    "per full block");
+    return false;
+  }
+  for (int64_t b = 0; b < *num_blocks; ++b) {
+    PyObject *item = PySequence_Fast_GET_ITEM(seq, b);
+    if (item == Py_None) {
+      continue;
+    }
+    if (!PyBytes_Check(item)) {
+      Py_DECREF(seq);
+      PyErr_SetString(PyExc_TypeError,
+                      "hash_request_blocks: extra_keys entries must be "
+                      "bytes or None");
+      return false;
+    }
+    inputs->extra[b].assign(PyBytes_AS_STRING(item), PyBytes_GET_SIZE(item));
+    inputs->has_extra[b] = true;
+  }
+  Py_DECREF(seq);
+  return true;
+}
+
+// Fast: hash parent || int32 token ids || extra keys || the parent and extra
+// key lengths, the last block's digest being the next parent
+bool FastHashBlocks(const std::string &parent, int64_t block_size,
+                    const BlockInputs &inputs, int64_t num_blocks,
+                    std::vector<uint8_t> *digests) {
+  std::vector<int32_t> tokens(inputs.tokens.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (inputs.tokens[i] < INT32_MIN || inputs.tokens[i] > INT32_MAX) {
+      PyErr_SetString(PyExc_OverflowError,
+                      "hash_request_blocks: token ids must fit in int32 for "
+                      "the fast hash");
+      return false;
+    }
+    tokens[i] = static_cast<int32_t>(inputs.tokens[i]);
+  }
+  constexpr size_t kDigestSize = 16;
+  digests->resize(num_blocks * kDigestSize);
+  Py_BEGIN_ALLOW_THREADS;
+  std::vector<uint8_t> message;
+  const uint8_t *prev = reinterpret_cast<const uint8_t *>(parent.data());
+  size_t prev_len = parent.size();
+  size_t token_bytes = block_size * sizeof(int32_t);
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    const std::string &extra = inputs.extra[b];
+    uint64_t trailer[2] = {prev_len,
+                           inputs.has_extra[b] ? extra.size() : UINT64_MAX};
+    message.resize(prev_len + token_bytes + extra.size() + sizeof(trailer));
+    uint8_t *p = message.data();
+    std::memcpy(p, prev, prev_len);
+    p += prev_len;
+    std::memcpy(p, tokens.data() + b * block_size, token_bytes);
+    p += token_bytes;
+    std::memcpy(p, extra.data(), extra.size());
+    p += extra.size();
+    std::memcpy(p, trailer, sizeof(trailer));
+    uint8_t *digest = digests->data() + b * kDigestSize;
+    FastHash128(message.data(), message.size(), digest);
+    prev = digest;
+    prev_len = kDigestSize;
+  }
+  Py_END_ALLOW_THREADS;
+  return true;
+}
+
+// sha256: the pickle of (parent, tuple(token_ids), extra_keys) is the frame
+// header and the parent as bytes, then a body per block holding the memo of
+// the parent, the token tuple, the extra keys and the closing opcodes
+bool Sha256HashBlocks(const std::string &parent, int64_t block_size,
+                      const BlockInputs &inputs, int64_t num_blocks,
+                      std::vector<uint8_t> *digests) {
+  size_t max_size = inputs.tokens.size() * kMaxPickledIntSize;
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    max_size += inputs.extra[b].size() + 8;
+  }
+  std::vector<char> bodies(max_size);
+  std::vector<size_t> offsets(num_blocks + 1, 0);
+  char *p = bodies.data();
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    *p++ = kMemoize;
+    p = PickleTokens(inputs.tokens.data() + b * block_size, block_size, p);
+    if (inputs.has_extra[b]) {
+      std::memcpy(p, inputs.extra[b].data(), inputs.extra[b].size());
+      p += inputs.extra[b].size();
+    } else {
+      *p++ = kNone;
+    }
+    *p++ = kTuple3;
+    *p++ = kMemoize;
+    *p++ = kStop;
+    offsets[b + 1] = p - bodies.data();
+    size_t parent_len = b == 0 ? parent.size() : Sha256::kDigestSize;
+    size_t frame_len = (parent_len < 256 ? 2 : 5) + parent_len +
+                       offsets[b + 1] - offsets[b];
+    if (frame_len >= kFrameSizeTarget) {
+      PyErr_SetString(PyExc_ValueError,
+                      "hash_request_blocks: a block pickles to more than "
+                      "one frame, which sha256 does not reproduce");
+      return false;
+    }
+  }
+  digests->resize(num_blocks * Sha256::kDigestSize);
+  Py_BEGIN_ALLOW_THREADS;
+  const uint8_t *prev = reinterpret_cast<const uint8_t *>(parent.data());
+  size_t prev_len = parent.size();
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    size_t body_len = offsets[b + 1] - offsets[b];
+    char head[16];
+    char *h = head;
+    *h++ = kProto;
+    *h++ = 5;
+    *h++ = kFrame;
+    h = PutLE((prev_len < 256 ? 2 : 5) + prev_len + body_len, 8, h);
+    h = PickleBytesHeader(prev_len, h);
+    const std::pair<const uint8_t *, size_t> parts[] = {
+        {reinterpret_cast<const uint8_t *>(head),
+         static_cast<size_t>(h - head)},
+        {prev, prev_len},
+        {reinterpret_cast<const uint8_t *>(bodies.data()) + offsets[b],
+         body_len}};
+    uint8_t *digest = digests->data() + b * Sha256::kDigestSize;
+    Sha256Digest(parts, 3, digest);
+    prev = digest;
+    prev_len = Sha256::kDigestSize;
+  }
+  Py_END_ALLOW_THREADS;
+  return true;
+}
+
+const char kHashRequestBlocksDoc[] =
+    "hash_request_blocks(token_ids, block_size, parent_hash,\n"
+    "                    extra_keys=None, *, start=0, algo='fast')\n"
+    "    -> list[bytes]\n"
+    "--\n\n"
+    "Return the chained hashes of the full blocks of token_ids from start\n"
+    "on, the first one chained to parent_hash, bytes.\n"
+    "token_ids: sequence of int; extra_keys: None, or one entry per full\n"
+    "block, None or the pickle opcodes of the block's extra keys as they\n"
+    "appear in pickle.dumps((parent, token_ids, extra_keys), protocol=5).\n"
+    "algo 'sha256' returns the 32-byte hashes of vLLM's hash_block_tokens\n"
+    "with sha256, 'fast' 16-byte non-cryptographic ones.";
+
+PyObject *HashRequestBlocks(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"token_ids", "block_size", "parent_hash",
+                                 "extra_keys", "start", "algo", NULL};
+  PyObject *token_ids = NULL, *parent_hash = NULL, *extra_keys = Py_None;
+  long long block_size = 0, start = 0;
+  const char *algo_name = "fast";
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "OLO!|O$Ls:hash_request_blocks",
+          const_cast<char **>(kwlist), &token_ids, &block_size, &PyBytes_Type,
+          &parent_hash, &extra_keys, &start, &algo_name)) {
+    return NULL;
+  }
+  BlockHashAlgo algo;
+  if (std::strcmp(algo_name, "fast") == 0) {
+    algo = BlockHashAlgo::kFast;
+  } else if (std::strcmp(algo_name, "sha256") == 0) {
+    algo = BlockHashAlgo::kSha256;
+  } else {
+    PyErr_Format(PyExc_ValueError,
+                 "hash_request_blocks: algo must be 'fast' or 'sha256', "
+                 "got '%s'",
+                 algo_name);
+    return NULL;
+  }
+  if (block_size <= 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "hash_request_blocks: block_size must be positive");
+    return NULL;
+  }
+
+  BlockInputs inputs;
+  int64_t num_blocks = 0;
+  if (!ReadInputs(token_ids, start, block_size, extra_keys, &num_blocks,
+                  &inputs)) {
+    return NULL;
+  }
+  std::string parent(PyBytes_AS_STRING(parent_hash),
+                     PyBytes_GET_SIZE(parent_hash));
+  std::vector<uint8_t> digests;
+  bool ok = algo == BlockHashAlgo::kFast
+                ? FastHashBlocks(parent, block_size, inputs, num_blocks,
+                                 &digests)
+                : Sha256HashBlocks(parent, block_size, inputs, num_blocks,
+                                   &digests);
+  if (!ok) {
+    return NULL;
+  }
+
+  PyObject *result = PyList_New(num_blocks);
+  if (result == NULL) {
+    return NULL;
+  }
+  size_t digest_size = num_blocks > 0 ? digests.size() / num_blocks : 0;
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    PyObject *digest = PyBytes_FromStringAndSize(
+        reinterpret_cast<const char *>(digests.data()) + b * digest_size,
+        digest_size);
+    if (digest == NULL) {
+      Py_DECREF(result);
+      return NULL;
+    }
+    PyList_SET_ITEM(result, b, digest);
+  }
+  return result;
+}
+
+PyMethodDef block_hash_methods[] = {
+    {"hash_request_blocks", reinterpret_cast<PyCFunction>(HashRequestBlocks),
+     METH_VARARGS | METH_KEYWORDS, kHashRequestBlocksDoc},
+    {NULL, NULL, 0, NULL}};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) { return PyModule_AddFunctions(m, block_hash_methods); }
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_HOST_BUFFER_UTILS_H
+#define VLLM_MINDSPORE_CSRC_HOST_BUFFER_UTILS_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "host/module.h"
+
+// Struct format characters of the element types the host helpers take
+template <typename T> struct BufferFormat {
+  static constexpr const char *kChars =
+      std::is_same<T, bool>::value       ? "?"
+      : std::is_floating_point<T>::value ? "efd"
+      : std::is_signed<T>::value         ? "bhilq"
+                                         : "BHILQ";
+  static constexpr const char *kName =
+      std::is_same<T, bool>::value       ? "bool"
+      : std::is_floating_point<T>::value ? "float"
+      : std::is_signed<T>::value         ? "int"
+                                         : "uint";
+};
+
+// Typed view of a C-contiguous buffer of a Python object, e.g. an ndarray,
+// checked against T. Released with the object.
+template <typename T> class TypedBuffer {
+public:
+  TypedBuffer() = default;
+  ~TypedBuffer() {
+    if (acquired_) {
+      PyBuffer_Release(&view_);
+    }
+  }
+
+  // Disable copy and assignment
+  TypedBuffer(const TypedBuffer &) = delete;
+  TypedBuffer &operator=(const TypedBuffer &) = delete;
+
+  // Returns false with a Python exception set if `obj` is no C-contiguous
+  // buffer of T, or not writable when asked.
+  bool Acquire(PyObject *obj, const char *name, bool writable = false) {
+    int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT |
+                (writable ? PyBUF_WRITABLE : 0);
+    if (PyObject_GetBuffer(obj, &view_, flags) < 0) {
+      PyErr_Format(PyExc_TypeError,
+                   "%s must be a C-contiguous%s buffer of %s%zu", name,
+                   writable ? " writable" : "", BufferFormat<T>::kName,
+                   sizeof(T) * 8);
+      return false;
+    }
+    acquired_ = true;
+    const char *format = view_.format == NULL ? "B" : view_.format;
+    // native byte order only
+    if (*format == '@' || *format == '=' || *format == '<') {
+      ++format;
+    }
+    if (view_.itemsize != static_cast<Py_ssize_t>(sizeof(T)) ||
+        std::strlen(format) != 1 ||
+        std::strchr(BufferFormat<T>::kChars, *format) == NULL) {
+      PyErr_Format(PyExc_TypeError, "%s must hold %s%zu, got format '%s'",
+                   name, BufferFormat<T>::kName, sizeof(T) * 8, view_.format);
+      return false;
+    }
+    return true;
+  }
+
+  T *data() const { return static_cast<T *>(view_.buf); }
+  int64_t size() const { return view_.len / static_cast<Py_ssize_t>(sizeof(T)); }
+  int ndim() const { return view_.ndim; }
+  int64_t shape(int dim) const {
+    return view_.shape == NULL ? size() : view_.shape[dim];
+  }
+
+private:
+  Py_buffer view_{};
+  bool acquired_{false};
+};
+
+#endif // VLLM_MINDSPORE_CSRC_HOST_BUFFER_UTILS_H
@@ -0,0 +1,137 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "host/module.h"
+
+// BufferView: a flat byte view over the buffer of another object, without a
+// copy. It holds the exporter's buffer, and optionally another owner, for as
+// long as the view or any memoryview / ndarray made from it is alive.
+//
+// Tensor serialization uses it both ways:
+// - encode: a read-only view over the host memory of a tensor, which keeps
+//   the tensor alive until the message is sent;
+// - decode: a view over a received message buffer, so that numpy and
+//   MindSpore build tensors over it in place, tied to the message. The view
+//   is only writable when the buffer is.
+namespace {
+struct BufferViewObject {
+  PyObject_HEAD Py_buffer view;
+  PyObject *owner;
+  int readonly;
+};
+
+void BufferViewDealloc(PyObject *self) {
+  auto *buf = reinterpret_cast<BufferViewObject *>(self);
+  PyBuffer_Release(&buf->view);
+  Py_XDECREF(buf->owner);
+  Py_TYPE(self)->tp_free(self);
+}
+
+int BufferViewGetBuffer(PyObject *self, Py_buffer *view, int flags) {
+  auto *buf = reinterpret_cast<BufferViewObject *>(self);
+  return PyBuffer_FillInfo(view, self, buf->view.buf, buf->view.len,
+                           buf->readonly, flags);
+}
+
+Py_ssize_t BufferViewLength(PyObject *self) {
+  return reinterpret_cast<BufferViewObject *>(self)->view.len;
+}
+
+PyObject *BufferViewRepr(PyObject *self) {
+  auto *buf = reinterpret_cast<BufferViewObject *>(self);
+  return PyUnicode_FromFormat("BufferView(nbytes=%zd, readonly=%s)",
+                              buf->view.len,
+                              buf->readonly ? "True" : "False");
+}
+
+PyObject *BufferViewGetReadonly(PyObject *self, void *) {
+  return PyBool_FromLong(reinterpret_cast<BufferViewObject *>(self)->readonly);
+}
+
+PyBufferProcs buffer_view_as_buffer = {BufferViewGetBuffer, NULL};
+
+PySequenceMethods buffer_view_as_sequence = {BufferViewLength};
+
+PyGetSetDef buffer_view_getset[] = {
+    {"readonly", BufferViewGetReadonly, NULL, "Whether the view is read-only",
+     NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+PyTypeObject BufferViewType = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+const char kBufferViewDoc[] =
+    "buffer_view(obj, *, owner=None, writable=False)\n"
+    "--\n\n"
+    "Flat byte view over the C-contiguous buffer of `obj`, without a copy.\n"
+    "`owner` is kept alive along with `obj`, e.g. the tensor whose host\n"
+    "memory `obj` exposes. With `writable`, the view is writable, and\n"
+    "BufferError is raised when `obj` is not.";
+
+PyObject *BufferView(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"obj", "owner", "writable", NULL};
+  PyObject *obj = NULL;
+  PyObject *owner = Py_None;
+  int writable = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$Op:buffer_view",
+                                   const_cast<char **>(kwlist), &obj, &owner,
+                                   &writable)) {
+    return NULL;
+  }
+  auto *buf = PyObject_New(BufferViewObject, &BufferViewType);
+  if (buf == NULL) {
+    return NULL;
+  }
+  // No PyBUF_FORMAT: the dtype of the exporter does not matter, and numpy
+  // refuses to describe some of them (bfloat16) in a format string.
+  int flags = PyBUF_C_CONTIGUOUS | (writable ? PyBUF_WRITABLE : 0);
+  if (PyObject_GetBuffer(obj, &buf->view, flags) < 0) {
+    buf->owner = NULL;
+    buf->view.obj = NULL;
+    Py_DECREF(buf);
+    return NULL;
+  }
+  Py_INCREF(owner);
+  buf->owner = owner;
+  buf->readonly = writable ? 0 : 1;
+  return reinterpret_cast<PyObject *>(buf);
+}
+
+PyMethodDef buffer_view_methods[] = {
+    {"buffer_view", reinterpret_cast<PyCFunction>(BufferView),
+     METH_VARARGS | METH_KEYWORDS, kBufferViewDoc},
+    {NULL, NULL, 0, NULL}};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  BufferViewType.tp_name = "vllm_mindspore._C_host.BufferView";
+  BufferViewType.tp_basicsize = sizeof(BufferViewObject);
+  BufferViewType.tp_dealloc = BufferViewDealloc;
+  BufferViewType.tp_repr = BufferViewRepr;
+  BufferViewType.tp_as_sequence = &buffer_view_as_sequence;
+  BufferViewType.tp_as_buffer = &buffer_view_as_buffer;
+  BufferViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+  BufferViewType.tp_doc = "Flat byte view over the buffer of another object";
+  BufferViewType.tp_getset = buffer_view_getset;
+  if (PyType_Ready(&BufferViewType) < 0) {
+    return -1;
+  }
+  Py_INCREF(&BufferViewType);
+  if (PyModule_AddObject(m, "BufferView",
+                         reinterpret_cast<PyObject *>(&BufferViewType)) < 0) {
+    Py_DECREF(&BufferViewType);
+    return -1;
+  }
+  return PyModule_AddFunctions(m, buffer_view_methods);
+}
@@ -0,0 +1,543 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "host/module.h"
+#include "host/thread_pool.h"
+
+// HostBlockPool: fixed-size KV cache blocks in host memory, the host tier
+// KV cache blocks are swapped out to and in from.
+//
+// A block holds the bytes of one device block of every layer, back to back,
+// its row in a slab aligned to a cache line. Slabs of blocks_per_slab blocks
+// are mapped anonymous on first use, so that a large pool costs no memory
+// until blocks are written, and with `lock` are locked in RAM: no page of a
+// swapped out block is paged out nor faults on the copy back. Block ids come
+// from a free list, LIFO so that recently freed blocks, already faulted in,
+// are reused first, or are claimed as another pool hands them out: the
+// worker pool mirrors the ids of the scheduler's.
+//
+// write and read copy a batch of allocated blocks, one part of each at a
+// byte offset, e.g. the key cache of one layer, from and to a C-contiguous
+// buffer of the parts back to back: the contiguous batch a device gather
+// produces or a device scatter consumes. The copies run with the GIL released, split
+// across threads of the host pool, or with `copy_threads` of a pool of their
+// own: a swap of hundreds of MB in the background then does not hold up the
+// host helpers of the step.
+namespace {
+constexpr int64_t kAlignment = 64;
+// default bytes of a slab, mapped and locked at once
+constexpr int64_t kSlabBytes = 256 * 1024 * 1024;
+// bytes a thread of a copy copies at least
+constexpr int64_t kMinTaskBytes = 2 * 1024 * 1024;
+
+class HostBlockPool {
+public:
+  HostBlockPool(int64_t num_blocks, int64_t block_bytes,
+                int64_t blocks_per_slab, bool lock, int copy_threads)
+      : num_blocks_(num_blocks), block_bytes_(block_bytes),
+        stride_((block_bytes + kAlignment - 1) / kAlignment * kAlignment),
+        lock_(lock), allocated_(num_blocks, false) {
+    if (copy_threads > 0) {
+      copy_pool_ = std::make_unique<HostThreadPool>(copy_threads - 1);
+    }
+    if (blocks_per_slab <= 0) {
+      blocks_per_slab =
+          stride_ == 0 ? num_blocks : std::max<int64_t>(1, kSlabBytes / stride_);
+    }
+    blocks_per_slab_ = std::max<int64_t>(
+        1, std::min<int64_t>(blocks_per_slab, num_blocks));
+    slabs_.assign((num_blocks + blocks_per_slab_ - 1) / blocks_per_slab_,
+                  nullptr);
+    free_.reserve(num_blocks);
+    for (int64_t id = num_blocks - 1; id >= 0; --id) {
+      free_.push_back(id);
+    }
+  }
+
+  ~HostBlockPool() {
+    for (size_t slab = 0; slab < slabs_.size(); ++slab) {
+      if (slabs_[slab] != nullptr) {
+        munmap(slabs_[slab], SlabBytes(slab));
+      }
+    }
+  }
+
+  // Disable copy and assignment
+  HostBlockPool(const HostBlockPool &) = delete;
+  HostBlockPool &operator=(const HostBlockPool &) = delete;
+
+  int64_t num_blocks() const { return num_blocks_; }
+  int64_t block_bytes() const { return block_bytes_; }
+  int64_t num_free() const { return static_cast<int64_t>(free_.size()); }
+  int64_t mapped_bytes() const { return mapped_bytes_; }
+
+  bool Allocate(int64_t num, std::vector<int64_t> *ids) {
+    if (num > num_free()) {
+      return false;
+    }
+    ids->resize(num);
+    for (int64_t i = 0; i < num; ++i) {
+      int64_t id = free_.back();
+      free_.pop_back();
+      allocated_[id] = true;
+      (*ids)[i] = id;
+    }
+    return true;
+  }
+
+  // Free all of ids, or none of them when one is out of range or not
+  // allocated, returning the index of that one
+  int64_t Free(const std::vector<int64_t> &ids) {
+    for (size_t i = 0; i < ids.size(); ++i) {
+      int64_t id = ids[i];
+      if (id < 0 || id >= num_blocks_ || !allocated_[id]) {
+        for (size_t j = 0; j < i; ++j) {
+          allocated_[ids[j]] = true;
+        }
+        return static_cast<int64_t>(i);
+      }
+      allocated_[id] = false;
+    }
+    free_.insert(free_.end(), ids.rbegin(), ids.rend());
+    return -1;
+  }
+
+  // Take exactly ids off the free list, those another pool allocated when
+  // this one mirrors it, or none of them when one is out of range or
+  // allocated, returning the index of that one
+  int64_t Claim(const std::vector<int64_t> &ids) {
+    for (size_t i = 0; i < ids.size(); ++i) {
+      int64_t id = ids[i];
+      if (id < 0 || id >= num_blocks_ || allocated_[id]) {
+        for (size_t j = 0; j < i; ++j) {
+          allocated_[ids[j]] = false;
+        }
+        return static_cast<int64_t>(i);
+      }
+      allocated_[id] = true;
+    }
+    if (!ids.empty()) {
+      free_.erase(std::remove_if(free_.begin(), free_.end(),
+                                 [this](int64_t id) { return allocated_[id]; }),
+                  free_.end());
+    }
+    return -1;
+  }
+
+  bool IsAllocated(int64_t id) const { return allocated_[id]; }
+
+  // Map the slabs of ids not mapped yet; false with errno set on failure
+  bool MapSlabs(const std::vector<int64_t> &ids) {
+    for (int64_t id : ids) {
+      size_t slab = static_cast<size_t>(id / blocks_per_slab_);
+      if (slabs_[slab] != nullptr) {
+        continue;
+      }
+      size_t bytes = SlabBytes(slab);
+      void *addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (addr == MAP_FAILED) {
+        return false;
+      }
+#ifdef MADV_HUGEPAGE
+      // fewer TLB misses on the copies, at no cost if THP is off
+      madvise(addr, bytes, MADV_HUGEPAGE);
+#endif
+      if (lock_ && mlock(addr, bytes) != 0) {
+        int error = errno;
+        munmap(addr, bytes);
+        errno = error;
+        return false;
+      }
+      slabs_[slab] = static_cast<uint8_t *>(addr);
+      mapped_bytes_ += static_cast<int64_t>(bytes);
+    }
+    return true;
+  }
+
+  // Copy part bytes of every block of ids at offset from (to_blocks) or to
+  // buf, the parts back to back in the order of ids. The slabs are mapped.
+  void Copy(const std::vector<int64_t> &ids, int64_t offset, int64_t part,
+            uint8_t *buf, bool to_blocks, int num_threads) const {
+    auto num = static_cast<int64_t>(ids.size());
+    int64_t total = num * part;
+    HostThreadPool &thread_pool =
+        copy_pool_ != nullptr ? *copy_pool_ : HostThreadPool::Instance();
+    int max_threads = num_threads <= 0 ? thread_pool.NumThreads() : num_threads;
+    int64_t num_tasks = std::max<int64_t>(
+        1, std::min<int64_t>({num, total / kMinTaskBytes, 4 * max_threads}));
+    int64_t task_blocks = (num + num_tasks - 1) / num_tasks;
+    thread_pool.ParallelFor(
+        num_tasks, num_threads, [&](int64_t task) {
+          int64_t end = std::min(num, (task + 1) * task_blocks);
+          for (int64_t i = task * task_blocks; i < end; ++i) {
+            uint8_t *block = Block(ids[i]) + offset;
+            if (to_blocks) {
+              std::memcpy(block, buf + i * part, part);
+            } else {
+              std::memcpy(buf + i * part, block, part);
+            }
+          }
+        });
+  }
+
+private:
+  size_t SlabBytes(size_t slab) const {
+    int64_t blocks = std::min<int64_t>(
+        blocks_per_slab_, num_blocks_ - static_cast<int64_t>(slab) *
+                                            blocks_per_slab_);
+    return static_cast<size_t>(blocks * stride_);
+  }
+
+  uint8_t *Block(int64_t id) const {
+    return slabs_[id / blocks_per_slab_] + (id % blocks_per_slab_) * stride_;
+  }
+
+  int64_t num_blocks_;
+  int64_t block_bytes_;
+  int64_t stride_;
+  int64_t blocks_per_slab_{1};
+  bool lock_;
+  int64_t mapped_bytes_{0};
+  std::vector<uint8_t *> slabs_;
+  std::vector<int64_t> free_;
+  std::vector<bool> allocated_;
+  // threads of the copies, the shared host pool when null
+  std::unique_ptr<HostThreadPool> copy_pool_;
+};
+
+struct HostBlockPoolObject {
+  PyObject_HEAD HostBlockPool *pool;
+};
+
+void HostBlockPoolDealloc(PyObject *self) {
+  delete reinterpret_cast<HostBlockPoolObject *>(self)->pool;
+  Py_TYPE(self)->tp_free(self);
+}
+
+int HostBlockPoolInit(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"num_blocks",      "block_bytes",
+                                 "blocks_per_slab", "lock",
+                                 "copy_threads",    NULL};
+  auto *obj = reinterpret_cast<HostBlockPoolObject *>(self);
+  Py_ssize_t num_blocks = 0;
+  Py_ssize_t block_bytes = 0;
+  Py_ssize_t blocks_per_slab = 0;
+  int lock = 0;
+  int copy_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn|$npi:HostBlockPool",
+                                   const_cast<char **>(kwlist), &num_blocks,
+                                   &block_bytes, &blocks_per_slab, &lock,
+                                   &copy_threads)) {
+    return -1;
+  }
+  if (obj->pool != NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "HostBlockPool is initialized");
+    return -1;
+  }
+  if (num_blocks < 0 || block_bytes < 0) {
+    PyErr_Format(PyExc_ValueError,
+                 "invalid pool of %zd blocks of %zd bytes", num_blocks,
+                 block_bytes);
+    return -1;
+  }
+  obj->pool = new HostBlockPool(num_blocks, block_bytes, blocks_per_slab,
+                                lock != 0, copy_threads);
+  return 0;
+}
+
+HostBlockPool *GetPool(PyObject *self) {
+  auto *pool = reinterpret_cast<HostBlockPoolObject *>(self)->pool;
+  if (pool == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "HostBlockPool is not initialized");
+  }
+  return pool;
+}
+
+bool ParseBlockIds(PyObject *obj, std::vector<int64_t> *ids) {
+  PyObject *seq = PySequence_Fast(obj, "block_ids must be a sequence");
+  if (seq == NULL) {
+    return false;
+  }
+  Py_ssize_t num = PySequence_Fast_GET_SIZE(seq);
+  PyObject **items = PySequence_Fast_ITEMS(seq);
+  ids->resize(num);
+  for (Py_ssize_t i = 0; i < num; ++i) {
+    (*ids)[i] = PyLong_AsLongLong(items[i]);
+    if ((*ids)[i] == -1 && PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return false;
+    }
+  }
+  Py_DECREF(seq);
+  return true;
+}
+
+PyObject *BlockIdList(const std::vector<int64_t> &ids) {
+  PyObject *list = PyList_New(static_cast<Py_ssize_t>(ids.size()));
+  if (list == NULL) {
+    return NULL;
+  }
+  for (size_t i = 0; i < ids.size(); ++i) {
+    PyObject *id = PyLong_FromLongLong(ids[i]);
+    if (id == NULL) {
+      Py_DECREF(list);
+      return NULL;
+    }
+    PyList_SET_ITEM(list, i, id);
+  }
+  return list;
+}
+
+PyObject *HostBlockPoolAllocate(PyObject *self, PyObject *arg) {
+  auto *pool = GetPool(self);
+  if (pool == NULL) {
+    return NULL;
+  }
+  Py_ssize_t num = PyLong_AsSsize_t(arg);
+  if (num == -1 && PyErr_Occurred()) {
+    return NULL;
+  }
+  if (num < 0) {
+    PyErr_Format(PyExc_ValueError, "cannot allocate %zd blocks", num);
+    return NULL;
+  }
+  std::vector<int64_t> ids;
+  if (!pool->Allocate(num, &ids)) {
+    PyErr_Format(PyExc_MemoryError, "%zd blocks requested, %lld free", num,
+                 static_cast<long long>(pool->num_free()));
+    return NULL;
+  }
+  return BlockIdList(ids);
+}
+
+PyObject *HostBlockPoolFree(PyObject *self, PyObject *arg) {
+  auto *pool = GetPool(self);
+  if (pool == NULL) {
+    return NULL;
+  }
+  std::vector<int64_t> ids;
+  if (!ParseBlockIds(arg, &ids)) {
+    return NULL;
+  }
+  int64_t bad = pool->Free(ids);
+  if (bad >= 0) {
+    PyErr_Format(PyExc_ValueError, "block %lld is not allocated",
+                 static_cast<long long>(ids[bad]));
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject *HostBlockPoolClaim(PyObject *self, PyObject *arg) {
+  auto *pool = GetPool(self);
+  if (pool == NULL) {
+    return NULL;
+  }
+  std::vector<int64_t> ids;
+  if (!ParseBlockIds(arg, &ids)) {
+    return NULL;
+  }
+  int64_t bad = pool->Claim(ids);
+  if (bad >= 0) {
+    PyErr_Format(PyExc_ValueError, "block %lld is not free",
+                 static_cast<long long>(ids[bad]));
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+// write and read: block ids and the buffer of their parts, checked against
+// the pool, with the slabs of the blocks mapped
+PyObject *HostBlockPoolCopy(PyObject *self, PyObject *args, PyObject *kwargs,
+                            bool to_blocks) {
+  static const char *kwlist[] = {"block_ids", "buf", "offset", "num_threads",
+                                 NULL};
+  auto *pool = GetPool(self);
+  if (pool == NULL) {
+    return NULL;
+  }
+  PyObject *block_ids = NULL;
+  PyObject *buf = NULL;
+  Py_ssize_t offset = 0;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, to_blocks ? "OO|$ni:write" : "OO|$ni:read",
+          const_cast<char **>(kwlist), &block_ids, &buf, &offset,
+          &num_threads)) {
+    return NULL;
+  }
+  std::vector<int64_t> ids;
+  if (!ParseBlockIds(block_ids, &ids)) {
+    return NULL;
+  }
+  for (int64_t id : ids) {
+    if (id < 0 || id >= pool->num_blocks()) {
+      PyErr_Format(PyExc_IndexError, "block %lld out of range [0, %lld)",
+                   static_cast<long long>(id),
+                   static_cast<long long>(pool->num_blocks()));
+      return NULL;
+    }
+    if (!pool->IsAllocated(id)) {
+      PyErr_Format(PyExc_ValueError, "block %lld is not allocated",
+                   static_cast<long long>(id));
+      return NULL;
+    }
+  }
+  // No PyBUF_FORMAT: numpy does not describe some dtypes (bfloat16) in a
+  // format string, and only the bytes matter here.
+  Py_buffer view;
+  int flags = PyBUF_C_CONTIGUOUS | (to_blocks ? 0 : PyBUF_WRITABLE);
+  if (PyObject_GetBuffer(buf, &view, flags) < 0) {
+    return NULL;
+  }
+  auto num = static_cast<int64_t>(ids.size());
+  int64_t part = num == 0 ? 0 : view.len / num;
+  if (part * num != view.len || offset < 0 ||
+      offset + part > pool->block_bytes()) {
+    PyErr_Format(PyExc_ValueError,
+                 "buf of %zd bytes is not %lld parts within blocks of %lld "
+                 "bytes from offset %zd",
+                 view.len, static_cast<long long>(num),
+                 static_cast<long long>(pool->block_bytes()), offset);
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  if (!pool->MapSlabs(ids)) {
+    PyErr_Format(PyExc_MemoryError, "cannot map a slab of the pool: %s",
+                 std::strerror(errno));
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  if (part > 0) {
+    Py_BEGIN_ALLOW_THREADS;
+    pool->Copy(ids, offset, part, static_cast<uint8_t *>(view.buf), to_blocks,
+               num_threads);
+    Py_END_ALLOW_THREADS;
+  }
+  PyBuffer_Release(&view);
+  Py_RETURN_NONE;
+}
+
+PyObject *HostBlockPoolWrite(PyObject *self, PyObject *args,
+                             PyObject *kwargs) {
+  return HostBlockPoolCopy(self, args, kwargs, true);
+}
+
+PyObject *HostBlockPoolRead(PyObject *self, PyObject *args,
+                            PyObject *kwargs) {
+  return HostBlockPoolCopy(self, args, kwargs, false);
+}
+
+PyObject *HostBlockPoolNumBlocks(PyObject *self, void *) {
+  auto *pool = GetPool(self);
+  return pool == NULL ? NULL : PyLong_FromLongLong(pool->num_blocks());
+}
+
+PyObject *HostBlockPoolBlockBytes(PyObject *self, void *) {
+  auto *pool = GetPool(self);
+  return pool == NULL ? NULL : PyLong_FromLongLong(pool->block_bytes());
+}
+
+PyObject *HostBlockPoolNumFree(PyObject *self, void *) {
+  auto *pool = GetPool(self);
+  return pool == NULL ? NULL : PyLong_FromLongLong(pool->num_free());
+}
+
+PyObject *HostBlockPoolMappedBytes(PyObject *self, void *) {
+  auto *pool = GetPool(self);
+  return pool == NULL ? NULL : PyLong_FromLongLong(pool->mapped_bytes());
+}
+
+PyMethodDef host_block_pool_methods[] = {
+    {"allocate", HostBlockPoolAllocate, METH_O,
+     "allocate(num) -> list[int]\n\n"
+     "Take `num` block ids from the free list; MemoryError, with none\n"
+     "taken, if fewer are free."},
+    {"free", HostBlockPoolFree, METH_O,
+     "free(block_ids)\n\n"
+     "Return the blocks to the free list; ValueError, with none returned,\n"
+     "if one is not allocated."},
+    {"claim", HostBlockPoolClaim, METH_O,
+     "claim(block_ids)\n\n"
+     "Take exactly these blocks off the free list, in a pool that mirrors\n"
+     "the allocations of another; ValueError, with none taken, if one is\n"
+     "not free."},
+    {"write", reinterpret_cast<PyCFunction>(HostBlockPoolWrite),
+     METH_VARARGS | METH_KEYWORDS,
+     "write(block_ids, buf, *, offset=0, num_threads=0)\n\n"
+     "Copy the C-contiguous buffer `buf`, len(block_ids) parts of equal\n"
+     "size back to back, into the allocated blocks, each part at byte\n"
+     "`offset` of its block. The copy runs on up to `num_threads` threads of\n"
+     "the host pool, or of the pool of the copies with `copy_threads`, 0\n"
+     "for all of them; ValueError if a block is not allocated."},
+    {"read", reinterpret_cast<PyCFunction>(HostBlockPoolRead),
+     METH_VARARGS | METH_KEYWORDS,
+     "read(block_ids, buf, *, offset=0, num_threads=0)\n\n"
+     "Copy the parts of the blocks at byte `offset` into the C-contiguous\n"
+     "writable buffer `buf`, back to back; the inverse of write."},
+    {NULL, NULL, 0, NULL}};
+
+PyGetSetDef host_block_pool_getset[] = {
+    {"num_blocks", HostBlockPoolNumBlocks, NULL, "Blocks of the pool.", NULL},
+    {"block_bytes", HostBlockPoolBlockBytes, NULL, "Bytes of a block.", NULL},
+    {"num_free", HostBlockPoolNumFree, NULL, "Blocks on the free list.", NULL},
+    {"mapped_bytes", HostBlockPoolMappedBytes, NULL,
+     "Bytes of the slabs mapped so far.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+PyTypeObject HostBlockPoolType = {PyVarObject_HEAD_INIT(NULL, 0)};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  HostBlockPoolType.tp_name = "vllm_mindspore._C_host.HostBlockPool";
+  HostBlockPoolType.tp_basicsize = sizeof(HostBlockPoolObject);
+  HostBlockPoolType.tp_dealloc = HostBlockPoolDealloc;
+  HostBlockPoolType.tp_flags = Py_TPFLAGS_DEFAULT;
+  HostBlockPoolType.tp_doc =
+      "HostBlockPool(num_blocks, block_bytes, *, blocks_per_slab=0, "
+      "lock=False, copy_threads=0)\n\n"
+      "`num_blocks` blocks of `block_bytes` bytes in host memory, mapped a\n"
+      "slab of `blocks_per_slab` blocks at a time on first write or read, 0\n"
+      "for slabs of 256MiB, and with `lock` locked in RAM. With block_bytes\n"
+      "0 the pool only hands out block ids. With `copy_threads`, write and\n"
+      "read run on a pool of that many threads of their own, rather than on\n"
+      "the host pool the other helpers share.";
+  HostBlockPoolType.tp_methods = host_block_pool_methods;
+  HostBlockPoolType.tp_getset = host_block_pool_getset;
+  HostBlockPoolType.tp_init = HostBlockPoolInit;
+  HostBlockPoolType.tp_new = PyType_GenericNew;
+  if (PyType_Ready(&HostBlockPoolType) < 0) {
+    return -1;
+  }
+  Py_INCREF(&HostBlockPoolType);
+  if (PyModule_AddObject(m, "HostBlockPool",
+                         reinterpret_cast<PyObject *>(&HostBlockPoolType)) <
+      0) {
+    Py_DECREF(&HostBlockPoolType);
+    return -1;
+  }
+  return 0;
+}
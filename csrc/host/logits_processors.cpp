@@ -0,0 +1,336 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "host/buffer_utils.h"
+#include "host/module.h"
+#include "host/thread_pool.h"
+
+// apply_logits_processors: the built-in logits processors of
+// vllm_mindspore.logits_process, applied to every row of a batch of logits
+// at once instead of one Python call per row and processor.
+//
+// Both the token ids of the rows and their processors are packed CSR-style:
+// row r owns the tokens [token_offsets[r], token_offsets[r + 1]), its
+// prompt_lens[r] prompt tokens followed by its output tokens, and the ops
+// [op_offsets[r], op_offsets[r + 1]), applied in order. Op i has a kind, up
+// to three float parameters and the token ids [op_token_offsets[i],
+// op_token_offsets[i + 1]):
+// - kPenalties (repetition, presence, frequency): x / repetition if x > 0
+//   else x * repetition for every token of the prompt or the output, then
+//   x - frequency * count - presence for every output token, as the
+//   sampler's apply_penalties;
+// - kBadWords: the words, each as its length then its ids; the last token of
+//   a word is masked when the output ends with the rest of it, always for
+//   single-token words;
+// - kMinTokens (min_tokens): the stop token ids, masked while the output is
+//   shorter than min_tokens;
+// - kAllowedTokens: the allowed token ids, every other token is masked.
+// Masked logits are set to -inf. Token ids outside the vocabulary are
+// ignored. The rows are split across threads of the host pool.
+namespace {
+enum LogitsOpKind : int32_t {
+  kPenalties = 0,
+  kBadWords = 1,
+  kMinTokens = 2,
+  kAllowedTokens = 3,
+};
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+struct LogitsProcessorsArgs {
+  float *logits;
+  int64_t vocab_size;
+  const int32_t *token_ids;
+  const int64_t *token_offsets;
+  const int32_t *prompt_lens;
+  const int64_t *op_offsets;
+  const int32_t *op_kinds;
+  const float *op_params;
+  const int64_t *op_token_offsets;
+  const int32_t *op_token_ids;
+};
+
+// Scratch buffers of one thread, kept across rows
+struct RowScratch {
+  std::vector<int32_t> output;
+  std::vector<int32_t> seen;
+  std::vector<float> kept;
+};
+
+// Sorted ids of `tokens` inside the vocabulary
+void SortedInVocab(const int32_t *begin, const int32_t *end, int64_t vocab_size,
+                   std::vector<int32_t> *sorted) {
+  sorted->clear();
+  for (const int32_t *t = begin; t < end; ++t) {
+    if (*t >= 0 && *t < vocab_size) {
+      sorted->push_back(*t);
+    }
+  }
+  std::sort(sorted->begin(), sorted->end());
+}
+
+void ApplyPenalties(float *row, int64_t vocab_size, const int32_t *prompt,
+                    const int32_t *output, const int32_t *output_end,
+                    const float *params, RowScratch *scratch) {
+  float repetition = params[0];
+  float presence = params[1];
+  float frequency = params[2];
+  SortedInVocab(output, output_end, vocab_size, &scratch->output);
+  const auto &out = scratch->output;
+  if (repetition != 1.0f) {
+    // every distinct token of the prompt and the output once
+    SortedInVocab(prompt, output_end, vocab_size, &scratch->seen);
+    auto &seen = scratch->seen;
+    seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+    for (int32_t t : seen) {
+      float x = row[t];
+      row[t] = x > 0.0f ? x / repetition : x * repetition;
+    }
+  }
+  if (presence == 0.0f && frequency == 0.0f) {
+    return;
+  }
+  for (size_t i = 0; i < out.size();) {
+    size_t j = i + 1;
+    while (j < out.size() && out[j] == out[i]) {
+      ++j;
+    }
+    float count = static_cast<float>(j - i);
+    row[out[i]] = (row[out[i]] - frequency * count) - presence;
+    i = j;
+  }
+}
+
+void ApplyBadWords(float *row, int64_t vocab_size, const int32_t *output,
+                   int64_t num_output, const int32_t *words,
+                   const int32_t *words_end) {
+  while (words < words_end) {
+    int64_t length = *words++;
+    if (length <= 0 || length > words_end - words) {
+      return;
+    }
+    const int32_t *word = words;
+    words += length;
+    int64_t prefix = length - 1;
+    if (prefix > num_output ||
+        !std::equal(word, word + prefix, output + num_output - prefix)) {
+      continue;
+    }
+    int32_t last = word[prefix];
+    if (last >= 0 && last < vocab_size) {
+      row[last] = kNegInf;
+    }
+  }
+}
+
+void ApplyAllowedTokens(float *row, int64_t vocab_size, const int32_t *allowed,
+                        const int32_t *allowed_end, RowScratch *scratch) {
+  auto &kept = scratch->kept;
+  kept.clear();
+  for (const int32_t *t = allowed; t < allowed_end; ++t) {
+    kept.push_back(*t >= 0 && *t < vocab_size ? row[*t] : 0.0f);
+  }
+  // one pass over the row the compiler vectorizes, then the allowed tokens
+  // back
+  std::fill(row, row + vocab_size, kNegInf);
+  for (const int32_t *t = allowed; t < allowed_end; ++t) {
+    if (*t >= 0 && *t < vocab_size) {
+      row[*t] = kept[t - allowed];
+    }
+  }
+}
+
+void ProcessRow(const LogitsProcessorsArgs &args, int64_t r,
+                RowScratch *scratch) {
+  float *row = args.logits + r * args.vocab_size;
+  const int32_t *prompt = args.token_ids + args.token_offsets[r];
+  const int32_t *output = prompt + args.prompt_lens[r];
+  const int32_t *output_end = args.token_ids + args.token_offsets[r + 1];
+  int64_t num_output = output_end - output;
+  for (int64_t op = args.op_offsets[r]; op < args.op_offsets[r + 1]; ++op) {
+    const float *params = args.op_params + op * 3;
+    const int32_t *ids = args.op_token_ids + args.op_token_offsets[op];
+    const int32_t *ids_end = args.op_token_ids + args.op_token_offsets[op + 1];
+    switch (args.op_kinds[op]) {
+    case kPenalties:
+      ApplyPenalties(row, args.vocab_size, prompt, output, output_end, params,
+                     scratch);
+      break;
+    case kBadWords:
+      ApplyBadWords(row, args.vocab_size, output, num_output, ids, ids_end);
+      break;
+    case kMinTokens:
+      if (static_cast<float>(num_output) < params[0]) {
+        for (const int32_t *t = ids; t < ids_end; ++t) {
+          if (*t >= 0 && *t < args.vocab_size) {
+            row[*t] = kNegInf;
+          }
+        }
+      }
+      break;
+    case kAllowedTokens:
+      ApplyAllowedTokens(row, args.vocab_size, ids, ids_end, scratch);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// Offsets must start at 0, not decrease, and end within `limit`
+bool CheckOffsets(const TypedBuffer<int64_t> &offsets, int64_t count,
+                  int64_t limit, const char *name) {
+  if (offsets.size() != count + 1 || offsets.data()[0] != 0 ||
+      offsets.data()[count] > limit) {
+    PyErr_Format(PyExc_ValueError,
+                 "apply_logits_processors: %s must be [%lld] offsets from 0 "
+                 "to at most %lld",
+                 name, static_cast<long long>(count + 1),
+                 static_cast<long long>(limit));
+    return false;
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    if (offsets.data()[i + 1] < offsets.data()[i]) {
+      PyErr_Format(PyExc_ValueError,
+                   "apply_logits_processors: %s must not decrease", name);
+      return false;
+    }
+  }
+  return true;
+}
+
+const char kApplyLogitsProcessorsDoc[] =
+    "apply_logits_processors(logits, token_ids, token_offsets, prompt_lens,\n"
+    "                        op_offsets, op_kinds, op_params,\n"
+    "                        op_token_offsets, op_token_ids, *,\n"
+    "                        num_threads=0)\n"
+    "--\n\n"
+    "Apply the built-in logits processors of every row in place.\n"
+    "logits: float32 [num_rows, vocab_size]; token_ids: int32, the prompt\n"
+    "then the output tokens of each row, split by token_offsets: int64\n"
+    "[num_rows + 1]; prompt_lens: int32 [num_rows]; op_offsets: int64\n"
+    "[num_rows + 1], the ops of each row, in order, with op_kinds: int32\n"
+    "[num_ops] (0 penalties, 1 bad words, 2 min tokens, 3 allowed tokens),\n"
+    "op_params: float32 [num_ops, 3] and op_token_ids: int32, split by\n"
+    "op_token_offsets: int64 [num_ops + 1]. The rows are split across up to\n"
+    "num_threads threads of the host pool, 0 for all of them.";
+
+PyObject *ApplyLogitsProcessors(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"logits",
+                                 "token_ids",
+                                 "token_offsets",
+                                 "prompt_lens",
+                                 "op_offsets",
+                                 "op_kinds",
+                                 "op_params",
+                                 "op_token_offsets",
+                                 "op_token_ids",
+                                 "num_threads",
+                                 NULL};
+  PyObject *objs[9];
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "OOOOOOOOO|$i:apply_logits_processors",
+          const_cast<char **>(kwlist), &objs[0], &objs[1], &objs[2], &objs[3],
+          &objs[4], &objs[5], &objs[6], &objs[7], &objs[8], &num_threads)) {
+    return NULL;
+  }
+  TypedBuffer<float> logits, op_params;
+  TypedBuffer<int32_t> token_ids, prompt_lens, op_kinds, op_token_ids;
+  TypedBuffer<int64_t> token_offsets, op_offsets, op_token_offsets;
+  if (!logits.Acquire(objs[0], "logits", true) ||
+      !token_ids.Acquire(objs[1], "token_ids") ||
+      !token_offsets.Acquire(objs[2], "token_offsets") ||
+      !prompt_lens.Acquire(objs[3], "prompt_lens") ||
+      !op_offsets.Acquire(objs[4], "op_offsets") ||
+      !op_kinds.Acquire(objs[5], "op_kinds") ||
+      !op_params.Acquire(objs[6], "op_params") ||
+      !op_token_offsets.Acquire(objs[7], "op_token_offsets") ||
+      !op_token_ids.Acquire(objs[8], "op_token_ids")) {
+    return NULL;
+  }
+  if (logits.ndim() != 2) {
+    PyErr_SetString(PyExc_ValueError,
+                    "apply_logits_processors: logits must be 2-D");
+    return NULL;
+  }
+  int64_t num_rows = logits.shape(0);
+  int64_t num_ops = op_kinds.size();
+  if (prompt_lens.size() != num_rows || op_params.size() != num_ops * 3) {
+    PyErr_SetString(PyExc_ValueError,
+                    "apply_logits_processors: prompt_lens must be [num_rows] "
+                    "and op_params [num_ops, 3]");
+    return NULL;
+  }
+  if (!CheckOffsets(token_offsets, num_rows, token_ids.size(),
+                    "token_offsets") ||
+      !CheckOffsets(op_offsets, num_rows, num_ops, "op_offsets") ||
+      !CheckOffsets(op_token_offsets, num_ops, op_token_ids.size(),
+                    "op_token_offsets")) {
+    return NULL;
+  }
+  for (int64_t r = 0; r < num_rows; ++r) {
+    int32_t prompt_len = prompt_lens.data()[r];
+    if (prompt_len < 0 || prompt_len > token_offsets.data()[r + 1] -
+                                           token_offsets.data()[r]) {
+      PyErr_Format(PyExc_ValueError,
+                   "apply_logits_processors: row %lld has a prompt of %d "
+                   "tokens out of its token_ids",
+                   static_cast<long long>(r), prompt_len);
+      return NULL;
+    }
+  }
+
+  LogitsProcessorsArgs process_args{logits.data(),
+                                    logits.shape(1),
+                                    token_ids.data(),
+                                    token_offsets.data(),
+                                    prompt_lens.data(),
+                                    op_offsets.data(),
+                                    op_kinds.data(),
+                                    op_params.data(),
+                                    op_token_offsets.data(),
+                                    op_token_ids.data()};
+  Py_BEGIN_ALLOW_THREADS;
+  auto &pool = HostThreadPool::Instance();
+  int max_threads = num_threads <= 0 ? pool.NumThreads() : num_threads;
+  int64_t num_tasks = std::min<int64_t>(num_rows, max_threads);
+  // contiguous spans of rows, each thread with its own scratch
+  pool.ParallelFor(num_tasks, num_threads, [&](int64_t task) {
+    RowScratch scratch;
+    int64_t end = num_rows * (task + 1) / num_tasks;
+    for (int64_t r = num_rows * task / num_tasks; r < end; ++r) {
+      ProcessRow(process_args, r, &scratch);
+    }
+  });
+  Py_END_ALLOW_THREADS;
+  Py_RETURN_NONE;
+}
+
+PyMethodDef logits_processors_methods[] = {
+    {"apply_logits_processors",
+     reinterpret_cast<PyCFunction>(ApplyLogitsProcessors),
+     METH_VARARGS | METH_KEYWORDS, kApplyLogitsProcessorsDoc},
+    {NULL, NULL, 0, NULL}};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  return PyModule_AddFunctions(m, logits_processors_methods);
+}
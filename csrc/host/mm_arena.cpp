@@ -0,0 +1,569 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "host/module.h"
+#include "host/thread_pool.h"
+
+// MmArena: one contiguous host region the multimodal inputs of the requests
+// in flight are placed in once, when they reach the worker, so that the
+// batch of a step is a view of the region rather than a concatenation of
+// copies.
+//
+// The region is mapped anonymous up front, so that it costs no memory until
+// written, and with `lock` is locked in RAM: no page of an input is paged out
+// nor faults on the copy to device. Ranges are handed out next fit from a
+// free list ordered by offset, from the end of the last range on and then
+// from the start, and coalesced with their neighbours on free. The region is
+// thus filled like a ring: inputs placed one after the other sit back to
+// back, rather than in the holes left by earlier requests, and the inputs of
+// a step, those of the requests that arrived together, are mostly one span.
+//
+// place copies a buffer into a new range and returns an MmArenaSlot, which
+// exports the range as a buffer and frees it once it and every view made
+// from it are gone. gather copies ranges back to back into one buffer, for
+// the batches that are not one span. Copies run with the GIL released, split
+// across threads of the host pool.
+namespace {
+constexpr int64_t kAlignment = 64;
+// bytes a thread of a copy copies at least
+constexpr int64_t kMinTaskBytes = 2 * 1024 * 1024;
+
+struct CopySpan {
+  const uint8_t *src;
+  uint8_t *dst;
+  int64_t bytes;
+};
+
+// Copy the spans, the bytes of all of them split evenly across tasks
+void ParallelCopy(const std::vector<CopySpan> &spans, int num_threads) {
+  std::vector<int64_t> starts(spans.size() + 1, 0);
+  for (size_t i = 0; i < spans.size(); ++i) {
+    starts[i + 1] = starts[i] + spans[i].bytes;
+  }
+  int64_t total = starts.back();
+  if (total == 0) {
+    return;
+  }
+  int max_threads = num_threads <= 0 ? HostThreadPool::Instance().NumThreads()
+                                     : num_threads;
+  int64_t num_tasks = std::max<int64_t>(
+      1, std::min<int64_t>(total / kMinTaskBytes, 4 * max_threads));
+  int64_t task_bytes = (total + num_tasks - 1) / num_tasks;
+  HostThreadPool::Instance().ParallelFor(
+      num_tasks, num_threads, [&](int64_t task) {
+        int64_t begin = task * task_bytes;
+        int64_t end = std::min(total, begin + task_bytes);
+        // the span the first byte of the task is in
+        size_t i = std::upper_bound(starts.begin(), starts.end(), begin) -
+                   starts.begin() - 1;
+        for (; begin < end; ++i) {
+          int64_t skip = begin - starts[i];
+          int64_t bytes = std::min(end, starts[i + 1]) - begin;
+          std::memcpy(spans[i].dst + skip, spans[i].src + skip, bytes);
+          begin += bytes;
+        }
+      });
+}
+
+class MmArena {
+public:
+  explicit MmArena(int64_t capacity) : capacity_(capacity) {
+    if (capacity > 0) {
+      free_[0] = capacity;
+    }
+  }
+
+  ~MmArena() {
+    if (base_ != nullptr) {
+      munmap(base_, static_cast<size_t>(capacity_));
+    }
+  }
+
+  // Disable copy and assignment
+  MmArena(const MmArena &) = delete;
+  MmArena &operator=(const MmArena &) = delete;
+
+  // Map the region; false with errno set on failure
+  bool Map(bool lock) {
+    if (capacity_ == 0) {
+      return true;
+    }
+    void *addr = mmap(nullptr, static_cast<size_t>(capacity_),
+                      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                      0);
+    if (addr == MAP_FAILED) {
+      return false;
+    }
+#ifdef MADV_HUGEPAGE
+    // fewer TLB misses on the copies, at no cost if THP is off
+    madvise(addr, static_cast<size_t>(capacity_), MADV_HUGEPAGE);
+#endif
+    if (lock && mlock(addr, static_cast<size_t>(capacity_)) != 0) {
+      int error = errno;
+      munmap(addr, static_cast<size_t>(capacity_));
+      errno = error;
+      return false;
+    }
+    base_ = static_cast<uint8_t *>(addr);
+    return true;
+  }
+
+  uint8_t *base() const { return base_; }
+  int64_t capacity() const { return capacity_; }
+  int64_t used_bytes() const { return used_bytes_; }
+  int64_t bytes_copied() const { return bytes_copied_; }
+  void AddBytesCopied(int64_t bytes) { bytes_copied_ += bytes; }
+
+  // Offset of a new range of bytes at a multiple of align, -1 if no free
+  // range holds it
+  int64_t Allocate(int64_t bytes, int64_t align) {
+    // the free range the cursor is in, or the first one after it
+    auto first = free_.upper_bound(cursor_);
+    if (first != free_.begin() &&
+        std::prev(first)->first + std::prev(first)->second > cursor_) {
+      --first;
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+      auto end = pass == 0 ? free_.end() : first;
+      for (auto it = pass == 0 ? first : free_.begin(); it != end; ++it) {
+        int64_t offset = TryAllocate(it, bytes, align);
+        if (offset >= 0) {
+          return offset;
+        }
+      }
+    }
+    return -1;
+  }
+
+  void Free(int64_t offset) {
+    auto used = used_.find(offset);
+    if (used == used_.end()) {
+      return;
+    }
+    int64_t begin = offset;
+    int64_t end = offset + used->second;
+    used_bytes_ -= used->second;
+    used_.erase(used);
+    auto next = free_.lower_bound(begin);
+    if (next != free_.end() && next->first == end) {
+      end += next->second;
+      next = free_.erase(next);
+    }
+    if (next != free_.begin()) {
+      auto prev = std::prev(next);
+      if (prev->first + prev->second == begin) {
+        begin = prev->first;
+        free_.erase(prev);
+      }
+    }
+    free_[begin] = end - begin;
+  }
+
+  // Whether [offset, offset + bytes) lies in one allocated range
+  bool IsAllocated(int64_t offset, int64_t bytes) const {
+    auto used = used_.upper_bound(offset);
+    if (used == used_.begin()) {
+      return false;
+    }
+    --used;
+    return offset + bytes <= used->first + used->second;
+  }
+
+private:
+  // Take bytes at a multiple of align from the free range it, at the cursor
+  // when it is in it; -1 if they do not fit
+  int64_t TryAllocate(std::map<int64_t, int64_t>::iterator it, int64_t bytes,
+                      int64_t align) {
+    int64_t begin = it->first;
+    int64_t end = it->first + it->second;
+    int64_t offset = (std::max(begin, std::min(cursor_, end)) + align - 1) /
+                     align * align;
+    if (offset + bytes > end) {
+      offset = (begin + align - 1) / align * align;
+      if (offset + bytes > end) {
+        return -1;
+      }
+    }
+    free_.erase(it);
+    if (offset > begin) {
+      free_[begin] = offset - begin;
+    }
+    if (end > offset + bytes) {
+      free_[offset + bytes] = end - offset - bytes;
+    }
+    used_[offset] = bytes;
+    used_bytes_ += bytes;
+    cursor_ = offset + bytes;
+    return offset;
+  }
+
+  uint8_t *base_{nullptr};
+  int64_t capacity_;
+  int64_t used_bytes_{0};
+  int64_t bytes_copied_{0};
+  int64_t cursor_{0}; // end of the last range allocated
+  std::map<int64_t, int64_t> free_; // offset -> bytes
+  std::map<int64_t, int64_t> used_; // offset -> bytes
+};
+
+struct MmArenaObject {
+  PyObject_HEAD MmArena *arena;
+};
+
+struct MmArenaSlotObject {
+  PyObject_HEAD PyObject *arena; // MmArenaObject
+  int64_t offset;
+  int64_t nbytes;
+};
+
+PyTypeObject MmArenaType = {PyVarObject_HEAD_INIT(NULL, 0)};
+PyTypeObject MmArenaSlotType = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+MmArena *ArenaOf(PyObject *obj) {
+  return reinterpret_cast<MmArenaObject *>(obj)->arena;
+}
+
+void MmArenaDealloc(PyObject *self) {
+  delete ArenaOf(self);
+  Py_TYPE(self)->tp_free(self);
+}
+
+int MmArenaInit(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"capacity", "lock", NULL};
+  auto *obj = reinterpret_cast<MmArenaObject *>(self);
+  Py_ssize_t capacity = 0;
+  int lock = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|$p:MmArena",
+                                   const_cast<char **>(kwlist), &capacity,
+                                   &lock)) {
+    return -1;
+  }
+  if (obj->arena != NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "MmArena is initialized");
+    return -1;
+  }
+  if (capacity < 0) {
+    PyErr_Format(PyExc_ValueError, "invalid arena of %zd bytes", capacity);
+    return -1;
+  }
+  auto *arena = new MmArena(capacity);
+  if (!arena->Map(lock != 0)) {
+    PyErr_Format(PyExc_MemoryError, "cannot map an arena of %zd bytes: %s",
+                 capacity, std::strerror(errno));
+    delete arena;
+    return -1;
+  }
+  obj->arena = arena;
+  return 0;
+}
+
+MmArena *GetArena(PyObject *self) {
+  auto *arena = ArenaOf(self);
+  if (arena == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "MmArena is not initialized");
+  }
+  return arena;
+}
+
+// Buffer of the whole region, for views of spans of several slots
+int MmArenaGetBuffer(PyObject *self, Py_buffer *view, int flags) {
+  auto *arena = GetArena(self);
+  if (arena == NULL) {
+    view->obj = NULL;
+    return -1;
+  }
+  return PyBuffer_FillInfo(view, self, arena->base(), arena->capacity(), 0,
+                           flags);
+}
+
+PyObject *MmArenaPlace(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"buf", "align", "num_threads", NULL};
+  auto *arena = GetArena(self);
+  if (arena == NULL) {
+    return NULL;
+  }
+  PyObject *buf = NULL;
+  Py_ssize_t align = kAlignment;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$ni:place",
+                                   const_cast<char **>(kwlist), &buf, &align,
+                                   &num_threads)) {
+    return NULL;
+  }
+  if (align <= 0) {
+    PyErr_Format(PyExc_ValueError, "invalid alignment %zd", align);
+    return NULL;
+  }
+  // No PyBUF_FORMAT: numpy does not describe some dtypes (bfloat16) in a
+  // format string, and only the bytes matter here.
+  Py_buffer view;
+  if (PyObject_GetBuffer(buf, &view, PyBUF_C_CONTIGUOUS) < 0) {
+    return NULL;
+  }
+  if (view.len == 0) {
+    PyErr_SetString(PyExc_ValueError, "cannot place an empty buffer");
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  int64_t offset = arena->Allocate(view.len, align);
+  if (offset < 0) {
+    PyErr_Format(PyExc_MemoryError,
+                 "no free range of %zd bytes in an arena of %lld bytes, %lld "
+                 "used",
+                 view.len, static_cast<long long>(arena->capacity()),
+                 static_cast<long long>(arena->used_bytes()));
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  auto *slot = PyObject_New(MmArenaSlotObject, &MmArenaSlotType);
+  if (slot == NULL) {
+    arena->Free(offset);
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  Py_INCREF(self);
+  slot->arena = self;
+  slot->offset = offset;
+  slot->nbytes = view.len;
+  std::vector<CopySpan> spans = {
+      {static_cast<const uint8_t *>(view.buf), arena->base() + offset,
+       view.len}};
+  Py_BEGIN_ALLOW_THREADS;
+  ParallelCopy(spans, num_threads);
+  Py_END_ALLOW_THREADS;
+  arena->AddBytesCopied(view.len);
+  PyBuffer_Release(&view);
+  return reinterpret_cast<PyObject *>(slot);
+}
+
+bool ParseInt64List(PyObject *obj, const char *name,
+                    std::vector<int64_t> *values) {
+  PyObject *seq = PySequence_Fast(obj, name);
+  if (seq == NULL) {
+    return false;
+  }
+  Py_ssize_t num = PySequence_Fast_GET_SIZE(seq);
+  PyObject **items = PySequence_Fast_ITEMS(seq);
+  values->resize(num);
+  for (Py_ssize_t i = 0; i < num; ++i) {
+    (*values)[i] = PyLong_AsLongLong(items[i]);
+    if ((*values)[i] == -1 && PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return false;
+    }
+  }
+  Py_DECREF(seq);
+  return true;
+}
+
+PyObject *MmArenaGather(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"offsets", "sizes", "out", "num_threads",
+                                 NULL};
+  auto *arena = GetArena(self);
+  if (arena == NULL) {
+    return NULL;
+  }
+  PyObject *offsets_obj = NULL;
+  PyObject *sizes_obj = NULL;
+  PyObject *out = NULL;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|$i:gather",
+                                   const_cast<char **>(kwlist), &offsets_obj,
+                                   &sizes_obj, &out, &num_threads)) {
+    return NULL;
+  }
+  std::vector<int64_t> offsets, sizes;
+  if (!ParseInt64List(offsets_obj, "offsets must be a sequence", &offsets) ||
+      !ParseInt64List(sizes_obj, "sizes must be a sequence", &sizes)) {
+    return NULL;
+  }
+  if (offsets.size() != sizes.size()) {
+    PyErr_Format(PyExc_ValueError, "%zu offsets but %zu sizes",
+                 offsets.size(), sizes.size());
+    return NULL;
+  }
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    if (sizes[i] < 0 || !arena->IsAllocated(offsets[i], sizes[i])) {
+      PyErr_Format(PyExc_ValueError,
+                   "%lld bytes at offset %lld are not in a placed range",
+                   static_cast<long long>(sizes[i]),
+                   static_cast<long long>(offsets[i]));
+      return NULL;
+    }
+  }
+  Py_buffer view;
+  if (PyObject_GetBuffer(out, &view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) <
+      0) {
+    return NULL;
+  }
+  std::vector<CopySpan> spans(offsets.size());
+  int64_t total = 0;
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    spans[i] = {arena->base() + offsets[i],
+                static_cast<uint8_t *>(view.buf) + total, sizes[i]};
+    total += sizes[i];
+  }
+  if (total != view.len) {
+    PyErr_Format(PyExc_ValueError, "out of %zd bytes for %lld bytes gathered",
+                 view.len, static_cast<long long>(total));
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS;
+  ParallelCopy(spans, num_threads);
+  Py_END_ALLOW_THREADS;
+  arena->AddBytesCopied(total);
+  PyBuffer_Release(&view);
+  Py_RETURN_NONE;
+}
+
+PyObject *MmArenaAddress(PyObject *self, void *) {
+  auto *arena = GetArena(self);
+  return arena == NULL ? NULL : PyLong_FromVoidPtr(arena->base());
+}
+
+PyObject *MmArenaCapacity(PyObject *self, void *) {
+  auto *arena = GetArena(self);
+  return arena == NULL ? NULL : PyLong_FromLongLong(arena->capacity());
+}
+
+PyObject *MmArenaUsedBytes(PyObject *self, void *) {
+  auto *arena = GetArena(self);
+  return arena == NULL ? NULL : PyLong_FromLongLong(arena->used_bytes());
+}
+
+PyObject *MmArenaBytesCopied(PyObject *self, void *) {
+  auto *arena = GetArena(self);
+  return arena == NULL ? NULL : PyLong_FromLongLong(arena->bytes_copied());
+}
+
+PyMethodDef mm_arena_methods[] = {
+    {"place", reinterpret_cast<PyCFunction>(MmArenaPlace),
+     METH_VARARGS | METH_KEYWORDS,
+     "place(buf, *, align=64, num_threads=0) -> MmArenaSlot\n\n"
+     "Copy the C-contiguous buffer `buf` into a new range of the arena at a\n"
+     "multiple of `align` bytes, on up to `num_threads` threads of the host\n"
+     "pool, 0 for all of them. MemoryError if no free range holds it."},
+    {"gather", reinterpret_cast<PyCFunction>(MmArenaGather),
+     METH_VARARGS | METH_KEYWORDS,
+     "gather(offsets, sizes, out, *, num_threads=0)\n\n"
+     "Copy `sizes[i]` bytes at `offsets[i]`, each within a placed range,\n"
+     "back to back into the C-contiguous writable buffer `out`."},
+    {NULL, NULL, 0, NULL}};
+
+PyGetSetDef mm_arena_getset[] = {
+    {"address", MmArenaAddress, NULL, "Address of the region.", NULL},
+    {"capacity", MmArenaCapacity, NULL, "Bytes of the region.", NULL},
+    {"used_bytes", MmArenaUsedBytes, NULL, "Bytes of the ranges placed.",
+     NULL},
+    {"bytes_copied", MmArenaBytesCopied, NULL,
+     "Bytes copied by place and gather so far.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+PyBufferProcs mm_arena_as_buffer = {MmArenaGetBuffer, NULL};
+
+void MmArenaSlotDealloc(PyObject *self) {
+  auto *slot = reinterpret_cast<MmArenaSlotObject *>(self);
+  ArenaOf(slot->arena)->Free(slot->offset);
+  Py_DECREF(slot->arena);
+  Py_TYPE(self)->tp_free(self);
+}
+
+int MmArenaSlotGetBuffer(PyObject *self, Py_buffer *view, int flags) {
+  auto *slot = reinterpret_cast<MmArenaSlotObject *>(self);
+  return PyBuffer_FillInfo(view, self,
+                           ArenaOf(slot->arena)->base() + slot->offset,
+                           slot->nbytes, 0, flags);
+}
+
+PyObject *MmArenaSlotOffset(PyObject *self, void *) {
+  return PyLong_FromLongLong(
+      reinterpret_cast<MmArenaSlotObject *>(self)->offset);
+}
+
+PyObject *MmArenaSlotNbytes(PyObject *self, void *) {
+  return PyLong_FromLongLong(
+      reinterpret_cast<MmArenaSlotObject *>(self)->nbytes);
+}
+
+PyObject *MmArenaSlotRepr(PyObject *self) {
+  auto *slot = reinterpret_cast<MmArenaSlotObject *>(self);
+  return PyUnicode_FromFormat("MmArenaSlot(offset=%lld, nbytes=%lld)",
+                              static_cast<long long>(slot->offset),
+                              static_cast<long long>(slot->nbytes));
+}
+
+PyGetSetDef mm_arena_slot_getset[] = {
+    {"offset", MmArenaSlotOffset, NULL, "Offset of the range in the arena.",
+     NULL},
+    {"nbytes", MmArenaSlotNbytes, NULL, "Bytes of the range.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+PyBufferProcs mm_arena_slot_as_buffer = {MmArenaSlotGetBuffer, NULL};
+
+int AddType(PyObject *m, const char *name, PyTypeObject *type) {
+  if (PyType_Ready(type) < 0) {
+    return -1;
+  }
+  Py_INCREF(type);
+  if (PyModule_AddObject(m, name, reinterpret_cast<PyObject *>(type)) < 0) {
+    Py_DECREF(type);
+    return -1;
+  }
+  return 0;
+}
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  MmArenaType.tp_name = "vllm_mindspore._C_host.MmArena";
+  MmArenaType.tp_basicsize = sizeof(MmArenaObject);
+  MmArenaType.tp_dealloc = MmArenaDealloc;
+  MmArenaType.tp_as_buffer = &mm_arena_as_buffer;
+  MmArenaType.tp_flags = Py_TPFLAGS_DEFAULT;
+  MmArenaType.tp_doc =
+      "MmArena(capacity, *, lock=False)\n\n"
+      "A host region of `capacity` bytes, with `lock` locked in RAM, that\n"
+      "buffers are placed in and gathered from. It exports the whole region\n"
+      "as a writable buffer.";
+  MmArenaType.tp_methods = mm_arena_methods;
+  MmArenaType.tp_getset = mm_arena_getset;
+  MmArenaType.tp_init = MmArenaInit;
+  MmArenaType.tp_new = PyType_GenericNew;
+
+  MmArenaSlotType.tp_name = "vllm_mindspore._C_host.MmArenaSlot";
+  MmArenaSlotType.tp_basicsize = sizeof(MmArenaSlotObject);
+  MmArenaSlotType.tp_dealloc = MmArenaSlotDealloc;
+  MmArenaSlotType.tp_repr = MmArenaSlotRepr;
+  MmArenaSlotType.tp_as_buffer = &mm_arena_slot_as_buffer;
+  MmArenaSlotType.tp_flags = Py_TPFLAGS_DEFAULT;
+  MmArenaSlotType.tp_doc =
+      "A range of an MmArena, made by MmArena.place. It exports the range as\n"
+      "a writable buffer and frees it once it and its views are gone.";
+  MmArenaSlotType.tp_getset = mm_arena_slot_getset;
+  if (AddType(m, "MmArena", &MmArenaType) < 0) {
+    return -1;
+  }
+  return AddType(m, "MmArenaSlot", &MmArenaSlotType);
+}
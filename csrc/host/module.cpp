@@ -0,0 +1,39 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "host/module.h"
+
+static struct PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    "_C_host",
+    "Host-side helpers of vllm-mindspore",
+    -1,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL};
+
+PyMODINIT_FUNC PyInit__C_host(void) {
+  PyObject *m = PyModule_Create(&module_def);
+  if (m == NULL) {
+    return NULL;
+  }
+  if (HostModuleRegistry::Instance().RegisterAll(m) < 0) {
+    Py_DECREF(m);
+    return NULL;
+  }
+  return m;
+}
@@ -0,0 +1,82 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_HOST_MODULE_H
+#define VLLM_MINDSPORE_CSRC_HOST_MODULE_H
+
+// The host extension (_C_host) holds host-side helpers that need neither
+// MindSpore nor a device, so it is written against the Python C API only and
+// built by setuptools, like the dummy _C_ops module.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <vector>
+
+// Define the type of module registration functions, returning 0 on success
+// and -1 with a Python exception set on failure
+using HostModuleRegisterFunction = int (*)(PyObject *);
+
+// Module registry class
+class HostModuleRegistry {
+public:
+  // Get the singleton instance
+  static HostModuleRegistry &Instance() {
+    static HostModuleRegistry instance;
+    return instance;
+  }
+
+  // Register a module function
+  void Register(HostModuleRegisterFunction func) { functions_.push_back(func); }
+
+  // Call all registered module functions
+  int RegisterAll(PyObject *m) {
+    for (const auto &func : functions_) {
+      if (func(m) < 0) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+private:
+  HostModuleRegistry() = default;
+  ~HostModuleRegistry() = default;
+
+  // Disable copy and assignment
+  HostModuleRegistry(const HostModuleRegistry &) = delete;
+  HostModuleRegistry &operator=(const HostModuleRegistry &) = delete;
+
+  // Store all registered functions
+  std::vector<HostModuleRegisterFunction> functions_;
+};
+
+#define HOST_CONCATENATE_DETAIL(x, y) x##y
+#define HOST_CONCATENATE(x, y) HOST_CONCATENATE_DETAIL(x, y)
+
+#define VLLM_MS_HOST_MODULE(m)                                                 \
+  static int HOST_CONCATENATE(host_func_register_, __LINE__)(PyObject *);      \
+  namespace {                                                                  \
+  struct HOST_CONCATENATE(host_func_registrar_, __LINE__) {                    \
+    HOST_CONCATENATE(host_func_registrar_, __LINE__)() {                       \
+      HostModuleRegistry::Instance().Register(                                 \
+          HOST_CONCATENATE(host_func_register_, __LINE__));                    \
+    }                                                                          \
+  };                                                                           \
+  static HOST_CONCATENATE(host_func_registrar_, __LINE__)                      \
+      HOST_CONCATENATE(host_registrar_instance_, __LINE__);                    \
+  }                                                                            \
+  static int HOST_CONCATENATE(host_func_register_, __LINE__)(PyObject * m)
+
+#endif // VLLM_MINDSPORE_CSRC_HOST_MODULE_H
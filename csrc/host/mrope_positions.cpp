@@ -0,0 +1,404 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "host/buffer_utils.h"
+#include "host/module.h"
+
+// mrope_positions: the 3-D rope positions of a Qwen2-VL / Qwen2.5-VL /
+// Qwen3-VL prompt, as MRotaryEmbedding._vl_get_input_positions_tensor and
+// _qwen3_vl_get_input_positions_tensor compute them, without building a
+// tensor per text run and vision item.
+//
+// The prompt is cut into text runs and vision items, each vision item
+// starting at the next image or video token after the previous one. A text
+// run of n tokens gets the positions s, s + 1, ..., s + n - 1 on all three
+// axes; the llm_grid_t x llm_grid_h x llm_grid_w tokens of a vision item get
+// (s + t_index, s + h, s + w), where s is one past the largest position so
+// far. The scan over the prompt builds the list of these chunks first, with
+// the GIL held since it reads Python objects, and the positions are written
+// after it without the GIL.
+namespace {
+struct MropeItem {
+  int64_t t;
+  int64_t h;
+  int64_t w;
+  // t_index = int(t * second_per_grid * tokens_per_second) in fp32 for
+  // Qwen2.5-VL, with 0 for images; t itself when not scaled
+  bool scaled;
+  float second_per_grid;
+};
+
+struct MropeChunk {
+  int64_t start;  // first token
+  int64_t length; // tokens
+  int64_t base;   // position of the first token on every axis
+  bool vision;
+  MropeItem item;
+};
+
+struct MropeConfig {
+  int64_t image_token_id;
+  int64_t video_token_id;
+  int64_t vision_start_token_id;
+  int64_t spatial_merge_size;
+  float tokens_per_second;
+  bool per_frame_videos;
+};
+
+inline int64_t TimeIndex(const MropeItem &item, int64_t t,
+                         float tokens_per_second) {
+  if (!item.scaled) {
+    return t;
+  }
+  float scaled = static_cast<float>(t) * item.second_per_grid;
+  return static_cast<int64_t>(scaled * tokens_per_second);
+}
+
+// Parses a sequence of [t, h, w] into grids; returns false with a Python
+// exception set
+bool ParseGrids(PyObject *obj, const char *name,
+                std::vector<std::array<int64_t, 3>> *grids) {
+  if (obj == Py_None) {
+    return true;
+  }
+  PyObject *seq = PySequence_Fast(obj, "grid_thw must be a sequence");
+  if (seq == NULL) {
+    return false;
+  }
+  bool ok = true;
+  for (Py_ssize_t i = 0; ok && i < PySequence_Fast_GET_SIZE(seq); ++i) {
+    PyObject *row = PySequence_Fast(PySequence_Fast_GET_ITEM(seq, i),
+                                    "grid_thw rows must be sequences");
+    ok = row != NULL;
+    if (ok && PySequence_Fast_GET_SIZE(row) != 3) {
+      PyErr_Format(PyExc_ValueError, "%s rows must be [t, h, w]", name);
+      ok = false;
+    }
+    std::array<int64_t, 3> grid{};
+    for (int k = 0; ok && k < 3; ++k) {
+      grid[k] = PyLong_AsLongLong(PySequence_Fast_GET_ITEM(row, k));
+      ok = !(grid[k] == -1 && PyErr_Occurred());
+    }
+    Py_XDECREF(row);
+    if (ok) {
+      grids->push_back(grid);
+    }
+  }
+  Py_DECREF(seq);
+  return ok;
+}
+
+// Index of the first `token` at or after `start`, n + 1 when the prompt
+// holds none. Returns -1 with a ValueError set when it only holds some
+// before `start`, as list.index does.
+int64_t FindToken(const std::vector<int64_t> &tokens, int64_t token,
+                  int64_t start) {
+  auto n = static_cast<int64_t>(tokens.size());
+  if (start < n) {
+    auto iter = std::find(tokens.begin() + start, tokens.end(), token);
+    if (iter != tokens.end()) {
+      return iter - tokens.begin();
+    }
+  }
+  if (std::find(tokens.begin(), tokens.begin() + std::min(start, n), token) !=
+      tokens.begin() + std::min(start, n)) {
+    PyErr_Format(PyExc_ValueError, "%lld is not in list",
+                 static_cast<long long>(token));
+    return -1;
+  }
+  return n + 1;
+}
+
+// Cuts the prompt into chunks and returns the largest position, -1 for an
+// empty prompt; returns -2 with a Python exception set on failure
+int64_t PlanChunks(const std::vector<int64_t> &tokens, const MropeConfig &cfg,
+                   const std::vector<std::array<int64_t, 3>> &image_grids,
+                   const std::vector<std::array<int64_t, 3>> &video_grids,
+                   const std::vector<double> *second_per_grid_ts,
+                   std::vector<MropeChunk> *chunks) {
+  auto n = static_cast<int64_t>(tokens.size());
+  int64_t image_nums = 0;
+  int64_t video_nums = 0;
+  for (int64_t i = 0; i + 1 < n; ++i) {
+    if (tokens[i] == cfg.vision_start_token_id) {
+      image_nums += tokens[i + 1] == cfg.image_token_id;
+      video_nums += tokens[i + 1] == cfg.video_token_id;
+    }
+  }
+  // Qwen3-VL gives every video frame its own vision start and timestamp
+  std::vector<std::array<int64_t, 3>> frames;
+  const auto *videos = &video_grids;
+  if (cfg.per_frame_videos) {
+    for (const auto &grid : video_grids) {
+      for (int64_t t = 0; t < grid[0]; ++t) {
+        frames.push_back({1, grid[1], grid[2]});
+      }
+    }
+    videos = &frames;
+  }
+
+  int64_t st = 0;
+  int64_t last_max = -1;
+  size_t image_index = 0;
+  size_t video_index = 0;
+  int64_t remain_images = image_nums;
+  int64_t remain_videos = video_nums;
+  for (int64_t k = 0; k < image_nums + video_nums; ++k) {
+    int64_t ed_image = remain_images > 0
+                           ? FindToken(tokens, cfg.image_token_id, st)
+                           : n + 1;
+    int64_t ed_video = remain_videos > 0
+                           ? FindToken(tokens, cfg.video_token_id, st)
+                           : n + 1;
+    if (ed_image < 0 || ed_video < 0) {
+      return -2;
+    }
+    MropeItem item{};
+    int64_t ed;
+    if (ed_image < ed_video) {
+      if (image_index >= image_grids.size()) {
+        PyErr_SetString(PyExc_IndexError, "image_grid_thw index out of range");
+        return -2;
+      }
+      const auto &grid = image_grids[image_index++];
+      item = {grid[0], grid[1], grid[2], !cfg.per_frame_videos, 0.0f};
+      --remain_images;
+      ed = ed_image;
+    } else {
+      if (video_index >= videos->size() ||
+          (second_per_grid_ts != nullptr && !cfg.per_frame_videos &&
+           video_index >= second_per_grid_ts->size())) {
+        PyErr_SetString(PyExc_IndexError, "video_grid_thw index out of range");
+        return -2;
+      }
+      const auto &grid = (*videos)[video_index];
+      float second_per_grid =
+          second_per_grid_ts != nullptr && !cfg.per_frame_videos
+              ? static_cast<float>((*second_per_grid_ts)[video_index])
+              : 1.0f;
+      item = {grid[0], grid[1], grid[2], !cfg.per_frame_videos,
+              second_per_grid};
+      ++video_index;
+      --remain_videos;
+      ed = ed_video;
+    }
+    item.h /= cfg.spatial_merge_size;
+    item.w /= cfg.spatial_merge_size;
+    if (item.t <= 0 || item.h <= 0 || item.w <= 0) {
+      PyErr_SetString(PyExc_ValueError,
+                      "mrope_positions: empty vision grid after merging");
+      return -2;
+    }
+
+    int64_t text_len = ed - st;
+    int64_t st_idx = last_max + 1;
+    chunks->push_back({st, text_len, st_idx, false, item});
+    int64_t base = st_idx + text_len;
+    chunks->push_back({ed, item.t * item.h * item.w, base, true, item});
+    int64_t max_t = 0;
+    for (int64_t t = 0; t < item.t; ++t) {
+      max_t = std::max(max_t, TimeIndex(item, t, cfg.tokens_per_second));
+    }
+    last_max = base + std::max({max_t, item.h - 1, item.w - 1});
+    st = ed + item.t * item.h * item.w;
+  }
+  if (st < n) {
+    int64_t st_idx = last_max + 1;
+    chunks->push_back({st, n - st, st_idx, false, MropeItem{}});
+    last_max = st_idx + n - st - 1;
+  }
+  return last_max;
+}
+
+// Writes the positions of tokens [context_len, seq_len) of every chunk into
+// out [3, stride]
+void FillPositions(const std::vector<MropeChunk> &chunks,
+                   float tokens_per_second, int64_t context_len,
+                   int64_t seq_len, int64_t *out, int64_t stride) {
+  int64_t *out_t = out;
+  int64_t *out_h = out + stride;
+  int64_t *out_w = out + 2 * stride;
+  for (const auto &chunk : chunks) {
+    int64_t begin = std::max(chunk.start, context_len);
+    int64_t end = std::min(chunk.start + chunk.length, seq_len);
+    if (begin >= end) {
+      continue;
+    }
+    if (!chunk.vision) {
+      for (int64_t i = begin; i < end; ++i) {
+        int64_t pos = chunk.base + (i - chunk.start);
+        out_t[i - context_len] = pos;
+        out_h[i - context_len] = pos;
+        out_w[i - context_len] = pos;
+      }
+      continue;
+    }
+    const auto &item = chunk.item;
+    int64_t frame = item.h * item.w;
+    for (int64_t i = begin; i < end; ++i) {
+      int64_t j = i - chunk.start;
+      int64_t t = j / frame;
+      int64_t rem = j - t * frame;
+      int64_t h = rem / item.w;
+      out_t[i - context_len] =
+          chunk.base + TimeIndex(item, t, tokens_per_second);
+      out_h[i - context_len] = chunk.base + h;
+      out_w[i - context_len] = chunk.base + (rem - h * item.w);
+    }
+  }
+}
+
+const char kMropePositionsDoc[] =
+    "mrope_positions(input_tokens, image_grid_thw, video_grid_thw,\n"
+    "                second_per_grid_ts, out, *, image_token_id,\n"
+    "                video_token_id, vision_start_token_id,\n"
+    "                spatial_merge_size, tokens_per_second=1.0,\n"
+    "                per_frame_videos=False, context_len=0, seq_len=-1)\n"
+    "    -> int\n"
+    "--\n\n"
+    "Write the mrope positions of tokens [context_len, seq_len) of a prompt\n"
+    "into out, int64 [3, >= seq_len - context_len], and return\n"
+    "mrope_position_delta. seq_len -1 is the end of the prompt.\n"
+    "input_tokens: sequence of int; image_grid_thw, video_grid_thw:\n"
+    "sequences of [t, h, w] or None; second_per_grid_ts: sequence of float\n"
+    "or None, for 1.0 per video. The time index of a video is scaled by\n"
+    "second_per_grid_ts and tokens_per_second and 0 for images, as in\n"
+    "Qwen2.5-VL; per_frame_videos splits videos into frames of t = 1 and\n"
+    "leaves the time index unscaled, as in Qwen3-VL.";
+
+PyObject *MropePositions(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"input_tokens",
+                                 "image_grid_thw",
+                                 "video_grid_thw",
+                                 "second_per_grid_ts",
+                                 "out",
+                                 "image_token_id",
+                                 "video_token_id",
+                                 "vision_start_token_id",
+                                 "spatial_merge_size",
+                                 "tokens_per_second",
+                                 "per_frame_videos",
+                                 "context_len",
+                                 "seq_len",
+                                 NULL};
+  PyObject *objs[5];
+  MropeConfig cfg{};
+  long long image_token_id = 0, video_token_id = 0, vision_start_token_id = 0;
+  long long spatial_merge_size = 0, context_len = 0, seq_len = -1;
+  double tokens_per_second = 1.0;
+  int per_frame_videos = 0;
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "OOOOO|$LLLLdpLL:mrope_positions",
+          const_cast<char **>(kwlist), &objs[0], &objs[1], &objs[2], &objs[3],
+          &objs[4], &image_token_id, &video_token_id, &vision_start_token_id,
+          &spatial_merge_size, &tokens_per_second, &per_frame_videos,
+          &context_len, &seq_len)) {
+    return NULL;
+  }
+  if (spatial_merge_size <= 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "mrope_positions: spatial_merge_size must be positive");
+    return NULL;
+  }
+  cfg = {image_token_id,
+         video_token_id,
+         vision_start_token_id,
+         spatial_merge_size,
+         static_cast<float>(tokens_per_second),
+         per_frame_videos != 0};
+
+  std::vector<int64_t> tokens;
+  PyObject *seq =
+      PySequence_Fast(objs[0], "input_tokens must be a sequence of int");
+  if (seq == NULL) {
+    return NULL;
+  }
+  tokens.resize(PySequence_Fast_GET_SIZE(seq));
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    tokens[i] = PyLong_AsLongLong(PySequence_Fast_GET_ITEM(seq, i));
+    if (tokens[i] == -1 && PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+  }
+  Py_DECREF(seq);
+
+  std::vector<std::array<int64_t, 3>> image_grids, video_grids;
+  if (!ParseGrids(objs[1], "image_grid_thw", &image_grids) ||
+      !ParseGrids(objs[2], "video_grid_thw", &video_grids)) {
+    return NULL;
+  }
+  std::vector<double> second_per_grid_ts;
+  if (objs[3] != Py_None) {
+    seq = PySequence_Fast(objs[3], "second_per_grid_ts must be a sequence");
+    if (seq == NULL) {
+      return NULL;
+    }
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+      second_per_grid_ts.push_back(
+          PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i)));
+    }
+    Py_DECREF(seq);
+    if (PyErr_Occurred()) {
+      return NULL;
+    }
+  }
+
+  auto n = static_cast<int64_t>(tokens.size());
+  if (seq_len < 0) {
+    seq_len = n;
+  }
+  TypedBuffer<int64_t> out;
+  if (!out.Acquire(objs[4], "out", true)) {
+    return NULL;
+  }
+  if (context_len < 0 || context_len > seq_len || seq_len > n ||
+      out.ndim() != 2 || out.shape(0) != 3 ||
+      out.shape(1) < seq_len - context_len) {
+    PyErr_SetString(PyExc_ValueError,
+                    "mrope_positions: out must be [3, >= seq_len - "
+                    "context_len], with 0 <= context_len <= seq_len <= "
+                    "len(input_tokens)");
+    return NULL;
+  }
+
+  std::vector<MropeChunk> chunks;
+  int64_t max_position =
+      PlanChunks(tokens, cfg, image_grids, video_grids,
+                 objs[3] == Py_None ? nullptr : &second_per_grid_ts, &chunks);
+  if (max_position < -1) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS;
+  FillPositions(chunks, cfg.tokens_per_second, context_len, seq_len,
+                out.data(), out.shape(1));
+  Py_END_ALLOW_THREADS;
+  return PyLong_FromLongLong(max_position + 1 - n);
+}
+
+PyMethodDef mrope_positions_methods[] = {
+    {"mrope_positions", reinterpret_cast<PyCFunction>(MropePositions),
+     METH_VARARGS | METH_KEYWORDS, kMropePositionsDoc},
+    {NULL, NULL, 0, NULL}};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  return PyModule_AddFunctions(m, mrope_positions_methods);
+}
@@ -0,0 +1,283 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "host/buffer_utils.h"
+#include "host/module.h"
+#include "host/thread_pool.h"
+
+// prepare_inputs: the host-side batch assembly of
+// GPUModelRunner._prepare_inputs, in one pass over the scheduled requests,
+// into the persistent buffers of InputBatch and its block tables. For the
+// t-th scheduled token of request i, at position p = num_computed_tokens[i]
+// + t, it writes
+//   input_ids[k] = token_ids[i, p]
+//   positions[k] = p
+//   slot_mapping_g[k] = block_table_g[i, p / block_size_g] * block_size_g
+//                       + p % block_size_g,   for every KV cache group g
+// where k = query_start_loc[i] + t, along with query_start_loc and seq_lens,
+// without the req_indices / arange / token_indices temporaries of the numpy
+// version.
+namespace {
+// Below this many tokens a batch is cheaper to assemble on one thread than
+// to hand over to the pool
+constexpr int64_t kMinTokensPerTask = 8192;
+
+struct BlockTableGroup {
+  TypedBuffer<int32_t> block_table;
+  TypedBuffer<int64_t> slot_mapping;
+  int64_t block_size{0};
+  int64_t max_num_blocks_per_req{0};
+};
+
+struct PrepareInputsArgs {
+  const int32_t *num_scheduled_tokens;
+  const int32_t *num_computed_tokens;
+  const int32_t *token_ids;
+  int64_t max_model_len;
+  int32_t *input_ids;
+  int64_t *positions;
+  const int32_t *query_start_loc;
+  std::vector<std::unique_ptr<BlockTableGroup>> *groups;
+};
+
+// Fill the tokens of requests [begin, end)
+void PrepareRequests(const PrepareInputsArgs &args, int64_t begin,
+                     int64_t end) {
+  for (int64_t req = begin; req < end; ++req) {
+    int64_t start = args.query_start_loc[req];
+    int64_t num_tokens = args.num_scheduled_tokens[req];
+    int64_t computed = args.num_computed_tokens[req];
+    const int32_t *token_ids = args.token_ids + req * args.max_model_len;
+    std::copy(token_ids + computed, token_ids + computed + num_tokens,
+              args.input_ids + start);
+    int64_t *positions = args.positions + start;
+    for (int64_t t = 0; t < num_tokens; ++t) {
+      positions[t] = computed + t;
+    }
+    for (auto &group : *args.groups) {
+      const int32_t *blocks =
+          group->block_table.data() + req * group->max_num_blocks_per_req;
+      int64_t block_size = group->block_size;
+      int64_t *slots = group->slot_mapping.data() + start;
+      // walk the blocks instead of dividing every position
+      int64_t pos = computed;
+      int64_t t = 0;
+      while (t < num_tokens) {
+        int64_t block = pos / block_size;
+        int64_t offset = pos - block * block_size;
+        int64_t run = std::min(block_size - offset, num_tokens - t);
+        int64_t base = static_cast<int64_t>(blocks[block]) * block_size + offset;
+        for (int64_t j = 0; j < run; ++j) {
+          slots[t + j] = base + j;
+        }
+        t += run;
+        pos += run;
+      }
+    }
+  }
+}
+
+const char kPrepareInputsDoc[] =
+    "prepare_inputs(num_scheduled_tokens, num_computed_tokens, token_ids,\n"
+    "               input_ids, positions, query_start_loc, seq_lens,\n"
+    "               block_tables, slot_mappings, block_sizes, *,\n"
+    "               num_threads=1) -> int\n"
+    "--\n\n"
+    "Assemble the inputs of a batch of num_reqs = len(num_scheduled_tokens)\n"
+    "requests in place, and return the largest number of scheduled tokens.\n"
+    "num_scheduled_tokens, num_computed_tokens: int32 [>= num_reqs];\n"
+    "token_ids: int32 [max_num_reqs, max_model_len]; input_ids: int32 and\n"
+    "positions: int64, [>= num_tokens]; query_start_loc: int32\n"
+    "[>= num_reqs + 1], padded with num_tokens; seq_lens: int32 [>= num_reqs];\n"
+    "block_tables: int32 [max_num_reqs, max_num_blocks_per_req] and\n"
+    "slot_mappings: int64 [>= num_tokens], one per KV cache group, with\n"
+    "block_sizes. Batches of many tokens are split across up to num_threads\n"
+    "threads of the host pool, 0 for all of them.";
+
+PyObject *PrepareInputs(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {
+      "num_scheduled_tokens", "num_computed_tokens", "token_ids",
+      "input_ids",            "positions",           "query_start_loc",
+      "seq_lens",             "block_tables",        "slot_mappings",
+      "block_sizes",          "num_threads",         NULL};
+  PyObject *objs[10];
+  int num_threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "OOOOOOOOOO|$i:prepare_inputs",
+          const_cast<char **>(kwlist), &objs[0], &objs[1], &objs[2], &objs[3],
+          &objs[4], &objs[5], &objs[6], &objs[7], &objs[8], &objs[9],
+          &num_threads)) {
+    return NULL;
+  }
+  TypedBuffer<int32_t> num_scheduled_tokens, num_computed_tokens, token_ids,
+      input_ids, query_start_loc, seq_lens;
+  TypedBuffer<int64_t> positions;
+  if (!num_scheduled_tokens.Acquire(objs[0], "num_scheduled_tokens") ||
+      !num_computed_tokens.Acquire(objs[1], "num_computed_tokens") ||
+      !token_ids.Acquire(objs[2], "token_ids") ||
+      !input_ids.Acquire(objs[3], "input_ids", true) ||
+      !positions.Acquire(objs[4], "positions", true) ||
+      !query_start_loc.Acquire(objs[5], "query_start_loc", true) ||
+      !seq_lens.Acquire(objs[6], "seq_lens", true)) {
+    return NULL;
+  }
+  int64_t num_reqs = num_scheduled_tokens.size();
+  if (token_ids.ndim() != 2 || num_computed_tokens.size() < num_reqs ||
+      token_ids.shape(0) < num_reqs || query_start_loc.size() < num_reqs + 1 ||
+      seq_lens.size() < num_reqs) {
+    PyErr_SetString(PyExc_ValueError,
+                    "prepare_inputs: buffers too small for the batch");
+    return NULL;
+  }
+
+  // KV cache groups
+  PyObject *tables = PySequence_Fast(objs[7], "block_tables must be a sequence");
+  if (tables == NULL) {
+    return NULL;
+  }
+  PyObject *mappings =
+      PySequence_Fast(objs[8], "slot_mappings must be a sequence");
+  PyObject *sizes =
+      mappings == NULL
+          ? NULL
+          : PySequence_Fast(objs[9], "block_sizes must be a sequence");
+  std::vector<std::unique_ptr<BlockTableGroup>> groups;
+  bool ok = sizes != NULL;
+  if (ok && (PySequence_Fast_GET_SIZE(tables) !=
+                 PySequence_Fast_GET_SIZE(mappings) ||
+             PySequence_Fast_GET_SIZE(tables) !=
+                 PySequence_Fast_GET_SIZE(sizes))) {
+    PyErr_SetString(PyExc_ValueError,
+                    "block_tables, slot_mappings and block_sizes differ in "
+                    "length");
+    ok = false;
+  }
+  for (Py_ssize_t g = 0; ok && g < PySequence_Fast_GET_SIZE(tables); ++g) {
+    auto group = std::make_unique<BlockTableGroup>();
+    group->block_size =
+        PyLong_AsLongLong(PySequence_Fast_GET_ITEM(sizes, g));
+    ok = !(group->block_size == -1 && PyErr_Occurred()) &&
+         group->block_table.Acquire(PySequence_Fast_GET_ITEM(tables, g),
+                                    "block_tables[i]") &&
+         group->slot_mapping.Acquire(PySequence_Fast_GET_ITEM(mappings, g),
+                                     "slot_mappings[i]", true);
+    if (ok && (group->block_size <= 0 || group->block_table.ndim() != 2 ||
+               group->block_table.shape(0) < num_reqs)) {
+      PyErr_SetString(PyExc_ValueError,
+                      "block_tables[i] must be [max_num_reqs, "
+                      "max_num_blocks_per_req], with a positive block size");
+      ok = false;
+    }
+    if (ok) {
+      group->max_num_blocks_per_req = group->block_table.shape(1);
+      groups.push_back(std::move(group));
+    }
+  }
+  Py_DECREF(tables);
+  Py_XDECREF(mappings);
+  Py_XDECREF(sizes);
+  if (!ok) {
+    return NULL;
+  }
+
+  // query_start_loc, seq_lens, and the bounds of every request
+  int64_t max_model_len = token_ids.shape(1);
+  int64_t num_tokens = 0;
+  int32_t max_num_scheduled_tokens = 0;
+  query_start_loc.data()[0] = 0;
+  for (int64_t req = 0; req < num_reqs; ++req) {
+    int32_t scheduled = num_scheduled_tokens.data()[req];
+    int32_t computed = num_computed_tokens.data()[req];
+    int64_t seq_len = static_cast<int64_t>(computed) + scheduled;
+    bool blocks_fit = true;
+    for (auto &group : groups) {
+      blocks_fit = blocks_fit && (seq_len + group->block_size - 1) /
+                                         group->block_size <=
+                                     group->max_num_blocks_per_req;
+    }
+    if (scheduled < 0 || computed < 0 || seq_len > max_model_len ||
+        !blocks_fit) {
+      PyErr_Format(PyExc_ValueError,
+                   "prepare_inputs: request %lld schedules %d tokens after %d "
+                   "out of the bounds of its buffers",
+                   static_cast<long long>(req), scheduled, computed);
+      return NULL;
+    }
+    num_tokens += scheduled;
+    max_num_scheduled_tokens = std::max(max_num_scheduled_tokens, scheduled);
+    query_start_loc.data()[req + 1] = static_cast<int32_t>(num_tokens);
+    seq_lens.data()[req] = static_cast<int32_t>(seq_len);
+  }
+  // keep query_start_loc non-decreasing past the batch
+  std::fill(query_start_loc.data() + num_reqs + 1,
+            query_start_loc.data() + query_start_loc.size(),
+            static_cast<int32_t>(num_tokens));
+  bool fits = input_ids.size() >= num_tokens && positions.size() >= num_tokens;
+  for (auto &group : groups) {
+    fits = fits && group->slot_mapping.size() >= num_tokens;
+  }
+  if (!fits) {
+    PyErr_SetString(PyExc_ValueError,
+                    "prepare_inputs: input_ids, positions or slot_mappings "
+                    "too small for the scheduled tokens");
+    return NULL;
+  }
+
+  PrepareInputsArgs prepare_args{num_scheduled_tokens.data(),
+                                 num_computed_tokens.data(),
+                                 token_ids.data(),
+                                 max_model_len,
+                                 input_ids.data(),
+                                 positions.data(),
+                                 query_start_loc.data(),
+                                 &groups};
+  Py_BEGIN_ALLOW_THREADS;
+  auto &pool = HostThreadPool::Instance();
+  int64_t num_tasks =
+      std::min<int64_t>(num_tokens / kMinTokensPerTask,
+                        num_threads <= 0 ? pool.NumThreads() : num_threads);
+  if (num_tasks <= 1) {
+    PrepareRequests(prepare_args, 0, num_reqs);
+  } else {
+    // split at request boundaries into spans of about the same number of
+    // tokens
+    const int32_t *cu = query_start_loc.data();
+    pool.ParallelFor(num_tasks, num_threads, [&](int64_t task) {
+      auto first_request = [&](int64_t i) {
+        return std::lower_bound(cu, cu + num_reqs, num_tokens * i / num_tasks) -
+               cu;
+      };
+      PrepareRequests(prepare_args, first_request(task),
+                      first_request(task + 1));
+    });
+  }
+  Py_END_ALLOW_THREADS;
+  return PyLong_FromLong(max_num_scheduled_tokens);
+}
+
+PyMethodDef prepare_inputs_methods[] = {
+    {"prepare_inputs", reinterpret_cast<PyCFunction>(PrepareInputs),
+     METH_VARARGS | METH_KEYWORDS, kPrepareInputsDoc},
+    {NULL, NULL, 0, NULL}};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  return PyModule_AddFunctions(m, prepare_inputs_methods);
+}
@@ -0,0 +1,486 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "host/buffer_utils.h"
+#include "host/module.h"
+#include "host/thread_pool.h"
+
+// build_punica_metadata: the metadata the Punica wrapper rebuilds every
+// step, that of vLLM's convert_mapping and compute_meta, in one pass over
+// the token to LoRA mapping instead of a list.index per token and a handful
+// of tensor ops:
+//   token_lora_indices[t] = slot of the LoRA of token t, -1 for none
+//   embeddings_indices = [slot * extra_vocab_size,
+//                         slot * (vocab_size + extra_vocab_size)], slot 0
+//                         for none
+//   sampler_indices[i] = slot of the LoRA of prompt i, -1 for none
+//   sampler_indices_padded[i] = i + (slot, or max_loras - 1 for none) *
+//                               num_prompts
+//   seq_start_locs, seq_lengths, lora_indices_per_batch: the runs of tokens
+//                               of the same slot, the SGMV segments
+//   group_list[slot + 1] = tokens of the slot, group 0 those of none
+//   token_order = the tokens grouped by slot + 1, stably
+//
+// sgmv_shrink and sgmv_expand: float32 reference SGMV over the segments, to
+// check and time the LoRA path without an NPU.
+namespace {
+// Below this many multiply-adds a reference SGMV runs on the calling thread
+constexpr int64_t kMinFlopsPerTask = 1 << 20;
+// Partial sums of a dot product, independent so that the loop vectorizes
+// without -ffast-math
+constexpr int64_t kDotLanes = 8;
+
+float Dot(const float *a, const float *b, int64_t n) {
+  float acc[kDotLanes] = {};
+  int64_t i = 0;
+  for (; i + kDotLanes <= n; i += kDotLanes) {
+    for (int64_t l = 0; l < kDotLanes; ++l) {
+      acc[l] += a[i + l] * b[i + l];
+    }
+  }
+  float sum = 0.0f;
+  for (; i < n; ++i) {
+    sum += a[i] * b[i];
+  }
+  for (int64_t l = 0; l < kDotLanes; ++l) {
+    sum += acc[l];
+  }
+  return sum;
+}
+
+// Sequence of ints into values; false with a Python exception set
+bool ParseInts(PyObject *obj, const char *name, std::vector<int64_t> *values,
+               bool none_as_minus_one = false) {
+  PyObject *seq = PySequence_Fast(obj, name);
+  if (seq == NULL) {
+    return false;
+  }
+  Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+  PyObject **items = PySequence_Fast_ITEMS(seq);
+  values->resize(size);
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    if (none_as_minus_one && items[i] == Py_None) {
+      (*values)[i] = -1;
+      continue;
+    }
+    (*values)[i] = PyLong_AsLongLong(items[i]);
+    if ((*values)[i] == -1 && PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return false;
+    }
+  }
+  Py_DECREF(seq);
+  return true;
+}
+
+const char kBuildPunicaMetadataDoc[] =
+    "build_punica_metadata(index_mapping, prompt_mapping, lora_index_to_id,\n"
+    "                      max_loras, vocab_size, extra_vocab_size,\n"
+    "                      token_lora_indices, embeddings_indices,\n"
+    "                      sampler_indices, sampler_indices_padded,\n"
+    "                      seq_start_locs, seq_lengths,\n"
+    "                      lora_indices_per_batch, group_list, token_order)\n"
+    "    -> (batch_size, max_length, no_lora, grouped)\n"
+    "--\n\n"
+    "Fill the Punica metadata of a LoRA mapping of num_tokens =\n"
+    "len(index_mapping) tokens and num_prompts = len(prompt_mapping)\n"
+    "prompts, LoRA ids with 0 for none, and return the number of SGMV\n"
+    "segments, the longest, whether no token has a LoRA, and whether the\n"
+    "tokens are grouped by slot already. All the buffers are int64:\n"
+    "token_lora_indices and token_order [>= num_tokens], embeddings_indices\n"
+    "[>= 2 * num_tokens], filled [2, num_tokens] from the start;\n"
+    "sampler_indices and sampler_indices_padded [>= num_prompts];\n"
+    "seq_start_locs, seq_lengths and lora_indices_per_batch [>= segments];\n"
+    "group_list [> every slot + 1], zeroed past the slots used.\n"
+    "ValueError if a LoRA id has no slot in lora_index_to_id.";
+
+PyObject *BuildPunicaMetadata(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"index_mapping",
+                                 "prompt_mapping",
+                                 "lora_index_to_id",
+                                 "max_loras",
+                                 "vocab_size",
+                                 "extra_vocab_size",
+                                 "token_lora_indices",
+                                 "embeddings_indices",
+                                 "sampler_indices",
+                                 "sampler_indices_padded",
+                                 "seq_start_locs",
+                                 "seq_lengths",
+                                 "lora_indices_per_batch",
+                                 "group_list",
+                                 "token_order",
+                                 NULL};
+  PyObject *mapping_objs[3];
+  long long max_loras = 0;
+  long long vocab_size = 0;
+  long long extra_vocab_size = 0;
+  PyObject *objs[9];
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "OOOLLLOOOOOOOOO:build_punica_metadata",
+          const_cast<char **>(kwlist), &mapping_objs[0], &mapping_objs[1],
+          &mapping_objs[2], &max_loras, &vocab_size, &extra_vocab_size,
+          &objs[0], &objs[1], &objs[2], &objs[3], &objs[4], &objs[5],
+          &objs[6], &objs[7], &objs[8])) {
+    return NULL;
+  }
+  std::vector<int64_t> index_mapping, prompt_mapping, lora_index_to_id;
+  if (!ParseInts(mapping_objs[0], "index_mapping must be a sequence",
+                 &index_mapping) ||
+      !ParseInts(mapping_objs[1], "prompt_mapping must be a sequence",
+                 &prompt_mapping) ||
+      !ParseInts(mapping_objs[2], "lora_index_to_id must be a sequence",
+                 &lora_index_to_id, true)) {
+    return NULL;
+  }
+  TypedBuffer<int64_t> token_lora_indices, embeddings_indices,
+      sampler_indices, sampler_indices_padded, seq_start_locs, seq_lengths,
+      lora_indices_per_batch, group_list, token_order;
+  if (!token_lora_indices.Acquire(objs[0], "token_lora_indices", true) ||
+      !embeddings_indices.Acquire(objs[1], "embeddings_indices", true) ||
+      !sampler_indices.Acquire(objs[2], "sampler_indices", true) ||
+      !sampler_indices_padded.Acquire(objs[3], "sampler_indices_padded",
+                                      true) ||
+      !seq_start_locs.Acquire(objs[4], "seq_start_locs", true) ||
+      !seq_lengths.Acquire(objs[5], "seq_lengths", true) ||
+      !lora_indices_per_batch.Acquire(objs[6], "lora_indices_per_batch",
+                                      true) ||
+      !group_list.Acquire(objs[7], "group_list", true) ||
+      !token_order.Acquire(objs[8], "token_order", true)) {
+    return NULL;
+  }
+  auto num_tokens = static_cast<int64_t>(index_mapping.size());
+  auto num_prompts = static_cast<int64_t>(prompt_mapping.size());
+  if (token_lora_indices.size() < num_tokens ||
+      token_order.size() < num_tokens ||
+      embeddings_indices.size() < 2 * num_tokens ||
+      sampler_indices.size() < num_prompts ||
+      sampler_indices_padded.size() < num_prompts) {
+    PyErr_SetString(PyExc_ValueError,
+                    "build_punica_metadata: buffers too small for the mapping");
+    return NULL;
+  }
+
+  // the first slot of every LoRA id, as lora_index_to_id.index gives
+  std::unordered_map<int64_t, int64_t> slots;
+  for (size_t slot = lora_index_to_id.size(); slot-- > 0;) {
+    slots[lora_index_to_id[slot]] = static_cast<int64_t>(slot);
+  }
+  // the last id looked up, runs of tokens share their LoRA
+  int64_t last_id = 0;
+  int64_t last_slot = -1;
+  auto slot_of = [&](int64_t lora_id, int64_t *slot) {
+    if (lora_id <= 0) {
+      *slot = -1;
+      return true;
+    }
+    if (lora_id != last_id) {
+      auto it = slots.find(lora_id);
+      if (it == slots.end()) {
+        PyErr_Format(PyExc_ValueError, "LoRA %lld has no slot",
+                     static_cast<long long>(lora_id));
+        return false;
+      }
+      last_id = lora_id;
+      last_slot = it->second;
+    }
+    *slot = last_slot;
+    return true;
+  };
+
+  int64_t *token_slots = token_lora_indices.data();
+  int64_t *embeddings = embeddings_indices.data();
+  int64_t *groups = group_list.data();
+  int64_t num_groups = group_list.size();
+  std::fill(groups, groups + num_groups, 0);
+  int64_t batch_size = 0;
+  int64_t max_length = 0;
+  bool grouped = true;
+  for (int64_t t = 0; t < num_tokens; ++t) {
+    int64_t slot;
+    if (!slot_of(index_mapping[t], &slot)) {
+      return NULL;
+    }
+    if (slot + 1 >= num_groups) {
+      PyErr_Format(PyExc_ValueError,
+                   "build_punica_metadata: slot %lld past the %lld groups of "
+                   "group_list",
+                   static_cast<long long>(slot),
+                   static_cast<long long>(num_groups));
+      return NULL;
+    }
+    token_slots[t] = slot;
+    int64_t embedding_slot = slot < 0 ? 0 : slot;
+    embeddings[t] = embedding_slot * extra_vocab_size;
+    embeddings[num_tokens + t] =
+        embedding_slot * (vocab_size + extra_vocab_size);
+    ++groups[slot + 1];
+    if (t == 0 || slot != token_slots[t - 1]) {
+      if (batch_size >= seq_lengths.size() ||
+          batch_size >= seq_start_locs.size() ||
+          batch_size >= lora_indices_per_batch.size()) {
+        PyErr_SetString(PyExc_ValueError,
+                        "build_punica_metadata: more segments than "
+                        "seq_lengths holds");
+        return NULL;
+      }
+      grouped = grouped && (t == 0 || slot > token_slots[t - 1]);
+      seq_start_locs.data()[batch_size] = t;
+      seq_lengths.data()[batch_size] = 0;
+      lora_indices_per_batch.data()[batch_size] = slot;
+      ++batch_size;
+    }
+    int64_t length = ++seq_lengths.data()[batch_size - 1];
+    max_length = std::max(max_length, length);
+  }
+
+  // tokens grouped by slot: a counting sort over the group sizes
+  std::vector<int64_t> group_starts(num_groups, 0);
+  for (int64_t g = 1; g < num_groups; ++g) {
+    group_starts[g] = group_starts[g - 1] + groups[g - 1];
+  }
+  for (int64_t t = 0; t < num_tokens; ++t) {
+    token_order.data()[group_starts[token_slots[t] + 1]++] = t;
+  }
+
+  for (int64_t i = 0; i < num_prompts; ++i) {
+    int64_t slot;
+    if (!slot_of(prompt_mapping[i], &slot)) {
+      return NULL;
+    }
+    sampler_indices.data()[i] = slot;
+    sampler_indices_padded.data()[i] =
+        i + (slot == -1 ? max_loras - 1 : slot) * num_prompts;
+  }
+  bool no_lora =
+      batch_size == 1 && lora_indices_per_batch.data()[0] == -1;
+  return Py_BuildValue("(LLOO)", static_cast<long long>(batch_size),
+                       static_cast<long long>(max_length),
+                       no_lora ? Py_True : Py_False,
+                       grouped ? Py_True : Py_False);
+}
+
+// The segments of a reference SGMV, checked against the tokens
+struct Segments {
+  TypedBuffer<int64_t> starts, lengths, lora_indices;
+
+  bool Acquire(PyObject *starts_obj, PyObject *lengths_obj,
+               PyObject *lora_indices_obj, int64_t num_tokens,
+               int64_t num_loras) {
+    if (!starts.Acquire(starts_obj, "seq_start_locs") ||
+        !lengths.Acquire(lengths_obj, "seq_lengths") ||
+        !lora_indices.Acquire(lora_indices_obj, "lora_indices")) {
+      return false;
+    }
+    if (starts.size() != lengths.size() ||
+        starts.size() != lora_indices.size()) {
+      PyErr_SetString(PyExc_ValueError,
+                      "seq_start_locs, seq_lengths and lora_indices differ in "
+                      "length");
+      return false;
+    }
+    for (int64_t s = 0; s < starts.size(); ++s) {
+      int64_t start = starts.data()[s];
+      int64_t length = lengths.data()[s];
+      int64_t lora = lora_indices.data()[s];
+      if (start < 0 || length < 0 || start + length > num_tokens ||
+          lora < -1 || lora >= num_loras) {
+        PyErr_Format(PyExc_ValueError,
+                     "segment %lld out of the %lld tokens or %lld LoRAs",
+                     static_cast<long long>(s),
+                     static_cast<long long>(num_tokens),
+                     static_cast<long long>(num_loras));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // fn(token, lora) for every token of a segment with a LoRA, on up to
+  // num_threads threads when there are flops_per_token * tokens to do
+  template <typename Fn>
+  void ForEachToken(int64_t flops_per_token, int num_threads, Fn fn) const {
+    std::vector<std::pair<int64_t, int64_t>> tokens;
+    for (int64_t s = 0; s < starts.size(); ++s) {
+      if (lora_indices.data()[s] < 0) {
+        continue;
+      }
+      for (int64_t t = 0; t < lengths.data()[s]; ++t) {
+        tokens.emplace_back(starts.data()[s] + t, lora_indices.data()[s]);
+      }
+    }
+    auto num = static_cast<int64_t>(tokens.size());
+    auto &pool = HostThreadPool::Instance();
+    int64_t num_tasks = std::min<int64_t>(
+        {num, num * flops_per_token / kMinFlopsPerTask,
+         num_threads <= 0 ? pool.NumThreads() : num_threads});
+    if (num_tasks <= 1) {
+      for (const auto &token : tokens) {
+        fn(token.first, token.second);
+      }
+      return;
+    }
+    pool.ParallelFor(num_tasks, num_threads, [&](int64_t task) {
+      for (int64_t i = num * task / num_tasks;
+           i < num * (task + 1) / num_tasks; ++i) {
+        fn(tokens[i].first, tokens[i].second);
+      }
+    });
+  }
+};
+
+const char kSgmvShrinkDoc[] =
+    "sgmv_shrink(x, lora_a, out, seq_start_locs, seq_lengths, lora_indices,\n"
+    "            scale, *, num_threads=1)\n"
+    "--\n\n"
+    "out[t] = scale * lora_a[l] @ x[t] for every token t of a segment of\n"
+    "LoRA l, tokens of segments of LoRA -1 left as they are. x: float32\n"
+    "[num_tokens, hidden]; lora_a: float32 [num_loras, rank, hidden];\n"
+    "out: float32 [num_tokens, rank]; the segments int64, as\n"
+    "build_punica_metadata gives them.";
+
+PyObject *SgmvShrink(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"x",           "lora_a",      "out",
+                                 "seq_start_locs", "seq_lengths",
+                                 "lora_indices", "scale",      "num_threads",
+                                 NULL};
+  PyObject *objs[6];
+  double scale = 1.0;
+  int num_threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOOd|$i:sgmv_shrink",
+                                   const_cast<char **>(kwlist), &objs[0],
+                                   &objs[1], &objs[2], &objs[3], &objs[4],
+                                   &objs[5], &scale, &num_threads)) {
+    return NULL;
+  }
+  TypedBuffer<float> x, lora_a, out;
+  if (!x.Acquire(objs[0], "x") || !lora_a.Acquire(objs[1], "lora_a") ||
+      !out.Acquire(objs[2], "out", true)) {
+    return NULL;
+  }
+  if (x.ndim() != 2 || out.ndim() != 2 || lora_a.ndim() != 3 ||
+      x.shape(0) != out.shape(0) || lora_a.shape(1) != out.shape(1) ||
+      lora_a.shape(2) != x.shape(1)) {
+    PyErr_SetString(PyExc_ValueError,
+                    "sgmv_shrink: x, lora_a and out must be [num_tokens, "
+                    "hidden], [num_loras, rank, hidden] and [num_tokens, "
+                    "rank]");
+    return NULL;
+  }
+  Segments segments;
+  if (!segments.Acquire(objs[3], objs[4], objs[5], x.shape(0),
+                        lora_a.shape(0))) {
+    return NULL;
+  }
+  int64_t hidden = x.shape(1);
+  int64_t rank = out.shape(1);
+  auto scale_f = static_cast<float>(scale);
+  Py_BEGIN_ALLOW_THREADS;
+  segments.ForEachToken(hidden * rank, num_threads,
+                        [&](int64_t t, int64_t lora) {
+                          const float *in = x.data() + t * hidden;
+                          const float *a = lora_a.data() + lora * rank * hidden;
+                          float *y = out.data() + t * rank;
+                          for (int64_t r = 0; r < rank; ++r) {
+                            y[r] = scale_f * Dot(a + r * hidden, in, hidden);
+                          }
+                        });
+  Py_END_ALLOW_THREADS;
+  Py_RETURN_NONE;
+}
+
+const char kSgmvExpandDoc[] =
+    "sgmv_expand(x, lora_b, out, seq_start_locs, seq_lengths, lora_indices,\n"
+    "            *, offset=0, add_inputs=True, num_threads=1)\n"
+    "--\n\n"
+    "out[t, offset:offset + size] (+)= lora_b[l] @ x[t] for every token t\n"
+    "of a segment of LoRA l, tokens of segments of LoRA -1 left as they\n"
+    "are. x: float32 [num_tokens, rank]; lora_b: float32 [num_loras, size,\n"
+    "rank]; out: float32 [num_tokens, >= offset + size]; the segments\n"
+    "int64, as build_punica_metadata gives them.";
+
+PyObject *SgmvExpand(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"x",           "lora_b",      "out",
+                                 "seq_start_locs", "seq_lengths",
+                                 "lora_indices", "offset",     "add_inputs",
+                                 "num_threads",  NULL};
+  PyObject *objs[6];
+  Py_ssize_t offset = 0;
+  int add_inputs = 1;
+  int num_threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOO|$npi:sgmv_expand",
+                                   const_cast<char **>(kwlist), &objs[0],
+                                   &objs[1], &objs[2], &objs[3], &objs[4],
+                                   &objs[5], &offset, &add_inputs,
+                                   &num_threads)) {
+    return NULL;
+  }
+  TypedBuffer<float> x, lora_b, out;
+  if (!x.Acquire(objs[0], "x") || !lora_b.Acquire(objs[1], "lora_b") ||
+      !out.Acquire(objs[2], "out", true)) {
+    return NULL;
+  }
+  if (x.ndim() != 2 || out.ndim() != 2 || lora_b.ndim() != 3 ||
+      x.shape(0) != out.shape(0) || lora_b.shape(2) != x.shape(1) ||
+      offset < 0 || offset + lora_b.shape(1) > out.shape(1)) {
+    PyErr_SetString(PyExc_ValueError,
+                    "sgmv_expand: x, lora_b and out must be [num_tokens, "
+                    "rank], [num_loras, size, rank] and [num_tokens, >= "
+                    "offset + size]");
+    return NULL;
+  }
+  Segments segments;
+  if (!segments.Acquire(objs[3], objs[4], objs[5], x.shape(0),
+                        lora_b.shape(0))) {
+    return NULL;
+  }
+  int64_t rank = x.shape(1);
+  int64_t size = lora_b.shape(1);
+  int64_t out_cols = out.shape(1);
+  bool add = add_inputs != 0;
+  Py_BEGIN_ALLOW_THREADS;
+  segments.ForEachToken(rank * size, num_threads,
+                        [&](int64_t t, int64_t lora) {
+                          const float *in = x.data() + t * rank;
+                          const float *b = lora_b.data() + lora * size * rank;
+                          float *y = out.data() + t * out_cols + offset;
+                          for (int64_t o = 0; o < size; ++o) {
+                            float acc = Dot(b + o * rank, in, rank);
+                            y[o] = add ? y[o] + acc : acc;
+                          }
+                        });
+  Py_END_ALLOW_THREADS;
+  Py_RETURN_NONE;
+}
+
+PyMethodDef punica_metadata_methods[] = {
+    {"build_punica_metadata",
+     reinterpret_cast<PyCFunction>(BuildPunicaMetadata),
+     METH_VARARGS | METH_KEYWORDS, kBuildPunicaMetadataDoc},
+    {"sgmv_shrink", reinterpret_cast<PyCFunction>(SgmvShrink),
+     METH_VARARGS | METH_KEYWORDS, kSgmvShrinkDoc},
+    {"sgmv_expand", reinterpret_cast<PyCFunction>(SgmvExpand),
+     METH_VARARGS | METH_KEYWORDS, kSgmvExpandDoc},
+    {NULL, NULL, 0, NULL}};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  return PyModule_AddFunctions(m, punica_metadata_methods);
+}
@@ -0,0 +1,727 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "host/module.h"
+#include "host/thread_pool.h"
+
+// SafetensorsFile: a safetensors checkpoint shard mapped read-only, whose
+// tensors, or the slice of one tensor along one dim, are copied straight
+// into buffers of the caller, e.g. the ndarray a weight loader hands to its
+// parameter.
+//
+// A shard is an 8-byte little-endian header length, a JSON header mapping
+// every tensor name to its dtype, shape and [begin, end) byte offsets, then
+// the tensor data. The header is parsed once when the file is opened; a
+// read copies the rows of the slice with the GIL released, split across
+// threads of the host pool, which also overlaps the page faults of a cold
+// file. Before a read the kernel is asked to fetch the bytes of the slice
+// and `readahead` bytes past the end of the tensor, the start of the
+// tensors that usually follow.
+namespace {
+// the header of a safetensors file is bounded by its format
+constexpr uint64_t kMaxHeaderBytes = 100 * 1024 * 1024;
+// bytes a thread of a read copies at least, so that small tensors are
+// copied by the calling thread alone
+constexpr int64_t kMinTaskBytes = 4 * 1024 * 1024;
+
+struct DtypeInfo {
+  const char *name;
+  int64_t itemsize;
+};
+
+const DtypeInfo kDtypes[] = {
+    {"BOOL", 1}, {"U8", 1},  {"I8", 1},  {"F8_E5M2", 1}, {"F8_E4M3", 1},
+    {"I16", 2},  {"U16", 2}, {"F16", 2}, {"BF16", 2},    {"I32", 4},
+    {"U32", 4},  {"F32", 4}, {"F64", 8}, {"I64", 8},     {"U64", 8}};
+
+int64_t DtypeItemsize(const std::string &dtype) {
+  for (const auto &info : kDtypes) {
+    if (dtype == info.name) {
+      return info.itemsize;
+    }
+  }
+  return 0;
+}
+
+struct TensorEntry {
+  std::string name;
+  std::string dtype;
+  int64_t itemsize;
+  std::vector<int64_t> shape;
+  uint64_t begin; // offsets into the data, past the header
+  uint64_t end;
+};
+
+// Just enough JSON for a safetensors header: objects, arrays, strings and
+// non-negative integers are read, any other value is skipped.
+class HeaderParser {
+public:
+  HeaderParser(const char *begin, const char *end) : pos_(begin), end_(end) {}
+
+  bool Parse(std::vector<TensorEntry> *tensors) {
+    if (!Consume('{')) {
+      return false;
+    }
+    if (Consume('}')) {
+      return AtEnd();
+    }
+    do {
+      std::string name;
+      if (!ParseString(&name) || !Consume(':')) {
+        return false;
+      }
+      if (name == "__metadata__") {
+        if (!SkipValue(0)) {
+          return false;
+        }
+        continue;
+      }
+      TensorEntry entry;
+      entry.name = std::move(name);
+      if (!ParseTensor(&entry)) {
+        return false;
+      }
+      tensors->push_back(std::move(entry));
+    } while (Consume(','));
+    return Consume('}') && AtEnd();
+  }
+
+private:
+  void SkipSpace() {
+    while (pos_ < end_ &&
+           (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipSpace();
+    if (pos_ < end_ && *pos_ == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  // safetensors pads the header with spaces
+  bool AtEnd() {
+    SkipSpace();
+    return pos_ == end_;
+  }
+
+  bool ParseHex4(uint32_t *code) {
+    if (end_ - pos_ < 4) {
+      return false;
+    }
+    *code = 0;
+    for (int i = 0; i < 4; ++i, ++pos_) {
+      char c = *pos_;
+      uint32_t digit = c >= '0' && c <= '9'   ? c - '0'
+                       : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                       : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                              : 16;
+      if (digit == 16) {
+        return false;
+      }
+      *code = *code * 16 + digit;
+    }
+    return true;
+  }
+
+  static void AppendUtf8(uint32_t code, std::string *out) {
+    if (code < 0x80) {
+      out->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out->push_back(static_cast<char>(0xc0 | (code >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+      out->push_back(static_cast<char>(0xe0 | (code >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+      out->push_back(static_cast<char>(0xf0 | (code >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+  }
+
+  bool ParseString(std::string *out) {
+    if (!Consume('"')) {
+      return false;
+    }
+    while (pos_ < end_ && *pos_ != '"') {
+      if (*pos_ != '\\') {
+        out->push_back(*pos_++);
+        continue;
+      }
+      if (++pos_ == end_) {
+        return false;
+      }
+      char c = *pos_++;
+      switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        out->push_back(c);
+        break;
+      case 'b':
+        out->push_back('\b');
+        break;
+      case 'f':
+        out->push_back('\f');
+        break;
+      case 'n':
+        out->push_back('\n');
+        break;
+      case 'r':
+        out->push_back('\r');
+        break;
+      case 't':
+        out->push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code = 0;
+        if (!ParseHex4(&code)) {
+          return false;
+        }
+        // a surrogate pair encodes one code point above the BMP
+        uint32_t low = 0;
+        if (code >= 0xd800 && code < 0xdc00 && end_ - pos_ >= 2 &&
+            pos_[0] == '\\' && pos_[1] == 'u') {
+          pos_ += 2;
+          if (!ParseHex4(&low) || low < 0xdc00 || low >= 0xe000) {
+            return false;
+          }
+          code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        }
+        AppendUtf8(code, out);
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    return Consume('"');
+  }
+
+  bool ParseInt(int64_t *out) {
+    SkipSpace();
+    const char *start = pos_;
+    int64_t value = 0;
+    while (pos_ < end_ && *pos_ >= '0' && *pos_ <= '9') {
+      if (value > (INT64_MAX - 9) / 10) {
+        return false;
+      }
+      value = value * 10 + (*pos_++ - '0');
+    }
+    *out = value;
+    return pos_ != start;
+  }
+
+  bool ParseIntArray(std::vector<int64_t> *out) {
+    if (!Consume('[')) {
+      return false;
+    }
+    if (Consume(']')) {
+      return true;
+    }
+    do {
+      int64_t value = 0;
+      if (!ParseInt(&value)) {
+        return false;
+      }
+      out->push_back(value);
+    } while (Consume(','));
+    return Consume(']');
+  }
+
+  bool ParseTensor(TensorEntry *entry) {
+    if (!Consume('{')) {
+      return false;
+    }
+    bool has_dtype = false;
+    bool has_shape = false;
+    std::vector<int64_t> offsets;
+    if (!Consume('}')) {
+      do {
+        std::string key;
+        if (!ParseString(&key) || !Consume(':')) {
+          return false;
+        }
+        bool parsed = false;
+        if (key == "dtype") {
+          parsed = ParseString(&entry->dtype);
+          has_dtype = true;
+        } else if (key == "shape") {
+          parsed = ParseIntArray(&entry->shape);
+          has_shape = true;
+        } else if (key == "data_offsets") {
+          parsed = ParseIntArray(&offsets);
+        } else {
+          parsed = SkipValue(0);
+        }
+        if (!parsed) {
+          return false;
+        }
+      } while (Consume(','));
+      if (!Consume('}')) {
+        return false;
+      }
+    }
+    if (!has_dtype || !has_shape || offsets.size() != 2) {
+      return false;
+    }
+    entry->begin = static_cast<uint64_t>(offsets[0]);
+    entry->end = static_cast<uint64_t>(offsets[1]);
+    return true;
+  }
+
+  bool SkipValue(int depth) {
+    // nesting deeper than any sane header is taken as garbage
+    if (depth > 64) {
+      return false;
+    }
+    SkipSpace();
+    if (pos_ == end_) {
+      return false;
+    }
+    if (*pos_ == '"') {
+      std::string ignored;
+      return ParseString(&ignored);
+    }
+    if (*pos_ == '{' || *pos_ == '[') {
+      char close = *pos_ == '{' ? '}' : ']';
+      bool object = *pos_++ == '{';
+      if (Consume(close)) {
+        return true;
+      }
+      do {
+        if (object) {
+          std::string ignored;
+          if (!ParseString(&ignored) || !Consume(':')) {
+            return false;
+          }
+        }
+        if (!SkipValue(depth + 1)) {
+          return false;
+        }
+      } while (Consume(','));
+      return Consume(close);
+    }
+    // numbers, true, false and null
+    const char *start = pos_;
+    while (pos_ < end_ && *pos_ != ',' && *pos_ != '}' && *pos_ != ']' &&
+           *pos_ != ' ' && *pos_ != '\n' && *pos_ != '\r' && *pos_ != '\t') {
+      ++pos_;
+    }
+    return pos_ != start;
+  }
+
+  const char *pos_;
+  const char *end_;
+};
+
+class SafetensorsFile {
+public:
+  SafetensorsFile() = default;
+  ~SafetensorsFile() {
+    if (map_ != nullptr) {
+      munmap(map_, map_bytes_);
+    }
+  }
+
+  // Disable copy and assignment
+  SafetensorsFile(const SafetensorsFile &) = delete;
+  SafetensorsFile &operator=(const SafetensorsFile &) = delete;
+
+  // Returns false with `error` set if the file cannot be mapped or is no
+  // valid safetensors file
+  bool Open(const std::string &path, int64_t readahead, std::string *error) {
+    readahead_ = readahead;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      *error = std::string("cannot open: ") + std::strerror(errno);
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < 8) {
+      close(fd);
+      *error = "not a safetensors file";
+      return false;
+    }
+    map_bytes_ = static_cast<size_t>(st.st_size);
+    if (readahead_ > 0) {
+      // the data is mostly read front to back, one tensor after the other
+      posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    void *map = mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping holds its own reference to the file
+    close(fd);
+    if (map == MAP_FAILED) {
+      *error = std::string("cannot map: ") + std::strerror(errno);
+      return false;
+    }
+    map_ = static_cast<uint8_t *>(map);
+
+    uint64_t header_bytes = 0;
+    for (int i = 7; i >= 0; --i) {
+      header_bytes = (header_bytes << 8) | map_[i];
+    }
+    if (header_bytes > kMaxHeaderBytes || header_bytes > map_bytes_ - 8) {
+      *error = "invalid header length";
+      return false;
+    }
+    const char *header = reinterpret_cast<const char *>(map_ + 8);
+    if (!HeaderParser(header, header + header_bytes).Parse(&tensors_)) {
+      *error = "invalid JSON header";
+      return false;
+    }
+    data_ = map_ + 8 + header_bytes;
+    uint64_t data_bytes = map_bytes_ - 8 - header_bytes;
+    for (auto &entry : tensors_) {
+      entry.itemsize = DtypeItemsize(entry.dtype);
+      if (entry.itemsize == 0) {
+        *error = "tensor " + entry.name + " has unknown dtype " + entry.dtype;
+        return false;
+      }
+      uint64_t nbytes = static_cast<uint64_t>(entry.itemsize);
+      for (int64_t dim : entry.shape) {
+        // a wrapped product could match the data offsets of a smaller one
+        if (dim != 0 && nbytes > UINT64_MAX / static_cast<uint64_t>(dim)) {
+          *error = "tensor " + entry.name + " has a shape too large";
+          return false;
+        }
+        nbytes *= static_cast<uint64_t>(dim);
+      }
+      if (entry.begin > entry.end || entry.end > data_bytes ||
+          entry.end - entry.begin != nbytes) {
+        *error = "tensor " + entry.name + " has invalid data offsets";
+        return false;
+      }
+    }
+    // in file order, which a loader walking the names reads sequentially
+    std::sort(tensors_.begin(), tensors_.end(),
+              [](const TensorEntry &a, const TensorEntry &b) {
+                return a.begin < b.begin;
+              });
+    index_.reserve(tensors_.size());
+    for (size_t i = 0; i < tensors_.size(); ++i) {
+      if (!index_.emplace(tensors_[i].name, i).second) {
+        *error = "tensor " + tensors_[i].name + " appears twice";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const std::vector<TensorEntry> &tensors() const { return tensors_; }
+
+  const TensorEntry *Find(const std::string &name) const {
+    auto iter = index_.find(name);
+    return iter == index_.end() ? nullptr : &tensors_[iter->second];
+  }
+
+  // Copy rows [start, start + size) of `dim` of the tensor, clamped to its
+  // shape, into `out`, which holds exactly their bytes.
+  void ReadSlice(const TensorEntry &entry, int dim, int64_t start,
+                 int64_t size, uint8_t *out, int num_threads) const {
+    int64_t outer = 1;
+    for (int d = 0; d < dim; ++d) {
+      outer *= entry.shape[d];
+    }
+    int64_t inner = entry.itemsize;
+    for (size_t d = dim + 1; d < entry.shape.size(); ++d) {
+      inner *= entry.shape[d];
+    }
+    int64_t src_row = entry.shape.empty() ? inner : entry.shape[dim] * inner;
+    int64_t dst_row = size * inner;
+    int64_t total = outer * dst_row;
+    if (total == 0) {
+      return;
+    }
+    const uint8_t *src = data_ + entry.begin + start * inner;
+    Prefetch(entry, src, src + (outer - 1) * src_row + dst_row);
+
+    // split the destination into even byte ranges, each copying the parts
+    // of the rows it covers
+    int max_threads = num_threads <= 0 ? HostThreadPool::Instance().NumThreads()
+                                       : num_threads;
+    int64_t num_tasks = std::max<int64_t>(
+        1, std::min<int64_t>(total / kMinTaskBytes, 4 * max_threads));
+    int64_t task_bytes = (total + num_tasks - 1) / num_tasks;
+    HostThreadPool::Instance().ParallelFor(
+        num_tasks, num_threads, [&](int64_t task) {
+          int64_t begin = task * task_bytes;
+          int64_t end = std::min(total, begin + task_bytes);
+          while (begin < end) {
+            int64_t row = begin / dst_row;
+            int64_t offset = begin - row * dst_row;
+            int64_t bytes = std::min(end - begin, dst_row - offset);
+            std::memcpy(out + begin, src + row * src_row + offset, bytes);
+            begin += bytes;
+          }
+        });
+  }
+
+private:
+  void Prefetch(const TensorEntry &entry, const uint8_t *begin,
+                const uint8_t *end) const {
+    if (readahead_ <= 0) {
+      return;
+    }
+    const uint8_t *tensor_end = data_ + entry.end;
+    const uint8_t *map_end = map_ + map_bytes_;
+    end = std::max(end, std::min(map_end, tensor_end + readahead_));
+    auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto aligned = reinterpret_cast<uintptr_t>(begin) & ~(page - 1);
+    madvise(reinterpret_cast<void *>(aligned),
+            reinterpret_cast<uintptr_t>(end) - aligned, MADV_WILLNEED);
+  }
+
+  uint8_t *map_{nullptr};
+  size_t map_bytes_{0};
+  const uint8_t *data_{nullptr};
+  int64_t readahead_{0};
+  std::vector<TensorEntry> tensors_;
+  std::unordered_map<std::string, size_t> index_;
+};
+
+struct SafetensorsFileObject {
+  PyObject_HEAD SafetensorsFile *file;
+};
+
+void SafetensorsFileDealloc(PyObject *self) {
+  delete reinterpret_cast<SafetensorsFileObject *>(self)->file;
+  Py_TYPE(self)->tp_free(self);
+}
+
+int SafetensorsFileInit(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"path", "readahead", NULL};
+  auto *obj = reinterpret_cast<SafetensorsFileObject *>(self);
+  PyObject *path = NULL;
+  Py_ssize_t readahead = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|$n:SafetensorsFile",
+                                   const_cast<char **>(kwlist),
+                                   PyUnicode_FSConverter, &path, &readahead)) {
+    return -1;
+  }
+  if (obj->file != NULL) {
+    Py_DECREF(path);
+    PyErr_SetString(PyExc_RuntimeError, "SafetensorsFile is initialized");
+    return -1;
+  }
+  std::string filename(PyBytes_AS_STRING(path));
+  Py_DECREF(path);
+  auto *file = new SafetensorsFile();
+  std::string error;
+  bool opened = false;
+  Py_BEGIN_ALLOW_THREADS;
+  opened = file->Open(filename, readahead, &error);
+  Py_END_ALLOW_THREADS;
+  if (!opened) {
+    delete file;
+    PyErr_Format(PyExc_ValueError, "%s: %s", filename.c_str(), error.c_str());
+    return -1;
+  }
+  obj->file = file;
+  return 0;
+}
+
+SafetensorsFile *GetFile(PyObject *self) {
+  auto *file = reinterpret_cast<SafetensorsFileObject *>(self)->file;
+  if (file == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "SafetensorsFile is not initialized");
+  }
+  return file;
+}
+
+const TensorEntry *FindTensor(const SafetensorsFile *file, PyObject *name) {
+  const char *chars = PyUnicode_AsUTF8(name);
+  if (chars == NULL) {
+    return nullptr;
+  }
+  const TensorEntry *entry = file->Find(chars);
+  if (entry == nullptr) {
+    PyErr_Format(PyExc_KeyError, "no tensor %R in the file", name);
+  }
+  return entry;
+}
+
+PyObject *SafetensorsFileKeys(PyObject *self, PyObject *) {
+  auto *file = GetFile(self);
+  if (file == NULL) {
+    return NULL;
+  }
+  const auto &tensors = file->tensors();
+  PyObject *keys = PyList_New(static_cast<Py_ssize_t>(tensors.size()));
+  if (keys == NULL) {
+    return NULL;
+  }
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    PyObject *name = PyUnicode_FromStringAndSize(tensors[i].name.data(),
+                                                 tensors[i].name.size());
+    if (name == NULL) {
+      Py_DECREF(keys);
+      return NULL;
+    }
+    PyList_SET_ITEM(keys, i, name);
+  }
+  return keys;
+}
+
+PyObject *SafetensorsFileInfo(PyObject *self, PyObject *arg) {
+  auto *file = GetFile(self);
+  if (file == NULL) {
+    return NULL;
+  }
+  const TensorEntry *entry = FindTensor(file, arg);
+  if (entry == nullptr) {
+    return NULL;
+  }
+  PyObject *shape = PyTuple_New(static_cast<Py_ssize_t>(entry->shape.size()));
+  if (shape == NULL) {
+    return NULL;
+  }
+  for (size_t d = 0; d < entry->shape.size(); ++d) {
+    PyObject *dim = PyLong_FromLongLong(entry->shape[d]);
+    if (dim == NULL) {
+      Py_DECREF(shape);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(shape, d, dim);
+  }
+  return Py_BuildValue("(sN)", entry->dtype.c_str(), shape);
+}
+
+PyObject *SafetensorsFileRead(PyObject *self, PyObject *args,
+                              PyObject *kwargs) {
+  static const char *kwlist[] = {"name", "out",  "dim", "start",
+                                 "size", "num_threads", NULL};
+  auto *file = GetFile(self);
+  if (file == NULL) {
+    return NULL;
+  }
+  PyObject *name = NULL;
+  PyObject *out = NULL;
+  Py_ssize_t dim = -1;
+  Py_ssize_t start = 0;
+  Py_ssize_t size = -1;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "UO|$nnni:read",
+                                   const_cast<char **>(kwlist), &name, &out,
+                                   &dim, &start, &size, &num_threads)) {
+    return NULL;
+  }
+  const TensorEntry *entry = FindTensor(file, name);
+  if (entry == nullptr) {
+    return NULL;
+  }
+  auto ndim = static_cast<Py_ssize_t>(entry->shape.size());
+  if (dim >= ndim || (dim >= 0 && start < 0)) {
+    PyErr_Format(PyExc_ValueError,
+                 "cannot slice dim %zd from %zd of a %zd-d tensor", dim, start,
+                 ndim);
+    return NULL;
+  }
+  // the whole tensor is one slice of its first dim; a slice past the end of
+  // the dim is clamped, as numpy slicing does
+  int read_dim = dim < 0 ? 0 : static_cast<int>(dim);
+  int64_t length = ndim == 0 ? 1 : entry->shape[read_dim];
+  int64_t begin = dim < 0 ? 0 : std::min<int64_t>(start, length);
+  int64_t rows = dim < 0 || size < 0 ? length - begin
+                                     : std::min<int64_t>(size, length - begin);
+  uint64_t nbytes = (entry->end - entry->begin) / (length == 0 ? 1 : length);
+  nbytes = length == 0 ? 0 : nbytes * rows;
+
+  // No PyBUF_FORMAT: numpy does not describe some dtypes (bfloat16) in a
+  // format string, and only the bytes matter here.
+  Py_buffer view;
+  if (PyObject_GetBuffer(out, &view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) <
+      0) {
+    return NULL;
+  }
+  if (static_cast<uint64_t>(view.len) != nbytes) {
+    PyErr_Format(PyExc_ValueError,
+                 "out holds %zd bytes, the slice of %U %llu", view.len, name,
+                 static_cast<unsigned long long>(nbytes));
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS;
+  file->ReadSlice(*entry, ndim == 0 ? -1 : read_dim, begin, rows,
+                  static_cast<uint8_t *>(view.buf), num_threads);
+  Py_END_ALLOW_THREADS;
+  PyBuffer_Release(&view);
+  Py_RETURN_NONE;
+}
+
+PyMethodDef safetensors_file_methods[] = {
+    {"keys", SafetensorsFileKeys, METH_NOARGS,
+     "Names of the tensors, in the order of their data in the file."},
+    {"info", SafetensorsFileInfo, METH_O,
+     "info(name) -> (dtype, shape)\n\n"
+     "Safetensors dtype string, e.g. 'BF16', and shape tuple of a tensor."},
+    {"read", reinterpret_cast<PyCFunction>(SafetensorsFileRead),
+     METH_VARARGS | METH_KEYWORDS,
+     "read(name, out, *, dim=-1, start=0, size=-1, num_threads=0)\n\n"
+     "Copy the tensor into the C-contiguous writable buffer `out`, or with\n"
+     "`dim` >= 0 only its rows [start, start + size) along `dim`, clamped\n"
+     "to the shape; size -1 reads to the end. `out` must hold exactly the\n"
+     "bytes read. The copy runs on up to `num_threads` threads of the host\n"
+     "pool, 0 for all of them."},
+    {NULL, NULL, 0, NULL}};
+
+PyTypeObject SafetensorsFileType = {PyVarObject_HEAD_INIT(NULL, 0)};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  SafetensorsFileType.tp_name = "vllm_mindspore._C_host.SafetensorsFile";
+  SafetensorsFileType.tp_basicsize = sizeof(SafetensorsFileObject);
+  SafetensorsFileType.tp_dealloc = SafetensorsFileDealloc;
+  SafetensorsFileType.tp_flags = Py_TPFLAGS_DEFAULT;
+  SafetensorsFileType.tp_doc =
+      "SafetensorsFile(path, *, readahead=0)\n\n"
+      "A safetensors file mapped read-only, with its header parsed. Reads\n"
+      "ask the kernel to fetch `readahead` bytes past the end of the tensor\n"
+      "read, 0 leaves the readahead to the kernel.";
+  SafetensorsFileType.tp_methods = safetensors_file_methods;
+  SafetensorsFileType.tp_init = SafetensorsFileInit;
+  SafetensorsFileType.tp_new = PyType_GenericNew;
+  if (PyType_Ready(&SafetensorsFileType) < 0) {
+    return -1;
+  }
+  Py_INCREF(&SafetensorsFileType);
+  if (PyModule_AddObject(m, "SafetensorsFile",
+                         reinterpret_cast<PyObject *>(&SafetensorsFileType)) <
+      0) {
+    Py_DECREF(&SafetensorsFileType);
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,507 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#include "host/module.h"
+
+// RingBufferQueue: the synchronization of a single-writer / n-reader ring of
+// chunks in shared memory, for shm_broadcast.
+//
+// The chunks themselves keep the layout of ShmRingBuffer: max_chunks chunks
+// of max_chunk_bytes at the start of the buffer. Instead of a written flag
+// and n_reader read flags per chunk, polled from Python, the metadata that
+// follows the chunks holds one sequence number per party:
+// - the writer publishes chunk `seq % max_chunks` by moving its sequence
+//   number past `seq`, and can write it once every reader has moved past
+//   `seq - max_chunks`;
+// - reader r reads chunk `seq % max_chunks` once the writer has moved past
+//   its own sequence number `seq`, then moves past it.
+// Each sequence number sits on its own cache line with a futex word, bumped
+// with every move, so that a party waits without burning CPU after a short
+// spin, and a move only costs a syscall when somebody is sleeping on it.
+namespace {
+constexpr uint64_t kRingMagic = 0x676e69726d736c76; // "vlsmring"
+constexpr size_t kCacheLineBytes = 64;
+// Some tens of microseconds of spinning, to catch a broadcast already on its
+// way without a syscall, before going to sleep
+constexpr int kSpinIterations = 1024;
+
+struct alignas(kCacheLineBytes) RingHeader {
+  std::atomic<uint64_t> magic;
+  uint64_t n_reader;
+  uint64_t max_chunk_bytes;
+  uint64_t max_chunks;
+};
+
+struct alignas(kCacheLineBytes) SeqCounter {
+  std::atomic<uint64_t> seq;
+  // bumped after every move of seq, waited on with FUTEX_WAIT
+  std::atomic<uint32_t> futex;
+  // number of parties sleeping on the futex word
+  std::atomic<uint32_t> waiters;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the ring buffer needs lock-free 64-bit atomics");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex words are 32-bit");
+static_assert(sizeof(SeqCounter) == kCacheLineBytes,
+              "one sequence number per cache line");
+
+// header, writer sequence number, then one sequence number per reader
+size_t RingMetadataBytes(size_t n_reader) {
+  return sizeof(RingHeader) + sizeof(SeqCounter) * (1 + n_reader);
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Shared (not private) futexes: the parties are different processes.
+inline void FutexWait(std::atomic<uint32_t> *word, uint32_t expected,
+                      const struct timespec *timeout) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected,
+          timeout, nullptr, 0);
+}
+
+inline void FutexWake(std::atomic<uint32_t> *word, int count) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, count,
+          nullptr, nullptr, 0);
+}
+
+void Publish(SeqCounter *counter, uint64_t seq, int wake_count) {
+  counter->seq.store(seq);
+  counter->futex.fetch_add(1);
+  if (counter->waiters.load() > 0) {
+    FutexWake(&counter->futex, wake_count);
+  }
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Wait until `ready()` holds, which only turns true with a move of
+// `counter`. Returns false when `deadline` passes first, no deadline waits
+// forever.
+template <typename Ready>
+bool WaitFor(SeqCounter *counter, const Ready &ready,
+             const Clock::time_point *deadline) {
+  for (int i = 0; i < kSpinIterations; ++i) {
+    if (ready()) {
+      return true;
+    }
+    CpuRelax();
+  }
+  while (true) {
+    // Read the futex word before the condition, and announce the waiter
+    // before checking it: a move after the check either changes the word,
+    // so that FUTEX_WAIT returns at once, or sees the waiter and wakes it.
+    uint32_t word = counter->futex.load();
+    counter->waiters.fetch_add(1);
+    if (ready()) {
+      counter->waiters.fetch_sub(1);
+      return true;
+    }
+    struct timespec timeout;
+    if (deadline != nullptr) {
+      auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           *deadline - Clock::now())
+                           .count();
+      if (remaining <= 0) {
+        counter->waiters.fetch_sub(1);
+        return false;
+      }
+      timeout.tv_sec = remaining / 1000000000;
+      timeout.tv_nsec = remaining % 1000000000;
+    }
+    FutexWait(&counter->futex, word, deadline == nullptr ? nullptr : &timeout);
+    counter->waiters.fetch_sub(1);
+  }
+}
+
+class RingBufferQueue {
+public:
+  RingBufferQueue(uint8_t *metadata, uint64_t n_reader)
+      : header_(reinterpret_cast<RingHeader *>(metadata)),
+        writer_(reinterpret_cast<SeqCounter *>(metadata + sizeof(RingHeader))),
+        readers_(writer_ + 1), n_reader_(n_reader) {}
+
+  void Init(uint64_t max_chunk_bytes, uint64_t max_chunks) {
+    std::memset(static_cast<void *>(header_), 0, RingMetadataBytes(n_reader_));
+    header_->n_reader = n_reader_;
+    header_->max_chunk_bytes = max_chunk_bytes;
+    header_->max_chunks = max_chunks;
+    header_->magic.store(kRingMagic);
+  }
+
+  bool Matches(uint64_t max_chunk_bytes, uint64_t max_chunks) const {
+    return header_->magic.load() == kRingMagic &&
+           header_->n_reader == n_reader_ &&
+           header_->max_chunk_bytes == max_chunk_bytes &&
+           header_->max_chunks == max_chunks;
+  }
+
+  uint64_t max_chunks() const { return header_->max_chunks; }
+  uint64_t n_reader() const { return n_reader_; }
+  uint64_t WriteSeq() const { return writer_->seq.load(); }
+  uint64_t ReadSeq(uint64_t reader) const {
+    return readers_[reader].seq.load();
+  }
+
+  bool Writable(uint64_t reader, uint64_t seq) const {
+    return ReadSeq(reader) + max_chunks() > seq;
+  }
+
+  bool Writable() const {
+    uint64_t seq = WriteSeq();
+    for (uint64_t r = 0; r < n_reader_; ++r) {
+      if (!Writable(r, seq)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool Readable(uint64_t reader) const { return WriteSeq() > ReadSeq(reader); }
+
+  // The writer waits for the readers one by one, on the futex of the one
+  // holding the chunk back; sequence numbers only grow, so a reader done
+  // with the chunk stays done.
+  bool WaitWritable(const Clock::time_point *deadline) {
+    uint64_t seq = WriteSeq();
+    for (uint64_t r = 0; r < n_reader_; ++r) {
+      if (!WaitFor(
+              &readers_[r], [this, r, seq] { return Writable(r, seq); },
+              deadline)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool WaitReadable(uint64_t reader, const Clock::time_point *deadline) {
+    return WaitFor(
+        writer_, [this, reader] { return Readable(reader); }, deadline);
+  }
+
+  // only the writer sleeps on a reader, all the readers on the writer
+  void CommitWrite() { Publish(writer_, WriteSeq() + 1, INT_MAX); }
+  void CommitRead(uint64_t reader) {
+    Publish(&readers_[reader], ReadSeq(reader) + 1, 1);
+  }
+
+private:
+  RingHeader *header_;
+  SeqCounter *writer_;
+  SeqCounter *readers_;
+  uint64_t n_reader_;
+};
+
+struct RingBufferQueueObject {
+  PyObject_HEAD Py_buffer view;
+  RingBufferQueue *queue;
+};
+
+void RingBufferQueueDealloc(PyObject *self) {
+  auto *obj = reinterpret_cast<RingBufferQueueObject *>(self);
+  delete obj->queue;
+  if (obj->view.obj != NULL) {
+    PyBuffer_Release(&obj->view);
+  }
+  Py_TYPE(self)->tp_free(self);
+}
+
+int RingBufferQueueInit(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static const char *kwlist[] = {"buffer",    "metadata_offset", "n_reader",
+                                 "max_chunk_bytes", "max_chunks", "create",
+                                 NULL};
+  auto *obj = reinterpret_cast<RingBufferQueueObject *>(self);
+  PyObject *buffer = NULL;
+  Py_ssize_t metadata_offset = 0;
+  Py_ssize_t n_reader = 0;
+  Py_ssize_t max_chunk_bytes = 0;
+  Py_ssize_t max_chunks = 0;
+  int create = 0;
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "Onnnnp:RingBufferQueue", const_cast<char **>(kwlist),
+          &buffer, &metadata_offset, &n_reader, &max_chunk_bytes, &max_chunks,
+          &create)) {
+    return -1;
+  }
+  if (n_reader < 0 || max_chunk_bytes <= 0 || max_chunks <= 0) {
+    PyErr_Format(PyExc_ValueError,
+                 "invalid ring buffer: n_reader=%zd, max_chunk_bytes=%zd, "
+                 "max_chunks=%zd",
+                 n_reader, max_chunk_bytes, max_chunks);
+    return -1;
+  }
+  if (metadata_offset < 0 ||
+      metadata_offset % static_cast<Py_ssize_t>(kCacheLineBytes) != 0) {
+    PyErr_Format(PyExc_ValueError,
+                 "metadata_offset must be a multiple of %zu, got %zd",
+                 kCacheLineBytes, metadata_offset);
+    return -1;
+  }
+  if (obj->view.obj != NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "RingBufferQueue is initialized");
+    return -1;
+  }
+  if (PyObject_GetBuffer(buffer, &obj->view, PyBUF_WRITABLE) < 0) {
+    obj->view.obj = NULL;
+    return -1;
+  }
+  auto metadata_bytes = static_cast<Py_ssize_t>(RingMetadataBytes(n_reader));
+  auto *metadata = static_cast<uint8_t *>(obj->view.buf) + metadata_offset;
+  if (obj->view.len < metadata_offset + metadata_bytes ||
+      reinterpret_cast<uintptr_t>(metadata) % kCacheLineBytes != 0) {
+    PyErr_Format(PyExc_ValueError,
+                 "buffer of %zd bytes has no aligned ring metadata of %zd "
+                 "bytes at offset %zd",
+                 obj->view.len, metadata_bytes, metadata_offset);
+    PyBuffer_Release(&obj->view);
+    obj->view.obj = NULL;
+    return -1;
+  }
+  obj->queue = new RingBufferQueue(metadata, n_reader);
+  if (create) {
+    obj->queue->Init(max_chunk_bytes, max_chunks);
+  } else if (!obj->queue->Matches(max_chunk_bytes, max_chunks)) {
+    PyErr_SetString(PyExc_ValueError,
+                    "the shared memory does not hold a ring buffer of this "
+                    "n_reader, max_chunk_bytes and max_chunks");
+    delete obj->queue;
+    obj->queue = NULL;
+    PyBuffer_Release(&obj->view);
+    obj->view.obj = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+RingBufferQueue *GetQueue(PyObject *self) {
+  auto *queue = reinterpret_cast<RingBufferQueueObject *>(self)->queue;
+  if (queue == NULL) {
+    PyErr_SetString(PyExc_RuntimeError, "RingBufferQueue is not initialized");
+  }
+  return queue;
+}
+
+// None waits forever, otherwise a timeout in seconds
+bool ParseDeadline(PyObject *timeout, Clock::time_point *deadline,
+                   bool *has_deadline) {
+  *has_deadline = timeout != Py_None;
+  if (!*has_deadline) {
+    return true;
+  }
+  double seconds = PyFloat_AsDouble(timeout);
+  if (seconds == -1.0 && PyErr_Occurred()) {
+    return false;
+  }
+  // clamped to a day, far beyond any sensible timeout, to stay in range
+  seconds = seconds > 0.0 ? (seconds < 86400.0 ? seconds : 86400.0) : 0.0;
+  *deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double>(seconds));
+  return true;
+}
+
+bool ParseReader(RingBufferQueue *queue, Py_ssize_t reader) {
+  if (reader < 0 || static_cast<uint64_t>(reader) >= queue->n_reader()) {
+    PyErr_Format(PyExc_IndexError, "reader %zd out of range [0, %llu)", reader,
+                 static_cast<unsigned long long>(queue->n_reader()));
+    return false;
+  }
+  return true;
+}
+
+PyObject *RingBufferQueueWaitWrite(PyObject *self, PyObject *args,
+                                   PyObject *kwargs) {
+  static const char *kwlist[] = {"timeout", NULL};
+  PyObject *timeout = Py_None;
+  auto *queue = GetQueue(self);
+  if (queue == NULL ||
+      !PyArg_ParseTupleAndKeywords(args, kwargs, "|O:wait_write",
+                                   const_cast<char **>(kwlist), &timeout)) {
+    return NULL;
+  }
+  Clock::time_point deadline;
+  bool has_deadline = false;
+  if (!ParseDeadline(timeout, &deadline, &has_deadline)) {
+    return NULL;
+  }
+  bool ready = false;
+  Py_BEGIN_ALLOW_THREADS;
+  ready = queue->WaitWritable(has_deadline ? &deadline : nullptr);
+  Py_END_ALLOW_THREADS;
+  return PyBool_FromLong(ready);
+}
+
+PyObject *RingBufferQueueWaitRead(PyObject *self, PyObject *args,
+                                  PyObject *kwargs) {
+  static const char *kwlist[] = {"reader", "timeout", NULL};
+  Py_ssize_t reader = 0;
+  PyObject *timeout = Py_None;
+  auto *queue = GetQueue(self);
+  if (queue == NULL ||
+      !PyArg_ParseTupleAndKeywords(args, kwargs, "n|O:wait_read",
+                                   const_cast<char **>(kwlist), &reader,
+                                   &timeout) ||
+      !ParseReader(queue, reader)) {
+    return NULL;
+  }
+  Clock::time_point deadline;
+  bool has_deadline = false;
+  if (!ParseDeadline(timeout, &deadline, &has_deadline)) {
+    return NULL;
+  }
+  bool ready = false;
+  Py_BEGIN_ALLOW_THREADS;
+  ready = queue->WaitReadable(reader, has_deadline ? &deadline : nullptr);
+  Py_END_ALLOW_THREADS;
+  return PyBool_FromLong(ready);
+}
+
+PyObject *RingBufferQueueCommitWrite(PyObject *self, PyObject *) {
+  auto *queue = GetQueue(self);
+  if (queue == NULL) {
+    return NULL;
+  }
+  if (!queue->Writable()) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "commit_write on a chunk the readers still hold");
+    return NULL;
+  }
+  queue->CommitWrite();
+  Py_RETURN_NONE;
+}
+
+PyObject *RingBufferQueueCommitRead(PyObject *self, PyObject *arg) {
+  auto *queue = GetQueue(self);
+  if (queue == NULL) {
+    return NULL;
+  }
+  Py_ssize_t reader = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+  if ((reader == -1 && PyErr_Occurred()) || !ParseReader(queue, reader)) {
+    return NULL;
+  }
+  if (!queue->Readable(reader)) {
+    PyErr_SetString(PyExc_RuntimeError, "commit_read on an unwritten chunk");
+    return NULL;
+  }
+  queue->CommitRead(reader);
+  Py_RETURN_NONE;
+}
+
+PyObject *RingBufferQueueWriteIndex(PyObject *self, PyObject *) {
+  auto *queue = GetQueue(self);
+  if (queue == NULL) {
+    return NULL;
+  }
+  return PyLong_FromUnsignedLongLong(queue->WriteSeq() % queue->max_chunks());
+}
+
+PyObject *RingBufferQueueReadIndex(PyObject *self, PyObject *arg) {
+  auto *queue = GetQueue(self);
+  if (queue == NULL) {
+    return NULL;
+  }
+  Py_ssize_t reader = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+  if ((reader == -1 && PyErr_Occurred()) || !ParseReader(queue, reader)) {
+    return NULL;
+  }
+  return PyLong_FromUnsignedLongLong(queue->ReadSeq(reader) %
+                                     queue->max_chunks());
+}
+
+PyObject *RingBufferQueueMetadataBytes(PyObject *, PyObject *arg) {
+  Py_ssize_t n_reader = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+  if (n_reader == -1 && PyErr_Occurred()) {
+    return NULL;
+  }
+  if (n_reader < 0) {
+    PyErr_SetString(PyExc_ValueError, "n_reader must not be negative");
+    return NULL;
+  }
+  return PyLong_FromSize_t(RingMetadataBytes(n_reader));
+}
+
+PyMethodDef ring_buffer_queue_methods[] = {
+    {"wait_write", reinterpret_cast<PyCFunction>(RingBufferQueueWaitWrite),
+     METH_VARARGS | METH_KEYWORDS,
+     "wait_write(timeout=None) -> bool\n\n"
+     "Wait until the next chunk to write is read by all the readers.\n"
+     "Returns False if `timeout` seconds pass first."},
+    {"commit_write", RingBufferQueueCommitWrite, METH_NOARGS,
+     "Publish the chunk at write_index() to the readers."},
+    {"wait_read", reinterpret_cast<PyCFunction>(RingBufferQueueWaitRead),
+     METH_VARARGS | METH_KEYWORDS,
+     "wait_read(reader, timeout=None) -> bool\n\n"
+     "Wait until the next chunk of `reader` is written.\n"
+     "Returns False if `timeout` seconds pass first."},
+    {"commit_read", RingBufferQueueCommitRead, METH_O,
+     "commit_read(reader)\n\n"
+     "Hand the chunk at read_index(reader) back to the writer."},
+    {"write_index", RingBufferQueueWriteIndex, METH_NOARGS,
+     "Index of the next chunk to write."},
+    {"read_index", RingBufferQueueReadIndex, METH_O,
+     "read_index(reader)\n\nIndex of the next chunk `reader` reads."},
+    {"metadata_bytes", RingBufferQueueMetadataBytes, METH_O | METH_STATIC,
+     "metadata_bytes(n_reader)\n\n"
+     "Bytes of ring metadata for `n_reader` readers, to be placed at a\n"
+     "cache-line aligned offset of the shared memory."},
+    {NULL, NULL, 0, NULL}};
+
+PyTypeObject RingBufferQueueType = {PyVarObject_HEAD_INIT(NULL, 0)};
+} // namespace
+
+VLLM_MS_HOST_MODULE(m) {
+  RingBufferQueueType.tp_name = "vllm_mindspore._C_host.RingBufferQueue";
+  RingBufferQueueType.tp_basicsize = sizeof(RingBufferQueueObject);
+  RingBufferQueueType.tp_dealloc = RingBufferQueueDealloc;
+  RingBufferQueueType.tp_flags = Py_TPFLAGS_DEFAULT;
+  RingBufferQueueType.tp_doc =
+      "RingBufferQueue(buffer, metadata_offset, n_reader, max_chunk_bytes, "
+      "max_chunks, create)\n\n"
+      "Single-writer / n-reader synchronization of the chunks of a shared\n"
+      "memory ring buffer, with futex wakeups. The ring metadata lives in\n"
+      "`buffer` at `metadata_offset`; `create` initializes it, otherwise it\n"
+      "must match the other arguments.";
+  RingBufferQueueType.tp_methods = ring_buffer_queue_methods;
+  RingBufferQueueType.tp_init = RingBufferQueueInit;
+  RingBufferQueueType.tp_new = PyType_GenericNew;
+  if (PyType_Ready(&RingBufferQueueType) < 0) {
+    return -1;
+  }
+  Py_INCREF(&RingBufferQueueType);
+  if (PyModule_AddObject(m, "RingBufferQueue",
+                         reinterpret_cast<PyObject *>(&RingBufferQueueType)) <
+      0) {
+    Py_DECREF(&RingBufferQueueType);
+    return -1;
+  }
+  return 0;
+}
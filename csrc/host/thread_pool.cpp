@@ -0,0 +1,118 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "host/thread_pool.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+HostThreadPool &HostThreadPool::Instance() {
+  static std::mutex instance_mutex;
+  static HostThreadPool *instance = nullptr;
+  static pid_t owner = 0;
+  std::lock_guard<std::mutex> lock(instance_mutex);
+  if (instance == nullptr || owner != getpid()) {
+    // The pool of a parent process is left behind on purpose: its threads
+    // are gone, and its mutexes may have been held at fork time.
+    int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+    instance = new HostThreadPool(std::max(hardware_threads, 1) - 1);
+    owner = getpid();
+  }
+  return *instance;
+}
+
+HostThreadPool::HostThreadPool(int num_workers) {
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+HostThreadPool::~HostThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  job_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void HostThreadPool::RunTasks() {
+  for (int64_t task = next_task_.fetch_add(1); task < num_tasks_;
+       task = next_task_.fetch_add(1)) {
+    (*fn_)(task);
+  }
+}
+
+void HostThreadPool::WorkerLoop(int worker) {
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      if (worker >= active_workers_) {
+        continue;
+      }
+    }
+    RunTasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_workers_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+}
+
+void HostThreadPool::ParallelFor(int64_t num_tasks, int num_threads,
+                                 const std::function<void(int64_t)> &fn) {
+  if (num_tasks <= 0) {
+    return;
+  }
+  int max_threads = NumThreads();
+  num_threads = num_threads <= 0 ? max_threads
+                                 : std::min(num_threads, max_threads);
+  num_threads = static_cast<int>(
+      std::min<int64_t>(static_cast<int64_t>(num_threads), num_tasks));
+  if (num_threads == 1) {
+    for (int64_t task = 0; task < num_tasks; ++task) {
+      fn(task);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> job_lock(job_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_tasks_ = num_tasks;
+    next_task_.store(0);
+    active_workers_ = num_threads - 1;
+    pending_workers_ = num_threads - 1;
+    ++generation_;
+  }
+  job_cv_.notify_all();
+  RunTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return pending_workers_ == 0; });
+  fn_ = nullptr;
+}
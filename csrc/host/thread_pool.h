@@ -0,0 +1,75 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_HOST_THREAD_POOL_H
+#define VLLM_MINDSPORE_CSRC_HOST_THREAD_POOL_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool of the host helpers, for work split into independent tasks.
+// The threads are started on first use and sleep between jobs. Callers run
+// with the GIL released and must not touch Python objects from the tasks.
+class HostThreadPool {
+public:
+  // Get the pool of this process; a forked child gets a fresh one, the
+  // threads of the parent do not survive the fork.
+  static HostThreadPool &Instance();
+
+  // A pool of its own, of num_workers threads besides the caller, for work
+  // that must neither queue behind the jobs of the shared pool nor hold them
+  // up. Its threads do not survive a fork.
+  explicit HostThreadPool(int num_workers);
+  ~HostThreadPool();
+
+  // Threads of the pool, the calling thread included
+  int NumThreads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Run fn(task) for every task in [0, num_tasks) on at most num_threads
+  // threads, the calling thread included, and return once all are done.
+  // num_threads <= 0 uses the whole pool. Jobs are serialized.
+  void ParallelFor(int64_t num_tasks, int num_threads,
+                   const std::function<void(int64_t)> &fn);
+
+private:
+  // Disable copy and assignment
+  HostThreadPool(const HostThreadPool &) = delete;
+  HostThreadPool &operator=(const HostThreadPool &) = delete;
+
+  void WorkerLoop(int worker);
+  void RunTasks();
+
+  std::vector<std::thread> workers_;
+  std::mutex job_mutex_; // one job at a time
+  std::mutex mutex_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_{0};
+  bool stop_{false};
+  int active_workers_{0};
+  int pending_workers_{0};
+  const std::function<void(int64_t)> *fn_{nullptr};
+  int64_t num_tasks_{0};
+  std::atomic<int64_t> next_task_{0};
+};
+
+#endif // VLLM_MINDSPORE_CSRC_HOST_THREAD_POOL_H
@@ -14,43 +14,51 @@
  * limitations under the License.
  */
 
-#include <map>
 #include <memory>
 #include <string>
 
 #include "ms_extension/api.h"
 
+#ifdef VLLM_MS_CPU_BACKEND
+#include "cpu/adv_step_flash.h"
+#else
 #include "ascendc/adv_step_flash.h"
+#endif
 #include "module/module.h"
+#include "module/op_utils.h"
 
-struct DtypeCaster {
-  ms::Tensor CheckAndCast(const ms::Tensor &t, const std::string &name = "") {
-    if (t.data_type() != ms::TypeId::kNumberTypeInt32) {
-      if (!name.empty()) {
-        tensor_map_[name] = t;
-      }
-      return t.cast(ms::TypeId::kNumberTypeInt32);
-    }
-    return t;
-  }
-
-  ms::Tensor RecoveryTensorDtype(const ms::Tensor &t, const std::string &name) {
-    auto iter = tensor_map_.find(name);
-    if (iter == tensor_map_.end()) {
-      return t;
-    }
-    auto ori_tensor = iter->second;
-    auto ret = t.cast(ori_tensor.data_type());
-    ori_tensor.AssignTensor(ret);
-    return ori_tensor;
-  }
-  std::map<std::string, ms::Tensor> tensor_map_;
-};
+// The kernel is instantiated for int32 and int64 index tensors, anything else
+// goes through int32.
+static ms::TypeId KernelIndexDtype(const ms::Tensor &t) {
+  return t.data_type() == ms::TypeId::kNumberTypeInt64
+             ? ms::TypeId::kNumberTypeInt64
+             : ms::TypeId::kNumberTypeInt32;
+}
 
 class AdvStepFlashOp : public ms::pynative::PyboostRunner {
 public:
   using PyboostRunner::PyboostRunner;
+  static int StatsId() {
+    static const int id = OpStats::RegisterOp("advance_step_flashattn");
+    return id;
+  }
+
   void LaunchKernel() override {
+    bool idx_int64 =
+        outputs()[1].data_type() == ms::TypeId::kNumberTypeInt64;
+    bool len_int64 = inputs()[1].data_type() == ms::TypeId::kNumberTypeInt64;
+    if (idx_int64 && len_int64) {
+      LaunchKernelImpl<int64_t, int64_t>();
+    } else if (idx_int64) {
+      LaunchKernelImpl<int64_t, int32_t>();
+    } else if (len_int64) {
+      LaunchKernelImpl<int32_t, int64_t>();
+    } else {
+      LaunchKernelImpl<int32_t, int32_t>();
+    }
+  }
+
+  template <typename IdxT, typename LenT> void LaunchKernelImpl() {
     uint8_t *sampledTokenIdsPtr =
         static_cast<uint8_t *>(inputs()[0].GetDataPtr());
     uint8_t *seqLensPtr = static_cast<uint8_t *>(inputs()[1].GetDataPtr());
@@ -62,35 +70,67 @@ public:
     auto stride = inputs()[2].stride();
     int32_t block_tables_stride = stride.empty() ? 1 : stride[0];
 
-    uint32_t blockDims = 1;
+    if (num_seqs_ <= 0) {
+      return;
+    }
+#ifdef VLLM_MS_CPU_BACKEND
+    OpKernelTimer timer(StatsId(), nullptr);
+    AdvStepFlashCpu<IdxT, LenT>(
+        reinterpret_cast<const IdxT *>(sampledTokenIdsPtr),
+        reinterpret_cast<const int32_t *>(blockTablesPtr),
+        reinterpret_cast<LenT *>(seqLensPtr),
+        reinterpret_cast<IdxT *>(inputTokensPtr),
+        reinterpret_cast<IdxT *>(inputPositionsPtr),
+        reinterpret_cast<IdxT *>(slotMappingPtr), num_seqs_, num_queries_,
+        num_tokens_per_seq_, block_size_, block_tables_stride);
+#else
+    auto tiling = ComputeAdvStepFlashTiling(
+        num_seqs_, num_queries_, num_tokens_per_seq_, GetVectorCoreNum());
     void *l2ctrl = nullptr;
-    AdvStepFlashKernelEntry(blockDims, l2ctrl, stream(), sampledTokenIdsPtr,
-                            blockTablesPtr, seqLensPtr, inputTokensPtr,
-                            inputPositionsPtr, seqLensPtr, slotMappingPtr,
-                            num_seqs_, block_size_, block_tables_stride);
+    OpKernelTimer timer(StatsId(), stream());
+    AdvStepFlashKernelEntry<IdxT, LenT>(
+        l2ctrl, stream(), sampledTokenIdsPtr, blockTablesPtr, seqLensPtr,
+        inputTokensPtr, inputPositionsPtr, seqLensPtr, slotMappingPtr,
+        block_size_, block_tables_stride, tiling);
+#endif
   }
 
+  // sampled_token_ids, input_tokens, input_positions and slot_mapping hold
+  // num_tokens_per_seq entries per sequence, sequence-major.
   static void Eval(int32_t num_seqs, int32_t num_queries, int32_t block_size,
-                   ms::Tensor input_tokens,      // output
-                   ms::Tensor sampled_token_ids, // input
-                   ms::Tensor input_positions,   // output
-                   ms::Tensor seq_lens,          // input&output (inplace)
-                   ms::Tensor slot_mapping,      // output
-                   ms::Tensor block_tables       // input
-  ) {
-    // the AdvStepFlashKernelEntry only support int32 inputs.
+                   ms::Tensor input_tokens,       // output
+                   ms::Tensor sampled_token_ids,  // input
+                   ms::Tensor input_positions,    // output
+                   ms::Tensor seq_lens,           // input&output (inplace)
+                   ms::Tensor slot_mapping,       // output
+                   ms::Tensor block_tables,       // input
+                   int32_t num_tokens_per_seq) {
+    OpStatsScope stats(StatsId());
+    // The kernel reads and writes int32 or int64 tensors natively, keyed on
+    // the dtype of input_positions and seq_lens. Only tensors of another
+    // dtype are cast, and cast back afterwards.
+    auto idx_dtype = KernelIndexDtype(input_positions);
+    auto len_dtype = KernelIndexDtype(seq_lens);
     DtypeCaster caster;
-    sampled_token_ids = caster.CheckAndCast(sampled_token_ids);
-    block_tables = caster.CheckAndCast(block_tables);
-    input_tokens = caster.CheckAndCast(input_tokens, "input_tokens");
-    input_positions = caster.CheckAndCast(input_positions, "input_positions");
-    slot_mapping = caster.CheckAndCast(slot_mapping, "slot_mapping");
-    seq_lens = caster.CheckAndCast(seq_lens, "seq_lens");
+    sampled_token_ids = caster.CheckAndCast(sampled_token_ids, idx_dtype);
+    block_tables =
+        caster.CheckAndCast(block_tables, ms::TypeId::kNumberTypeInt32);
+    input_tokens = caster.CheckAndCast(input_tokens, idx_dtype, "input_tokens");
+    input_positions =
+        caster.CheckAndCast(input_positions, idx_dtype, "input_positions");
+    slot_mapping = caster.CheckAndCast(slot_mapping, idx_dtype, "slot_mapping");
+    seq_lens = caster.CheckAndCast(seq_lens, len_dtype, "seq_lens");
 
     auto runner = std::make_shared<AdvStepFlashOp>("AdvanceStepFlashattn");
     runner->num_seqs_ = num_seqs;
     runner->num_queries_ = num_queries;
     runner->block_size_ = block_size;
+    runner->num_tokens_per_seq_ = num_tokens_per_seq;
+    if (stats.enabled()) {
+      stats.AddBytes(TensorBytes({sampled_token_ids, seq_lens, block_tables}),
+                     TensorBytes({input_tokens, input_positions, seq_lens,
+                                  slot_mapping}));
+    }
     runner->Run({sampled_token_ids, seq_lens, block_tables},
                 {input_tokens, input_positions, seq_lens, slot_mapping});
 
@@ -99,20 +139,24 @@ public:
         caster.RecoveryTensorDtype(input_positions, "input_positions");
     slot_mapping = caster.RecoveryTensorDtype(slot_mapping, "slot_mapping");
     seq_lens = caster.RecoveryTensorDtype(seq_lens, "seq_lens");
+    stats.AddCasts(caster.casts_, caster.cast_ns_);
   }
   int32_t num_seqs_{0};
   int32_t num_queries_{0};
   int32_t block_size_{0};
+  int32_t num_tokens_per_seq_{1};
 };
 
 auto pyboost_adv_step_flash(int32_t num_seqs, int32_t num_queries,
                             int32_t block_size, ms::Tensor input_tokens,
                             ms::Tensor sampled_token_ids,
                             ms::Tensor input_positions, ms::Tensor seq_lens,
-                            ms::Tensor slot_mapping, ms::Tensor block_tables) {
+                            ms::Tensor slot_mapping, ms::Tensor block_tables,
+                            int32_t num_tokens_per_seq) {
   return ms::pynative::PyboostRunner::Call<0>(
       AdvStepFlashOp::Eval, num_seqs, num_queries, block_size, input_tokens,
-      sampled_token_ids, input_positions, seq_lens, slot_mapping, block_tables);
+      sampled_token_ids, input_positions, seq_lens, slot_mapping, block_tables,
+      num_tokens_per_seq);
 }
 
 VLLM_MS_EXTENSION_MODULE(m) {
@@ -121,5 +165,6 @@ VLLM_MS_EXTENSION_MODULE(m) {
         pybind11::arg("num_queries"), pybind11::arg("block_size"),
         pybind11::arg("input_tokens"), pybind11::arg("sampled_token_ids"),
         pybind11::arg("input_positions"), pybind11::arg("seq_lens"),
-        pybind11::arg("slot_mapping"), pybind11::arg("block_tables"));
+        pybind11::arg("slot_mapping"), pybind11::arg("block_tables"),
+        pybind11::arg("num_tokens_per_seq") = 1);
 }
@@ -0,0 +1,124 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include "ms_extension/api.h"
+
+#ifdef VLLM_MS_CPU_BACKEND
+#include "cpu/attention_mask.h"
+#else
+#include "ascendc/attention_mask.h"
+#endif
+#include "module/module.h"
+#include "module/op_utils.h"
+
+// The kernel only moves bits, 2 bytes for fp16 and bf16 masks and 4 for fp32
+// ones; any other mask dtype is built in fp32.
+static ms::TypeId KernelMaskDtype(const ms::Tensor &t) {
+  switch (t.data_type()) {
+  case ms::TypeId::kNumberTypeFloat16:
+  case ms::TypeId::kNumberTypeBFloat16:
+    return t.data_type();
+  default:
+    return ms::TypeId::kNumberTypeFloat32;
+  }
+}
+
+class AttentionMaskOp : public ms::pynative::PyboostRunner {
+public:
+  using PyboostRunner::PyboostRunner;
+  static int StatsId() {
+    static const int id = OpStats::RegisterOp("attention_mask");
+    return id;
+  }
+
+  void LaunchKernel() override {
+    if (outputs()[0].data_type() == ms::TypeId::kNumberTypeFloat32) {
+      LaunchKernelImpl<uint32_t>();
+    } else {
+      LaunchKernelImpl<uint16_t>();
+    }
+  }
+
+  template <typename T> void LaunchKernelImpl() {
+    const auto &shape = outputs()[0].shape();
+    auto num_reqs = static_cast<int32_t>(inputs()[0].numel());
+    auto num_rows = static_cast<int32_t>(shape[0]);
+    auto max_seq_len = static_cast<int32_t>(shape[1]);
+    if (num_rows <= 0 || max_seq_len <= 0) {
+      return;
+    }
+    auto fill_bits = static_cast<T>(
+        FloatScalarBits(fill_value_, outputs()[0].data_type()));
+#ifdef VLLM_MS_CPU_BACKEND
+    OpKernelTimer timer(StatsId(), nullptr);
+    AttentionMaskCpu<T>(static_cast<const int32_t *>(inputs()[0].GetDataPtr()),
+                        static_cast<const int32_t *>(inputs()[1].GetDataPtr()),
+                        static_cast<T *>(outputs()[0].GetDataPtr()), num_reqs,
+                        num_rows, max_seq_len, fill_bits);
+#else
+    auto tiling = ComputeAttentionMaskTiling(
+        num_reqs, num_rows, max_seq_len, sizeof(T), GetVectorCoreNum());
+    void *l2ctrl = nullptr;
+    OpKernelTimer timer(StatsId(), stream());
+    AttentionMaskKernelEntry<T>(
+        l2ctrl, stream(), static_cast<uint8_t *>(inputs()[0].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[1].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[0].GetDataPtr()), fill_bits, tiling);
+#endif
+  }
+
+  // mask [num_rows, max_seq_len] is fully overwritten: the rows of request i
+  // start after those of the requests before it, and row t of them is 0 up
+  // to column mask_offsets[i] + t and fill_value after it.
+  static void Eval(ms::Tensor mask,         // output
+                   ms::Tensor query_lens,   // input
+                   ms::Tensor mask_offsets, // input
+                   float fill_value) {
+    OpStatsScope stats(StatsId());
+    DtypeCaster caster;
+    auto int32 = ms::TypeId::kNumberTypeInt32;
+    query_lens = caster.CheckAndCast(query_lens, int32);
+    mask_offsets = caster.CheckAndCast(mask_offsets, int32);
+    mask = caster.CheckAndCast(mask, KernelMaskDtype(mask), "mask");
+
+    auto runner = std::make_shared<AttentionMaskOp>("AttentionMask");
+    runner->fill_value_ = fill_value;
+    if (stats.enabled()) {
+      stats.AddBytes(TensorBytes({query_lens, mask_offsets}),
+                     TensorBytes(mask));
+    }
+    runner->Run({query_lens, mask_offsets}, {mask});
+
+    mask = caster.RecoveryTensorDtype(mask, "mask");
+    stats.AddCasts(caster.casts_, caster.cast_ns_);
+  }
+  float fill_value_{0.0f};
+};
+
+auto pyboost_attention_mask(ms::Tensor mask, ms::Tensor query_lens,
+                            ms::Tensor mask_offsets, float fill_value) {
+  return ms::pynative::PyboostRunner::Call<0>(
+      AttentionMaskOp::Eval, mask, query_lens, mask_offsets, fill_value);
+}
+
+VLLM_MS_EXTENSION_MODULE(m) {
+  m.def("attention_mask", &pyboost_attention_mask, "attention_mask",
+        pybind11::arg("mask"), pybind11::arg("query_lens"),
+        pybind11::arg("mask_offsets"), pybind11::arg("fill_value"));
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include "ms_extension/api.h"
+
+#ifdef VLLM_MS_CPU_BACKEND
+#include "cpu/eagle_prepare_inputs.h"
+#else
+#include "ascendc/eagle_prepare_inputs.h"
+#endif
+#include "module/module.h"
+#include "module/op_utils.h"
+
+class EaglePrepareInputsOp : public ms::pynative::PyboostRunner {
+public:
+  using PyboostRunner::PyboostRunner;
+  static int StatsId() {
+    static const int id = OpStats::RegisterOp("eagle_prepare_inputs");
+    return id;
+  }
+
+  void LaunchKernel() override {
+    const auto &shape = inputs()[0].shape();
+    auto num_reqs = static_cast<int32_t>(shape[0]);
+    auto max_gen_len = static_cast<int32_t>(shape[1]);
+    if (num_reqs <= 0) {
+      return;
+    }
+#ifdef VLLM_MS_CPU_BACKEND
+    OpKernelTimer timer(StatsId(), nullptr);
+    EaglePrepareInputsCpu(
+        static_cast<const int32_t *>(inputs()[0].GetDataPtr()),
+        static_cast<const int32_t *>(inputs()[1].GetDataPtr()),
+        static_cast<const bool *>(inputs()[2].GetDataPtr()),
+        static_cast<const int32_t *>(inputs()[3].GetDataPtr()),
+        static_cast<const int32_t *>(inputs()[4].GetDataPtr()),
+        static_cast<int32_t *>(outputs()[0].GetDataPtr()),
+        static_cast<int32_t *>(outputs()[1].GetDataPtr()),
+        static_cast<int32_t *>(outputs()[2].GetDataPtr()), num_reqs,
+        max_gen_len, vocab_size_);
+#else
+    auto tiling = ComputeEaglePrepareInputsTiling(
+        num_reqs, max_gen_len, vocab_size_, GetVectorCoreNum());
+    void *l2ctrl = nullptr;
+    OpKernelTimer timer(StatsId(), stream());
+    EaglePrepareInputsKernelEntry(
+        l2ctrl, stream(), static_cast<uint8_t *>(inputs()[0].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[1].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[2].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[3].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[4].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[0].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[1].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[2].GetDataPtr()), tiling);
+#endif
+  }
+
+  // next_token_ids, valid_sampled_tokens_count and token_indices_to_sample
+  // [num_reqs] are fully overwritten from sampled_token_ids [num_reqs,
+  // max_gen_len], cu_num_draft_tokens, discard_mask, backup_next_token_ids
+  // [num_reqs] and query_start_loc [num_reqs + 1].
+  static void Eval(ms::Tensor next_token_ids,             // output
+                   ms::Tensor valid_sampled_tokens_count, // output
+                   ms::Tensor token_indices_to_sample,    // output
+                   ms::Tensor sampled_token_ids,          // input
+                   ms::Tensor cu_num_draft_tokens,        // input
+                   ms::Tensor discard_mask,               // input
+                   ms::Tensor backup_next_token_ids,      // input
+                   ms::Tensor query_start_loc,            // input
+                   int32_t vocab_size) {
+    OpStatsScope stats(StatsId());
+    DtypeCaster caster;
+    auto int32 = ms::TypeId::kNumberTypeInt32;
+    sampled_token_ids = caster.CheckAndCast(sampled_token_ids, int32);
+    cu_num_draft_tokens = caster.CheckAndCast(cu_num_draft_tokens, int32);
+    discard_mask =
+        caster.CheckAndCast(discard_mask, ms::TypeId::kNumberTypeBool);
+    backup_next_token_ids = caster.CheckAndCast(backup_next_token_ids, int32);
+    query_start_loc = caster.CheckAndCast(query_start_loc, int32);
+    next_token_ids =
+        caster.CheckAndCast(next_token_ids, int32, "next_token_ids");
+    valid_sampled_tokens_count = caster.CheckAndCast(
+        valid_sampled_tokens_count, int32, "valid_sampled_tokens_count");
+    token_indices_to_sample = caster.CheckAndCast(
+        token_indices_to_sample, int32, "token_indices_to_sample");
+
+    auto runner = std::make_shared<EaglePrepareInputsOp>("EaglePrepareInputs");
+    runner->vocab_size_ = vocab_size;
+    if (stats.enabled()) {
+      stats.AddBytes(TensorBytes({sampled_token_ids, cu_num_draft_tokens,
+                                  discard_mask, backup_next_token_ids,
+                                  query_start_loc}),
+                     TensorBytes({next_token_ids, valid_sampled_tokens_count,
+                                  token_indices_to_sample}));
+    }
+    runner->Run({sampled_token_ids, cu_num_draft_tokens, discard_mask,
+                 backup_next_token_ids, query_start_loc},
+                {next_token_ids, valid_sampled_tokens_count,
+                 token_indices_to_sample});
+
+    next_token_ids = caster.RecoveryTensorDtype(next_token_ids,
+                                                "next_token_ids");
+    valid_sampled_tokens_count = caster.RecoveryTensorDtype(
+        valid_sampled_tokens_count, "valid_sampled_tokens_count");
+    token_indices_to_sample = caster.RecoveryTensorDtype(
+        token_indices_to_sample, "token_indices_to_sample");
+    stats.AddCasts(caster.casts_, caster.cast_ns_);
+  }
+  int32_t vocab_size_{0};
+};
+
+auto pyboost_eagle_prepare_inputs(
+    ms::Tensor next_token_ids, ms::Tensor valid_sampled_tokens_count,
+    ms::Tensor token_indices_to_sample, ms::Tensor sampled_token_ids,
+    ms::Tensor cu_num_draft_tokens, ms::Tensor discard_mask,
+    ms::Tensor backup_next_token_ids, ms::Tensor query_start_loc,
+    int32_t vocab_size) {
+  return ms::pynative::PyboostRunner::Call<0>(
+      EaglePrepareInputsOp::Eval, next_token_ids, valid_sampled_tokens_count,
+      token_indices_to_sample, sampled_token_ids, cu_num_draft_tokens,
+      discard_mask, backup_next_token_ids, query_start_loc, vocab_size);
+}
+
+VLLM_MS_EXTENSION_MODULE(m) {
+  m.def("eagle_prepare_inputs", &pyboost_eagle_prepare_inputs,
+        "eagle_prepare_inputs", pybind11::arg("next_token_ids"),
+        pybind11::arg("valid_sampled_tokens_count"),
+        pybind11::arg("token_indices_to_sample"),
+        pybind11::arg("sampled_token_ids"),
+        pybind11::arg("cu_num_draft_tokens"), pybind11::arg("discard_mask"),
+        pybind11::arg("backup_next_token_ids"),
+        pybind11::arg("query_start_loc"), pybind11::arg("vocab_size"));
+}
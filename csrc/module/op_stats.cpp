@@ -0,0 +1,222 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "module/op_stats.h"
+
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef VLLM_MS_CPU_BACKEND
+#include "acl/acl.h"
+#endif
+#include "module/module.h"
+
+std::atomic<bool> OpStats::enabled_{false};
+std::atomic<bool> OpStats::kernel_timing_{false};
+
+int OpStats::RegisterOp(const std::string &name) {
+  auto &stats = Instance();
+  std::lock_guard<std::mutex> lock(stats.mutex_);
+  auto iter = std::find(stats.names_.begin(), stats.names_.end(), name);
+  if (iter != stats.names_.end()) {
+    return static_cast<int>(iter - stats.names_.begin());
+  }
+  if (stats.names_.size() >= static_cast<size_t>(kOpStatsMaxOps)) {
+    throw std::runtime_error("too many ops in OpStats, raise kOpStatsMaxOps");
+  }
+  stats.names_.push_back(name);
+  return static_cast<int>(stats.names_.size()) - 1;
+}
+
+OpStats::ThreadCounters *OpStats::NewThreadCounters() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  threads_.push_back(std::make_unique<ThreadCounters>());
+  return threads_.back().get();
+}
+
+OpCounters &OpStats::Local(int op_id) {
+  thread_local ThreadCounters *counters = Instance().NewThreadCounters();
+  return (*counters)[op_id];
+}
+
+std::vector<OpStatsSnapshot> OpStats::Snapshot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<OpStatsSnapshot> snapshots(names_.size());
+  for (size_t op = 0; op < names_.size(); ++op) {
+    auto &s = snapshots[op];
+    s.name = names_[op];
+    for (const auto &thread : threads_) {
+      const auto &c = (*thread)[op];
+      s.calls += c.calls.load(std::memory_order_relaxed);
+      s.host_ns += c.host_ns.load(std::memory_order_relaxed);
+      s.casts += c.casts.load(std::memory_order_relaxed);
+      s.cast_ns += c.cast_ns.load(std::memory_order_relaxed);
+      s.bytes_in += c.bytes_in.load(std::memory_order_relaxed);
+      s.bytes_out += c.bytes_out.load(std::memory_order_relaxed);
+      s.kernel_calls += c.kernel_calls.load(std::memory_order_relaxed);
+      s.kernel_ns += c.kernel_ns.load(std::memory_order_relaxed);
+      for (int b = 0; b < kOpStatsNumBuckets; ++b) {
+        s.host_hist[b] += c.host_hist[b].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  return snapshots;
+}
+
+void OpStats::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &thread : threads_) {
+    for (auto &c : *thread) {
+      for (auto *counter :
+           {&c.calls, &c.host_ns, &c.casts, &c.cast_ns, &c.bytes_in,
+            &c.bytes_out, &c.kernel_calls, &c.kernel_ns}) {
+        counter->store(0, std::memory_order_relaxed);
+      }
+      for (auto &bucket : c.host_hist) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+OpStatsScope::~OpStatsScope() {
+  if (!enabled_) {
+    return;
+  }
+  uint64_t elapsed = OpStatsNowNs() - start_ns_;
+  auto &c = OpStats::Local(op_id_);
+  OpStatsAdd(&c.calls, 1);
+  OpStatsAdd(&c.host_ns, elapsed);
+  OpStatsAdd(&c.casts, casts_);
+  OpStatsAdd(&c.cast_ns, cast_ns_);
+  OpStatsAdd(&c.bytes_in, bytes_in_);
+  OpStatsAdd(&c.bytes_out, bytes_out_);
+  int bucket = elapsed == 0 ? 0 : 63 - __builtin_clzll(elapsed);
+  OpStatsAdd(&c.host_hist[std::min(bucket, kOpStatsNumBuckets - 1)], 1);
+}
+
+OpKernelTimer::OpKernelTimer(int op_id, void *stream)
+    : op_id_(op_id), enabled_(OpStats::KernelTiming()), stream_(stream) {
+  if (!enabled_) {
+    return;
+  }
+#ifdef VLLM_MS_CPU_BACKEND
+  start_ns_ = OpStatsNowNs();
+#else
+  aclrtEvent start = nullptr;
+  aclrtEvent end = nullptr;
+  if (aclrtCreateEventWithFlag(&start, ACL_EVENT_TIME_LINE) != ACL_SUCCESS ||
+      aclrtCreateEventWithFlag(&end, ACL_EVENT_TIME_LINE) != ACL_SUCCESS ||
+      aclrtRecordEvent(start, stream_) != ACL_SUCCESS) {
+    enabled_ = false;
+  }
+  start_event_ = start;
+  end_event_ = end;
+#endif
+}
+
+OpKernelTimer::~OpKernelTimer() {
+  uint64_t elapsed = 0;
+#ifdef VLLM_MS_CPU_BACKEND
+  if (enabled_) {
+    elapsed = OpStatsNowNs() - start_ns_;
+  }
+#else
+  float elapsed_ms = 0.0f;
+  if (enabled_ &&
+      (aclrtRecordEvent(end_event_, stream_) != ACL_SUCCESS ||
+       aclrtSynchronizeEvent(end_event_) != ACL_SUCCESS ||
+       aclrtEventElapsedTime(&elapsed_ms, start_event_, end_event_) !=
+           ACL_SUCCESS)) {
+    enabled_ = false;
+  }
+  elapsed = static_cast<uint64_t>(static_cast<double>(elapsed_ms) * 1e6);
+  for (void *event : {start_event_, end_event_}) {
+    if (event != nullptr) {
+      aclrtDestroyEvent(event);
+    }
+  }
+#endif
+  if (enabled_) {
+    auto &c = OpStats::Local(op_id_);
+    OpStatsAdd(&c.kernel_calls, 1);
+    OpStatsAdd(&c.kernel_ns, elapsed);
+  }
+}
+
+namespace {
+// Upper bound of the bucket holding the q-quantile of the calls, in us
+double HistogramQuantileUs(const OpStatsSnapshot &s, double q) {
+  if (s.calls == 0) {
+    return 0.0;
+  }
+  uint64_t target =
+      static_cast<uint64_t>(q * static_cast<double>(s.calls - 1)) + 1;
+  uint64_t seen = 0;
+  for (int b = 0; b < kOpStatsNumBuckets; ++b) {
+    seen += s.host_hist[b];
+    if (seen >= target) {
+      return static_cast<double>(uint64_t{2} << b) / 1e3;
+    }
+  }
+  return static_cast<double>(uint64_t{1} << kOpStatsNumBuckets) / 1e3;
+}
+
+pybind11::dict GetOpStats() {
+  pybind11::dict stats;
+  for (const auto &s : OpStats::Instance().Snapshot()) {
+    if (s.calls == 0 && s.kernel_calls == 0) {
+      continue;
+    }
+    pybind11::dict op;
+    op["calls"] = s.calls;
+    op["host_us"] = static_cast<double>(s.host_ns) / 1e3;
+    op["host_p50_us"] = HistogramQuantileUs(s, 0.5);
+    op["host_p99_us"] = HistogramQuantileUs(s, 0.99);
+    op["casts"] = s.casts;
+    op["cast_us"] = static_cast<double>(s.cast_ns) / 1e3;
+    op["bytes_in"] = s.bytes_in;
+    op["bytes_out"] = s.bytes_out;
+    op["kernel_calls"] = s.kernel_calls;
+    op["kernel_us"] = static_cast<double>(s.kernel_ns) / 1e3;
+    op["host_hist"] =
+        std::vector<uint64_t>(s.host_hist.begin(), s.host_hist.end());
+    stats[pybind11::str(s.name)] = op;
+  }
+  return stats;
+}
+} // namespace
+
+VLLM_MS_EXTENSION_MODULE(m) {
+  m.def("get_op_stats", &GetOpStats,
+        "Counters of every custom op called since the last reset: calls, "
+        "host latency total and p50/p99 in us, DtypeCaster casts and time, "
+        "bytes in and out, kernel calls and time, and host_hist, the calls "
+        "per log2 bucket of host latency in ns.");
+  m.def("reset_op_stats", []() { OpStats::Instance().Reset(); },
+        "Zero the counters of all custom ops.");
+  m.def(
+      "set_op_stats_enabled",
+      [](bool enabled, bool kernel_timing) {
+        OpStats::SetEnabled(enabled, kernel_timing);
+      },
+      "Turn the op counters on or off. kernel_timing also times every "
+      "kernel, on device by waiting for it.",
+      pybind11::arg("enabled"), pybind11::arg("kernel_timing") = false);
+  m.def("op_stats_enabled", &OpStats::Enabled,
+        "Whether the op counters are on.");
+}
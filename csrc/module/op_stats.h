@@ -0,0 +1,180 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_MODULE_OP_STATS_H
+#define VLLM_MINDSPORE_CSRC_MODULE_OP_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-op counters of the custom ops: calls, host latency of the whole call
+// and its histogram, time spent in DtypeCaster, bytes in and out, and
+// optionally the time of the kernel itself. Disabled by default, then an
+// instrumented call costs one relaxed atomic load.
+//
+// Every thread counts into its own block of counters, so that recording is
+// lock-free and touches no shared cache line; blocks are only locked when a
+// thread records for the first time, and summed when the stats are read.
+
+// log2 buckets of nanoseconds: bucket i holds [2^i, 2^(i+1)) ns, the last one
+// everything above
+constexpr int kOpStatsNumBuckets = 40;
+constexpr int kOpStatsMaxOps = 64;
+
+struct alignas(64) OpCounters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> host_ns{0};
+  std::atomic<uint64_t> casts{0};
+  std::atomic<uint64_t> cast_ns{0};
+  std::atomic<uint64_t> bytes_in{0};
+  std::atomic<uint64_t> bytes_out{0};
+  std::atomic<uint64_t> kernel_calls{0};
+  std::atomic<uint64_t> kernel_ns{0};
+  std::array<std::atomic<uint64_t>, kOpStatsNumBuckets> host_hist{};
+};
+
+// Summed counters of one op, as read by GetOpStats
+struct OpStatsSnapshot {
+  std::string name;
+  uint64_t calls{0};
+  uint64_t host_ns{0};
+  uint64_t casts{0};
+  uint64_t cast_ns{0};
+  uint64_t bytes_in{0};
+  uint64_t bytes_out{0};
+  uint64_t kernel_calls{0};
+  uint64_t kernel_ns{0};
+  std::array<uint64_t, kOpStatsNumBuckets> host_hist{};
+};
+
+class OpStats {
+public:
+  static OpStats &Instance() {
+    static OpStats instance;
+    return instance;
+  }
+
+  // Id of an op by name, registered on first use; hold it in a static local
+  static int RegisterOp(const std::string &name);
+
+  static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+  static bool KernelTiming() {
+    return kernel_timing_.load(std::memory_order_relaxed);
+  }
+  static void SetEnabled(bool enabled, bool kernel_timing) {
+    kernel_timing_.store(enabled && kernel_timing, std::memory_order_relaxed);
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Counters of op_id in the block of the calling thread
+  static OpCounters &Local(int op_id);
+
+  std::vector<OpStatsSnapshot> Snapshot();
+  void Reset();
+
+private:
+  OpStats() = default;
+  ~OpStats() = default;
+
+  // Disable copy and assignment
+  OpStats(const OpStats &) = delete;
+  OpStats &operator=(const OpStats &) = delete;
+
+  using ThreadCounters = std::array<OpCounters, kOpStatsMaxOps>;
+  ThreadCounters *NewThreadCounters();
+
+  static std::atomic<bool> enabled_;
+  static std::atomic<bool> kernel_timing_;
+
+  std::mutex mutex_;
+  std::vector<std::string> names_;
+  // blocks of all threads, kept past the end of their thread
+  std::vector<std::unique_ptr<ThreadCounters>> threads_;
+};
+
+inline uint64_t OpStatsNowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+// Relaxed, on a cache line only the calling thread writes to; still an atomic
+// add, so that a concurrent Reset is not overwritten
+inline void OpStatsAdd(std::atomic<uint64_t> *counter, uint64_t value) {
+  counter->fetch_add(value, std::memory_order_relaxed);
+}
+
+// Records one call of an op, from construction to destruction, on the host
+class OpStatsScope {
+public:
+  explicit OpStatsScope(int op_id)
+      : op_id_(op_id), enabled_(OpStats::Enabled()),
+        start_ns_(enabled_ ? OpStatsNowNs() : 0) {}
+  ~OpStatsScope();
+
+  // Disable copy and assignment
+  OpStatsScope(const OpStatsScope &) = delete;
+  OpStatsScope &operator=(const OpStatsScope &) = delete;
+
+  bool enabled() const { return enabled_; }
+  void AddBytes(uint64_t bytes_in, uint64_t bytes_out) {
+    bytes_in_ += bytes_in;
+    bytes_out_ += bytes_out;
+  }
+  void AddCasts(uint64_t casts, uint64_t cast_ns) {
+    casts_ += casts;
+    cast_ns_ += cast_ns;
+  }
+
+private:
+  int op_id_;
+  bool enabled_;
+  uint64_t start_ns_;
+  uint64_t bytes_in_{0};
+  uint64_t bytes_out_{0};
+  uint64_t casts_{0};
+  uint64_t cast_ns_{0};
+};
+
+// Records the time of the kernel of an op, when kernel timing is on. The
+// device build times the stream between two events and waits for the second
+// one, which serializes the launch with the device; the CPU build times the
+// host kernel.
+class OpKernelTimer {
+public:
+  OpKernelTimer(int op_id, void *stream);
+  ~OpKernelTimer();
+
+  // Disable copy and assignment
+  OpKernelTimer(const OpKernelTimer &) = delete;
+  OpKernelTimer &operator=(const OpKernelTimer &) = delete;
+
+private:
+  int op_id_;
+  bool enabled_;
+  void *stream_;
+  uint64_t start_ns_{0};
+  void *start_event_{nullptr};
+  void *end_event_{nullptr};
+};
+
+#endif // VLLM_MINDSPORE_CSRC_MODULE_OP_STATS_H
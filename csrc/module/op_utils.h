@@ -0,0 +1,162 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VLLM_MINDSPORE_CSRC_MODULE_OP_UTILS_H
+#define VLLM_MINDSPORE_CSRC_MODULE_OP_UTILS_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include <string>
+
+#include "ms_extension/api.h"
+#ifndef VLLM_MS_CPU_BACKEND
+#include "acl/acl.h"
+#endif
+#include "module/op_stats.h"
+
+// Casts inputs to the dtype a kernel takes, and writes named outputs back to
+// their original tensors at the original dtype. Casts are counted and timed
+// while the op stats are on.
+struct DtypeCaster {
+  ms::Tensor CheckAndCast(const ms::Tensor &t, ms::TypeId dtype,
+                          const std::string &name = "") {
+    if (t.data_type() != dtype) {
+      if (!name.empty()) {
+        tensor_map_[name] = t;
+      }
+      uint64_t start = timed_ ? OpStatsNowNs() : 0;
+      auto ret = t.cast(dtype);
+      CountCast(start);
+      return ret;
+    }
+    return t;
+  }
+
+  ms::Tensor RecoveryTensorDtype(const ms::Tensor &t, const std::string &name) {
+    auto iter = tensor_map_.find(name);
+    if (iter == tensor_map_.end()) {
+      return t;
+    }
+    uint64_t start = timed_ ? OpStatsNowNs() : 0;
+    auto ori_tensor = iter->second;
+    auto ret = t.cast(ori_tensor.data_type());
+    ori_tensor.AssignTensor(ret);
+    CountCast(start);
+    return ori_tensor;
+  }
+
+  void CountCast(uint64_t start) {
+    if (timed_) {
+      ++casts_;
+      cast_ns_ += OpStatsNowNs() - start;
+    }
+  }
+
+  std::map<std::string, ms::Tensor> tensor_map_;
+  bool timed_{OpStats::Enabled()};
+  uint64_t casts_{0};
+  uint64_t cast_ns_{0};
+};
+
+// Size of the data of a tensor in bytes
+inline uint64_t TensorBytes(const ms::Tensor &t) {
+  uint64_t itemsize = 4;
+  switch (t.data_type()) {
+  case ms::TypeId::kNumberTypeBool:
+  case ms::TypeId::kNumberTypeInt8:
+  case ms::TypeId::kNumberTypeUInt8:
+    itemsize = 1;
+    break;
+  case ms::TypeId::kNumberTypeInt16:
+  case ms::TypeId::kNumberTypeUInt16:
+  case ms::TypeId::kNumberTypeFloat16:
+  case ms::TypeId::kNumberTypeBFloat16:
+    itemsize = 2;
+    break;
+  case ms::TypeId::kNumberTypeInt64:
+  case ms::TypeId::kNumberTypeUInt64:
+  case ms::TypeId::kNumberTypeFloat64:
+    itemsize = 8;
+    break;
+  default:
+    break;
+  }
+  return static_cast<uint64_t>(t.numel()) * itemsize;
+}
+
+inline uint64_t TensorBytes(std::initializer_list<ms::Tensor> tensors) {
+  uint64_t bytes = 0;
+  for (const auto &t : tensors) {
+    bytes += TensorBytes(t);
+  }
+  return bytes;
+}
+
+// Bits of value in a float dtype, rounded to nearest even as a cast would:
+// the low 16 bits for fp16 and bf16, the fp32 bits otherwise. Lets kernels
+// that only move values take one integer argument for any float dtype.
+inline uint32_t FloatScalarBits(float value, ms::TypeId dtype) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  uint32_t abs = bits & 0x7fffffffu;
+  if (dtype == ms::TypeId::kNumberTypeBFloat16) {
+    if (abs > 0x7f800000u) {
+      return (bits >> 16) | 0x40u; // quiet NaN
+    }
+    return (bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16;
+  }
+  if (dtype != ms::TypeId::kNumberTypeFloat16) {
+    return bits;
+  }
+  uint32_t sign = (bits >> 16) & 0x8000u;
+  if (abs > 0x7f800000u) {
+    return sign | 0x7e00u;
+  }
+  if (abs >= 0x477ff000u) { // 65520 and up round to inf
+    return sign | 0x7c00u;
+  }
+  if (abs < 0x38800000u) { // below 2^-14: subnormal, in units of 2^-24
+    return sign |
+           static_cast<uint32_t>(std::nearbyint(std::fabs(value) * 0x1p24f));
+  }
+  abs += 0xfffu + ((abs >> 13) & 1u);
+  return sign | ((abs - 0x38000000u) >> 13);
+}
+
+#ifndef VLLM_MS_CPU_BACKEND
+// Number of vector cores on the current device, queried once per process.
+inline int32_t GetVectorCoreNum() {
+  static int32_t core_num = []() {
+    // Atlas A2 series has at least 40 vector cores.
+    constexpr int64_t kDefaultVectorCoreNum = 40;
+    int32_t device_id = 0;
+    int64_t value = 0;
+    if (aclrtGetDevice(&device_id) != ACL_SUCCESS ||
+        aclrtGetDeviceInfo(static_cast<uint32_t>(device_id),
+                           ACL_DEV_ATTR_VECTOR_CORE_NUM,
+                           &value) != ACL_SUCCESS ||
+        value <= 0) {
+      value = kDefaultVectorCoreNum;
+    }
+    return static_cast<int32_t>(value);
+  }();
+  return core_num;
+}
+#endif
+
+#endif // VLLM_MINDSPORE_CSRC_MODULE_OP_UTILS_H
@@ -0,0 +1,151 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include "ms_extension/api.h"
+
+#ifdef VLLM_MS_CPU_BACKEND
+#include "cpu/rejection_sample.h"
+#else
+#include "ascendc/rejection_sample.h"
+#endif
+#include "module/module.h"
+#include "module/op_utils.h"
+
+class RejectionSampleOp : public ms::pynative::PyboostRunner {
+public:
+  using PyboostRunner::PyboostRunner;
+  static int StatsId() {
+    static const int id = OpStats::RegisterOp("rejection_sample");
+    return id;
+  }
+
+  void LaunchKernel() override {
+    auto batch_size = static_cast<int32_t>(inputs()[0].shape()[0]);
+    auto vocab_size = static_cast<int32_t>(inputs()[3].shape().back());
+    if (batch_size <= 0) {
+      return;
+    }
+#ifdef VLLM_MS_CPU_BACKEND
+    OpKernelTimer timer(StatsId(), nullptr);
+    RejectionSampleCpu(
+        static_cast<const int32_t *>(inputs()[0].GetDataPtr()),
+        static_cast<const int32_t *>(inputs()[1].GetDataPtr()),
+        use_draft_probs_ ? static_cast<const float *>(inputs()[2].GetDataPtr())
+                         : nullptr,
+        static_cast<const float *>(inputs()[3].GetDataPtr()),
+        static_cast<const int32_t *>(inputs()[4].GetDataPtr()),
+        static_cast<const float *>(inputs()[5].GetDataPtr()),
+        static_cast<const float *>(inputs()[6].GetDataPtr()),
+        static_cast<const bool *>(inputs()[7].GetDataPtr()),
+        static_cast<int32_t *>(outputs()[0].GetDataPtr()), batch_size,
+        max_spec_len_, vocab_size);
+#else
+    auto tiling = ComputeRejectionSampleTiling(batch_size, max_spec_len_,
+                                               vocab_size, GetVectorCoreNum());
+    void *l2ctrl = nullptr;
+    OpKernelTimer timer(StatsId(), stream());
+    RejectionSampleKernelEntry(
+        l2ctrl, stream(), static_cast<uint8_t *>(inputs()[0].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[1].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[2].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[3].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[4].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[5].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[6].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[7].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[0].GetDataPtr()), use_draft_probs_,
+        tiling);
+#endif
+  }
+
+  // output_token_ids [batch_size, max_spec_len + 1] is fully overwritten.
+  // draft_probs is only read when use_draft_probs is set, uniform_probs and
+  // recovery_noise [batch_size, vocab_size] only for requests not in
+  // is_greedy.
+  static void Eval(ms::Tensor output_token_ids,    // output
+                   ms::Tensor cu_num_draft_tokens, // input
+                   ms::Tensor draft_token_ids,     // input
+                   ms::Tensor draft_probs,         // input
+                   ms::Tensor target_probs,        // input
+                   ms::Tensor bonus_token_ids,     // input
+                   ms::Tensor uniform_probs,       // input
+                   ms::Tensor recovery_noise,      // input
+                   ms::Tensor is_greedy,           // input
+                   int32_t max_spec_len, bool use_draft_probs) {
+    OpStatsScope stats(StatsId());
+    DtypeCaster caster;
+    auto int32 = ms::TypeId::kNumberTypeInt32;
+    auto fp32 = ms::TypeId::kNumberTypeFloat32;
+    cu_num_draft_tokens = caster.CheckAndCast(cu_num_draft_tokens, int32);
+    draft_token_ids = caster.CheckAndCast(draft_token_ids, int32);
+    draft_probs = caster.CheckAndCast(draft_probs, fp32);
+    target_probs = caster.CheckAndCast(target_probs, fp32);
+    bonus_token_ids = caster.CheckAndCast(bonus_token_ids, int32);
+    // the acceptance test compares in fp32, on both backends
+    uniform_probs = caster.CheckAndCast(uniform_probs, fp32);
+    recovery_noise = caster.CheckAndCast(recovery_noise, fp32);
+    is_greedy = caster.CheckAndCast(is_greedy, ms::TypeId::kNumberTypeBool);
+    output_token_ids =
+        caster.CheckAndCast(output_token_ids, int32, "output_token_ids");
+
+    auto runner = std::make_shared<RejectionSampleOp>("RejectionSample");
+    runner->max_spec_len_ = max_spec_len;
+    runner->use_draft_probs_ = use_draft_probs;
+    if (stats.enabled()) {
+      stats.AddBytes(
+          TensorBytes({cu_num_draft_tokens, draft_token_ids, target_probs,
+                       bonus_token_ids, uniform_probs, recovery_noise,
+                       is_greedy}) +
+              (use_draft_probs ? TensorBytes(draft_probs) : 0),
+          TensorBytes(output_token_ids));
+    }
+    runner->Run({cu_num_draft_tokens, draft_token_ids, draft_probs,
+                 target_probs, bonus_token_ids, uniform_probs, recovery_noise,
+                 is_greedy},
+                {output_token_ids});
+
+    output_token_ids =
+        caster.RecoveryTensorDtype(output_token_ids, "output_token_ids");
+    stats.AddCasts(caster.casts_, caster.cast_ns_);
+  }
+  int32_t max_spec_len_{0};
+  bool use_draft_probs_{false};
+};
+
+auto pyboost_rejection_sample(
+    ms::Tensor output_token_ids, ms::Tensor cu_num_draft_tokens,
+    ms::Tensor draft_token_ids, ms::Tensor draft_probs,
+    ms::Tensor target_probs, ms::Tensor bonus_token_ids,
+    ms::Tensor uniform_probs, ms::Tensor recovery_noise, ms::Tensor is_greedy,
+    int32_t max_spec_len, bool use_draft_probs) {
+  return ms::pynative::PyboostRunner::Call<0>(
+      RejectionSampleOp::Eval, output_token_ids, cu_num_draft_tokens,
+      draft_token_ids, draft_probs, target_probs, bonus_token_ids,
+      uniform_probs, recovery_noise, is_greedy, max_spec_len, use_draft_probs);
+}
+
+VLLM_MS_EXTENSION_MODULE(m) {
+  m.def("rejection_sample", &pyboost_rejection_sample, "rejection_sample",
+        pybind11::arg("output_token_ids"),
+        pybind11::arg("cu_num_draft_tokens"), pybind11::arg("draft_token_ids"),
+        pybind11::arg("draft_probs"), pybind11::arg("target_probs"),
+        pybind11::arg("bonus_token_ids"), pybind11::arg("uniform_probs"),
+        pybind11::arg("recovery_noise"), pybind11::arg("is_greedy"),
+        pybind11::arg("max_spec_len"), pybind11::arg("use_draft_probs"));
+}
@@ -0,0 +1,165 @@
+/**
+ * Copyright 2025 Huawei Technologies Co., Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "ms_extension/api.h"
+
+#ifdef VLLM_MS_CPU_BACKEND
+#include "cpu/segment_pool.h"
+#else
+#include "ascendc/segment_pool.h"
+#endif
+#include "module/module.h"
+#include "module/op_utils.h"
+
+// The kernel reads fp16, bf16 and fp32 hidden states as they are; any other
+// dtype is pooled in fp32.
+static ms::TypeId KernelHiddenDtype(const ms::Tensor &t) {
+  switch (t.data_type()) {
+  case ms::TypeId::kNumberTypeFloat16:
+  case ms::TypeId::kNumberTypeBFloat16:
+    return t.data_type();
+  default:
+    return ms::TypeId::kNumberTypeFloat32;
+  }
+}
+
+static SegmentPoolDtype ToSegmentPoolDtype(ms::TypeId dtype) {
+  switch (dtype) {
+  case ms::TypeId::kNumberTypeFloat16:
+    return SegmentPoolDtype::kFloat16;
+  case ms::TypeId::kNumberTypeBFloat16:
+    return SegmentPoolDtype::kBFloat16;
+  default:
+    return SegmentPoolDtype::kFloat32;
+  }
+}
+
+class SegmentPoolOp : public ms::pynative::PyboostRunner {
+public:
+  using PyboostRunner::PyboostRunner;
+  static int StatsId() {
+    static const int id = OpStats::RegisterOp("segment_pool");
+    return id;
+  }
+
+  void LaunchKernel() override {
+    auto num_reqs = static_cast<int32_t>(inputs()[1].numel());
+    auto hidden_size = static_cast<int32_t>(inputs()[0].shape().back());
+    if (num_reqs <= 0 || hidden_size <= 0) {
+      return;
+    }
+    auto dtype = ToSegmentPoolDtype(inputs()[0].data_type());
+#ifdef VLLM_MS_CPU_BACKEND
+    OpKernelTimer timer(StatsId(), nullptr);
+    SegmentPoolCpu(inputs()[0].GetDataPtr(),
+                   static_cast<const int32_t *>(inputs()[1].GetDataPtr()),
+                   static_cast<const int32_t *>(inputs()[2].GetDataPtr()),
+                   static_cast<const int32_t *>(inputs()[3].GetDataPtr()),
+                   static_cast<const int32_t *>(inputs()[4].GetDataPtr()),
+                   outputs()[0].GetDataPtr(),
+                   static_cast<float *>(outputs()[1].GetDataPtr()), num_reqs,
+                   hidden_size, pooling_type_, dtype);
+#else
+    auto tiling = ComputeSegmentPoolTiling(num_reqs, hidden_size,
+                                           pooling_type_, GetVectorCoreNum());
+    void *l2ctrl = nullptr;
+    OpKernelTimer timer(StatsId(), stream());
+    SegmentPoolKernelEntry(
+        l2ctrl, stream(), static_cast<uint8_t *>(inputs()[0].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[1].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[2].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[3].GetDataPtr()),
+        static_cast<uint8_t *>(inputs()[4].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[0].GetDataPtr()),
+        static_cast<uint8_t *>(outputs()[1].GetDataPtr()), dtype, tiling);
+#endif
+  }
+
+  // pooled [num_reqs, hidden_size] is fully overwritten with the CLS, LAST or
+  // MEAN pooling of the tokens [first_token_indices[i], last_token_indices[i]]
+  // of hidden_states [num_tokens, hidden_size], after num_prev_tokens[i]
+  // tokens pooled in earlier steps, whose CLS row or MEAN sum partial_sums
+  // [num_reqs, hidden_size] carries in; the rows of prompts that go on after
+  // this step are written back to it.
+  static void Eval(ms::Tensor pooled,              // output
+                   ms::Tensor partial_sums,        // output, also input
+                   ms::Tensor hidden_states,       // input
+                   ms::Tensor first_token_indices, // input
+                   ms::Tensor last_token_indices,  // input
+                   ms::Tensor prompt_lens,         // input
+                   ms::Tensor num_prev_tokens,     // input
+                   int32_t pooling_type) {
+    if (pooling_type < kSegmentPoolCls || pooling_type > kSegmentPoolMean) {
+      throw std::invalid_argument("segment_pool: unknown pooling_type " +
+                                  std::to_string(pooling_type));
+    }
+    OpStatsScope stats(StatsId());
+    DtypeCaster caster;
+    auto int32 = ms::TypeId::kNumberTypeInt32;
+    auto float32 = ms::TypeId::kNumberTypeFloat32;
+    auto hidden_dtype = KernelHiddenDtype(hidden_states);
+    hidden_states = caster.CheckAndCast(hidden_states, hidden_dtype);
+    first_token_indices = caster.CheckAndCast(first_token_indices, int32);
+    last_token_indices = caster.CheckAndCast(last_token_indices, int32);
+    prompt_lens = caster.CheckAndCast(prompt_lens, int32);
+    num_prev_tokens = caster.CheckAndCast(num_prev_tokens, int32);
+    pooled = caster.CheckAndCast(
+        pooled, pooling_type == kSegmentPoolMean ? float32 : hidden_dtype,
+        "pooled");
+    partial_sums = caster.CheckAndCast(partial_sums, float32, "partial_sums");
+
+    auto runner = std::make_shared<SegmentPoolOp>("SegmentPool");
+    runner->pooling_type_ = pooling_type;
+    if (stats.enabled()) {
+      stats.AddBytes(TensorBytes({hidden_states, first_token_indices,
+                                  last_token_indices, prompt_lens,
+                                  num_prev_tokens}),
+                     TensorBytes({pooled, partial_sums}));
+    }
+    runner->Run({hidden_states, first_token_indices, last_token_indices,
+                 prompt_lens, num_prev_tokens},
+                {pooled, partial_sums});
+
+    pooled = caster.RecoveryTensorDtype(pooled, "pooled");
+    partial_sums = caster.RecoveryTensorDtype(partial_sums, "partial_sums");
+    stats.AddCasts(caster.casts_, caster.cast_ns_);
+  }
+  int32_t pooling_type_{kSegmentPoolLast};
+};
+
+auto pyboost_segment_pool(ms::Tensor pooled, ms::Tensor partial_sums,
+                          ms::Tensor hidden_states,
+                          ms::Tensor first_token_indices,
+                          ms::Tensor last_token_indices,
+                          ms::Tensor prompt_lens, ms::Tensor num_prev_tokens,
+                          int32_t pooling_type) {
+  return ms::pynative::PyboostRunner::Call<0>(
+      SegmentPoolOp::Eval, pooled, partial_sums, hidden_states,
+      first_token_indices, last_token_indices, prompt_lens, num_prev_tokens,
+      pooling_type);
+}
+
+VLLM_MS_EXTENSION_MODULE(m) {
+  m.def("segment_pool", &pyboost_segment_pool, "segment_pool",
+        pybind11::arg("pooled"), pybind11::arg("partial_sums"),
+        pybind11::arg("hidden_states"), pybind11::arg("first_token_indices"),
+        pybind11::arg("last_token_indices"), pybind11::arg("prompt_lens"),
+        pybind11::arg("num_prev_tokens"), pybind11::arg("pooling_type"));
+}
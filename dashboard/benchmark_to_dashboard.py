@@ -16,10 +16,12 @@
 import argparse
 import base64
 import io
+import json
 import os
 import shlex
 import site
 import subprocess
+import sys
 import threading
 import time
 from datetime import datetime
@@ -467,11 +469,127 @@ def parse_arguments(args_string):
     return args_dict
 
 
+# ===== 自定义算子 benchmark =====
+# benchmark_custom_ops.py (NPU) 或 benchmark_ops (CPU) 的 JSON 结果，每个算子一个 csv
+OPS_DIR = "ops"
+
+
+def save_op_metrics(json_file: str, base_dir="results"):
+    with open(json_file, encoding="utf-8") as f:
+        report = json.load(f)
+    ops_dir = os.path.join(base_dir, OPS_DIR)
+    os.makedirs(ops_dir, exist_ok=True)
+
+    now = datetime.now().strftime("%Y-%m-%d %H:%M:%S")
+    commit = get_commit_info_for_packages().get("vllm-mindspore")
+    rows_by_op = {}
+    for result in report["results"]:
+        case = ",".join(f"{k}={v}" for k, v in result["params"].items())
+        rows_by_op.setdefault(result["op"], []).append({
+            "timestamp": now,
+            "vllm-mindspore": commit,
+            "backend": report.get("backend", ""),
+            "num_threads": report.get("num_threads", ""),
+            "case": case,
+            "p50(us)": result["p50_us"],
+            "p99(us)": result["p99_us"],
+            "bytes": result["bytes"],
+            "bandwidth(GB/s)": result["gbps"],
+        })
+    for op, rows in rows_by_op.items():
+        csv_file = os.path.join(ops_dir, f"{sanitize_name(op)}.csv")
+        df_new = pd.DataFrame(rows)
+        if os.path.isfile(csv_file):
+            df_new = pd.concat([pd.read_csv(csv_file), df_new],
+                               ignore_index=True)
+        df_new.to_csv(csv_file, index=False)
+        print(f"✅ Saved {len(rows)} {op} results to {csv_file}")
+    return ops_dir
+
+
+def generate_ops_html(base_dir="results"):
+    ops_dir = os.path.join(base_dir, OPS_DIR)
+    html_rows = []
+    for csv_name in sorted(os.listdir(ops_dir)):
+        if not csv_name.endswith(".csv"):
+            continue
+        op = csv_name[:-len(".csv")]
+        df = pd.read_csv(os.path.join(ops_dir, csv_name))
+        df['timestamp'] = pd.to_datetime(df['timestamp'])
+        df = df.sort_values('timestamp')
+        for case, df_case in df.groupby(["backend", "case"], sort=False):
+            latest = df_case.iloc[-1]
+            row_cells = (f"<td>{op}</td><td>{case[0]}</td><td>{case[1]}</td>"
+                         f"<td>{latest['timestamp']}</td>")
+            # p50/p99 的历史趋势
+            for c in ["p50(us)", "p99(us)"]:
+                fig, ax = plt.subplots(figsize=(1.5, 0.3))
+                color = COLOR_LIST[hash(c) % len(COLOR_LIST)]
+                y = pd.to_numeric(df_case[c], errors="coerce").fillna(0)
+                ax.plot(range(len(y)), y, color=color, linewidth=1)
+                ax.axis("off")
+                buf = io.BytesIO()
+                plt.savefig(buf,
+                            format="png",
+                            bbox_inches="tight",
+                            pad_inches=0)
+                plt.close(fig)
+                img_base64 = base64.b64encode(buf.getvalue()).decode("utf-8")
+                row_cells += (
+                    f"<td>{latest[c]}<br>"
+                    f"<img src='data:image/png;base64,{img_base64}'></td>")
+            row_cells += (f"<td>{latest['bytes']}</td>"
+                          f"<td>{latest['bandwidth(GB/s)']}</td>"
+                          f"<td>{latest['num_threads']}</td>"
+                          f"<td>{latest['vllm-mindspore']}</td>")
+            html_rows.append(f"<tr>{row_cells}</tr>")
+
+    header_cells = "".join(f"<th>{c}</th>" for c in [
+        "Op", "Backend", "Case", "Timestamp", "p50(us)", "p99(us)", "bytes",
+        "bandwidth(GB/s)", "num_threads", "vllm-mindspore"
+    ])
+    html = f"""
+<html>
+<head>
+<meta charset="utf-8">
+<title>vLLM-mindspore Custom Op Benchmark</title>
+<link rel="stylesheet"
+ href="https://cdn.datatables.net/1.13.4/css/jquery.dataTables.min.css">
+<script src="https://code.jquery.com/jquery-3.6.0.min.js"></script>
+<script
+ src="https://cdn.datatables.net/1.13.4/js/jquery.dataTables.min.js"></script>
+<style>
+body{{font-family:Arial,sans-serif;}}
+h1{{color:#1f77b4;}}
+td{{vertical-align:top;}}
+</style>
+</head>
+<body>
+<h1>vLLM-mindspore Custom Op Benchmark</h1>
+<table id="ops" class="display" style="width:100%">
+<thead><tr>{header_cells}</tr></thead>
+<tbody>{''.join(html_rows)}</tbody>
+</table>
+<script>
+$(document).ready(function(){{
+    $('#ops').DataTable({{"pageLength": 100, "order": []}});
+}});
+</script>
+</body>
+</html>
+"""
+    html_path = os.path.join(ops_dir, "index.html")
+    with open(html_path, "w", encoding="utf-8") as f:
+        f.write(html)
+    print(f"✅ Generated Op Benchmark HTML: {html_path}")
+    return html_path
+
+
 # ===== 首页 Dashboard HTML =====
 def generate_index_html(base_dir="results"):
     models = [
         d for d in os.listdir(base_dir)
-        if os.path.isdir(os.path.join(base_dir, d))
+        if os.path.isdir(os.path.join(base_dir, d)) and d != OPS_DIR
     ]
     html_rows = []
     for m in models:
@@ -665,11 +783,15 @@ usage:
             --num-prompts=20 --random-input-len=20 \
             --dataset-name=random --trust-remote-code" \
         --display-name "gpt2-10;gpt2-20"
+
+    custom op benchmark (benchmarks/kernels/benchmark_custom_ops.py --output
+    ops.json, on the NPU or else csrc/cpu/benchmarks/benchmark_ops):
+    python benchmark_to_dashboard.py --op-bench-json=ops.json
 """
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser()
-    parser.add_argument("--model", required=True, help="模型名称")
+    parser.add_argument("--model", default=None, help="模型名称")
     parser.add_argument("--serve-args",
                         default="",
                         help="vllm-mindspore serve 参数")
@@ -677,8 +799,19 @@ if __name__ == "__main__":
                         default="",
                         help="多组 benchmark 参数，用 ';' 分隔")
     parser.add_argument("--display-name", default=None, help="多组用 ';' 分隔")
+    parser.add_argument("--op-bench-json",
+                        default=None,
+                        help="自定义算子 benchmark 的 JSON 结果")
     args = parser.parse_args()
 
+    if args.op_bench_json:
+        save_op_metrics(args.op_bench_json)
+        generate_ops_html()
+        if args.model is None:
+            sys.exit(0)
+    if args.model is None:
+        parser.error("--model is required")
+
     bench_args_list = [
         b.strip() for b in args.bench_args.split(";") if b.strip()
     ]
@@ -700,7 +833,6 @@ if __name__ == "__main__":
             csv_file = os.path.join(model_dir, "benchmark.csv")
             generate_model_html(display_name, model_dir, csv_file)
         generate_index_html()
-        import sys
         sys.exit(0)
 
     server, server_log = start_vllm_mindspore_server(args.model,
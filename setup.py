@@ -15,6 +15,7 @@
 # limitations under the License.
 """setup package."""
 
+import glob
 import importlib.util
 import logging
 import os
@@ -132,33 +133,50 @@ class CustomBuildExt(build_ext):
                 self.build_dummy_ops(ext)
             else:
                 self.build_c_ops(ext)
+        elif ext.name == "vllm_mindspore._C_ops_cpu":
+            self.build_c_ops(ext, backend="cpu")
+        elif ext.name == "vllm_mindspore._C_host":
+            # plain Python C API, built by setuptools on any platform
+            super().build_extension(ext)
         else:
             raise ValueError(f"Unknown extension name: {ext.name}")
 
-    def build_c_ops(self, ext):
-        # "vllm_mindspore._C_ops" --> "_C_ops"
+    def build_c_ops(self, ext, backend="ascend"):
+        # "vllm_mindspore._C_ops" --> "_C_ops",
+        # the CPU build is named after it with a "_cpu" suffix
         ext_name = ext.name.split('.')[-1]
         so_name = ext_name + ".so"
+        base_name = ext_name.removesuffix("_cpu")
         logger.info("Building %s ...", so_name)
         OPS_DIR = os.path.join(ROOT_DIR, "csrc")
-        BUILD_OPS_DIR = os.path.join(ROOT_DIR, "build", "csrc_ops")
+        BUILD_OPS_DIR = os.path.join(ROOT_DIR, "build",
+                                     "csrc_ops" if backend == "ascend" else
+                                     f"csrc_ops_{backend}")
         if os.path.exists(BUILD_OPS_DIR):
             shutil.rmtree(BUILD_OPS_DIR)
         os.makedirs(BUILD_OPS_DIR, exist_ok=True)
 
-        ascend_home_path = _get_ascend_home_path()
-        env_script_path = _get_ascend_env_path()
         build_extension_dir = os.path.join(BUILD_OPS_DIR, "kernel_meta",
-                                           ext_name)
+                                           base_name)
+        if backend == "ascend":
+            ascend_home_path = _get_ascend_home_path()
+            env_script_path = _get_ascend_env_path()
+            env_cmd = f"source {shlex.quote(env_script_path)} && "
+            backend_args = (
+                f"  -DASCEND_CANN_PACKAGE_PATH={shlex.quote(ascend_home_path)}"
+            )
+        else:
+            env_cmd = ""
+            backend_args = "  -DBUILD_ASCEND_OPS=OFF -DBUILD_CPU_OPS=ON"
         # Combine all cmake commands into one string
         cmake_cmd = (
-            f"source {shlex.quote(env_script_path)} && "
+            f"{env_cmd}"
             f"cmake -S {OPS_DIR} -B {BUILD_OPS_DIR}"
             f"  -DCMAKE_BUILD_TYPE=Release"
             f"  -DCMAKE_INSTALL_PREFIX={os.path.join(BUILD_OPS_DIR, 'install')}"
             f"  -DBUILD_EXTENSION_DIR={build_extension_dir}"
-            f"  -DMS_EXTENSION_NAME={ext_name}"
-            f"  -DASCEND_CANN_PACKAGE_PATH={shlex.quote(ascend_home_path)} && "
+            f"  -DMS_EXTENSION_NAME={base_name}"
+            f"{backend_args} && "
             f"cmake --build {BUILD_OPS_DIR} -j --verbose")
 
         # Run the combined cmake command
@@ -178,7 +196,9 @@ class CustomBuildExt(build_ext):
                 format(ext_name, build_log_file))
 
         # Copy the generated .so file to the target directory
-        src_so_path = os.path.join(build_extension_dir, so_name)
+        src_so_path = os.path.join(
+            build_extension_dir if backend == "ascend" else
+            f"{build_extension_dir}_{backend}", so_name)
         dst_so_path = self.get_ext_fullpath(ext.name)
         os.makedirs(os.path.dirname(dst_so_path), exist_ok=True)
         if os.path.exists(dst_so_path):
@@ -203,6 +223,11 @@ def _should_build_custom():
     return os.environ.get("BUILD_CUSTOM") == "1"
 
 
+def _should_build_custom_cpu():
+    """Check if BUILD_CUSTOM_CPU environment variable is set to 1."""
+    return os.environ.get("BUILD_CUSTOM_CPU") == "1"
+
+
 def _get_ext_modules():
     ext_modules = []
     if _should_build_custom():
@@ -221,6 +246,19 @@ def _get_ext_modules():
                 "vllm_mindspore._C_ops",
                 sources=[dummy_source],
             ))
+    if _should_build_custom_cpu():
+        # host implementation of the custom ops, used when the device target
+        # is CPU; sources are specified in CMakeLists.txt
+        ext_modules.append(Extension("vllm_mindspore._C_ops_cpu", sources=[]))
+    # host-side helpers, which need neither MindSpore nor CANN
+    ext_modules.append(
+        Extension(
+            "vllm_mindspore._C_host",
+            sources=sorted(glob.glob(os.path.join("csrc", "host", "*.cpp"))),
+            include_dirs=["csrc"],
+            extra_compile_args=["-std=c++17", "-O3"],
+            language="c++",
+        ))
     return ext_modules
 
 
@@ -0,0 +1,175 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native ring buffer queue of shm_broadcast"""
+import mmap
+import multiprocessing as mp
+import pickle
+import time
+from multiprocessing import shared_memory
+
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+N_READER, MAX_CHUNK_BYTES, MAX_CHUNKS = 3, 64, 4
+METADATA_OFFSET = 256
+
+
+def _make_queue(create, buf):
+    from vllm_mindspore._C_host import RingBufferQueue
+    return RingBufferQueue(buf, METADATA_OFFSET, N_READER, MAX_CHUNK_BYTES,
+                           MAX_CHUNKS, create)
+
+
+def _reader_process(reader, name, num_messages, results):
+    shm = shared_memory.SharedMemory(name=name)
+    queue = _make_queue(False, shm.buf)
+    received = []
+    for _ in range(num_messages):
+        assert queue.wait_read(reader, timeout=30)
+        start = queue.read_index(reader) * MAX_CHUNK_BYTES
+        received.append(int.from_bytes(shm.buf[start:start + 8], "little"))
+        queue.commit_read(reader)
+    del queue
+    shm.close()
+    results.put((reader, received))
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_ring_buffer_queue_single_process():
+    """
+    Test Summary:
+        Fill the ring, then drain it reader by reader.
+    Expected Result:
+        The writer waits for the slowest reader, each reader sees every
+        chunk once and in order, and waits time out instead of blocking.
+    """
+    from vllm_mindspore._C_host import RingBufferQueue
+
+    # page aligned, like shared memory
+    buf = mmap.mmap(-1,
+                    METADATA_OFFSET + RingBufferQueue.metadata_bytes(N_READER))
+    writer = _make_queue(True, buf)
+    with pytest.raises(ValueError):
+        RingBufferQueue(buf, METADATA_OFFSET, N_READER, MAX_CHUNK_BYTES,
+                        MAX_CHUNKS + 1, False)
+    readers = _make_queue(False, buf)
+
+    assert not readers.wait_read(0, timeout=0)
+    for i in range(MAX_CHUNKS):
+        assert writer.wait_write(timeout=0)
+        assert writer.write_index() == i
+        writer.commit_write()
+    start = time.monotonic()
+    assert not writer.wait_write(timeout=0.05)
+    assert time.monotonic() - start >= 0.05
+    with pytest.raises(RuntimeError):
+        writer.commit_write()
+
+    for reader in range(N_READER):
+        for i in range(MAX_CHUNKS):
+            assert readers.wait_read(reader, timeout=0)
+            assert readers.read_index(reader) == i
+            readers.commit_read(reader)
+        assert not readers.wait_read(reader, timeout=0)
+        with pytest.raises(RuntimeError):
+            readers.commit_read(reader)
+        # free only once the last reader is done with the oldest chunk
+        assert writer.wait_write(timeout=0) == (reader == N_READER - 1)
+    with pytest.raises(IndexError):
+        readers.read_index(N_READER)
+    del writer, readers
+    buf.close()
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_ring_buffer_queue_multi_process():
+    """
+    Test Summary:
+        One writer broadcasts many more messages than chunks to reader
+        processes.
+    Expected Result:
+        Every reader receives every message, in order.
+    """
+    from vllm_mindspore._C_host import RingBufferQueue
+
+    num_messages = 10000
+    shm = shared_memory.SharedMemory(
+        create=True,
+        size=METADATA_OFFSET + RingBufferQueue.metadata_bytes(N_READER))
+    try:
+        writer = _make_queue(True, shm.buf)
+        ctx = mp.get_context("spawn")
+        results = ctx.Queue()
+        processes = [
+            ctx.Process(target=_reader_process,
+                        args=(reader, shm.name, num_messages, results))
+            for reader in range(N_READER)
+        ]
+        for process in processes:
+            process.start()
+        for i in range(num_messages):
+            assert writer.wait_write(timeout=30)
+            start = writer.write_index() * MAX_CHUNK_BYTES
+            shm.buf[start:start + 8] = i.to_bytes(8, "little")
+            writer.commit_write()
+        received = dict(results.get(timeout=60) for _ in processes)
+        for process in processes:
+            process.join()
+            assert process.exitcode == 0
+        assert sorted(received) == list(range(N_READER))
+        for messages in received.values():
+            assert messages == list(range(num_messages))
+        del writer
+    finally:
+        shm.close()
+        shm.unlink()
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_shm_ring_buffer_layout():
+    """
+    Test Summary:
+        A ShmRingBuffer, and its copy opened by name as readers get it.
+    Expected Result:
+        The chunks keep their layout, both ends share one native queue, and
+        the buffer is released cleanly.
+    """
+    from vllm.distributed.device_communicators.shm_broadcast import (
+        ShmRingBuffer)
+
+    import vllm_mindspore  # noqa: F401, patches ShmRingBuffer
+
+    buffer = ShmRingBuffer(N_READER, 1000, MAX_CHUNKS)
+    assert buffer.native_queue is not None
+    assert buffer.metadata_offset % 64 == 0
+    assert buffer.metadata_offset >= 1000 * MAX_CHUNKS
+    with buffer.get_data(1) as data:
+        assert len(data) == 1000
+        data[0] = 42
+    opened = pickle.loads(pickle.dumps(buffer))
+    with opened.get_data(1) as data:
+        assert data[0] == 42
+    buffer.native_queue.wait_write(timeout=0)
+    buffer.native_queue.commit_write()
+    assert opened.native_queue.wait_read(0, timeout=0)
+    del opened, buffer
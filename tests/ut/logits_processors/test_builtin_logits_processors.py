@@ -0,0 +1,170 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native batch logits processors against the per-row ones"""
+from types import SimpleNamespace
+
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+VOCAB_SIZE = 2048
+
+
+def _processors(rng):
+    """A random list of built-in processors, the min tokens and allowed
+    token ids partly out of the vocabulary."""
+    from vllm_mindspore.logits_process import (AllowedTokenIdsLogitsProcessor,
+                                               BadWordsLogitsProcessor,
+                                               MinTokensLogitsProcessor,
+                                               PenaltiesLogitsProcessor)
+
+    processors = []
+    for kind in rng.integers(0, 4, rng.integers(1, 5)):
+        if kind == 0:
+            processors.append(
+                PenaltiesLogitsProcessor(float(rng.choice([1.0, 1.2, 0.7])),
+                                         float(rng.choice([0.0, 0.5, -0.3])),
+                                         float(rng.choice([0.0, 0.2]))))
+        elif kind == 1:
+            words = [
+                rng.integers(0, 16, rng.integers(1, 4)).tolist()
+                for _ in range(rng.integers(1, 6))
+            ]
+            processors.append(BadWordsLogitsProcessor(words))
+        elif kind == 2:
+            processors.append(
+                MinTokensLogitsProcessor(
+                    int(rng.integers(0, 8)),
+                    rng.integers(0, VOCAB_SIZE + 4, 3).tolist()))
+        else:
+            processors.append(
+                AllowedTokenIdsLogitsProcessor(
+                    rng.integers(0, VOCAB_SIZE + 4,
+                                 rng.integers(1, 64)).tolist()))
+    return processors
+
+
+def _rows(rng, num_rows):
+    # small token ids, so that words and penalties hit the outputs often
+    return [(_processors(rng), rng.integers(0, VOCAB_SIZE,
+                                            rng.integers(0, 40)).tolist(),
+             rng.integers(0, 16, rng.integers(0, 12)).tolist())
+            for _ in range(num_rows)]
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("num_rows", [1, 7, 64])
+@pytest.mark.parametrize("num_threads", [1, 0])
+def test_apply_builtin_logits_processors(num_rows, num_threads):
+    """
+    Test Summary:
+        Apply random lists of penalties, bad words, min tokens and allowed
+        token ids to a batch of logits natively, and row by row with the
+        numpy version of every processor.
+    Expected Result:
+        The logits are the same.
+    """
+    from vllm_mindspore.logits_process import apply_builtin_logits_processors
+
+    rng = np.random.default_rng(num_rows)
+    rows = _rows(rng, num_rows)
+    logits = rng.standard_normal((num_rows, VOCAB_SIZE)).astype(np.float32)
+    expected = logits.copy()
+    for row, (processors, prompt, output) in zip(expected, rows):
+        for processor in processors:
+            processor.apply_np(prompt, output, row)
+    apply_builtin_logits_processors(logits, rows, num_threads=num_threads)
+    np.testing.assert_array_equal(logits, expected)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_apply_logits_processors_mixed(monkeypatch):
+    """
+    Test Summary:
+        Run _apply_logits_processors on seq groups whose processors are
+        built-in, custom, or built-in followed by custom, with the native
+        engine and with it disabled.
+    Expected Result:
+        Both give the same logits, and every row goes through all of its
+        processors in order.
+    """
+    from vllm_mindspore import logits_process
+    from vllm_mindspore.model_executor.layers.logits_processor import (
+        _apply_logits_processors)
+
+    def add_output_len(prompt_tokens_ids, past_tokens_ids, logits_row):
+        return logits_row + len(past_tokens_ids)
+
+    rng = np.random.default_rng(0)
+    seq_groups = []
+    num_rows = 0
+    for processors in (_processors(rng), [add_output_len],
+                       _processors(rng) + [add_output_len]):
+        seq_ids = list(range(num_rows, num_rows + 3))
+        seq_groups.append(
+            SimpleNamespace(
+                seq_ids=seq_ids,
+                sample_indices=seq_ids,
+                prompt_logprob_indices=[],
+                sampling_params=SimpleNamespace(logits_processors=processors),
+                seq_data={
+                    seq_id: SimpleNamespace(
+                        prompt_token_ids=rng.integers(0, VOCAB_SIZE,
+                                                      20).tolist(),
+                        output_token_ids=rng.integers(0, 16, 6).tolist())
+                    for seq_id in seq_ids
+                }))
+        num_rows += len(seq_ids)
+    metadata = SimpleNamespace(seq_groups=seq_groups)
+    logits = rng.standard_normal((num_rows, VOCAB_SIZE)).astype(np.float32)
+
+    native = _apply_logits_processors(ms.Tensor(logits), metadata).asnumpy()
+    monkeypatch.setattr(logits_process, "_native_apply_logits_processors",
+                        None)
+    python = _apply_logits_processors(ms.Tensor(logits), metadata).asnumpy()
+    np.testing.assert_allclose(native, python, rtol=1e-6)
+    assert not np.array_equal(native, logits)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("bad_word", [[VOCAB_SIZE], [3, -1]])
+def test_bad_words_out_of_vocab(bad_word):
+    """
+    Test Summary:
+        Apply bad words with a token id out of the vocabulary, row by row
+        and natively.
+    Expected Result:
+        Both raise a ValueError, as vLLM does, and leave the logits as they
+        were.
+    """
+    from vllm_mindspore.logits_process import (BadWordsLogitsProcessor,
+                                               apply_builtin_logits_processors)
+
+    processor = BadWordsLogitsProcessor([[5], bad_word])
+    logits = np.zeros((1, VOCAB_SIZE), dtype=np.float32)
+    with pytest.raises(ValueError, match="specified as bad"):
+        processor.apply_np([], [], logits[0])
+    with pytest.raises(ValueError, match="specified as bad"):
+        apply_builtin_logits_processors(logits, [([processor], [], [])])
+    assert not logits.any()
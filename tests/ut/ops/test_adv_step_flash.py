@@ -0,0 +1,140 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test advance_step_flashattn custom op"""
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _golden(sampled_token_ids, seq_lens, block_tables, block_size):
+    positions = seq_lens.astype(np.int64)
+    rows = np.arange(len(seq_lens))
+    blocks = block_tables[rows, positions // block_size].astype(np.int64)
+    return (sampled_token_ids.reshape(-1), positions, positions + 1,
+            blocks * block_size + positions % block_size)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("idx_dtype", [np.int32, np.int64])
+@pytest.mark.parametrize("len_dtype", [np.int32, np.int64])
+@pytest.mark.parametrize("num_seqs", [1, 37, 1024])
+def test_advance_step_flashattn_dtypes(idx_dtype, len_dtype, num_seqs):
+    """
+    Test Summary:
+        The outputs are written in place at the dtype of the given tensors,
+        for every int32/int64 combination of the index tensors and seq_lens.
+    Expected Result:
+        Outputs keep their dtype and match the numpy golden.
+    """
+    from vllm_mindspore._custom_ops import advance_step_flashattn
+
+    block_size, max_blocks_per_seq = 16, 64
+    rng = np.random.default_rng(num_seqs)
+    sampled_token_ids = rng.integers(0, 151936, (num_seqs, 1), dtype=idx_dtype)
+    seq_lens = rng.integers(1, block_size * max_blocks_per_seq - 1, num_seqs,
+                            dtype=len_dtype)
+    block_tables = rng.integers(0, 65536, (num_seqs, max_blocks_per_seq),
+                                dtype=np.int32)
+    expects = _golden(sampled_token_ids, seq_lens, block_tables, block_size)
+
+    input_tokens = ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype))
+    input_positions = ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype))
+    slot_mapping = ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype))
+    seq_lens_tensor = ms.Tensor(seq_lens)
+    advance_step_flashattn(num_seqs=num_seqs,
+                           num_queries=num_seqs,
+                           block_size=block_size,
+                           input_tokens=input_tokens,
+                           sampled_token_ids=ms.Tensor(sampled_token_ids),
+                           input_positions=input_positions,
+                           seq_lens=seq_lens_tensor,
+                           slot_mapping=slot_mapping,
+                           block_tables=ms.Tensor(block_tables))
+
+    outputs = (input_tokens, input_positions, seq_lens_tensor, slot_mapping)
+    out_dtypes = (idx_dtype, idx_dtype, len_dtype, idx_dtype)
+    for output, out_dtype, expect in zip(outputs, out_dtypes, expects):
+        actual = output.asnumpy()
+        assert actual.dtype == out_dtype
+        np.testing.assert_array_equal(actual, expect)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("num_seqs, num_queries", [(37, 37), (64, 29),
+                                                   (1024, 1000)])
+@pytest.mark.parametrize("num_tokens_per_seq", [1, 4])
+def test_advance_step_flashattn_multi_token(num_seqs, num_queries,
+                                            num_tokens_per_seq):
+    """
+    Test Summary:
+        Each query sequence advances by num_tokens_per_seq tokens and the
+        sequences past num_queries are padded.
+    Expected Result:
+        Outputs follow the sequence-major layout, padded sequences get
+        token 0, position 0 and slot -1 and keep their seq_lens.
+    """
+    from vllm_mindspore._custom_ops import advance_step_flashattn
+
+    block_size, max_blocks_per_seq = 16, 64
+    k_tokens = num_tokens_per_seq
+    rng = np.random.default_rng(num_seqs)
+    sampled_token_ids = rng.integers(0, 151936, (num_seqs, k_tokens),
+                                     dtype=np.int32)
+    seq_lens = rng.integers(1, block_size * max_blocks_per_seq - k_tokens,
+                            num_seqs, dtype=np.int32)
+    block_tables = rng.integers(0, 65536, (num_seqs, max_blocks_per_seq),
+                                dtype=np.int32)
+
+    positions = seq_lens[:, None].astype(np.int64) + np.arange(k_tokens)
+    rows = np.arange(num_seqs)[:, None]
+    blocks = block_tables[rows, positions // block_size].astype(np.int64)
+    expect_tokens = sampled_token_ids.copy()
+    expect_slots = blocks * block_size + positions % block_size
+    expect_seq_lens = seq_lens + k_tokens
+    expect_tokens[num_queries:] = 0
+    positions[num_queries:] = 0
+    expect_slots[num_queries:] = -1
+    expect_seq_lens[num_queries:] = seq_lens[num_queries:]
+
+    num_tokens = num_seqs * k_tokens
+    input_tokens = ms.Tensor(np.full(num_tokens, 7, dtype=np.int32))
+    input_positions = ms.Tensor(np.full(num_tokens, 7, dtype=np.int32))
+    slot_mapping = ms.Tensor(np.full(num_tokens, 7, dtype=np.int32))
+    seq_lens_tensor = ms.Tensor(seq_lens)
+    advance_step_flashattn(num_seqs=num_seqs,
+                           num_queries=num_queries,
+                           block_size=block_size,
+                           input_tokens=input_tokens,
+                           sampled_token_ids=ms.Tensor(sampled_token_ids),
+                           input_positions=input_positions,
+                           seq_lens=seq_lens_tensor,
+                           slot_mapping=slot_mapping,
+                           block_tables=ms.Tensor(block_tables),
+                           num_tokens_per_seq=k_tokens)
+
+    np.testing.assert_array_equal(input_tokens.asnumpy(),
+                                  expect_tokens.reshape(-1))
+    np.testing.assert_array_equal(input_positions.asnumpy(),
+                                  positions.reshape(-1))
+    np.testing.assert_array_equal(slot_mapping.asnumpy(),
+                                  expect_slots.reshape(-1))
+    np.testing.assert_array_equal(seq_lens_tensor.asnumpy(), expect_seq_lens)
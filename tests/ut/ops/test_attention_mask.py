@@ -0,0 +1,68 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the fused attention mask against the per-request loop"""
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _batch(num_reqs, max_context_len, seed):
+    rng = np.random.default_rng(seed)
+    # decode requests among chunked prefills
+    query_lens = np.where(
+        rng.random(num_reqs) < 0.4, 1,
+        rng.integers(2, 64, num_reqs)).astype(np.int32)
+    seq_lens = query_lens + rng.integers(0, max_context_len,
+                                         num_reqs).astype(np.int32)
+    return query_lens, seq_lens
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("dtype", [ms.float16, ms.bfloat16])
+@pytest.mark.parametrize("num_reqs", [1, 9, 64])
+def test_attention_mask(dtype, num_reqs):
+    """
+    Test Summary:
+        Build the mask of a batch of decodes and chunked prefills with
+        contexts past cached_mask_len, with the fused op and with the loop
+        over requests, for the MLA mask (1.0 in bf16) and the normal one.
+    Expected Result:
+        Both masks are equal, and match the per-request causal offsets.
+    """
+    from vllm_mindspore.model_executor.models.attention_mask import (
+        LowerTriangularMask, MLALowerTriangularMask, causal_mask_offsets)
+
+    query_lens, seq_lens = _batch(num_reqs, 10000, num_reqs)
+    for mask_cls in (LowerTriangularMask, MLALowerTriangularMask):
+        mask_builder = mask_cls(dtype=dtype, max_model_len=16384)
+        assert mask_builder.fused_mask
+        fused = mask_builder.create_mask(query_lens, seq_lens).asnumpy()
+        mask_builder.fused_mask = False
+        golden = mask_builder.create_mask(query_lens, seq_lens).asnumpy()
+        assert fused.shape == (query_lens.sum(), seq_lens.max())
+        np.testing.assert_array_equal(fused, golden)
+
+        offsets = causal_mask_offsets(query_lens, seq_lens)
+        rows = np.repeat(np.arange(num_reqs), query_lens)
+        row_in_req = np.arange(rows.shape[0]) - np.repeat(
+            np.cumsum(query_lens) - query_lens, query_lens)
+        masked = np.arange(seq_lens.max())[None, :] > (offsets[rows] +
+                                                       row_in_req)[:, None]
+        np.testing.assert_array_equal(golden != 0, masked)
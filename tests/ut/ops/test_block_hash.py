@@ -0,0 +1,161 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native prefix caching block hashes against vLLM's"""
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _extra_keys(rng, num_blocks):
+    return [
+        None if rng.random() < 0.5 else
+        (f"lora-{int(rng.integers(3))}", ("mm-hash", int(rng.integers(64))))
+        for _ in range(num_blocks)
+    ]
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("block_size", [1, 16, 128])
+@pytest.mark.parametrize("with_extra_keys", [False, True])
+def test_hash_request_blocks_sha256(block_size, with_extra_keys):
+    """
+    Test Summary:
+        Hash all the full blocks of random token ids from a random start
+        with algo sha256, with and without extra keys.
+    Expected Result:
+        The hashes are those of hash_block_tokens with sha256, chained.
+    """
+    import vllm_mindspore  # noqa: F401
+    from vllm.utils import sha256
+    from vllm.v1.core.kv_cache_utils import hash_block_tokens
+    from vllm_mindspore._C_host import hash_request_blocks
+    from vllm_mindspore.v1.core.kv_cache_utils import _pickled_extra_keys
+
+    rng = np.random.default_rng(block_size)
+    for _ in range(10):
+        token_ids = rng.integers(0, 152064, rng.integers(0, 2000)).tolist()
+        start = int(rng.integers(0, len(token_ids) + 1))
+        num_blocks = (len(token_ids) - start) // block_size
+        parent = sha256("parent")
+        extra_keys = (_extra_keys(rng, num_blocks)
+                      if with_extra_keys else [None] * num_blocks)
+
+        expected, block_hash = [], parent
+        for i in range(num_blocks):
+            block_start = start + i * block_size
+            block_hash = hash_block_tokens(
+                sha256, block_hash,
+                token_ids[block_start:block_start + block_size],
+                extra_keys[i])
+            expected.append(block_hash)
+        pickled = [
+            None if keys is None else _pickled_extra_keys(keys)
+            for keys in extra_keys
+        ]
+        assert hash_request_blocks(
+            token_ids,
+            block_size,
+            parent,
+            pickled if with_extra_keys else None,
+            start=start,
+            algo="sha256") == expected
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_hash_request_blocks_fast():
+    """
+    Test Summary:
+        Hash the blocks of a prompt with algo fast in one call and in two,
+        the second chained to the last hash of the first, and with another
+        parent and other extra keys.
+    Expected Result:
+        Both ways give the same 16-byte hashes, all distinct, and any
+        change of parent or extra keys changes every hash from it on.
+    """
+    from vllm_mindspore._C_host import hash_request_blocks
+
+    block_size, parent = 16, bytes(32)
+    token_ids = np.random.default_rng(0).integers(0, 152064, 32768).tolist()
+    hashes = hash_request_blocks(token_ids, block_size, parent)
+    assert len(hashes) == len(token_ids) // block_size
+    assert all(len(block_hash) == 16 for block_hash in hashes)
+    assert len(set(hashes)) == len(hashes)
+
+    split = 100 * block_size
+    head = hash_request_blocks(token_ids[:split], block_size, parent)
+    tail = hash_request_blocks(token_ids, block_size, head[-1], start=split)
+    assert head + tail == hashes
+
+    other_parent = hash_request_blocks(token_ids, block_size, bytes(31) + b"1")
+    assert not set(other_parent) & set(hashes)
+    extra_keys = [None] * len(hashes)
+    extra_keys[10] = b"lora"
+    with_extra_keys = hash_request_blocks(token_ids, block_size, parent,
+                                          extra_keys)
+    assert with_extra_keys[:10] == hashes[:10]
+    assert not set(with_extra_keys[10:]) & set(hashes)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_request_block_hasher_compat():
+    """
+    Test Summary:
+        Hash the blocks of a request with a cache salt with the native
+        hasher in its default mode, compat, on creation and as output
+        tokens come.
+    Expected Result:
+        The block hashes are those of vLLM's block hasher with sha256.
+    """
+    import vllm_mindspore  # noqa: F401
+    from vllm import SamplingParams
+    from vllm.utils import sha256
+    from vllm.v1.core.kv_cache_utils import init_none_hash
+    from vllm.v1.request import Request
+    from vllm_mindspore.v1.core import kv_cache_utils
+
+    assert kv_cache_utils._BLOCK_HASH == "compat"
+    init_none_hash(sha256)
+    block_size = 16
+    rng = np.random.default_rng(0)
+    prompt_token_ids = rng.integers(0, 152064, 1000).tolist()
+
+    requests = [
+        Request(request_id="0",
+                prompt_token_ids=prompt_token_ids,
+                sampling_params=SamplingParams(max_tokens=64),
+                pooling_params=None,
+                eos_token_id=None,
+                cache_salt="salt",
+                block_hasher=hasher) for hasher in (
+                    kv_cache_utils.get_request_block_hasher(
+                        block_size, sha256),
+                    kv_cache_utils._vllm_get_request_block_hasher(
+                        block_size, sha256))
+    ]
+    assert requests[0].block_hashes == requests[1].block_hashes
+    for _ in range(5):
+        output_token_ids = rng.integers(0, 152064, 7).tolist()
+        for request in requests:
+            request.append_output_token_ids(output_token_ids)
+        assert requests[0].block_hashes == requests[1].block_hashes
+    assert len(requests[0].block_hashes) == (1000 + 35) // block_size
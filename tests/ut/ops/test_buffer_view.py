@@ -0,0 +1,100 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test zero-copy tensor serialization over the _C_host buffer views"""
+import gc
+import weakref
+
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_buffer_view_lifetime():
+    """
+    Test Summary:
+        A buffer view over an array, with an owner, and arrays made from it.
+    Expected Result:
+        No copy is made, the view is read-only unless asked and the
+        buffer is writable, and it keeps both the array and the owner
+        alive.
+    """
+    from vllm_mindspore._C_host import buffer_view
+
+    class Owner:
+        pass
+
+    arr = np.arange(1024, dtype=np.float32).reshape(16, 64)
+    owner = Owner()
+    owner_ref = weakref.ref(owner)
+    view = memoryview(buffer_view(arr, owner=owner))
+    assert view.readonly and view.nbytes == arr.nbytes
+    assert np.frombuffer(view, dtype=np.float32).ctypes.data == arr.ctypes.data
+    del owner, arr
+    gc.collect()
+    assert owner_ref() is not None
+    assert np.frombuffer(view, dtype=np.float32)[-1] == 1023
+    del view
+    gc.collect()
+    assert owner_ref() is None
+
+    payload = bytes(range(16))
+    assert not np.frombuffer(buffer_view(payload),
+                             dtype=np.uint8).flags.writeable
+    with pytest.raises(BufferError):
+        buffer_view(payload, writable=True)
+    decoded = np.frombuffer(buffer_view(bytearray(payload), writable=True),
+                            dtype=np.uint8)
+    assert decoded.flags.writeable
+    with pytest.raises(BufferError):
+        buffer_view(np.arange(16)[::2])
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("dtype", [ms.float32, ms.bfloat16, ms.int64])
+@pytest.mark.parametrize("shape", [(0, 8), (3, 5), (256, 1024)])
+def test_tensor_msgpack_round_trip(dtype, shape):
+    """
+    Test Summary:
+        Encode tensors inline and in backing buffers, then decode them.
+    Expected Result:
+        The decoded tensors equal the originals.
+    """
+    from vllm.v1.serial_utils import MsgpackDecoder, MsgpackEncoder
+
+    import vllm_mindspore  # noqa: F401, patches the msgpack tensor codec
+
+    tensor = ms.Tensor(
+        np.random.default_rng(0).standard_normal(shape).astype(np.float32),
+        dtype=dtype)
+    encoder = MsgpackEncoder(size_threshold=256)
+    frames = encoder.encode(tensor)
+    # the receiver gets read-only frames of its own
+    frames = [bytes(frame) for frame in frames]
+    decoded = MsgpackDecoder(ms.Tensor).decode(frames)
+
+    assert decoded.dtype == dtype and decoded.shape == tensor.shape
+    np.testing.assert_array_equal(
+        decoded.astype(ms.float32).asnumpy(),
+        tensor.astype(ms.float32).asnumpy())
+    # only tensors of at least size_threshold bytes go to backing buffers
+    assert len(frames) == (1 if tensor.nbytes < 256 else 2)
@@ -0,0 +1,184 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test eagle_prepare_inputs and advance_step_flashattn against the padded
+EAGLE drafter"""
+from types import SimpleNamespace
+
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+VOCAB_SIZE = 1000
+
+
+def _make_batch(rng, num_reqs, max_spec_len):
+    """A batch as the rejection sampler and `_prepare_inputs` leave it. Every
+    third request is a prefill chunk without draft tokens, and every other
+    of those is partial and discarded."""
+    max_gen_len = max_spec_len + 1
+    sampled_token_ids = np.full((num_reqs, max_gen_len), -1, dtype=np.int32)
+    num_draft_tokens = np.zeros(num_reqs, dtype=np.int32)
+    query_lens = np.zeros(num_reqs, dtype=np.int32)
+    discard_mask = np.zeros(num_reqs, dtype=np.bool_)
+    for i in range(num_reqs):
+        prefill = i % 3 == 0
+        discard_mask[i] = prefill and i % 2 == 0
+        num_draft_tokens[i] = 0 if prefill else rng.integers(
+            0, max_spec_len + 1)
+        num_sampled = 0 if discard_mask[i] else rng.integers(
+            1, num_draft_tokens[i] + 2)
+        sampled_token_ids[i, :num_sampled] = rng.integers(
+            0, VOCAB_SIZE, num_sampled)
+        query_lens[i] = rng.integers(1, 300) if prefill else (
+            num_draft_tokens[i] + 1)
+    query_start_loc = np.zeros(num_reqs + 1, dtype=np.int32)
+    np.cumsum(query_lens, out=query_start_loc[1:])
+    backup_next_token_ids = rng.integers(0, VOCAB_SIZE, num_reqs,
+                                         dtype=np.int32)
+    return (sampled_token_ids, np.cumsum(num_draft_tokens, dtype=np.int32),
+            discard_mask, backup_next_token_ids, query_start_loc)
+
+
+def _reference(sampled_token_ids, cu_num_draft_tokens, discard_mask,
+               backup_next_token_ids, query_start_loc):
+    """`prepare_next_token_ids_padded` and the `token_indices_to_sample` of
+    `prepare_inputs_padded` in eagle.py, in numpy."""
+    valid = (sampled_token_ids != -1) & (sampled_token_ids < VOCAB_SIZE)
+    valid[discard_mask] = False
+    count = valid.sum(axis=1).astype(np.int32)
+    last = sampled_token_ids[np.arange(len(count)), np.maximum(count - 1, 0)]
+    next_token_ids = np.where(count > 0, last, backup_next_token_ids)
+    num_draft_tokens = np.diff(cu_num_draft_tokens, prepend=0)
+    num_rejected = np.where(num_draft_tokens > 0,
+                            num_draft_tokens + 1 - count, 0)
+    token_indices_to_sample = query_start_loc[1:] - 1 - num_rejected
+    return next_token_ids, count, token_indices_to_sample
+
+
+def _native(sampled_token_ids, cu_num_draft_tokens, discard_mask,
+            backup_next_token_ids, query_start_loc):
+    from vllm_mindspore._custom_ops import eagle_prepare_inputs
+
+    num_reqs = sampled_token_ids.shape[0]
+    outputs = [
+        ms.Tensor(np.full(num_reqs, 7, dtype=np.int32)) for _ in range(3)
+    ]
+    eagle_prepare_inputs(*outputs, ms.Tensor(sampled_token_ids),
+                         ms.Tensor(cu_num_draft_tokens),
+                         ms.Tensor(discard_mask),
+                         ms.Tensor(backup_next_token_ids),
+                         ms.Tensor(query_start_loc), VOCAB_SIZE)
+    return [out.asnumpy() for out in outputs]
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("num_reqs", [1, 37, 1000])
+@pytest.mark.parametrize("max_spec_len", [0, 1, 4])
+def test_eagle_prepare_inputs(num_reqs, max_spec_len):
+    """
+    Test Summary:
+        Decode requests with any number of accepted draft tokens, and
+        prefill chunks, some of them discarded, in one batch.
+    Expected Result:
+        The custom op gives the next token ids, valid token counts and
+        indices to sample of the Python drafter.
+    """
+    rng = np.random.default_rng(num_reqs * 10 + max_spec_len)
+    batch = _make_batch(rng, num_reqs, max_spec_len)
+    for out, expected in zip(_native(*batch), _reference(*batch)):
+        np.testing.assert_array_equal(out, expected)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_eagle_prepare_inputs_discarded_without_drafts():
+    """
+    Test Summary:
+        A step without draft tokens, one sampled token per request, with a
+        discarded partial prefill and a token id past the vocabulary.
+    Expected Result:
+        Requests without a valid token count 0 and take the backup token,
+        and the last token of every request is sampled.
+    """
+    sampled_token_ids = np.array([[5], [-1], [VOCAB_SIZE + 3]], dtype=np.int32)
+    cu_num_draft_tokens = np.zeros(3, dtype=np.int32)
+    discard_mask = np.array([False, True, False])
+    backup_next_token_ids = np.array([10, 11, 12], dtype=np.int32)
+    query_start_loc = np.array([0, 1, 9, 10], dtype=np.int32)
+    next_token_ids, count, token_indices_to_sample = _native(
+        sampled_token_ids, cu_num_draft_tokens, discard_mask,
+        backup_next_token_ids, query_start_loc)
+    np.testing.assert_array_equal(next_token_ids, [5, 11, 12])
+    np.testing.assert_array_equal(count, [1, 0, 0])
+    np.testing.assert_array_equal(token_indices_to_sample, [0, 8, 9])
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("query_lens", [[3] * 37, [1] * 5, [3, 1, 3]])
+def test_eagle_draft_slot_mapping(query_lens):
+    """
+    Test Summary:
+        The slot mapping of the padded draft inputs, for decode batches with
+        the same number of draft tokens per request, and a mixed batch.
+    Expected Result:
+        Uniform batches get the slots on device from advance_step_flashattn,
+        the mixed one keeps the host slots, and both match the slots of the
+        target step.
+    """
+    from vllm_mindspore.v1.spec_decode.eagle import (
+        _advance_draft_slot_mapping)
+
+    block_size, max_blocks_per_seq = 16, 8
+    rng = np.random.default_rng(len(query_lens))
+    query_lens = np.array(query_lens, dtype=np.int32)
+    num_reqs = len(query_lens)
+    num_computed = rng.integers(0,
+                                block_size * max_blocks_per_seq -
+                                query_lens.max(),
+                                num_reqs,
+                                dtype=np.int32)
+    block_tables = rng.integers(0, 4096, (num_reqs, max_blocks_per_seq),
+                                dtype=np.int32)
+    positions = np.concatenate([
+        np.arange(start, start + query_len)
+        for start, query_len in zip(num_computed, query_lens)
+    ])
+    rows = np.repeat(np.arange(num_reqs), query_lens)
+    expected = (block_tables[rows, positions // block_size] * block_size +
+                positions % block_size)
+
+    total_num_tokens = int(query_lens.sum())
+    drafter = SimpleNamespace(block_size=block_size,
+                              token_arange_np=np.arange(total_num_tokens))
+    metadata = SimpleNamespace(num_reqs=num_reqs,
+                               num_computed_tokens_np=num_computed,
+                               block_table_tensor=ms.Tensor(block_tables),
+                               slot_mapping_np=expected.astype(np.int64))
+    slot_mapping, slot_mapping_np = _advance_draft_slot_mapping(
+        drafter, metadata, query_lens, total_num_tokens)
+    if (query_lens == query_lens[0]).all():
+        assert slot_mapping_np is None
+        np.testing.assert_array_equal(slot_mapping.asnumpy(), expected)
+    else:
+        assert slot_mapping is None
+        np.testing.assert_array_equal(slot_mapping_np, expected)
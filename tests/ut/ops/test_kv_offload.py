@@ -0,0 +1,286 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the host block pool, the host tier of the KV cache and the
+scheduler side of the host offloading connector"""
+from types import SimpleNamespace
+
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("copy_threads", [0, 3])
+def test_host_block_pool(copy_threads):
+    """
+    Test Summary:
+        Allocate and free blocks of a pool of small slabs under random churn,
+        writing the key and value parts of the blocks allocated, then read
+        them back, on the shared host threads and on threads of the pool's
+        own; free a block twice and allocate more than is free.
+    Expected Result:
+        Every block read holds what was written to it, the free count
+        follows the allocations, and the bad calls, copies of blocks not
+        allocated included, raise without changing the pool.
+    """
+    from vllm_mindspore._C_host import HostBlockPool
+
+    num_blocks, part_shape = 64, (16, 2, 24)
+    part_bytes = int(np.prod(part_shape)) * 2
+    pool = HostBlockPool(num_blocks,
+                         2 * part_bytes,
+                         blocks_per_slab=5,
+                         copy_threads=copy_threads)
+    assert (pool.num_blocks, pool.block_bytes) == (num_blocks, 2 * part_bytes)
+    assert pool.mapped_bytes == 0
+
+    rng = np.random.default_rng(0)
+    blocks: dict[int, tuple[np.ndarray, np.ndarray]] = {}
+    for _ in range(50):
+        if blocks and rng.random() < 0.4:
+            freed = rng.choice(list(blocks),
+                               int(rng.integers(1, len(blocks) + 1)),
+                               replace=False).tolist()
+            pool.free(freed)
+            for block_id in freed:
+                del blocks[block_id]
+        else:
+            ids = pool.allocate(int(rng.integers(0, pool.num_free + 1)))
+            keys = rng.standard_normal((len(ids), *part_shape)).astype(
+                np.float16)
+            values = rng.standard_normal(keys.shape).astype(np.float16)
+            pool.write(ids, keys)
+            pool.write(ids, values, offset=part_bytes)
+            blocks.update(zip(ids, zip(keys, values)))
+        assert pool.num_free == num_blocks - len(blocks)
+
+    ids = list(blocks)
+    keys = np.empty((len(ids), *part_shape), dtype=np.float16)
+    values = np.empty_like(keys)
+    pool.read(ids, keys)
+    pool.read(ids, values, offset=part_bytes, num_threads=1)
+    for i, block_id in enumerate(ids):
+        assert np.array_equal(keys[i], blocks[block_id][0])
+        assert np.array_equal(values[i], blocks[block_id][1])
+
+    free_ids = pool.allocate(pool.num_free)
+    with pytest.raises(MemoryError):
+        pool.allocate(1)
+    pool.free(free_ids)
+    with pytest.raises(ValueError):
+        pool.free([free_ids[0]])
+    with pytest.raises(ValueError):
+        pool.write(ids[:1], keys[:1], offset=part_bytes + 2)
+    assert pool.num_free == len(free_ids)
+
+    # freed blocks are not copied, until claimed as another pool hands
+    # them out
+    pool.free(ids[:1])
+    with pytest.raises(ValueError):
+        pool.read(ids[:1], keys[:1])
+    pool.claim(ids[:1])
+    pool.read(ids[:1], keys[:1])
+    with pytest.raises(ValueError):
+        pool.claim([free_ids[0], ids[1]])
+    assert free_ids[0] in pool.allocate(pool.num_free)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_host_kv_cache_tier():
+    """
+    Test Summary:
+        Store the blocks of prefixes into a tier of 8 blocks, look them up
+        before and after the stores complete, load some and store more than
+        fit while the loads are in flight.
+    Expected Result:
+        Blocks are found only once stored, from the first block on; the
+        least recently used blocks no load holds are evicted first, and a
+        store stops at the first block that does not fit.
+    """
+    from vllm_mindspore.v1.core.kv_offload import HostKVCacheTier
+
+    tier = HostKVCacheTier(8)
+    prefix = [b"a%d" % i for i in range(4)]
+    indices, host_ids = tier.prepare_store(prefix)
+    assert indices == [0, 1, 2, 3] and len(set(host_ids)) == 4
+    assert tier.lookup(prefix) == 0
+    tier.complete_store(prefix)
+    assert tier.lookup(prefix) == 4
+    assert tier.lookup(prefix[1:]) == 3
+    assert tier.lookup([b"x"] + prefix) == 0
+
+    # stored blocks are skipped
+    other = prefix[:2] + [b"b%d" % i for i in range(2)]
+    indices, _ = tier.prepare_store(other)
+    assert indices == [2, 3]
+    tier.complete_store([other[i] for i in indices])
+    assert tier.num_free_blocks == 2
+
+    # b0 and b1 were used least recently, a2 and a3 are held by a load
+    assert tier.prepare_load(prefix) == host_ids
+    tier.complete_load(prefix[:2])
+    new = [b"c%d" % i for i in range(8)]
+    indices, _ = tier.prepare_store(new)
+    assert indices == [0, 1, 2, 3, 4, 5]
+    assert tier.num_evicted == 4
+    evicted_ids = tier.pop_evicted()
+    assert len(evicted_ids) == 4 and set(host_ids[:2]) <= set(evicted_ids)
+    assert tier.pop_evicted() == []
+    assert tier.lookup(other) == 0
+    assert tier.lookup(prefix[2:]) == 2
+    assert tier.num_free_blocks == 0
+
+    # blocks being stored are not evicted either
+    assert tier.prepare_store([b"d"]) == ([], [])
+    tier.complete_load(prefix[2:])
+    tier.complete_store(new[:6])
+    indices, _ = tier.prepare_store([b"d"])
+    assert indices == [0]
+    assert tier.lookup(prefix[2:]) == 0
+    assert tier.lookup(new) == 6
+
+
+def _scheduler_output(new_reqs=(), cached=(), num_scheduled_tokens=None):
+    """A SchedulerOutput of new requests (req_id, block_ids,
+    num_computed_tokens) and cached ones (req_id, resumed, new_block_ids,
+    num_computed_tokens)."""
+    return SimpleNamespace(
+        scheduled_new_reqs=[
+            SimpleNamespace(req_id=req_id,
+                            block_ids=(block_ids, ),
+                            num_computed_tokens=num_computed_tokens)
+            for req_id, block_ids, num_computed_tokens in new_reqs
+        ],
+        scheduled_cached_reqs=SimpleNamespace(
+            req_ids=[c[0] for c in cached],
+            resumed_from_preemption=[c[1] for c in cached],
+            new_block_ids=[None if c[2] is None else (c[2], ) for c in cached],
+            num_computed_tokens=[c[3] for c in cached]),
+        num_scheduled_tokens=num_scheduled_tokens or {},
+        scheduled_spec_decode_tokens={})
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_host_offloading_connector_scheduler():
+    """
+    Test Summary:
+        Run the scheduler side of the host offloading connector, with a
+        host tier of 5 blocks, through the steps of two requests of blocks
+        of 4 tokens: both are scheduled, the first is preempted, resumes
+        with its first block still cached on the device, and both finish.
+    Expected Result:
+        Only the preempted request stores its full blocks, in the step it is
+        preempted in; once the store is done the blocks after the device
+        hit are matched and loaded into the same block positions of the
+        new device blocks; a finished request stores the blocks not yet in
+        the host tier, and the host blocks evicted for them are freed on
+        the worker.
+    """
+    from vllm.distributed.kv_transfer.kv_connector.v1.base import (
+        KVConnectorRole)
+    from vllm.v1.request import RequestStatus
+
+    from vllm_mindspore.distributed.kv_transfer.host_offloading_connector \
+        import MsHostOffloadingConnector
+
+    vllm_config = SimpleNamespace(
+        kv_transfer_config=SimpleNamespace(
+            kv_connector_extra_config={"num_host_blocks": 5}),
+        cache_config=SimpleNamespace(block_size=4))
+    connector = MsHostOffloadingConnector(vllm_config,
+                                          KVConnectorRole.SCHEDULER)
+    no_blocks = SimpleNamespace(get_block_ids=lambda: ([], ))
+    req_a = SimpleNamespace(request_id="a",
+                            num_tokens=17,
+                            num_computed_tokens=0,
+                            block_hashes=[b"a%d" % i for i in range(4)],
+                            status=RequestStatus.RUNNING)
+    req_b = SimpleNamespace(request_id="b",
+                            num_tokens=10,
+                            num_computed_tokens=0,
+                            block_hashes=[b"b%d" % i for i in range(2)],
+                            status=RequestStatus.RUNNING)
+    for req in (req_a, req_b):
+        assert connector.get_num_new_matched_tokens(req, 0) == (0, False)
+        connector.update_state_after_alloc(req, no_blocks, 0)
+    meta = connector.build_connector_meta(
+        _scheduler_output(new_reqs=[("a", [10, 11, 12, 13, 14], 0),
+                                    ("b", [15, 16, 17], 0)],
+                          num_scheduled_tokens={
+                              "a": 17,
+                              "b": 8
+                          }))
+    assert meta.store_device_ids == [] and meta.load_device_ids == []
+
+    # a is preempted after its prefill, b runs on
+    req_a.status = RequestStatus.PREEMPTED
+    meta = connector.build_connector_meta(
+        _scheduler_output(cached=[("b", False, None, 8)],
+                          num_scheduled_tokens={"b": 1}))
+    assert meta.store_device_ids == [10, 11, 12, 13]
+    assert len(set(meta.store_host_ids)) == 4
+    assert meta.free_host_ids == []
+    assert meta.load_device_ids == []
+    a_host_ids = meta.store_host_ids
+
+    # not matched before the store is done, in the next step
+    req_a.status = RequestStatus.WAITING
+    assert connector.get_num_new_matched_tokens(req_a, 4) == (0, False)
+    connector.update_state_after_alloc(req_a, no_blocks, 0)
+    meta = connector.build_connector_meta(
+        _scheduler_output(cached=[("b", False, None, 9)],
+                          num_scheduled_tokens={"b": 1}))
+    assert meta.store_device_ids == [] and meta.load_device_ids == []
+
+    # the first block is still cached on the device, the last token is
+    # computed: blocks 1 to 3 are loaded
+    assert connector.get_num_new_matched_tokens(req_a, 4) == (12, False)
+    connector.update_state_after_alloc(
+        req_a, SimpleNamespace(get_block_ids=lambda: ([20, 21, 22, 23,
+                                                       24], )), 12)
+    req_a.status = RequestStatus.RUNNING
+    meta = connector.build_connector_meta(
+        _scheduler_output(cached=[("a", True, [20, 21, 22, 23, 24], 16),
+                                  ("b", False, [18], 10)],
+                          num_scheduled_tokens={
+                              "a": 1,
+                              "b": 1
+                          }))
+    assert meta.load_device_ids == [21, 22, 23]
+    assert meta.load_host_ids == a_host_ids[1:]
+    assert meta.store_device_ids == []
+
+    # the blocks of a are stored already, those of b are not
+    req_a.num_computed_tokens, req_b.num_computed_tokens = 17, 11
+    req_a.status = req_b.status = RequestStatus.FINISHED_STOPPED
+    assert connector.request_finished(req_a,
+                                      [20, 21, 22, 23, 24]) == (False, None)
+    assert connector.request_finished(req_b, [15, 16, 17,
+                                              18]) == (False, None)
+    meta = connector.build_connector_meta(_scheduler_output())
+    assert meta.store_device_ids == [15, 16]
+    assert meta.load_device_ids == []
+    # the first block of a, the only one no load holds, made room for b
+    assert meta.free_host_ids == a_host_ids[:1]
+    connector.build_connector_meta(_scheduler_output())
+    assert connector.tier.lookup(req_b.block_hashes) == 2
@@ -0,0 +1,135 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the host arena the multimodal inputs are collated from"""
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_mm_arena():
+    """
+    Test Summary:
+        Place buffers of random size and alignment in a small arena under
+        random churn, dropping the slots of some; gather ranges of the
+        slots alive, then place more than is free and gather a range that
+        is not placed.
+    Expected Result:
+        Every slot holds what was placed at its alignment, the used bytes
+        follow the slots alive, the whole arena is free again once they are
+        gone, and the bad calls raise.
+    """
+    from vllm_mindspore._C_host import MmArena
+
+    arena = MmArena(1 << 16)
+    rng = np.random.default_rng(0)
+    slots: dict[int, tuple[object, np.ndarray]] = {}
+    for i in range(2000):
+        if slots and rng.random() < 0.5:
+            del slots[int(rng.choice(list(slots)))]
+            continue
+        data = rng.integers(0, 256, int(rng.integers(1, 3000)), dtype=np.uint8)
+        align = int(rng.choice([1, 4, 64]))
+        try:
+            slot = arena.place(data, align=align)
+        except MemoryError:
+            continue
+        assert slot.offset % align == 0 and slot.nbytes == data.nbytes
+        slots[i] = (slot, data)
+        del slot
+        assert arena.used_bytes == sum(s.nbytes for s, _ in slots.values())
+
+    for slot, data in slots.values():
+        assert np.array_equal(np.frombuffer(slot, dtype=np.uint8), data)
+    placed = list(slots.values())[::-1]
+    out = np.empty(sum(s.nbytes for s, _ in placed), dtype=np.uint8)
+    arena.gather([s.offset for s, _ in placed], [s.nbytes for s, _ in placed],
+                 out,
+                 num_threads=2)
+    assert np.array_equal(out, np.concatenate([data for _, data in placed]))
+
+    slot, data = placed[0]
+    with pytest.raises(ValueError):
+        arena.gather([slot.offset + 1], [slot.nbytes], np.empty(slot.nbytes))
+    with pytest.raises(MemoryError):
+        arena.place(np.zeros(1 << 16, dtype=np.uint8))
+    del slot, placed
+    slots.clear()
+    assert arena.used_bytes == 0
+    assert arena.place(np.zeros(1 << 16, dtype=np.uint8)).offset == 0
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_mm_arena_collate():
+    """
+    Test Summary:
+        Place the pixel patches of four images in the arena, then
+        concatenate and stack them in the order they were placed in, in
+        another order, and with a tensor not in the arena.
+    Expected Result:
+        The images placed back to back collate to a view of the arena, which
+        keeps their ranges allocated until it is released, the others to a
+        gathered copy, both equal to numpy concatenation and stacking; a
+        tensor outside the arena is not collated.
+    """
+    import mindspore as ms
+
+    from vllm_mindspore.multimodal.arena import MultiModalArena
+
+    arena = MultiModalArena(1 << 24)
+    rng = np.random.default_rng(0)
+    images = [
+        rng.standard_normal((rows, 1176), dtype=np.float32)
+        for rows in (64, 256, 100, 64)
+    ]
+    placed = [arena.place(ms.from_numpy(image)) for image in images]
+    assert all(
+        arena.offset_of(t.numpy()) is not None and np.array_equal(
+            t.numpy(), image) for t, image in zip(placed, images))
+    assert arena.place(placed[0]) is placed[0]
+
+    copied = arena.arena.bytes_copied
+    batch = arena.collate(placed, stack=False)
+    assert arena.arena.bytes_copied == copied
+    assert arena.offset_of(batch.numpy()) == arena.offset_of(
+        placed[0].numpy())
+    np.testing.assert_array_equal(batch.numpy(), np.concatenate(images))
+
+    batch = arena.collate(placed[::-1], stack=False)
+    assert arena.arena.bytes_copied == copied + batch.numpy().nbytes
+    np.testing.assert_array_equal(batch.numpy(),
+                                  np.concatenate(images[::-1]))
+
+    same_shape = [placed[0], placed[3]]
+    np.testing.assert_array_equal(
+        arena.collate(same_shape, stack=True).numpy(),
+        np.stack([images[0], images[3]]))
+    assert arena.collate([placed[0], ms.from_numpy(images[3])],
+                         stack=True) is None
+
+    # the view holds the ranges of the images once the requests drop them
+    batch = arena.collate(placed, stack=False)
+    used = arena.arena.used_bytes
+    del placed, same_shape
+    assert arena.arena.used_bytes == used
+    np.testing.assert_array_equal(batch.numpy(), np.concatenate(images))
+    del batch
+    assert arena.arena.used_bytes == 0
@@ -0,0 +1,111 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native mrope positions against the python version"""
+from types import SimpleNamespace
+
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+IMAGE_TOKEN_ID, VIDEO_TOKEN_ID = 151655, 151656
+VISION_START_TOKEN_ID, VISION_END_TOKEN_ID = 151652, 151653
+SPATIAL_MERGE_SIZE = 2
+
+
+def _prompt(rng, num_images, num_videos, per_frame_videos):
+    """A prompt of text and vision items in random order, with the grids
+    and second_per_grid_ts of its images and videos."""
+    tokens: list[int] = []
+    image_grid_thw, video_grid_thw, second_per_grid_ts = [], [], []
+    items = ["image"] * num_images + ["video"] * num_videos
+    rng.shuffle(items)
+    for item in items:
+        tokens += rng.integers(0, 1000, rng.integers(0, 300)).tolist()
+        t = int(rng.integers(1, 3 if item == "image" else 6))
+        h, w = (int(rng.integers(1, 20)) * SPATIAL_MERGE_SIZE,
+                int(rng.integers(1, 20)) * SPATIAL_MERGE_SIZE)
+        frame_len = h * w // SPATIAL_MERGE_SIZE**2
+        if item == "image":
+            tokens += ([VISION_START_TOKEN_ID] +
+                       [IMAGE_TOKEN_ID] * t * frame_len +
+                       [VISION_END_TOKEN_ID])
+            image_grid_thw.append([t, h, w])
+            continue
+        # Qwen3-VL puts a timestamp and vision start before every frame
+        for frames in ([1] * t if per_frame_videos else [t]):
+            if per_frame_videos:
+                tokens += rng.integers(0, 1000, 3).tolist()
+            tokens += ([VISION_START_TOKEN_ID] +
+                       [VIDEO_TOKEN_ID] * frames * frame_len +
+                       [VISION_END_TOKEN_ID])
+        video_grid_thw.append([t, h, w])
+        second_per_grid_ts.append(float(rng.choice([0.5, 1.0, 2.0, 0.7])))
+    tokens += rng.integers(0, 1000, rng.integers(1, 50)).tolist()
+    return tokens, image_grid_thw, video_grid_thw, second_per_grid_ts
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("model_type", ["qwen2_5_vl", "qwen3_vl"])
+@pytest.mark.parametrize("num_images,num_videos", [(0, 0), (1, 0), (6, 2),
+                                                   (0, 3)])
+def test_mrope_positions(monkeypatch, model_type, num_images, num_videos):
+    """
+    Test Summary:
+        Compute the mrope positions of prompts of text, images and videos
+        with the native builder and with the python version, for the whole
+        prompt and for chunks of it.
+    Expected Result:
+        The positions and mrope_position_delta are the same.
+    """
+    from vllm_mindspore.model_executor.layers import rotary_embedding
+    from vllm_mindspore.model_executor.layers.rotary_embedding import (
+        MRotaryEmbedding)
+
+    assert rotary_embedding._native_mrope_positions is not None
+    hf_config = SimpleNamespace(
+        model_type=model_type,
+        image_token_id=IMAGE_TOKEN_ID,
+        video_token_id=VIDEO_TOKEN_ID,
+        vision_start_token_id=VISION_START_TOKEN_ID,
+        vision_config=SimpleNamespace(spatial_merge_size=SPATIAL_MERGE_SIZE,
+                                      tokens_per_second=2))
+    get_positions = (MRotaryEmbedding._qwen3_vl_get_input_positions_tensor
+                     if model_type == "qwen3_vl" else
+                     MRotaryEmbedding._vl_get_input_positions_tensor)
+
+    rng = np.random.default_rng(num_images * 10 + num_videos)
+    tokens, image_grid_thw, video_grid_thw, second_per_grid_ts = _prompt(
+        rng, num_images, num_videos, model_type == "qwen3_vl")
+    chunk = len(tokens) // 3
+    for context_len, seq_len in [(0, None), (chunk, 2 * chunk),
+                                 (2 * chunk, len(tokens))]:
+        kwargs = dict(input_tokens=tokens,
+                      hf_config=hf_config,
+                      image_grid_thw=image_grid_thw,
+                      video_grid_thw=video_grid_thw,
+                      second_per_grid_ts=second_per_grid_ts,
+                      context_len=context_len,
+                      seq_len=seq_len)
+        positions, delta = get_positions(**kwargs)
+        with monkeypatch.context() as m:
+            m.setattr(rotary_embedding, "_native_mrope_positions", None)
+            expected_positions, expected_delta = get_positions(**kwargs)
+        assert delta == expected_delta
+        np.testing.assert_array_equal(positions.asnumpy(),
+                                      expected_positions.asnumpy())
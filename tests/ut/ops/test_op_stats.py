@@ -0,0 +1,111 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the per-op counters of the custom ops"""
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _advance_step(num_seqs, idx_dtype):
+    from vllm_mindspore._custom_ops import advance_step_flashattn
+
+    block_size, max_blocks_per_seq = 16, 8
+    advance_step_flashattn(
+        num_seqs=num_seqs,
+        num_queries=num_seqs,
+        block_size=block_size,
+        input_tokens=ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype)),
+        sampled_token_ids=ms.Tensor(np.ones((num_seqs, 1), dtype=idx_dtype)),
+        input_positions=ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype)),
+        seq_lens=ms.Tensor(np.full(num_seqs, 5, dtype=np.int32)),
+        slot_mapping=ms.Tensor(np.zeros(num_seqs, dtype=idx_dtype)),
+        block_tables=ms.Tensor(
+            np.zeros((num_seqs, max_blocks_per_seq), dtype=np.int32)))
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("kernel_timing", [False, True])
+def test_op_stats(kernel_timing):
+    """
+    Test Summary:
+        Count advance_step_flashattn calls with the op stats on and off,
+        with int32 index tensors and int16 ones, which DtypeCaster casts.
+    Expected Result:
+        Only calls made while enabled are counted, with their bytes and
+        casts, kernel times only with kernel_timing, and reset zeroes them.
+    """
+    from vllm_mindspore._custom_ops import (get_op_stats, reset_op_stats,
+                                            set_op_stats_enabled)
+
+    num_seqs = 64
+    reset_op_stats()
+    _advance_step(num_seqs, np.int32)
+    assert "advance_step_flashattn" not in get_op_stats()
+
+    assert set_op_stats_enabled(True, kernel_timing=kernel_timing)
+    try:
+        for _ in range(3):
+            _advance_step(num_seqs, np.int32)
+        _advance_step(num_seqs, np.int16)
+        ms.runtime.synchronize()
+    finally:
+        set_op_stats_enabled(False)
+    _advance_step(num_seqs, np.int32)
+
+    stats = get_op_stats()["advance_step_flashattn"]
+    assert stats["calls"] == 4
+    assert sum(stats["host_hist"]) == 4
+    assert 0 < stats["host_p50_us"] <= stats["host_p99_us"]
+    assert stats["host_us"] > 0
+    # sampled_token_ids, seq_lens and block_tables in; input_tokens,
+    # input_positions, seq_lens and slot_mapping out
+    assert stats["bytes_in"] == 4 * num_seqs * (4 + 4 + 8 * 4)
+    assert stats["bytes_out"] == 4 * num_seqs * 4 * 4
+    # int16 sampled_token_ids, input_tokens, input_positions, slot_mapping
+    # cast in, and the three outputs cast back
+    assert stats["casts"] == 7
+    assert stats["cast_us"] > 0
+    assert stats["kernel_calls"] == (4 if kernel_timing else 0)
+
+    reset_op_stats()
+    assert "advance_step_flashattn" not in get_op_stats()
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_op_stats_without_custom_ops(monkeypatch):
+    """
+    Test Summary:
+        Use the op stats over the dummy module of a build without
+        BUILD_CUSTOM, which imports but exports no op.
+    Expected Result:
+        Enabling reports that nothing counts, the stats are empty and
+        reset does nothing, none of them raise.
+    """
+    import types
+
+    from vllm_mindspore import _custom_ops
+
+    monkeypatch.setattr(_custom_ops, "_c_ops",
+                        lambda: types.ModuleType("_C_ops"))
+    assert not _custom_ops.set_op_stats_enabled(True, kernel_timing=True)
+    assert _custom_ops.get_op_stats() == {}
+    _custom_ops.reset_op_stats()
@@ -0,0 +1,120 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native batch assembly of _prepare_inputs against numpy"""
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _prepare_inputs_golden(num_scheduled_tokens, num_computed_tokens,
+                           token_ids, block_tables, block_sizes):
+    num_reqs = num_scheduled_tokens.shape[0]
+    req_indices = np.repeat(np.arange(num_reqs), num_scheduled_tokens)
+    cu_num_tokens = np.cumsum(num_scheduled_tokens)
+    arange = np.arange(cu_num_tokens[-1]) - np.repeat(
+        cu_num_tokens - num_scheduled_tokens, num_scheduled_tokens)
+    positions = num_computed_tokens[req_indices] + arange
+    input_ids = token_ids[req_indices, positions]
+    slot_mappings = [
+        block_table[req_indices, positions // block_size] * block_size +
+        positions % block_size
+        for block_table, block_size in zip(block_tables, block_sizes)
+    ]
+    return (input_ids, positions, np.concatenate([[0], cu_num_tokens]),
+            num_computed_tokens + num_scheduled_tokens, slot_mappings)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("num_reqs", [1, 7, 512])
+@pytest.mark.parametrize("num_threads", [1, 0])
+def test_prepare_inputs(num_reqs, num_threads):
+    """
+    Test Summary:
+        Decode requests and chunked prefills, with two KV cache groups of
+        different block sizes, assembled into buffers larger than the batch.
+    Expected Result:
+        The buffers hold the numpy results, query_start_loc is padded with
+        the number of tokens and nothing past the batch is written.
+    """
+    from vllm_mindspore._C_host import prepare_inputs
+
+    rng = np.random.default_rng(num_reqs)
+    max_num_reqs, max_model_len, block_sizes = num_reqs + 4, 2048, [16, 128]
+    num_scheduled_tokens = np.where(
+        rng.random(num_reqs) < 0.3, rng.integers(1, 300, num_reqs),
+        1).astype(np.int32)
+    num_computed_tokens = np.zeros(max_num_reqs, dtype=np.int32)
+    num_computed_tokens[:num_reqs] = rng.integers(
+        0, max_model_len - num_scheduled_tokens)
+    token_ids = rng.integers(0, 152064, (max_num_reqs, max_model_len),
+                             dtype=np.int32)
+    block_tables = [
+        rng.integers(0, 1 << 16, (max_num_reqs, max_model_len // block_size),
+                     dtype=np.int32) for block_size in block_sizes
+    ]
+    max_num_tokens = int(num_scheduled_tokens.sum()) + 8
+    input_ids = np.full(max_num_tokens, -1, dtype=np.int32)
+    positions = np.full(max_num_tokens, -1, dtype=np.int64)
+    query_start_loc = np.full(max_num_reqs + 1, -1, dtype=np.int32)
+    seq_lens = np.full(max_num_reqs, -1, dtype=np.int32)
+    slot_mappings = [
+        np.full(max_num_tokens, -1, dtype=np.int64) for _ in block_sizes
+    ]
+
+    max_num_scheduled_tokens = prepare_inputs(num_scheduled_tokens,
+                                              num_computed_tokens,
+                                              token_ids,
+                                              input_ids,
+                                              positions,
+                                              query_start_loc,
+                                              seq_lens,
+                                              block_tables,
+                                              slot_mappings,
+                                              block_sizes,
+                                              num_threads=num_threads)
+
+    golden = _prepare_inputs_golden(num_scheduled_tokens,
+                                    num_computed_tokens[:num_reqs],
+                                    token_ids, block_tables, block_sizes)
+    num_tokens = golden[0].shape[0]
+    assert max_num_scheduled_tokens == num_scheduled_tokens.max()
+    np.testing.assert_array_equal(input_ids[:num_tokens], golden[0])
+    np.testing.assert_array_equal(positions[:num_tokens], golden[1])
+    np.testing.assert_array_equal(query_start_loc[:num_reqs + 1], golden[2])
+    np.testing.assert_array_equal(seq_lens[:num_reqs], golden[3])
+    for slot_mapping, golden_slot_mapping in zip(slot_mappings, golden[4]):
+        np.testing.assert_array_equal(slot_mapping[:num_tokens],
+                                      golden_slot_mapping)
+        assert (slot_mapping[num_tokens:] == -1).all()
+    assert (query_start_loc[num_reqs + 1:] == num_tokens).all()
+    assert (input_ids[num_tokens:] == -1).all()
+    assert (seq_lens[num_reqs:] == -1).all()
+
+    # a request past the end of its block table
+    num_computed_tokens[0] = max_model_len - num_scheduled_tokens[0] + 1
+    with pytest.raises(ValueError):
+        prepare_inputs(num_scheduled_tokens, num_computed_tokens, token_ids,
+                       input_ids, positions, query_start_loc, seq_lens,
+                       block_tables, slot_mappings, block_sizes)
+    # positions of the wrong dtype
+    with pytest.raises(TypeError):
+        prepare_inputs(num_scheduled_tokens, num_computed_tokens, token_ids,
+                       input_ids, positions.astype(np.int32),
+                       query_start_loc, seq_lens, block_tables, slot_mappings,
+                       block_sizes)
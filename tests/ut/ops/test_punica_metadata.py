@@ -0,0 +1,186 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native Punica metadata and the reference SGMV"""
+from types import SimpleNamespace
+
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _convert_mapping(index_mapping, prompt_mapping, lora_index_to_id,
+                     max_loras, vocab_size, extra_vocab_size):
+    """vLLM's convert_mapping and compute_meta, in numpy."""
+    lora_indices = np.array([
+        lora_index_to_id.index(x) if x > 0 else -1 for x in index_mapping
+    ],
+                            dtype=np.int64)
+    embedding_indices = np.maximum(lora_indices, 0)
+    embeddings_indices = np.stack([
+        embedding_indices * extra_vocab_size,
+        embedding_indices * (vocab_size + extra_vocab_size)
+    ])
+    sampler_indices = np.array([
+        lora_index_to_id.index(x) if x > 0 else -1 for x in prompt_mapping
+    ],
+                               dtype=np.int64)
+    sampler_indices_padded = np.where(sampler_indices == -1, max_loras - 1,
+                                      sampler_indices)
+    sampler_indices_padded = (np.arange(len(sampler_indices)) +
+                              sampler_indices_padded * len(sampler_indices))
+    run_starts = np.flatnonzero(
+        np.diff(lora_indices, prepend=lora_indices[:1] - 1))
+    seq_lengths = np.diff(run_starts, append=len(lora_indices))
+    return (lora_indices, embeddings_indices, sampler_indices,
+            sampler_indices_padded, run_starts, seq_lengths,
+            lora_indices[run_starts])
+
+
+def _random_mapping(rng, num_slots, num_reqs):
+    lora_index_to_id = [None] * num_slots
+    lora_ids = rng.choice(np.arange(1, 100), num_slots - 1, replace=False)
+    for slot, lora_id in zip(rng.permutation(num_slots), lora_ids):
+        lora_index_to_id[slot] = int(lora_id)
+    req_lora_ids = rng.choice([0] + lora_ids.tolist(), num_reqs).astype(
+        np.int32)
+    num_scheduled_tokens = rng.integers(1, 64, num_reqs)
+    # as the LoRA mixin of the model runner builds it
+    return SimpleNamespace(
+        index_mapping=tuple(req_lora_ids.repeat(num_scheduled_tokens)),
+        prompt_mapping=tuple(req_lora_ids),
+        is_prefill=True), lora_index_to_id
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("num_slots", [1, 4, 64])
+def test_build_punica_metadata(num_slots):
+    """
+    Test Summary:
+        Build the Punica metadata of random batches of requests of random
+        LoRAs, slots and lengths, LoRAs without a slot included.
+    Expected Result:
+        The metadata are those of vLLM's convert_mapping and compute_meta;
+        group_list counts the tokens of every slot, token_order groups the
+        tokens by slot stably.
+    """
+    from vllm_mindspore.lora.punica_wrapper.utils import (
+        PunicaMetadataBuilder)
+
+    rng = np.random.default_rng(num_slots)
+    max_loras, vocab_size, extra_vocab_size = num_slots + 1, 1000, 16
+    builder = PunicaMetadataBuilder(256 * 64, 256, num_slots)
+    for _ in range(20):
+        mapping, lora_index_to_id = _random_mapping(
+            rng, num_slots, int(rng.integers(1, 256)))
+        builder.build(mapping, lora_index_to_id, max_loras, vocab_size,
+                      extra_vocab_size)
+        (lora_indices, embeddings_indices, sampler_indices,
+         sampler_indices_padded, seq_start_locs, seq_lengths,
+         lora_indices_per_batch) = _convert_mapping(
+             mapping.index_mapping, mapping.prompt_mapping, lora_index_to_id,
+             max_loras, vocab_size, extra_vocab_size)
+        num_tokens, num_prompts = len(lora_indices), len(sampler_indices)
+        batch_size = len(seq_start_locs)
+        assert (builder.num_tokens, builder.num_prompts,
+                builder.batch_size) == (num_tokens, num_prompts, batch_size)
+        assert np.array_equal(builder.token_lora_indices[:num_tokens],
+                              lora_indices)
+        assert np.array_equal(builder.embeddings(), embeddings_indices)
+        assert np.array_equal(builder.sampler_indices[:num_prompts],
+                              sampler_indices)
+        assert np.array_equal(builder.sampler_indices_padded[:num_prompts],
+                              sampler_indices_padded)
+        assert np.array_equal(builder.seq_start_locs[:batch_size],
+                              seq_start_locs)
+        assert np.array_equal(builder.seq_lengths[:batch_size], seq_lengths)
+        assert np.array_equal(builder.lora_indices_per_batch[:batch_size],
+                              lora_indices_per_batch)
+        assert builder.max_length == seq_lengths.max()
+        assert builder.no_lora == (batch_size == 1
+                                   and lora_indices_per_batch[0] == -1)
+        assert np.array_equal(
+            builder.group_list,
+            np.bincount(lora_indices + 1, minlength=num_slots + 1))
+        assert np.array_equal(builder.token_order[:num_tokens],
+                              np.argsort(lora_indices, kind="stable"))
+        slots = lora_indices_per_batch.tolist()
+        assert builder.grouped == (slots == sorted(set(slots)))
+
+    mapping.index_mapping += (1000, )
+    with pytest.raises(ValueError):
+        builder.build(mapping, lora_index_to_id, max_loras, vocab_size,
+                      extra_vocab_size)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_sgmv_reference():
+    """
+    Test Summary:
+        Shrink then expand into a slice of the output the tokens of segments
+        of random LoRAs, some without LoRA, with the reference SGMV.
+    Expected Result:
+        The outputs are those of a matmul per token with the weights of its
+        LoRA; the rows of tokens without LoRA are left as they were.
+    """
+    from vllm_mindspore._C_host import sgmv_expand, sgmv_shrink
+
+    rng = np.random.default_rng(0)
+    num_loras, hidden, rank, size = 4, 256, 16, 128
+    seq_lengths = rng.integers(1, 40, 12)
+    lora_indices = rng.integers(-1, num_loras, 12)
+    seq_start_locs = np.cumsum(seq_lengths) - seq_lengths
+    num_tokens = int(seq_lengths.sum())
+    token_loras = lora_indices.repeat(seq_lengths)
+    x = rng.standard_normal((num_tokens, hidden)).astype(np.float32)
+    lora_a = rng.standard_normal((num_loras, rank, hidden)).astype(np.float32)
+    lora_b = rng.standard_normal((num_loras, size, rank)).astype(np.float32)
+
+    shrunk = np.zeros((num_tokens, rank), dtype=np.float32)
+    sgmv_shrink(x,
+                lora_a,
+                shrunk,
+                seq_start_locs,
+                seq_lengths,
+                lora_indices,
+                0.5,
+                num_threads=0)
+    out = np.ones((num_tokens, 2 * size), dtype=np.float32)
+    sgmv_expand(shrunk,
+                lora_b,
+                out,
+                seq_start_locs,
+                seq_lengths,
+                lora_indices,
+                offset=size)
+
+    has_lora = token_loras >= 0
+    expected_shrunk = 0.5 * np.einsum("trh,th->tr",
+                                      lora_a[token_loras[has_lora]],
+                                      x[has_lora])
+    np.testing.assert_allclose(shrunk[has_lora],
+                               expected_shrunk,
+                               rtol=1e-4,
+                               atol=1e-3)
+    assert not shrunk[~has_lora].any()
+    expected_out = np.ones_like(out)
+    expected_out[has_lora, size:] += np.einsum(
+        "tor,tr->to", lora_b[token_loras[has_lora]], shrunk[has_lora])
+    np.testing.assert_allclose(out, expected_out, rtol=1e-4, atol=1e-3)
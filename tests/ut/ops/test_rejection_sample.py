@@ -0,0 +1,169 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test rejection_sample custom op against the Python rejection sampler"""
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _make_probs(rng, rows, vocab_size):
+    probs = rng.random((rows, vocab_size), dtype=np.float32)**4
+    return probs / probs.sum(axis=-1, keepdims=True)
+
+
+def _python_rejection_sample(cu_num_draft_tokens, draft_token_ids,
+                             draft_probs, target_probs, bonus_token_ids,
+                             uniform_probs, recovery_noise, is_greedy,
+                             max_spec_len):
+    """The Python path of vllm_mindspore.v1.sample.rejection_sampler, with
+    the random numbers given."""
+    from mindspore import mint
+
+    from vllm_mindspore.v1.sample.rejection_sampler import (
+        _rejection_greedy_sample, _rejection_random_sample,
+        _sample_recovered_tokens)
+
+    batch_size = cu_num_draft_tokens.shape[0]
+    num_draft_tokens = np.diff(cu_num_draft_tokens, prepend=0).tolist()
+    vocab_size = target_probs.shape[-1]
+    output_token_ids = mint.full((batch_size, max_spec_len + 1), -1,
+                                 dtype=ms.int32)
+    cu_num_draft_tokens = ms.Tensor(cu_num_draft_tokens)
+    draft_token_ids = ms.Tensor(draft_token_ids)
+    draft_probs = None if draft_probs is None else ms.Tensor(draft_probs)
+    target_probs = ms.Tensor(target_probs)
+    bonus_token_ids = ms.Tensor(bonus_token_ids)
+    is_greedy = ms.Tensor(is_greedy)
+
+    _rejection_greedy_sample(output_token_ids, num_draft_tokens,
+                             cu_num_draft_tokens, draft_token_ids,
+                             target_probs.argmax(dim=-1), bonus_token_ids,
+                             is_greedy)
+    recovered_token_ids = mint.empty_like(draft_token_ids)
+    _sample_recovered_tokens(recovered_token_ids, cu_num_draft_tokens,
+                             draft_token_ids, draft_probs, target_probs,
+                             ms.Tensor(recovery_noise), vocab_size)
+    _rejection_random_sample(output_token_ids, cu_num_draft_tokens,
+                             draft_token_ids, draft_probs, target_probs,
+                             bonus_token_ids, recovered_token_ids,
+                             ms.Tensor(uniform_probs), is_greedy,
+                             max_spec_len, vocab_size)
+    return output_token_ids.asnumpy()
+
+
+def _native_rejection_sample(cu_num_draft_tokens, draft_token_ids,
+                             draft_probs, target_probs, bonus_token_ids,
+                             uniform_probs, recovery_noise, is_greedy,
+                             max_spec_len):
+    from vllm_mindspore._custom_ops import rejection_sample
+
+    batch_size = cu_num_draft_tokens.shape[0]
+    output_token_ids = ms.Tensor(
+        np.full((batch_size, max_spec_len + 1), 7, dtype=np.int32))
+    rejection_sample(output_token_ids, ms.Tensor(cu_num_draft_tokens),
+                     ms.Tensor(draft_token_ids),
+                     None if draft_probs is None else ms.Tensor(draft_probs),
+                     ms.Tensor(target_probs), ms.Tensor(bonus_token_ids),
+                     ms.Tensor(uniform_probs), ms.Tensor(recovery_noise),
+                     ms.Tensor(is_greedy), max_spec_len)
+    return output_token_ids.asnumpy()
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("use_draft_probs", [True, False])
+@pytest.mark.parametrize("greedy_ratio", [0.0, 0.5, 1.0])
+def test_rejection_sample_same_random_numbers(use_draft_probs, greedy_ratio):
+    """
+    Test Summary:
+        Greedy and random requests in one batch, with the same uniform
+        probabilities and recovery noise given to both paths.
+    Expected Result:
+        The custom op samples exactly the tokens of the Python path.
+    """
+    batch_size, max_spec_len, vocab_size = 32, 4, 1000
+    rng = np.random.default_rng(0)
+    num_draft_tokens = rng.integers(0, max_spec_len + 1, batch_size)
+    cu_num_draft_tokens = np.cumsum(num_draft_tokens).astype(np.int32)
+    num_tokens = int(cu_num_draft_tokens[-1])
+    target_probs = _make_probs(rng, num_tokens, vocab_size)
+    draft_probs = _make_probs(rng, num_tokens,
+                              vocab_size) if use_draft_probs else None
+    # half of the drafts are the target argmax, so that some get accepted
+    draft_token_ids = np.where(
+        np.arange(num_tokens) % 2 == 0, target_probs.argmax(axis=-1),
+        rng.integers(0, vocab_size, num_tokens)).astype(np.int32)
+    bonus_token_ids = rng.integers(0, vocab_size, (batch_size, 1),
+                                   dtype=np.int32)
+    uniform_probs = rng.random(num_tokens, dtype=np.float32)
+    recovery_noise = rng.exponential(size=(batch_size, vocab_size)).astype(
+        np.float32)
+    is_greedy = rng.random(batch_size) < greedy_ratio
+
+    args = (cu_num_draft_tokens, draft_token_ids, draft_probs, target_probs,
+            bonus_token_ids, uniform_probs, recovery_noise, is_greedy,
+            max_spec_len)
+    np.testing.assert_array_equal(_native_rejection_sample(*args),
+                                  _python_rejection_sample(*args))
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("use_draft_probs", [True, False])
+def test_rejection_sample_distribution(use_draft_probs):
+    """
+    Test Summary:
+        Draft tokens drawn from the draft distribution, fresh random numbers
+        for each path. Whatever the draft distribution, the first sampled
+        token of a random request follows the target distribution.
+    Expected Result:
+        Both paths sample the target distribution, within the same bound.
+    """
+    num_trials, vocab_size, max_spec_len = 2000, 8, 1
+    rng = np.random.default_rng(1)
+    target_prob = _make_probs(rng, 1, vocab_size)[0]
+    draft_prob = _make_probs(rng, 1, vocab_size)[0]
+    if not use_draft_probs:
+        # without draft probs every draft is taken to have probability 1,
+        # which is exact for a one-hot draft distribution
+        draft_prob = np.eye(vocab_size, dtype=np.float32)[0]
+
+    def sample(run):
+        draft_token_ids = rng.choice(vocab_size, num_trials,
+                                     p=draft_prob / draft_prob.sum())
+        args = (np.arange(1, num_trials + 1, dtype=np.int32),
+                draft_token_ids.astype(np.int32),
+                np.tile(draft_prob, (num_trials, 1))
+                if use_draft_probs else None,
+                np.tile(target_prob, (num_trials, 1)),
+                np.zeros((num_trials, 1), dtype=np.int32),
+                rng.random(num_trials, dtype=np.float32),
+                rng.exponential(size=(num_trials, vocab_size)).astype(
+                    np.float32), np.zeros(num_trials, dtype=np.bool_),
+                max_spec_len)
+        first_tokens = run(*args)[:, 0]
+        return np.bincount(first_tokens, minlength=vocab_size) / num_trials
+
+    native_freq = sample(_native_rejection_sample)
+    python_freq = sample(_python_rejection_sample)
+    # total variation distance, its standard deviation is about 0.02 here
+    assert 0.5 * np.abs(native_freq - target_prob).sum() < 0.08
+    assert 0.5 * np.abs(python_freq - target_prob).sum() < 0.08
+    assert 0.5 * np.abs(native_freq - python_freq).sum() < 0.1
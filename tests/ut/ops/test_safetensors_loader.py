@@ -0,0 +1,119 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test the native safetensors loader against safe_open"""
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+
+def _checkpoint(path, rng):
+    """A shard of tensors of several dtypes and ranks, with metadata."""
+    from safetensors.numpy import save_file
+
+    tensors = {
+        "embed.weight": rng.standard_normal((97, 64)).astype(np.float32),
+        "layers.0.qkv.weight": rng.standard_normal(
+            (48, 40)).astype(np.float16),
+        "layers.0.qkv.bias": rng.standard_normal(48).astype(np.float16),
+        "layers.0.experts.w13": rng.integers(-8, 8, (4, 6, 10),
+                                             dtype=np.int8),
+        "layers.0.norm.eps": np.array(1e-6, dtype=np.float32),
+        # big enough to be copied by several threads
+        "lm_head.weight": rng.standard_normal(
+            (1024, 4096)).astype(np.float32),
+    }
+    save_file(tensors, path, metadata={"format": "np"})
+    return tensors
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("num_threads", [1, 0])
+def test_safetensors_loader(tmp_path, monkeypatch, num_threads):
+    """
+    Test Summary:
+        Read a synthetic shard through safetensors_weights_iterator with the
+        native loader, whole and as the TP shards split_loaded_weight cuts,
+        on one thread and on the whole host pool.
+    Expected Result:
+        Every tensor and index equals what safe_open reads, every shard the
+        same slice of the saved array.
+    """
+    from safetensors import safe_open
+
+    from vllm_mindspore.model_executor.model_loader import weight_utils
+
+    assert weight_utils.SafetensorsFile is not None
+    monkeypatch.setattr(weight_utils, "_SAFETENSORS_LOAD_THREADS",
+                        num_threads)
+    path = str(tmp_path / "model.safetensors")
+    tensors = _checkpoint(path, np.random.default_rng(0))
+
+    weights = dict(weight_utils.safetensors_weights_iterator([path], False))
+    assert sorted(weights) == sorted(tensors)
+    with safe_open(path, framework="np") as f:
+        for name, weight in weights.items():
+            assert isinstance(weight, weight_utils.NativeSafeSlice)
+            expected = f.get_slice(name)
+            assert weight.get_shape() == expected.get_shape()
+            assert weight.get_dtype() == expected.get_dtype()
+            loaded = weight_utils.get_loaded_weight(weight)
+            assert loaded.dtype == f.get_tensor(name).dtype
+            np.testing.assert_array_equal(loaded, f.get_tensor(name))
+            shape = expected.get_shape()
+            for dim in range(min(len(shape), 3)):
+                # tp 4, with the last rank past the end of a padded dim
+                shard_size = (shape[dim] + 3) // 4
+                for rank in range(4):
+                    np.testing.assert_array_equal(
+                        weight_utils.split_loaded_weight(
+                            weight, dim, rank * shard_size, shard_size),
+                        weight_utils.split_loaded_weight(
+                            tensors[name], dim, rank * shard_size,
+                            shard_size))
+            if shape and shape[0] > 1:
+                np.testing.assert_array_equal(weight[1], expected[1])
+                np.testing.assert_array_equal(weight[::2], expected[::2])
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+def test_safetensors_loader_fallback(tmp_path):
+    """
+    Test Summary:
+        Open a file that is no safetensors checkpoint natively, and one
+        with a shape whose bytes overflow.
+    Expected Result:
+        SafetensorsFile raises ValueError, and the iterator leaves the file
+        to safe_open.
+    """
+    from vllm_mindspore.model_executor.model_loader import weight_utils
+
+    path = tmp_path / "broken.safetensors"
+    path.write_bytes((64).to_bytes(8, "little") + b"{not json")
+    with pytest.raises(ValueError):
+        weight_utils.SafetensorsFile(str(path))
+    assert weight_utils._open_native_safetensors(str(path)) is None
+
+    # 2^64 bytes, which wraps to the 0 bytes of its data offsets
+    header = (b'{"t":{"dtype":"U8","shape":[4294967296,4294967296],'
+              b'"data_offsets":[0,0]}}')
+    path.write_bytes(len(header).to_bytes(8, "little") + header)
+    with pytest.raises(ValueError, match="too large"):
+        weight_utils.SafetensorsFile(str(path))
@@ -0,0 +1,133 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""test segment_pool custom op against the CLS, LAST and MEAN poolers"""
+import mindspore as ms
+import numpy as np
+import pytest
+
+from tests.utils.common_utils import teardown_function, setup_function
+
+CLS, LAST, MEAN = 0, 1, 2
+
+
+def _make_hidden(rng, num_tokens, hidden_size, dtype):
+    """fp32 hidden states that the dtype holds exactly, and the tensor."""
+    hidden = rng.standard_normal((num_tokens, hidden_size), dtype=np.float32)
+    if dtype == ms.bfloat16:
+        hidden = (hidden.view(np.uint32) & 0xffff0000).view(np.float32)
+    elif dtype == ms.float16:
+        hidden = hidden.astype(np.float16).astype(np.float32)
+    return hidden, ms.Tensor(hidden).astype(dtype)
+
+
+def _reference(hidden, prompt_lens, pooling_type):
+    """The pooling of whole prompts laid out one after the other."""
+    ends = np.cumsum(prompt_lens)
+    starts = ends - prompt_lens
+    if pooling_type == CLS:
+        return hidden[starts]
+    if pooling_type == LAST:
+        return hidden[ends - 1]
+    return np.stack([
+        hidden[s:e].sum(axis=0, dtype=np.float32) / (e - s)
+        for s, e in zip(starts, ends)
+    ])
+
+
+def _native(hidden_states, first, last, prompt_lens, num_prev, partial_sums,
+            pooling_type):
+    from vllm_mindspore._custom_ops import segment_pool
+
+    num_reqs, hidden_size = len(first), hidden_states.shape[-1]
+    pooled_dtype = ms.float32 if pooling_type == MEAN else hidden_states.dtype
+    pooled = ms.Tensor(np.full((num_reqs, hidden_size), 7,
+                               dtype=np.float32)).astype(pooled_dtype)
+    partial_sums = ms.Tensor(partial_sums)
+    segment_pool(pooled, partial_sums, hidden_states,
+                 ms.Tensor(first.astype(np.int32)),
+                 ms.Tensor(last.astype(np.int32)),
+                 ms.Tensor(prompt_lens.astype(np.int32)),
+                 ms.Tensor(num_prev.astype(np.int32)), pooling_type)
+    return (pooled.astype(ms.float32).asnumpy(), partial_sums.asnumpy())
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("pooling_type", [CLS, LAST, MEAN])
+@pytest.mark.parametrize("dtype", [ms.float16, ms.bfloat16, ms.float32])
+@pytest.mark.parametrize("num_reqs,hidden_size", [(1, 16), (37, 1000),
+                                                  (512, 1024)])
+def test_segment_pool(pooling_type, dtype, num_reqs, hidden_size):
+    """
+    Test Summary:
+        A batch of whole prompts of random length pooled in one call.
+    Expected Result:
+        The custom op gives the first or last token of every prompt, or
+        the mean of its tokens, as the Python poolers do.
+    """
+    rng = np.random.default_rng(num_reqs + hidden_size + pooling_type)
+    prompt_lens = rng.integers(1, 40, num_reqs)
+    hidden, hidden_states = _make_hidden(rng, int(prompt_lens.sum()),
+                                         hidden_size, dtype)
+    last = np.cumsum(prompt_lens) - 1
+    pooled, _ = _native(hidden_states, last - prompt_lens + 1, last,
+                        prompt_lens, np.zeros(num_reqs),
+                        np.zeros((num_reqs, hidden_size), np.float32),
+                        pooling_type)
+    expected = _reference(hidden, prompt_lens, pooling_type)
+    if pooling_type == MEAN:
+        np.testing.assert_allclose(pooled, expected, rtol=1e-5, atol=1e-6)
+    else:
+        np.testing.assert_array_equal(pooled, expected)
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend910b_training
+@pytest.mark.env_onecard
+@pytest.mark.parametrize("pooling_type", [CLS, MEAN])
+def test_segment_pool_chunked_prefill(pooling_type):
+    """
+    Test Summary:
+        Prompts split over two chunked prefill steps, the partial sums of
+        the first step carried into the second.
+    Expected Result:
+        The second step pools every prompt as a whole one would be.
+    """
+    rng = np.random.default_rng(pooling_type)
+    num_reqs, hidden_size = 9, 300
+    prompt_lens = rng.integers(2, 30, num_reqs)
+    hidden, _ = _make_hidden(rng, int(prompt_lens.sum()), hidden_size,
+                             ms.float32)
+    starts = np.cumsum(prompt_lens) - prompt_lens
+    partial_sums = np.zeros((num_reqs, hidden_size), np.float32)
+    num_prev = np.zeros(num_reqs, dtype=np.int32)
+    for num_scheduled in (prompt_lens // 2, prompt_lens - prompt_lens // 2):
+        # the tokens of the step, packed as the runner schedules them
+        step_hidden = np.concatenate([
+            hidden[s + p:s + p + n]
+            for s, p, n in zip(starts, num_prev, num_scheduled)
+        ])
+        last = np.cumsum(num_scheduled) - 1
+        pooled, partial_sums = _native(ms.Tensor(step_hidden),
+                                       last - num_scheduled + 1, last,
+                                       prompt_lens, num_prev, partial_sums,
+                                       pooling_type)
+        num_prev = num_prev + num_scheduled
+    np.testing.assert_allclose(pooled,
+                               _reference(hidden, prompt_lens, pooling_type),
+                               rtol=1e-5,
+                               atol=1e-6)
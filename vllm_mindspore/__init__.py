@@ -93,6 +93,12 @@ from vllm_mindspore.v1.core.single_type_kv_cache_manager import (
 
 vllm.v1.core.single_type_kv_cache_manager.spec_manager_map = _spec_manager_map
 
+import vllm.v1.core.kv_cache_utils
+from vllm_mindspore.v1.core.kv_cache_utils import get_request_block_hasher
+
+vllm.v1.core.kv_cache_utils.get_request_block_hasher = get_request_block_hasher
+vllm.v1.engine.core.get_request_block_hasher = get_request_block_hasher
+
 from vllm_mindspore.utils import (
     make_tensor_with_pad,
     async_tensor_h2d,
@@ -409,10 +415,16 @@ from vllm.v1.sample.logits_processor.builtin import MinPLogitsProcessor
 
 MinPLogitsProcessor.update_state = update_state
 
-from vllm_mindspore.distributed.shm_broadcast import initialize_ShmRingBuffer
-from vllm.distributed.device_communicators.shm_broadcast import ShmRingBuffer
+from vllm_mindspore.distributed.shm_broadcast import (
+    initialize_ShmRingBuffer, release_ShmRingBuffer, make_acquire_write,
+    make_acquire_read)
+from vllm.distributed.device_communicators.shm_broadcast import (
+    ShmRingBuffer, MessageQueue)
 
 ShmRingBuffer.__init__ = initialize_ShmRingBuffer
+ShmRingBuffer.__del__ = release_ShmRingBuffer
+MessageQueue.acquire_write = make_acquire_write(MessageQueue.acquire_write)
+MessageQueue.acquire_read = make_acquire_read(MessageQueue.acquire_read)
 
 import vllm.distributed.device_communicators.base_device_communicator
 
@@ -527,6 +539,14 @@ from vllm_mindspore.model_executor.layers.pooler import \
 
 PoolerNormalize.forward_chunk = forward_chunk
 
+from vllm.model_executor.layers.pooler import CLSPool, LastPool, MeanPool
+from vllm_mindspore.model_executor.layers.pooler import (
+    cls_pool_forward_all, last_pool_forward_all, mean_pool_forward_all)
+
+CLSPool.forward_all = cls_pool_forward_all
+LastPool.forward_all = last_pool_forward_all
+MeanPool.forward_all = mean_pool_forward_all
+
 # Use mindspore implementation in pooler
 from vllm_mindspore.model_executor.layers.linear import ReplicatedLinear
 
@@ -15,17 +15,51 @@
 # limitations under the License.
 # ============================================================================
 
+from typing import Optional
+
 import mindspore as ms
 
 
+def _c_ops():
+    """The custom op module of the current device target, the host build
+    `_C_ops_cpu` (BUILD_CUSTOM_CPU=1) on CPU and `_C_ops` otherwise. Both
+    export the same functions."""
+    if ms.get_context("device_target") == "CPU":
+        from vllm_mindspore import _C_ops_cpu as c_ops
+    else:
+        from vllm_mindspore import _C_ops as c_ops
+    return c_ops
+
+
+def is_custom_op_available(name: str) -> bool:
+    """Whether the custom op module of the current device target is built
+    and exports `name`."""
+    try:
+        return hasattr(_c_ops(), name)
+    except ImportError:
+        return False
+
+
 def advance_step_flashattn(num_seqs: int, num_queries: int, block_size: int,
                            input_tokens: ms.Tensor,
                            sampled_token_ids: ms.Tensor,
                            input_positions: ms.Tensor, seq_lens: ms.Tensor,
                            slot_mapping: ms.Tensor,
-                           block_tables: ms.Tensor) -> None:
-    """Advance a step on Ascend for existing inputs for a multi-step runner"""
-    from vllm_mindspore import _C_ops as c_ops
+                           block_tables: ms.Tensor,
+                           num_tokens_per_seq: int = 1) -> None:
+    """Advance a step on device for existing inputs for a multi-step runner.
+
+    Each of the first `num_queries` sequences advances by
+    `num_tokens_per_seq` tokens, e.g. the draft tokens of a speculative step.
+    `sampled_token_ids`, `input_tokens`, `input_positions` and `slot_mapping`
+    hold `num_tokens_per_seq` entries per sequence, sequence-major
+    (`num_seqs x num_tokens_per_seq`): that is how the rejection sampler
+    lays out the sampled tokens and how a padded speculative batch lays out
+    the tokens of each request, so neither side needs a transpose. The
+    padded sequences `[num_queries, num_seqs)` get token 0, position 0 and
+    slot -1, and keep their `seq_lens`.
+    """
+    c_ops = _c_ops()
     c_ops.advance_step_flashattn(num_seqs=num_seqs,
                                  num_queries=num_queries,
                                  block_size=block_size,
@@ -34,4 +68,149 @@ def advance_step_flashattn(num_seqs: int, num_queries: int, block_size: int,
                                  input_positions=input_positions,
                                  seq_lens=seq_lens,
                                  slot_mapping=slot_mapping,
-                                 block_tables=block_tables)
+                                 block_tables=block_tables,
+                                 num_tokens_per_seq=num_tokens_per_seq)
+
+
+def rejection_sample(output_token_ids: ms.Tensor,
+                     cu_num_draft_tokens: ms.Tensor,
+                     draft_token_ids: ms.Tensor,
+                     draft_probs: Optional[ms.Tensor],
+                     target_probs: ms.Tensor, bonus_token_ids: ms.Tensor,
+                     uniform_probs: ms.Tensor, recovery_noise: ms.Tensor,
+                     is_greedy: ms.Tensor, max_spec_len: int) -> None:
+    """Rejection sampling of speculative draft tokens in one call.
+
+    Greedy requests (`is_greedy`) accept draft tokens while they match the
+    target argmax. Random requests accept a draft token when
+    `target_prob / draft_prob >= uniform_probs`, and otherwise take the
+    recovered token, argmax of `max(target - draft, 0) / recovery_noise`.
+    `output_token_ids` [batch_size, max_spec_len + 1] is fully overwritten,
+    with -1 past the last sampled token. `uniform_probs` and `recovery_noise`
+    are not read for greedy requests.
+    """
+    c_ops = _c_ops()
+    c_ops.rejection_sample(
+        output_token_ids=output_token_ids,
+        cu_num_draft_tokens=cu_num_draft_tokens,
+        draft_token_ids=draft_token_ids,
+        draft_probs=target_probs if draft_probs is None else draft_probs,
+        target_probs=target_probs,
+        bonus_token_ids=bonus_token_ids,
+        uniform_probs=uniform_probs,
+        recovery_noise=recovery_noise,
+        is_greedy=is_greedy,
+        max_spec_len=max_spec_len,
+        use_draft_probs=draft_probs is not None)
+
+
+def attention_mask(mask: ms.Tensor, query_lens: ms.Tensor,
+                   mask_offsets: ms.Tensor, fill_value: float) -> None:
+    """Build the causal mask of a batch of requests in one call.
+
+    `mask` [num_rows, max_seq_len] is fully overwritten. The rows of request
+    i follow those of the requests before it, `query_lens[i]` of them, and
+    row t of them is 0 up to column `mask_offsets[i] + t` and `fill_value`
+    after it. Rows past the last request are all 0. See
+    `causal_mask_offsets` in `attention_mask.py` for the offsets.
+    """
+    c_ops = _c_ops()
+    c_ops.attention_mask(mask=mask,
+                         query_lens=query_lens,
+                         mask_offsets=mask_offsets,
+                         fill_value=fill_value)
+
+
+def eagle_prepare_inputs(next_token_ids: ms.Tensor,
+                         valid_sampled_tokens_count: ms.Tensor,
+                         token_indices_to_sample: ms.Tensor,
+                         sampled_token_ids: ms.Tensor,
+                         cu_num_draft_tokens: ms.Tensor,
+                         discard_mask: ms.Tensor,
+                         backup_next_token_ids: ms.Tensor,
+                         query_start_loc: ms.Tensor, vocab_size: int) -> None:
+    """Prepare the inputs of the EAGLE draft model of a padded speculative
+    step in one call.
+
+    Row i of `sampled_token_ids` [num_reqs, max_gen_len] holds the tokens
+    the rejection sampler accepted for request i, then -1. For every request
+    `valid_sampled_tokens_count` gets the tokens in `[0, vocab_size)` of its
+    row, 0 if `discard_mask` is set; `next_token_ids` the last of them, or
+    `backup_next_token_ids` when there is none; `token_indices_to_sample`
+    `query_start_loc[i + 1] - 1` less the rejected draft tokens of the
+    request, per the inclusive `cu_num_draft_tokens`. The three outputs
+    [num_reqs] are fully overwritten.
+    """
+    c_ops = _c_ops()
+    c_ops.eagle_prepare_inputs(
+        next_token_ids=next_token_ids,
+        valid_sampled_tokens_count=valid_sampled_tokens_count,
+        token_indices_to_sample=token_indices_to_sample,
+        sampled_token_ids=sampled_token_ids,
+        cu_num_draft_tokens=cu_num_draft_tokens,
+        discard_mask=discard_mask,
+        backup_next_token_ids=backup_next_token_ids,
+        query_start_loc=query_start_loc,
+        vocab_size=vocab_size)
+
+
+# pooling_type of segment_pool
+SEGMENT_POOL_CLS = 0
+SEGMENT_POOL_LAST = 1
+SEGMENT_POOL_MEAN = 2
+
+
+def segment_pool(pooled: ms.Tensor, partial_sums: ms.Tensor,
+                 hidden_states: ms.Tensor, first_token_indices: ms.Tensor,
+                 last_token_indices: ms.Tensor, prompt_lens: ms.Tensor,
+                 num_prev_tokens: ms.Tensor, pooling_type: int) -> None:
+    """Pool the hidden states of every request of a batch in one call.
+
+    Request i owns the rows `[first_token_indices[i], last_token_indices[i]]`
+    of `hidden_states` [num_tokens, hidden_size], which follow the
+    `num_prev_tokens[i]` tokens of its prompt of `prompt_lens[i]` tokens
+    pooled in earlier steps. Row i of `pooled` [num_reqs, hidden_size] is
+    fully overwritten with the first token of the prompt (SEGMENT_POOL_CLS),
+    the last one scheduled (SEGMENT_POOL_LAST) or the fp32 mean over the
+    prompt (SEGMENT_POOL_MEAN; `pooled` is then fp32). For CLS and MEAN row
+    i of the fp32 `partial_sums` carries in the first token or the sum of
+    the earlier tokens when `num_prev_tokens[i] > 0`, and is written back
+    when the prompt goes on after this step.
+    """
+    c_ops = _c_ops()
+    c_ops.segment_pool(pooled=pooled,
+                       partial_sums=partial_sums,
+                       hidden_states=hidden_states,
+                       first_token_indices=first_token_indices,
+                       last_token_indices=last_token_indices,
+                       prompt_lens=prompt_lens,
+                       num_prev_tokens=num_prev_tokens,
+                       pooling_type=pooling_type)
+
+
+def set_op_stats_enabled(enabled: bool, kernel_timing: bool = False) -> bool:
+    """Turn the per-op counters of the custom ops on or off, and return
+    whether the custom op module is there to count. `kernel_timing` also
+    times every kernel; on device it waits for each kernel to finish."""
+    if not is_custom_op_available("set_op_stats_enabled"):
+        return False
+    _c_ops().set_op_stats_enabled(enabled, kernel_timing)
+    return True
+
+
+def get_op_stats() -> dict[str, dict]:
+    """Counters of every custom op called since the last reset, by op name:
+    `calls`, `host_us` and its `host_p50_us`/`host_p99_us`, `casts` and
+    `cast_us` of DtypeCaster, `bytes_in`/`bytes_out`, `kernel_calls` and
+    `kernel_us` when kernel timing is on, and `host_hist`, the calls per
+    log2 bucket of host latency in ns. Empty without the custom op
+    module, e.g. on the dummy module of a build without BUILD_CUSTOM."""
+    if not is_custom_op_available("get_op_stats"):
+        return {}
+    return _c_ops().get_op_stats()
+
+
+def reset_op_stats() -> None:
+    """Zero the counters of all custom ops."""
+    if is_custom_op_available("reset_op_stats"):
+        _c_ops().reset_op_stats()
@@ -0,0 +1,257 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+A KV connector offloading KV cache blocks to host memory.
+
+The full blocks of preempted requests, and of finished ones unless
+offload_finished is false, are swapped out to a tier of host blocks keyed
+by their prefix caching hash. A request whose prefix is not in the device
+cache but in the host tier loads it from there instead of recomputing it.
+
+    --kv-transfer-config '{"kv_connector": "MsHostOffloadingConnector",
+        "kv_role": "kv_both",
+        "kv_connector_extra_config": {"num_host_blocks": 8192}}'
+
+kv_connector_extra_config:
+    num_host_blocks: blocks of the host tier, each of the size of a device
+        block of all the layers.
+    offload_finished: swap out the blocks of finished requests, default
+        true.
+    lock_host_memory: lock the host blocks in RAM, default false; needs
+        a memlock limit above the size of the tier.
+    swap_threads: threads of the host copies, apart from those of the
+        other host helpers, default 4.
+"""
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING, Any, Optional
+
+from vllm.distributed.kv_transfer.kv_connector.v1.base import (
+    KVConnectorBase_V1, KVConnectorMetadata, KVConnectorRole)
+from vllm.logger import init_logger
+from vllm.v1.core.sched.output import SchedulerOutput
+from vllm.v1.request import Request, RequestStatus
+
+from vllm_mindspore.utils import is_310p
+from vllm_mindspore.v1.core.kv_offload import HostKVCacheTier
+
+if TYPE_CHECKING:
+    from vllm.attention.backends.abstract import AttentionMetadata
+    from vllm.config import VllmConfig
+    from vllm.forward_context import ForwardContext
+    from vllm.v1.core.kv_cache_manager import KVCacheBlocks
+
+logger = init_logger(__name__)
+
+
+@dataclass
+class MsHostOffloadingConnectorMetadata(KVConnectorMetadata):
+    # host blocks evicted, freed in the worker pool before the stores
+    free_host_ids: list[int] = field(default_factory=list)
+    # device blocks to copy into host blocks, before the loads
+    store_device_ids: list[int] = field(default_factory=list)
+    store_host_ids: list[int] = field(default_factory=list)
+    # host blocks to copy into device blocks, before the forward
+    load_host_ids: list[int] = field(default_factory=list)
+    load_device_ids: list[int] = field(default_factory=list)
+
+
+@dataclass
+class _RequestState:
+    request: Request
+    # device blocks of the request, of its only KV cache group
+    block_ids: list[int]
+    # tokens whose KV is in the blocks once the step scheduled is done
+    num_computed_tokens: int
+
+
+class MsHostOffloadingConnector(KVConnectorBase_V1):
+
+    def __init__(self, vllm_config: "VllmConfig", role: KVConnectorRole):
+        super().__init__(vllm_config=vllm_config, role=role)
+        kv_transfer_config = vllm_config.kv_transfer_config
+        extra_config = kv_transfer_config.kv_connector_extra_config or {}
+        self.num_host_blocks = int(extra_config["num_host_blocks"])
+        self.offload_finished = bool(
+            extra_config.get("offload_finished", True))
+        self.lock_host_memory = bool(
+            extra_config.get("lock_host_memory", False))
+        self.swap_threads = int(extra_config.get("swap_threads", 4))
+        self.block_size = vllm_config.cache_config.block_size
+
+        if role == KVConnectorRole.SCHEDULER:
+            self.tier = HostKVCacheTier(self.num_host_blocks)
+            # local hits of the requests asked about, for their loads
+            self._num_local_blocks: dict[str, int] = {}
+            self._new_requests: dict[str, Request] = {}
+            self._requests: dict[str, _RequestState] = {}
+            # the stores and loads of the next step, and their block hashes
+            self._meta = MsHostOffloadingConnectorMetadata()
+            self._store_hashes: list[Any] = []
+            self._load_hashes: list[Any] = []
+            # block hashes of the stores and loads of the last step: the
+            # worker runs them before those of any later step
+            self._storing: list[Any] = []
+            self._loading: list[Any] = []
+        else:
+            self._swap_engine = None
+
+    # ==============================
+    # Worker-side methods
+    # ==============================
+
+    def register_kv_caches(self, kv_caches: dict[str, Any]) -> None:
+        from vllm_mindspore.v1.worker.kv_swap import (HostBlockPool,
+                                                      KVSwapEngine)
+        if HostBlockPool is None:
+            raise RuntimeError("MsHostOffloadingConnector needs "
+                               "vllm_mindspore._C_host, which is not built.")
+        quant_config = getattr(self._vllm_config, "quant_config", None)
+        if is_310p() or getattr(quant_config, "fa3_quant", False):
+            raise NotImplementedError(
+                "MsHostOffloadingConnector does not support KV caches in "
+                "NZ format.")
+        self._swap_engine = KVSwapEngine(kv_caches, self.num_host_blocks,
+                                         self.lock_host_memory,
+                                         self.swap_threads)
+
+    def start_load_kv(self, forward_context: "ForwardContext",
+                      **kwargs) -> None:
+        meta = self._get_connector_metadata()
+        assert isinstance(meta, MsHostOffloadingConnectorMetadata)
+        assert self._swap_engine is not None
+        # the device blocks stored may be loaded into in the same step
+        self._swap_engine.free(meta.free_host_ids)
+        self._swap_engine.swap_out(meta.store_device_ids, meta.store_host_ids)
+        self._swap_engine.swap_in(meta.load_host_ids, meta.load_device_ids)
+
+    def wait_for_layer_load(self, layer_name: str) -> None:
+        # the loads are done before the forward
+        return
+
+    def save_kv_layer(self, layer_name: str, kv_layer: Any,
+                      attn_metadata: "AttentionMetadata", **kwargs) -> None:
+        # blocks are stored once computed, in start_load_kv of a later step
+        return
+
+    def wait_for_save(self) -> None:
+        # the host blocks are written on the swap thread, before any later
+        # load of them
+        return
+
+    # ==============================
+    # Scheduler-side methods
+    # ==============================
+
+    def get_num_new_matched_tokens(
+            self, request: Request,
+            num_computed_tokens: int) -> tuple[Optional[int], bool]:
+        self._new_requests[request.request_id] = request
+        start = num_computed_tokens // self.block_size
+        # at least the last token is computed
+        end = (request.num_tokens - 1) // self.block_size
+        num_hits = self.tier.lookup(request.block_hashes[start:end])
+        self._num_local_blocks[request.request_id] = start
+        return num_hits * self.block_size, False
+
+    def update_state_after_alloc(self, request: Request,
+                                 blocks: "KVCacheBlocks",
+                                 num_external_tokens: int) -> None:
+        start = self._num_local_blocks.pop(request.request_id, 0)
+        if num_external_tokens == 0:
+            return
+        end = start + num_external_tokens // self.block_size
+        block_hashes = request.block_hashes[start:end]
+        self._meta.load_host_ids.extend(self.tier.prepare_load(block_hashes))
+        self._meta.load_device_ids.extend(
+            blocks.get_block_ids()[0][start:end])
+        self._load_hashes.extend(block_hashes)
+
+    def build_connector_meta(
+            self, scheduler_output: SchedulerOutput) -> KVConnectorMetadata:
+        self.tier.complete_store(self._storing)
+        self.tier.complete_load(self._loading)
+
+        num_scheduled_tokens = scheduler_output.num_scheduled_tokens
+        spec_tokens = scheduler_output.scheduled_spec_decode_tokens
+        for new_req in scheduler_output.scheduled_new_reqs:
+            req_id = new_req.req_id
+            request = self._new_requests.pop(req_id, None)
+            if request is None:
+                continue
+            self._requests[req_id] = _RequestState(
+                request, list(new_req.block_ids[0]),
+                new_req.num_computed_tokens + num_scheduled_tokens[req_id] -
+                len(spec_tokens.get(req_id, ())))
+        cached_reqs = scheduler_output.scheduled_cached_reqs
+        for i, req_id in enumerate(cached_reqs.req_ids):
+            new_block_ids = cached_reqs.new_block_ids[i]
+            if cached_reqs.resumed_from_preemption[i]:
+                request = self._new_requests.pop(req_id, None)
+                if request is None:
+                    continue
+                self._requests[req_id] = _RequestState(request, [], 0)
+            state = self._requests.get(req_id)
+            if state is None:
+                continue
+            if new_block_ids is not None:
+                state.block_ids.extend(new_block_ids[0])
+            state.num_computed_tokens = (cached_reqs.num_computed_tokens[i] +
+                                         num_scheduled_tokens[req_id] -
+                                         len(spec_tokens.get(req_id, ())))
+
+        # requests preempted in this step: their blocks are freed, but not
+        # written before the stores of this step are done
+        preempted = [
+            req_id for req_id, state in self._requests.items()
+            if state.request.status == RequestStatus.PREEMPTED
+            and req_id not in num_scheduled_tokens
+        ]
+        for req_id in preempted:
+            state = self._requests.pop(req_id)
+            self._store(state.request, state.block_ids,
+                        state.num_computed_tokens)
+
+        meta, self._meta = self._meta, MsHostOffloadingConnectorMetadata()
+        # blocks allocated since the last step are not ready, so not evicted
+        # since: the frees go before all the stores
+        meta.free_host_ids = self.tier.pop_evicted()
+        self._storing, self._store_hashes = self._store_hashes, []
+        self._loading, self._load_hashes = self._load_hashes, []
+        return meta
+
+    def request_finished(
+        self,
+        request: Request,
+        block_ids: list[int],
+    ) -> tuple[bool, Optional[dict[str, Any]]]:
+        self._requests.pop(request.request_id, None)
+        self._new_requests.pop(request.request_id, None)
+        self._num_local_blocks.pop(request.request_id, None)
+        if self.offload_finished:
+            # the blocks are freed, but not written before the stores of
+            # the next step are done
+            self._store(request, block_ids, request.num_computed_tokens)
+        return False, None
+
+    def _store(self, request: Request, block_ids: list[int],
+               num_computed_tokens: int) -> None:
+        num_blocks = min(len(request.block_hashes), len(block_ids),
+                         num_computed_tokens // self.block_size)
+        block_hashes = request.block_hashes[:num_blocks]
+        indices, host_ids = self.tier.prepare_store(block_hashes)
+        self._meta.store_device_ids.extend(block_ids[i] for i in indices)
+        self._meta.store_host_ids.extend(host_ids)
+        self._store_hashes.extend(block_hashes[i] for i in indices)
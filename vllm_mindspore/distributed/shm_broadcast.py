@@ -18,15 +18,29 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 """Adaption for shm broadcast."""
+import time
+from contextlib import contextmanager
 from multiprocessing import shared_memory
+from threading import Event
 from typing import Optional
 from unittest.mock import patch
 
 import numpy as np
+import vllm.envs as envs
 from vllm.logger import init_logger
 
+try:
+    from vllm_mindspore._C_host import RingBufferQueue
+except ImportError:
+    RingBufferQueue = None
+
 logger = init_logger(__name__)
 
+# Longest sleep of a native wait between two checks of the timeout, the
+# cancel event and the warning interval.
+_NATIVE_WAIT_SLICE_S = 0.1
+_CACHE_LINE_BYTES = 64
+
 
 def initialize_ShmRingBuffer(self,
                              n_reader: int,
@@ -42,6 +56,14 @@ def initialize_ShmRingBuffer(self,
                                   self.metadata_size) * self.max_chunks
     self.data_offset = 0
     self.metadata_offset = self.max_chunk_bytes * self.max_chunks
+    self.native_queue = None
+    if RingBufferQueue is not None:
+        # The chunks keep their layout, the per-chunk flags are replaced by
+        # the cache-line aligned metadata of the native queue.
+        self.metadata_offset = -(-self.metadata_offset // _CACHE_LINE_BYTES) \
+            * _CACHE_LINE_BYTES
+        self.total_bytes_of_buffer = self.metadata_offset + \
+            RingBufferQueue.metadata_bytes(n_reader)
 
     if name is None:
         # we are creating a buffer
@@ -52,6 +74,13 @@ def initialize_ShmRingBuffer(self,
         with memoryview(self.shared_memory.buf[self.metadata_offset:]
                         ) as metadata_buffer:
             np.frombuffer(metadata_buffer, dtype=np.uint8).fill(0)
+        if RingBufferQueue is not None:
+            self.native_queue = RingBufferQueue(self.shared_memory.buf,
+                                                self.metadata_offset,
+                                                n_reader,
+                                                max_chunk_bytes,
+                                                max_chunks,
+                                                create=True)
     else:
         # we are opening an existing buffer
         self.is_creator = False
@@ -68,8 +97,114 @@ def initialize_ShmRingBuffer(self,
                 # to the requested size. The size parameter is ignored
                 # when attaching to an existing block.
                 assert (self.shared_memory.size >= self.total_bytes_of_buffer)
+                if RingBufferQueue is not None:
+                    self.native_queue = RingBufferQueue(
+                        self.shared_memory.buf,
+                        self.metadata_offset,
+                        n_reader,
+                        max_chunk_bytes,
+                        max_chunks,
+                        create=False)
             except FileNotFoundError:
                 # we might deserialize the object in a different node
                 # in this case, this object is not used,
                 # and we should suppress the error
                 pass
+
+
+def release_ShmRingBuffer(self):
+    # the native queue holds the shared memory buffer, which cannot be
+    # closed while exported
+    self.native_queue = None
+    if hasattr(self, "shared_memory"):
+        self.shared_memory.close()
+        if self.is_creator:
+            self.shared_memory.unlink()
+
+
+def _native_wait(wait, timeout: Optional[float], cancel: Optional[Event],
+                 on_warning) -> None:
+    """Run `wait(slice_timeout)` until it returns True, in slices, checking
+    the timeout and the cancel event and logging a warning now and then in
+    between."""
+    start_time = time.monotonic()
+    n_warning = 1
+    wait_slice = _NATIVE_WAIT_SLICE_S if timeout is None else min(
+        _NATIVE_WAIT_SLICE_S, timeout)
+    while not wait(wait_slice):
+        if cancel is not None and cancel.is_set():
+            raise RuntimeError("cancelled")
+        elapsed = time.monotonic() - start_time
+        if elapsed > envs.VLLM_RINGBUFFER_WARNING_INTERVAL * n_warning:
+            on_warning(elapsed)
+            n_warning += 1
+        if timeout is not None and elapsed > timeout:
+            raise TimeoutError
+
+
+def make_acquire_write(acquire_write):
+    """Wrap MessageQueue.acquire_write to wait on the native queue of the
+    buffer, if it has one."""
+
+    @contextmanager
+    def acquire_write_native(self, timeout: Optional[float] = None):
+        queue = getattr(self.buffer, "native_queue", None)
+        if queue is None:
+            with acquire_write(self, timeout) as buf:
+                yield buf
+            return
+        assert self._is_writer, "Only writers can acquire write"
+
+        def on_warning(elapsed):
+            logger.debug(
+                "No available shared memory broadcast block found in %s "
+                "seconds. This typically happens when some processes are "
+                "hanging or doing some time-consuming work (e.g. "
+                "compilation)", int(elapsed))
+
+        _native_wait(lambda t: queue.wait_write(t), timeout, None, on_warning)
+        with self.buffer.get_data(queue.write_index()) as buf:
+            yield buf
+        queue.commit_write()
+        self.current_idx = queue.write_index()
+
+    return acquire_write_native
+
+
+def make_acquire_read(acquire_read):
+    """Wrap MessageQueue.acquire_read to wait on the native queue of the
+    buffer, if it has one."""
+
+    @contextmanager
+    def acquire_read_native(self,
+                            timeout: Optional[float] = None,
+                            cancel: Optional[Event] = None,
+                            *args,
+                            **kwargs):
+        queue = getattr(self.buffer, "native_queue", None)
+        if queue is None:
+            with acquire_read(self, timeout, cancel, *args, **kwargs) as buf:
+                yield buf
+            return
+        assert self._is_local_reader, "Only readers can acquire read"
+        reader = self.local_reader_rank
+        # `indefinite` of the vLLM versions that have it
+        indefinite = args[0] if args else kwargs.get("indefinite", False)
+
+        def on_warning(elapsed):
+            if not indefinite:
+                logger.debug(
+                    "No available shared memory broadcast block found in %s "
+                    "seconds. This typically happens when some processes are "
+                    "hanging or doing some time-consuming work (e.g. "
+                    "compilation)", int(elapsed))
+
+        # idle readers sleep on a futex instead of spinning
+        _native_wait(lambda t: queue.wait_read(reader, t), timeout, cancel,
+                     on_warning)
+        with self.buffer.get_data(queue.read_index(reader)) as buf:
+            yield buf
+        queue.commit_read(reader)
+        self.current_idx = queue.read_index(reader)
+
+    return acquire_read_native
@@ -0,0 +1,271 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Built-in logits processors, applied to a whole batch at once.
+
+Every processor here is an ordinary logits processor, called with
+(prompt_tokens_ids, past_tokens_ids, logits_row), but it also describes
+itself as an op of the native apply_logits_processors, so that
+_apply_logits_processors runs it over all the rows of a batch in one call
+instead of once per row under the GIL.
+"""
+import itertools
+from collections.abc import Sequence
+from typing import Optional
+
+import mindspore as ms
+import numpy as np
+
+try:
+    from vllm_mindspore._C_host import (apply_logits_processors as
+                                        _native_apply_logits_processors)
+except ImportError:
+    _native_apply_logits_processors = None
+
+try:
+    from vllm.logits_process import NoBadWordsLogitsProcessor
+except ImportError:
+    NoBadWordsLogitsProcessor = None
+
+# op kinds of apply_logits_processors
+_PENALTIES, _BAD_WORDS, _MIN_TOKENS, _ALLOWED_TOKEN_IDS = 0, 1, 2, 3
+
+
+def _in_vocab(token_ids, vocab_size: int) -> np.ndarray:
+    ids = np.asarray(token_ids, dtype=np.int64).reshape(-1)
+    return ids[(ids >= 0) & (ids < vocab_size)]
+
+
+class BuiltinLogitsProcessor:
+    """A logits processor the native engine can apply to a whole batch."""
+
+    kind: int = -1
+
+    def uses_prompt(self) -> bool:
+        """Whether the processor reads the prompt token ids."""
+        return False
+
+    def params(self) -> tuple[float, float, float]:
+        return (0.0, 0.0, 0.0)
+
+    def token_ids(self) -> list[int]:
+        return []
+
+    def check_token_ids(self, vocab_size: int) -> None:
+        """Raise a ValueError for token ids the processor rejects."""
+
+    def apply_np(self, prompt_tokens_ids: Sequence[int],
+                 past_tokens_ids: Sequence[int], row: np.ndarray) -> None:
+        """Process one float32 row in place, as the native engine does."""
+        raise NotImplementedError
+
+    def __call__(self, prompt_tokens_ids, past_tokens_ids, logits_row):
+        row = logits_row.astype(ms.float32).asnumpy().copy()
+        self.apply_np(prompt_tokens_ids, past_tokens_ids, row)
+        return ms.from_numpy(row).astype(logits_row.dtype)
+
+
+class PenaltiesLogitsProcessor(BuiltinLogitsProcessor):
+    """Repetition, presence and frequency penalties, as the sampler applies
+    them: the repetition penalty to the tokens of the prompt and the output,
+    then the frequency and presence ones to the output tokens."""
+
+    kind = _PENALTIES
+
+    def __init__(self,
+                 repetition_penalty: float = 1.0,
+                 presence_penalty: float = 0.0,
+                 frequency_penalty: float = 0.0):
+        self.repetition_penalty = repetition_penalty
+        self.presence_penalty = presence_penalty
+        self.frequency_penalty = frequency_penalty
+
+    def uses_prompt(self) -> bool:
+        return self.repetition_penalty != 1.0
+
+    def params(self) -> tuple[float, float, float]:
+        return (self.repetition_penalty, self.presence_penalty,
+                self.frequency_penalty)
+
+    def apply_np(self, prompt_tokens_ids, past_tokens_ids, row):
+        vocab_size = row.shape[-1]
+        output = _in_vocab(past_tokens_ids, vocab_size)
+        repetition = np.float32(self.repetition_penalty)
+        if repetition != 1:
+            seen = np.unique(
+                np.concatenate(
+                    [_in_vocab(prompt_tokens_ids, vocab_size), output]))
+            x = row[seen]
+            row[seen] = np.where(x > 0, x / repetition, x * repetition)
+        if self.presence_penalty == 0 and self.frequency_penalty == 0:
+            return
+        ids, counts = np.unique(output, return_counts=True)
+        row[ids] -= np.float32(self.frequency_penalty) * counts.astype(
+            np.float32)
+        row[ids] -= np.float32(self.presence_penalty)
+
+
+class BadWordsLogitsProcessor(BuiltinLogitsProcessor):
+    """Mask the last token of every bad word whose other tokens end the
+    output, the token of single-token words always."""
+
+    kind = _BAD_WORDS
+
+    def __init__(self, bad_words_ids: list[list[int]]):
+        self.bad_words_ids = bad_words_ids
+
+    def token_ids(self) -> list[int]:
+        # every word as its length, then its ids
+        return list(
+            itertools.chain.from_iterable(
+                [len(word), *word] for word in self.bad_words_ids if word))
+
+    def check_token_ids(self, vocab_size: int) -> None:
+        # as NoBadWordsLogitsProcessor, bad words out of the vocabulary
+        # are an error rather than ignored
+        invalid_token_ids = [
+            token_id for word in self.bad_words_ids for token_id in word
+            if token_id < 0 or token_id >= vocab_size
+        ]
+        if invalid_token_ids:
+            raise ValueError(
+                f"The model vocabulary size is {vocab_size},"
+                f" but the following tokens"
+                f" were specified as bad: {invalid_token_ids}."
+                f" All token id values should be integers satisfying:"
+                f" 0 <= token_id < {vocab_size}.")
+
+    def apply_np(self, prompt_tokens_ids, past_tokens_ids, row):
+        self.check_token_ids(row.shape[-1])
+        past = list(past_tokens_ids)
+        for word in self.bad_words_ids:
+            prefix = len(word) - 1
+            if not word or prefix > len(past):
+                continue
+            if prefix and past[len(past) - prefix:] != list(word[:-1]):
+                continue
+            row[word[-1]] = -np.inf
+
+
+class MinTokensLogitsProcessor(BuiltinLogitsProcessor):
+    """Mask the stop tokens until the output has min_tokens tokens."""
+
+    kind = _MIN_TOKENS
+
+    def __init__(self, min_tokens: int, stop_token_ids: Sequence[int]):
+        self.min_tokens = min_tokens
+        self.stop_token_ids = list(stop_token_ids)
+
+    def params(self) -> tuple[float, float, float]:
+        return (float(self.min_tokens), 0.0, 0.0)
+
+    def token_ids(self) -> list[int]:
+        return self.stop_token_ids
+
+    def apply_np(self, prompt_tokens_ids, past_tokens_ids, row):
+        if len(past_tokens_ids) < self.min_tokens:
+            row[_in_vocab(self.stop_token_ids, row.shape[-1])] = -np.inf
+
+
+class AllowedTokenIdsLogitsProcessor(BuiltinLogitsProcessor):
+    """Mask every token but the allowed ones."""
+
+    kind = _ALLOWED_TOKEN_IDS
+
+    def __init__(self, allowed_token_ids: Sequence[int]):
+        self.allowed_token_ids = list(allowed_token_ids)
+
+    def token_ids(self) -> list[int]:
+        return self.allowed_token_ids
+
+    def apply_np(self, prompt_tokens_ids, past_tokens_ids, row):
+        allowed = _in_vocab(self.allowed_token_ids, row.shape[-1])
+        kept = row[allowed]
+        row[:] = -np.inf
+        row[allowed] = kept
+
+
+def as_builtin_logits_processor(
+        logits_processor) -> Optional[BuiltinLogitsProcessor]:
+    """The built-in equivalent of a logits processor, None for a custom
+    one."""
+    if isinstance(logits_processor, BuiltinLogitsProcessor):
+        return logits_processor
+    if (NoBadWordsLogitsProcessor is not None
+            and isinstance(logits_processor, NoBadWordsLogitsProcessor)):
+        return BadWordsLogitsProcessor(logits_processor.bad_words_ids)
+    return None
+
+
+def num_leading_builtins(logits_processors) -> int:
+    """Number of built-in processors at the head of a list, the part the
+    native engine can apply before any custom one."""
+    if _native_apply_logits_processors is None:
+        return 0
+    for i, logits_processor in enumerate(logits_processors):
+        if as_builtin_logits_processor(logits_processor) is None:
+            return i
+    return len(logits_processors)
+
+
+def apply_builtin_logits_processors(logits: np.ndarray,
+                                    rows: list[tuple[list, Sequence[int],
+                                                     Sequence[int]]],
+                                    num_threads: int = 0) -> None:
+    """
+    Apply the built-in processors of every row of float32 logits in place.
+    rows holds, per row of logits, its processors, its prompt token ids and
+    its output token ids.
+    """
+    assert _native_apply_logits_processors is not None
+    processors = [[as_builtin_logits_processor(p) for p in row[0]]
+                  for row in rows]
+    ops = list(itertools.chain.from_iterable(processors))
+    for op in ops:
+        op.check_token_ids(logits.shape[-1])
+    # the prompt, usually the longest part, is only packed for the rows
+    # that read it
+    prompts = [
+        row[1] if any(op.uses_prompt() for op in row_ops) else ()
+        for row, row_ops in zip(rows, processors)
+    ]
+    token_lens = [
+        len(prompt) + len(row[2]) for prompt, row in zip(prompts, rows)
+    ]
+    op_token_ids = [op.token_ids() for op in ops]
+
+    def offsets(lengths):
+        out = np.zeros(len(lengths) + 1, dtype=np.int64)
+        np.cumsum(lengths, out=out[1:])
+        return out
+
+    _native_apply_logits_processors(
+        logits,
+        np.fromiter(itertools.chain.from_iterable(
+            itertools.chain(prompt, row[2])
+            for prompt, row in zip(prompts, rows)),
+                    dtype=np.int32,
+                    count=sum(token_lens)),
+        offsets(token_lens),
+        np.array([len(prompt) for prompt in prompts], dtype=np.int32),
+        offsets([len(row_ops) for row_ops in processors]),
+        np.array([op.kind for op in ops], dtype=np.int32),
+        np.array([op.params() for op in ops],
+                 dtype=np.float32).reshape(-1, 3),
+        offsets([len(ids) for ids in op_token_ids]),
+        np.fromiter(itertools.chain.from_iterable(op_token_ids),
+                    dtype=np.int32,
+                    count=sum(len(ids) for ids in op_token_ids)),
+        num_threads=num_threads)
@@ -24,6 +24,8 @@ from typing import TYPE_CHECKING, Callable, Optional
 if TYPE_CHECKING:
     from vllm.lora.lora import LoRAMapping
 
+import mindspore as ms
+import numpy as np
 from mindspore import mint, nn, Parameter, ops, dtype
 from mindspore.common import dtype as mstype
 from mindspore.common.initializer import initializer
@@ -35,6 +37,52 @@ from vllm_mindspore.model_executor.utils import (get_model_context,
 from vllm_mindspore.lora.ops.torch_ops.lora_ops import (
     bgmv_expand, bgmv_expand_slice, bgmv_shrink, sgmv_expand,
     sgmv_expand_slice, sgmv_shrink)
+from vllm_mindspore.lora.punica_wrapper.utils import (PunicaMetadataBuilder,
+                                                      build_punica_metadata)
+
+
+def _make_metadata_builder(max_num_batched_tokens, max_batches,
+                           max_loras) -> Optional[PunicaMetadataBuilder]:
+    if build_punica_metadata is None or max_loras is None:
+        return None
+    return PunicaMetadataBuilder(max_num_batched_tokens, max_batches,
+                                 max_loras)
+
+
+def _update_metadata_native(wrapper: PunicaWrapperBase,
+                            builder: PunicaMetadataBuilder,
+                            mapping: "LoRAMapping",
+                            lora_index_to_id: list[Optional[int]],
+                            max_loras: int, vocab_size: int,
+                            extra_vocab_size: int) -> None:
+    """_update_base_metadata and _update_prefill_metadata of the wrapper,
+    from the metadata built natively in one pass."""
+    builder.build(mapping, lora_index_to_id, max_loras, vocab_size,
+                  extra_vocab_size)
+    num_tokens, num_prompts = builder.num_tokens, builder.num_prompts
+    batch_size = builder.batch_size
+    if num_tokens:
+        wrapper._token_lora_indices[:num_tokens] = ms.from_numpy(
+            builder.token_lora_indices[:num_tokens])
+        wrapper._embeddings_indices[:, :num_tokens] = ms.from_numpy(
+            builder.embeddings())
+    if num_prompts:
+        wrapper._sampler_indices[:num_prompts] = ms.from_numpy(
+            builder.sampler_indices[:num_prompts])
+        wrapper._sampler_indices_padded[:num_prompts] = ms.from_numpy(
+            builder.sampler_indices_padded[:num_prompts])
+    wrapper.indices_len[:] = [num_tokens, num_prompts, num_prompts, num_tokens]
+    if batch_size:
+        wrapper._seq_start_locs[:batch_size] = ms.from_numpy(
+            builder.seq_start_locs[:batch_size])
+        wrapper._seq_lengths[:batch_size] = ms.from_numpy(
+            builder.seq_lengths[:batch_size])
+        wrapper._lora_indices_per_batch[:batch_size] = ms.from_numpy(
+            builder.lora_indices_per_batch[:batch_size])
+    wrapper.batch_size = batch_size
+    wrapper.max_length = builder.max_length
+    wrapper.token_nums = num_tokens
+    wrapper.no_lora = builder.no_lora
 
 
 # The platforms that are compatible with the PyTorch-native implementation can
@@ -49,6 +97,20 @@ class PunicaWrapperNPU(PunicaWrapperBase):
     def __init__(self, max_num_batched_tokens, max_batches, device, **kwargs):
         PunicaWrapperBase.__init__(self, max_num_batched_tokens, max_batches,
                                    device)
+        self._metadata_builder = _make_metadata_builder(
+            max_num_batched_tokens, max_batches, kwargs.get("max_loras"))
+
+    def update_metadata(self, mapping: "LoRAMapping",
+                        lora_index_to_id: list[Optional[int]], max_loras: int,
+                        vocab_size: int, extra_vocab_size: int, **kwargs):
+        if self._metadata_builder is None:
+            super().update_metadata(mapping, lora_index_to_id, max_loras,
+                                    vocab_size, extra_vocab_size, **kwargs)
+            return
+        _update_metadata_native(self, self._metadata_builder, mapping,
+                                lora_index_to_id, max_loras, vocab_size,
+                                extra_vocab_size)
+        self.is_prefill = mapping.is_prefill
 
     def _shrink_prefill(
         self,
@@ -379,7 +441,8 @@ class GraphPunicaWrapperNPU(PunicaWrapperBase, nn.Cell):
     Key differences from PunicaWrapperNPU (eager mode):
     - Uses Parameter instead of tuple for weights
     - Implements __call__ method for graph compilation
-    - Uses grouped_matmul_v4 for efficient batch processing
+    - Uses grouped_matmul_v4 for efficient batch processing, over the
+      tokens gathered in the order of their LoRA slots
     """
 
     def __init__(self, max_num_batched_tokens, max_batches, device, **kwargs):
@@ -390,6 +453,18 @@ class GraphPunicaWrapperNPU(PunicaWrapperBase, nn.Cell):
         self.group_list = Parameter(initializer("ones", self.max_loras + 1,
                                                 dtype.int64),
                                     name="group_list")
+        self._metadata_builder = _make_metadata_builder(
+            max_num_batched_tokens, max_batches, self.max_loras)
+        # grouped_matmul_v4 takes the tokens of group g, slot g - 1, after
+        # those of group g - 1: the tokens are gathered grouped by slot
+        # before it, and back in the order of the batch after it. The
+        # tokens past the batch stay in place.
+        self._token_arange = np.arange(max_num_batched_tokens, dtype=np.int64)
+        self.token_order = Parameter(ms.Tensor(self._token_arange),
+                                     name="token_order")
+        self.token_restore_order = Parameter(ms.Tensor(self._token_arange),
+                                             name="token_restore_order")
+        self._token_order_identity = True
 
     def sgmv_shrink(
         self,
@@ -405,18 +480,47 @@ class GraphPunicaWrapperNPU(PunicaWrapperBase, nn.Cell):
                                     group_list_type=1)[0]
         return outputs
 
-    def sgmv_expand_slice(self, y, inputs, lora_b_weights, group_list):
+    def sgmv_expand_slice(self, y, inputs, lora_b_weights, group_list,
+                          restore_order):
         expand_outputs = grouped_matmul_v4([inputs], [lora_b_weights],
                                            group_list=group_list,
                                            split_item=3,
                                            group_type=0,
                                            group_list_type=1)[0]
-        outputs = ops.add(y, expand_outputs)
+        outputs = ops.add(y, ops.gather(expand_outputs, restore_order, 0))
         return outputs
 
+    def _update_token_order(self, order: Optional[np.ndarray]) -> None:
+        """Order the tokens of the batch by `order` for the grouped
+        matmuls, in the order of the batch when None."""
+        if order is None:
+            if not self._token_order_identity:
+                self.token_order.set_data(ms.Tensor(self._token_arange))
+                self.token_restore_order.set_data(
+                    ms.Tensor(self._token_arange))
+                self._token_order_identity = True
+            return
+        token_order = self._token_arange.copy()
+        token_order[:len(order)] = order
+        restore_order = np.empty_like(token_order)
+        restore_order[token_order] = self._token_arange
+        self.token_order.set_data(ms.Tensor(token_order))
+        self.token_restore_order.set_data(ms.Tensor(restore_order))
+        self._token_order_identity = False
+
     def update_metadata(self, mapping: "LoRAMapping",
                         lora_index_to_id: list[Optional[int]], max_loras: int,
                         vocab_size: int, extra_vocab_size: int):
+        if self._metadata_builder is not None:
+            builder = self._metadata_builder
+            _update_metadata_native(self, builder, mapping, lora_index_to_id,
+                                    max_loras, vocab_size, extra_vocab_size)
+            self.is_prefill = mapping.is_prefill
+            self._update_token_order(None if builder.grouped else builder.
+                                     token_order[:builder.num_tokens])
+            self.group_list.set_data(ms.Tensor(builder.group_list))
+            set_model_context("no_lora", self.no_lora)
+            return
         self._update_base_metadata(mapping, lora_index_to_id, max_loras,
                                    vocab_size, extra_vocab_size)
         # Update metadata required for prefill and decode operators.
@@ -430,6 +534,17 @@ class GraphPunicaWrapperNPU(PunicaWrapperBase, nn.Cell):
         lora_indices = lora_indices + 1
         new_tensor[lora_indices] = seq_len
         self.group_list.set_data(new_tensor.astype(dtype.int64))
+        slot_of_id = {
+            lora_id: slot
+            for slot, lora_id in enumerate(lora_index_to_id)
+            if lora_id is not None
+        }
+        token_slots = np.array(
+            [slot_of_id.get(lora_id, -1) for lora_id in mapping.index_mapping],
+            dtype=np.int64)
+        grouped = bool(np.all(token_slots[:-1] <= token_slots[1:]))
+        self._update_token_order(None if grouped else np.argsort(
+            token_slots, kind="stable"))
         set_model_context("no_lora", self.no_lora)
 
     def construct(self, y, x, lora_a_stacked, lora_b_stacked,
@@ -437,14 +552,17 @@ class GraphPunicaWrapperNPU(PunicaWrapperBase, nn.Cell):
         if get_model_context("no_lora"):
             return y
         x = x.reshape(-1, x.shape[-1])
+        num_tokens = x.shape[0]
         orign_shape = y.shape
         y = y.reshape(-1, y.shape[-1])
         if lora_bias_stacked is not None:
             selected_loras_bias = lora_bias_stacked[self.token_lora_indices]
             y = ops.add(y, selected_loras_bias)
+        x = ops.gather(x, self.token_order[:num_tokens], 0)
         shrink_outputs = self.sgmv_shrink(x, lora_a_stacked, self.group_list,
                                           scale)
-        outputs = self.sgmv_expand_slice(y, shrink_outputs, lora_b_stacked,
-                                         self.group_list)
+        outputs = self.sgmv_expand_slice(
+            y, shrink_outputs, lora_b_stacked, self.group_list,
+            self.token_restore_order[:num_tokens])
         outputs = outputs.reshape(orign_shape)
         return outputs
@@ -0,0 +1,78 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Punica metadata built natively, that of vLLM's convert_mapping and
+compute_meta in one pass over the token to LoRA mapping."""
+from typing import TYPE_CHECKING, Optional
+
+import numpy as np
+
+if TYPE_CHECKING:
+    from vllm.lora.layers import LoRAMapping
+
+try:
+    from vllm_mindspore._C_host import build_punica_metadata
+except ImportError:
+    build_punica_metadata = None
+
+
+class PunicaMetadataBuilder:
+    """
+    Host buffers of the Punica metadata of a wrapper, refilled every step
+    by build_punica_metadata before they are copied to the device.
+    """
+
+    def __init__(self, max_num_batched_tokens: int, max_batches: int,
+                 max_loras: int):
+        self.token_lora_indices = np.empty(max_num_batched_tokens,
+                                           dtype=np.int64)
+        # [2, num_tokens] from the start
+        self.embeddings_indices = np.empty(2 * max_num_batched_tokens,
+                                           dtype=np.int64)
+        self.sampler_indices = np.empty(max_num_batched_tokens,
+                                        dtype=np.int64)
+        self.sampler_indices_padded = np.empty(max_num_batched_tokens,
+                                               dtype=np.int64)
+        self.seq_start_locs = np.empty(max_batches, dtype=np.int64)
+        self.seq_lengths = np.empty(max_batches, dtype=np.int64)
+        self.lora_indices_per_batch = np.empty(max_batches, dtype=np.int64)
+        # tokens per slot + 1, group 0 those without LoRA
+        self.group_list = np.empty(max_loras + 1, dtype=np.int64)
+        self.token_order = np.empty(max_num_batched_tokens, dtype=np.int64)
+        self.num_tokens = 0
+        self.num_prompts = 0
+        self.batch_size = 0
+        self.max_length = 0
+        self.no_lora = False
+        # whether the tokens are grouped by slot in ascending order
+        self.grouped = True
+
+    def build(self, mapping: "LoRAMapping",
+              lora_index_to_id: list[Optional[int]], max_loras: int,
+              vocab_size: int, extra_vocab_size: int) -> None:
+        self.num_tokens = len(mapping.index_mapping)
+        self.num_prompts = len(mapping.prompt_mapping)
+        (self.batch_size, self.max_length, self.no_lora,
+         self.grouped) = build_punica_metadata(
+             mapping.index_mapping, mapping.prompt_mapping, lora_index_to_id,
+             max_loras, vocab_size, extra_vocab_size, self.token_lora_indices,
+             self.embeddings_indices, self.sampler_indices,
+             self.sampler_indices_padded, self.seq_start_locs,
+             self.seq_lengths, self.lora_indices_per_batch, self.group_list,
+             self.token_order)
+
+    def embeddings(self) -> np.ndarray:
+        return self.embeddings_indices[:2 * self.num_tokens].reshape(
+            2, self.num_tokens)
@@ -19,11 +19,14 @@
 # limitations under the License.
 """A layer that compute logits from hidden_stats."""
 import inspect
+import os
 from concurrent.futures import ThreadPoolExecutor
 from typing import Optional, no_type_check
 
+import numpy as np
 import vllm.envs as envs
 from mindspore import Tensor, jit, mint, nn
+from mindspore.common import dtype as mstype
 from vllm.config import current_platform, get_current_vllm_config
 from vllm.distributed import (tensor_model_parallel_all_gather,
                               tensor_model_parallel_gather)
@@ -32,6 +35,8 @@ from vllm.v1.sample.metadata import SamplingMetadata
 
 from vllm_mindspore.distributed.communication_op import (
     AllGatherFromModelParallelRegion)
+from vllm_mindspore.logits_process import (apply_builtin_logits_processors,
+                                           num_leading_builtins)
 from vllm_mindspore.model_executor.layers.vocab_parallel_embedding import (
     VocabParallelEmbedding)
 from vllm_mindspore.utils import is_310p
@@ -42,6 +47,11 @@ if envs.VLLM_LOGITS_PROCESSOR_THREADS is not None:
         envs.VLLM_LOGITS_PROCESSOR_THREADS)
 logger = init_logger(__name__)
 
+# Threads of the host pool the built-in logits processors of a batch are
+# split across, 0 for all of them.
+_LOGITS_PROCESSOR_THREADS = int(
+    os.getenv("VLLM_MS_LOGITS_PROCESSOR_THREADS", "0"))
+
 
 class LogitsProcessor(nn.Cell):
     """Process logits and apply logits processors from sampling metadata.
@@ -163,36 +173,60 @@ def _apply_logits_processors(
 ) -> Tensor:
     found_logits_processors = False
     logits_processed = 0
-    logits_row_ids_and_logits_row_futures = []
+    # rows whose leading built-in processors run natively, in one batch
+    builtin_rows = []
+    # rows left with custom processors, called one row at a time
+    custom_rows = []
     for seq_group in sampling_metadata.seq_groups:
         seq_ids = seq_group.seq_ids
         sampling_params = seq_group.sampling_params
         logits_processors = sampling_params.logits_processors
         if logits_processors:
             found_logits_processors = True
+            num_builtins = num_leading_builtins(logits_processors)
 
             for seq_id, logits_row_idx in zip(seq_ids,
                                               seq_group.sample_indices):
-                logits_row = logits[logits_row_idx]
                 past_tokens_ids = seq_group.seq_data[seq_id].output_token_ids
                 prompt_tokens_ids = seq_group.seq_data[seq_id].prompt_token_ids
-
-            if _logits_processor_threadpool is not None:
-                logits_row_ids_and_logits_row_futures.append(
-                    (logits_row_idx,
-                     _logits_processor_threadpool.submit(
-                         _apply_logits_processors_single_seq, logits_row,
-                         logits_processors, past_tokens_ids,
-                         prompt_tokens_ids)))
-            else:
-                logits[logits_row_idx] = \
-                    _apply_logits_processors_single_seq(
-                        logits_row, logits_processors, past_tokens_ids,
-                        prompt_tokens_ids)
+                if num_builtins > 0:
+                    builtin_rows.append(
+                        (logits_row_idx, logits_processors[:num_builtins],
+                         prompt_tokens_ids, past_tokens_ids))
+                if num_builtins < len(logits_processors):
+                    custom_rows.append(
+                        (logits_row_idx, logits_processors[num_builtins:],
+                         past_tokens_ids, prompt_tokens_ids))
 
         logits_processed += len(seq_group.sample_indices) + len(
             seq_group.prompt_logprob_indices)
 
+    if builtin_rows:
+        row_ids = Tensor([row[0] for row in builtin_rows], dtype=mstype.int64)
+        rows = mint.index_select(logits, 0,
+                                 row_ids).astype(mstype.float32).asnumpy()
+        rows = np.require(rows, requirements=["C", "W"])
+        apply_builtin_logits_processors(rows,
+                                        [row[1:] for row in builtin_rows],
+                                        num_threads=_LOGITS_PROCESSOR_THREADS)
+        logits[row_ids] = Tensor.from_numpy(rows).astype(logits.dtype)
+
+    logits_row_ids_and_logits_row_futures = []
+    for (logits_row_idx, logits_processors, past_tokens_ids,
+         prompt_tokens_ids) in custom_rows:
+        logits_row = logits[logits_row_idx]
+        if _logits_processor_threadpool is not None:
+            logits_row_ids_and_logits_row_futures.append(
+                (logits_row_idx,
+                 _logits_processor_threadpool.submit(
+                     _apply_logits_processors_single_seq, logits_row,
+                     logits_processors, past_tokens_ids, prompt_tokens_ids)))
+        else:
+            logits[logits_row_idx] = \
+                _apply_logits_processors_single_seq(
+                    logits_row, logits_processors, past_tokens_ids,
+                    prompt_tokens_ids)
+
     for logits_row_idx, future in logits_row_ids_and_logits_row_futures:
         logits[logits_row_idx] = future.result()
 
@@ -19,7 +19,94 @@
 # limitations under the License.
 
 import mindspore as ms
+import numpy as np
+from mindspore import mint
+from vllm.model_executor.layers.pooler import CLSPool, LastPool, MeanPool
+from vllm.v1.pool.metadata import PoolingCursor
+
+from vllm_mindspore import _custom_ops as custom_ops
+
+_original_cls_pool_forward_all = CLSPool.forward_all
+_original_last_pool_forward_all = LastPool.forward_all
+_original_mean_pool_forward_all = MeanPool.forward_all
 
 
 def forward_chunk(self, pooled_data: ms.Tensor) -> ms.Tensor:
-    return ms.mint.nn.functional.normalize(pooled_data, p=2, dim=-1)
\ No newline at end of file
+    return ms.mint.nn.functional.normalize(pooled_data, p=2, dim=-1)
+
+
+def _segment_pool(hidden_states: ms.Tensor, pooling_cursor: PoolingCursor,
+                  pooling_type: int) -> ms.Tensor:
+    """Pool the requests of the cursor with one segment_pool call, carrying
+    the CLS rows and MEAN sums of prompts in chunked prefill across steps."""
+    num_reqs = len(pooling_cursor.index)
+    hidden_size = hidden_states.shape[-1]
+    state = getattr(pooling_cursor, "partial_state", None)
+    if state is None:
+        num_prev = np.zeros(num_reqs, dtype=np.int32)
+        num_scheduled = pooling_cursor.num_scheduled_tokens_cpu.asnumpy()
+        prompt_lens = pooling_cursor.prompt_lens_cpu.asnumpy()
+    else:
+        rows = np.asarray(pooling_cursor.index)
+        num_prev = state.num_computed_tokens_np[rows]
+        num_scheduled = state.num_scheduled_tokens_np[rows]
+        prompt_lens = state.prompt_lens_np[rows]
+    carried = np.flatnonzero(num_prev > 0)
+    carries = pooling_type != custom_ops.SEGMENT_POOL_LAST
+
+    partial_sums = mint.empty((num_reqs, hidden_size), dtype=ms.float32)
+    if carries:
+        for i in carried:
+            # without a state nothing is carried in; a prompt may also start
+            # past tokens that were never pooled, on a prefix cache hit
+            req_id = state.req_ids[rows[i]]
+            assert req_id in state.partial_sums, (
+                "partial prefill of a prompt whose earlier tokens were not "
+                "pooled is not supported with CLS or MEAN pooling")
+            partial_sums[i] = state.partial_sums[req_id]
+    pooled_dtype = (ms.float32 if pooling_type
+                    == custom_ops.SEGMENT_POOL_MEAN else hidden_states.dtype)
+    pooled = mint.empty((num_reqs, hidden_size), dtype=pooled_dtype)
+    custom_ops.segment_pool(
+        pooled, partial_sums, hidden_states,
+        pooling_cursor.first_token_indices_gpu,
+        pooling_cursor.last_token_indices_gpu,
+        ms.from_numpy(np.ascontiguousarray(prompt_lens, dtype=np.int32)),
+        ms.from_numpy(np.ascontiguousarray(num_prev, dtype=np.int32)),
+        pooling_type)
+
+    if carries and state is not None:
+        going_on = num_prev + num_scheduled < prompt_lens
+        for i in range(num_reqs):
+            req_id = state.req_ids[rows[i]]
+            if going_on[i]:
+                state.partial_sums[req_id] = partial_sums[i]
+            else:
+                state.partial_sums.pop(req_id, None)
+    return pooled
+
+
+def cls_pool_forward_all(self, hidden_states: ms.Tensor,
+                         pooling_cursor: PoolingCursor) -> ms.Tensor:
+    if custom_ops.is_custom_op_available("segment_pool"):
+        return _segment_pool(hidden_states, pooling_cursor,
+                             custom_ops.SEGMENT_POOL_CLS)
+    return _original_cls_pool_forward_all(self, hidden_states, pooling_cursor)
+
+
+def last_pool_forward_all(self, hidden_states: ms.Tensor,
+                          pooling_cursor: PoolingCursor) -> ms.Tensor:
+    if custom_ops.is_custom_op_available("segment_pool"):
+        return _segment_pool(hidden_states, pooling_cursor,
+                             custom_ops.SEGMENT_POOL_LAST)
+    return _original_last_pool_forward_all(self, hidden_states,
+                                           pooling_cursor)
+
+
+def mean_pool_forward_all(self, hidden_states: ms.Tensor,
+                          pooling_cursor: PoolingCursor) -> ms.Tensor:
+    if custom_ops.is_custom_op_available("segment_pool"):
+        return _segment_pool(hidden_states, pooling_cursor,
+                             custom_ops.SEGMENT_POOL_MEAN)
+    return _original_mean_pool_forward_all(self, hidden_states,
+                                           pooling_cursor)
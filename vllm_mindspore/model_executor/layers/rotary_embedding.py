@@ -41,6 +41,12 @@ from vllm_mindspore.model_executor.models.vision import (
 from vllm_mindspore.model_executor.utils import get_model_context
 from vllm_mindspore.utils import MS_DTYPE_TO_SIZE, is_310p
 
+try:
+    from vllm_mindspore._C_host import (mrope_positions as
+                                        _native_mrope_positions)
+except ImportError:
+    _native_mrope_positions = None
+
 YARN_MSCALE_COEFFICIENT = 0.1
 YARN_DEFAULT_SCALE = 1.0
 
@@ -273,6 +279,47 @@ class InferLlama3RotaryEmbedding(InferRotaryEmbedding):
         return new_freqs
 
 
+def _native_vl_input_positions(
+    input_tokens: list[int],
+    hf_config: PretrainedConfig,
+    image_grid_thw: Union[list[list[int]], Tensor],
+    video_grid_thw: Union[list[list[int]], Tensor],
+    second_per_grid_ts: Optional[list[float]],
+    context_len: int,
+    seq_len: Optional[int],
+    per_frame_videos: bool,
+) -> tuple[Tensor, int]:
+    """The mrope positions of the Qwen2/2.5-VL and Qwen3-VL layouts in one
+    native pass over the prompt, written into an int64 buffer that the
+    returned tensor shares."""
+    if isinstance(image_grid_thw, Tensor):
+        image_grid_thw = image_grid_thw.tolist()
+    if isinstance(video_grid_thw, Tensor):
+        video_grid_thw = video_grid_thw.tolist()
+    if isinstance(second_per_grid_ts, Tensor):
+        second_per_grid_ts = second_per_grid_ts.tolist()
+    # the bounds of llm_positions[:, context_len:seq_len]
+    start, stop, _ = slice(context_len, seq_len).indices(len(input_tokens))
+    stop = max(start, stop)
+    out = np.empty((3, stop - start), dtype=np.int64)
+    mrope_position_delta = _native_mrope_positions(
+        input_tokens,
+        image_grid_thw,
+        video_grid_thw,
+        second_per_grid_ts,
+        out,
+        image_token_id=hf_config.image_token_id,
+        video_token_id=hf_config.video_token_id,
+        vision_start_token_id=hf_config.vision_start_token_id,
+        spatial_merge_size=hf_config.vision_config.spatial_merge_size,
+        tokens_per_second=getattr(hf_config.vision_config,
+                                  "tokens_per_second", 1.0),
+        per_frame_videos=per_frame_videos,
+        context_len=start,
+        seq_len=stop)
+    return ms.from_numpy(out), mrope_position_delta
+
+
 class MRotaryEmbedding(RotaryEmbedding):
     """Rotary Embedding with Multimodal Sections."""
 
@@ -576,6 +623,15 @@ class MRotaryEmbedding(RotaryEmbedding):
         second_per_grid_ts: list[float] | None = None,
     ) -> tuple[Tensor, int]:
         """Get mrope input positions and delta value."""
+        if _native_mrope_positions is not None:
+            return _native_vl_input_positions(input_tokens,
+                                              hf_config,
+                                              image_grid_thw,
+                                              video_grid_thw,
+                                              second_per_grid_ts,
+                                              context_len,
+                                              seq_len,
+                                              per_frame_videos=True)
 
         video_grid_thw = [[1, h, w] for t, h, w in video_grid_thw
                           for _ in range(t)]
@@ -1067,6 +1123,16 @@ class MRotaryEmbedding(RotaryEmbedding):
         seq_len: Optional[int] = None,
     ) -> tuple[Tensor, int]:
         """Get mrope input positions and delta value."""
+        if _native_mrope_positions is not None:
+            return _native_vl_input_positions(input_tokens,
+                                              hf_config,
+                                              image_grid_thw,
+                                              video_grid_thw,
+                                              second_per_grid_ts,
+                                              context_len,
+                                              seq_len,
+                                              per_frame_videos=False)
+
         image_token_id = hf_config.image_token_id
         video_token_id = hf_config.video_token_id
         vision_start_token_id = hf_config.vision_start_token_id
@@ -18,6 +18,9 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import contextlib
+import functools
+import os
 from collections.abc import Generator
 from typing import Any
 
@@ -26,11 +29,120 @@ import numpy as np
 from mindspore import Parameter
 from safetensors import safe_open
 from tqdm.auto import tqdm
+from vllm.logger import init_logger
 from vllm.model_executor.model_loader.weight_utils import (_BAR_FORMAT,
                                                            enable_tqdm)
 
 from vllm_mindspore.utils import cast_weight_for_310p, is_310p
 
+try:
+    from vllm_mindspore._C_host import SafetensorsFile
+except ImportError:
+    SafetensorsFile = None
+
+logger = init_logger(__name__)
+
+# "0" reads the checkpoint through safetensors.safe_open even when the
+# native loader is built.
+_NATIVE_SAFETENSORS = os.getenv("VLLM_MS_NATIVE_SAFETENSORS", "1") != "0"
+# Threads of the host pool a native read is split across, 0 for all of them;
+# every rank of the node loads its shards at the same time.
+_SAFETENSORS_LOAD_THREADS = int(
+    os.getenv("VLLM_MS_SAFETENSORS_LOAD_THREADS", "8"))
+# MiB past every tensor read the kernel is asked to fetch ahead, 0 to leave
+# the readahead to the kernel.
+_SAFETENSORS_READAHEAD_MB = int(
+    os.getenv("VLLM_MS_SAFETENSORS_READAHEAD_MB", "64"))
+
+# numpy dtypes of the safetensors ones, "bfloat16" as MindSpore registers it
+_SAFETENSORS_NP_DTYPES = {
+    "BOOL": np.bool_,
+    "U8": np.uint8,
+    "I8": np.int8,
+    "I16": np.int16,
+    "U16": np.uint16,
+    "F16": np.float16,
+    "BF16": "bfloat16",
+    "I32": np.int32,
+    "U32": np.uint32,
+    "F32": np.float32,
+    "F64": np.float64,
+    "I64": np.int64,
+    "U64": np.uint64,
+}
+
+
+@functools.cache
+def _safetensors_np_dtype(dtype: str):
+    """numpy dtype of a safetensors dtype, None if numpy has none."""
+    try:
+        return np.dtype(_SAFETENSORS_NP_DTYPES[dtype])
+    except (KeyError, TypeError):
+        return None
+
+
+class NativeSafeSlice:
+    """
+    A tensor of a SafetensorsFile, read on demand like the PySafeSlice of
+    safe_open. Slicing one dim with unit step, or taking one index of it,
+    copies only these rows out of the file, straight into the returned
+    array; any other index reads the whole tensor first.
+    """
+
+    def __init__(self, file, name: str):
+        self._file = file
+        self._name = name
+        dtype, self._shape = file.info(name)
+        self._dtype = _safetensors_np_dtype(dtype)
+        self._st_dtype = dtype
+
+    def get_shape(self) -> list[int]:
+        return list(self._shape)
+
+    def get_dtype(self) -> str:
+        return self._st_dtype
+
+    def read(self, dim: int = -1, start: int = 0, size: int = -1):
+        """Rows [start, start + size) of dim, clamped; dim -1 reads all."""
+        shape = list(self._shape)
+        if dim >= 0:
+            start = min(start, shape[dim])
+            end = shape[dim] if size < 0 else min(start + size, shape[dim])
+            shape[dim] = end - start
+        out = np.empty(shape, dtype=self._dtype)
+        self._file.read(self._name,
+                        out,
+                        dim=dim,
+                        start=start,
+                        size=size,
+                        num_threads=_SAFETENSORS_LOAD_THREADS)
+        return out
+
+    def __getitem__(self, index):
+        if not isinstance(index, tuple):
+            index = (index, )
+        if index and index[-1] is Ellipsis:
+            index = index[:-1]
+        dims = [
+            d for d, idx in enumerate(index)
+            if not (isinstance(idx, slice) and idx == slice(None))
+        ]
+        if not dims:
+            return self.read()
+        dim = dims[0]
+        idx = index[dim]
+        if len(dims) == 1 and dim < len(self._shape):
+            if (isinstance(idx, (int, np.integer))
+                    and 0 <= idx < self._shape[dim]):
+                return self.read(dim, int(idx), 1).squeeze(dim)
+            if (isinstance(idx, slice) and idx.step in (None, 1)
+                    and (idx.start or 0) >= 0
+                    and (idx.stop is None or idx.stop >= 0)):
+                start = idx.start or 0
+                size = -1 if idx.stop is None else max(idx.stop - start, 0)
+                return self.read(dim, start, size)
+        return self.read()[index]
+
 
 def _finalize_weight(loaded_weight):
     """
@@ -63,6 +175,11 @@ def split_loaded_weight(loaded_weight, shard_dim, start_idx, shard_size):
         loaded_weight = get_loaded_weight(loaded_weight)
         return loaded_weight
 
+    if isinstance(loaded_weight, NativeSafeSlice):
+        # only the shard of this rank is copied out of the file
+        loaded_weight = loaded_weight.read(shard_dim, start_idx, shard_size)
+        return _finalize_weight(loaded_weight)
+
     end_idx = start_idx + shard_size
     if shard_dim == 0:
         loaded_weight = loaded_weight[start_idx:end_idx]
@@ -88,6 +205,10 @@ def safetensors_weights_iterator(
             disable=not enable_tqdm(use_tqdm_on_load),
             bar_format=_BAR_FORMAT,
     ):
+        native_file = _open_native_safetensors(st_file)
+        if native_file is not None:
+            yield from _native_safetensors_weights(st_file, native_file)
+            continue
         with safe_open(st_file, framework="np") as f:
             for name in f.keys():  # noqa: SIM118
                 # Return a lightweight PySafeSlice object that uses file
@@ -98,6 +219,34 @@ def safetensors_weights_iterator(
                 yield name, param
 
 
+def _open_native_safetensors(st_file: str):
+    """The SafetensorsFile of st_file, None to read it with safe_open."""
+    if SafetensorsFile is None or not _NATIVE_SAFETENSORS:
+        return None
+    try:
+        return SafetensorsFile(st_file,
+                               readahead=_SAFETENSORS_READAHEAD_MB << 20)
+    except ValueError as e:
+        logger.warning("Reading %s with safe_open: %s", st_file, e)
+        return None
+
+
+def _native_safetensors_weights(
+        st_file: str, native_file) -> Generator[tuple[str, Any], None, None]:
+    """Weights of a mapped file, in the order of their data in it."""
+    with contextlib.ExitStack() as stack:
+        fallback = None
+        for name in native_file.keys():
+            if _safetensors_np_dtype(native_file.info(name)[0]) is not None:
+                yield name, NativeSafeSlice(native_file, name)
+                continue
+            # dtypes numpy has no type for, e.g. float8, go through safe_open
+            if fallback is None:
+                fallback = stack.enter_context(
+                    safe_open(st_file, framework="np"))
+            yield name, fallback.get_slice(name)
+
+
 def default_weight_loader(param: Parameter, loaded_weight: Any) -> None:
     """Default weight loader."""
     loaded_weight = get_loaded_weight(loaded_weight)
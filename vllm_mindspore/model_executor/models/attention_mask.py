@@ -21,6 +21,9 @@ from mindspore import Tensor
 from mindspore import dtype as mstype
 from mindspore import mint
 
+from vllm_mindspore._custom_ops import attention_mask as fused_attention_mask
+from vllm_mindspore._custom_ops import is_custom_op_available
+
 # yapf conflicts with isort
 # yapf: disable  # noqa: ERA001
 
@@ -39,6 +42,19 @@ FA:ASD-V2.1.5
 # yapf: enable  # noqa: ERA001
 
 
+def causal_mask_offsets(query_lens_np: np.ndarray,
+                        seq_lens_np: np.ndarray) -> np.ndarray:
+    """
+    Compact form of the decode mask of a batch, one int32 per request: row t
+    of request i attends to the columns up to offset[i] + t, its context and
+    the query tokens up to its own. Requests with at most one query token
+    attend to every column, as in `LowerTriangularMask.create_mask`.
+    """
+    max_seq_len = seq_lens_np.max()
+    return np.where(query_lens_np > 1, seq_lens_np - query_lens_np,
+                    max_seq_len).astype(np.int32)
+
+
 class LowerTriangularMask:
     r"""
     Provide Infer model attention mask.
@@ -64,6 +80,8 @@ class LowerTriangularMask:
             shape=(self.cached_mask_len, self.cached_mask_len), dtype=np.int8),
                                           k=1),
                                   dtype=self.dtype) * self.decode_mask_coeff
+        # builds the mask past cached_mask_len in one kernel
+        self.fused_mask = is_custom_op_available("attention_mask")
 
     def create_mask(self, query_lens_np, seq_lens_np):
         '''
@@ -73,6 +91,9 @@ class LowerTriangularMask:
         0 0 0 0 0 0
         0 0 0 0 0 0
         '''
+        if self.fused_mask:
+            return self.create_mask_fused(query_lens_np, seq_lens_np)
+
         max_seq_len = seq_lens_np.max().item()
         total_q_len = query_lens_np.sum().item()
         attention_mask = mint.zeros((total_q_len, max_seq_len),
@@ -111,6 +132,21 @@ class LowerTriangularMask:
 
         return attention_mask
 
+    def create_mask_fused(self, query_lens_np, seq_lens_np):
+        '''
+        create_mask in one kernel, from the per-request offsets of
+        causal_mask_offsets, without zeroing the mask first
+        '''
+        max_seq_len = seq_lens_np.max().item()
+        total_q_len = query_lens_np.sum().item()
+        attention_mask = mint.empty((total_q_len, max_seq_len),
+                                    dtype=self.dtype)
+        fused_attention_mask(
+            attention_mask, Tensor(query_lens_np.astype(np.int32)),
+            Tensor(causal_mask_offsets(query_lens_np, seq_lens_np)),
+            self.decode_mask_coeff)
+        return attention_mask
+
     def gen_attention_mask(self, is_prefill: bool, position_ids: Tensor,
                            query_lens_np: np.ndarray, seq_lens_np: np.ndarray):
         max_query_len = query_lens_np.max()
@@ -0,0 +1,146 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""The host arena of the multimodal inputs of the worker: their tensors are
+placed in it once, as a request reaches the model runner, and
+the batches of the encoder are views of it rather than concatenations of
+copies."""
+import os
+from typing import Optional
+
+import mindspore
+import numpy as np
+from vllm.logger import init_logger
+from vllm.multimodal.inputs import MultiModalKwargsItem
+
+try:
+    from vllm_mindspore._C_host import MmArena, buffer_view
+except ImportError:
+    MmArena = None
+    buffer_view = None
+
+logger = init_logger(__name__)
+
+# MiB of the arena, 0 to collate multimodal inputs by concatenation
+_ARENA_MB = int(os.getenv("VLLM_MS_MM_ARENA_MB", "1024"))
+# Lock the arena in RAM; it then takes its whole size up front
+_ARENA_LOCK = os.getenv("VLLM_MS_MM_ARENA_LOCK", "0") == "1"
+
+_arena: Optional["MultiModalArena"] = None
+
+
+class MultiModalArena:
+    """
+    Tensors of multimodal inputs in one MmArena. A placed tensor is a view
+    of an MmArenaSlot, whose range is freed once nothing holds the tensor;
+    tensors placed one after the other are back to back in the arena.
+    """
+
+    def __init__(self, capacity: int, lock: bool = False):
+        self.arena = MmArena(capacity, lock=lock)
+        self._address = self.arena.address
+        self._capacity = self.arena.capacity
+
+    def offset_of(self, array: np.ndarray) -> Optional[int]:
+        """Offset of a C-contiguous array in the arena, None if it is not
+        in it."""
+        if not array.flags.c_contiguous:
+            return None
+        offset = array.__array_interface__["data"][0] - self._address
+        if offset < 0 or offset + array.nbytes > self._capacity:
+            return None
+        return offset
+
+    def place_array(self, array: np.ndarray) -> Optional[mindspore.Tensor]:
+        """A copy of the array in the arena as a tensor, None if it is empty
+        or does not fit."""
+        if array.nbytes == 0:
+            return None
+        try:
+            slot = self.arena.place(np.ascontiguousarray(array),
+                                    align=array.itemsize)
+        except MemoryError:
+            logger.debug("Multimodal input of %d bytes does not fit in the "
+                         "arena, %d bytes used", array.nbytes,
+                         self.arena.used_bytes)
+            return None
+        view = np.frombuffer(slot, dtype=array.dtype).reshape(array.shape)
+        return mindspore.from_numpy(view)
+
+    def place(self, tensor: mindspore.Tensor) -> mindspore.Tensor:
+        """The tensor as a view of the arena, the tensor itself when it
+        already is one, or cannot be."""
+        if tensor.dtype == mindspore.bfloat16:
+            # numpy has no bfloat16 to view the range with
+            return tensor
+        array = tensor.numpy()
+        if self.offset_of(array) is not None:
+            return tensor
+        placed = self.place_array(array)
+        return tensor if placed is None else placed
+
+    def place_item(self, item: MultiModalKwargsItem) -> None:
+        """Place the tensors of the fields of one multimodal item."""
+        for elem in item.values():
+            if isinstance(elem.data, mindspore.Tensor):
+                elem.data = self.place(elem.data)
+
+    def collate(self, tensors: list[mindspore.Tensor],
+                stack: bool) -> Optional[mindspore.Tensor]:
+        """The tensors, all of one dtype and C-contiguous, concatenated
+        along dim 0 or stacked along a new one: a read-only view when they
+        are back to back in the arena, else gathered from it in one native
+        copy. None if one of them is not in the arena."""
+        if any(t.dtype == mindspore.bfloat16 for t in tensors):
+            return None
+        arrays = [t.numpy() for t in tensors]
+        offsets = [self.offset_of(a) for a in arrays]
+        if None in offsets or len({a.dtype for a in arrays}) != 1:
+            return None
+        if stack:
+            shape = (len(arrays), *arrays[0].shape)
+        else:
+            shape = (sum(a.shape[0] for a in arrays), *arrays[0].shape[1:])
+        dtype = arrays[0].dtype
+        sizes = [a.nbytes for a in arrays]
+        if all(offsets[i] + sizes[i] == offsets[i + 1]
+               for i in range(len(arrays) - 1)):
+            # One span of the arena, viewed through a buffer that holds the
+            # tensors, and so the slots of its ranges, as long as it lives.
+            # The items are shared by the requests the receiver cache hands
+            # them to: the view is read-only.
+            start = offsets[0]
+            span = buffer_view(memoryview(self.arena)[start:start +
+                                                      sum(sizes)],
+                               owner=tuple(tensors))
+            view = np.frombuffer(span, dtype=dtype)
+            return mindspore.from_numpy(view.reshape(shape))
+        out = np.empty(shape, dtype=dtype)
+        self.arena.gather(offsets, sizes, out)
+        return mindspore.from_numpy(out)
+
+
+def init_mm_arena() -> Optional[MultiModalArena]:
+    """Create the arena of this process, None without the host extension
+    or with VLLM_MS_MM_ARENA_MB=0."""
+    global _arena
+    if _arena is None and MmArena is not None and _ARENA_MB > 0:
+        _arena = MultiModalArena(_ARENA_MB << 20, lock=_ARENA_LOCK)
+    return _arena
+
+
+def get_mm_arena() -> Optional[MultiModalArena]:
+    """The arena of this process, None until the model runner creates it."""
+    return _arena
@@ -27,6 +27,8 @@ import torch
 from vllm.multimodal import MultiModalKwargs
 from vllm.multimodal.inputs import MultiModalFieldElem, is_list_of
 
+from vllm_mindspore.multimodal.arena import get_mm_arena
+
 NestedTensors = Union[
     list["NestedTensors"],
     list[mindspore.Tensor],
@@ -58,6 +60,13 @@ def batched_reduce_data(self, batch: list[NestedTensors], *, pin_memory):
             return mindspore.from_numpy(np.expand_dims(batch[0].numpy(), 0))
         first_shape = batch[0].shape
         if all(elem.shape == first_shape for elem in batch):
+            # A view of the multimodal arena when the inputs were placed in
+            # it back to back.
+            arena = get_mm_arena()
+            stacked = None if arena is None else arena.collate(batch,
+                                                               stack=True)
+            if stacked is not None:
+                return stacked
             return mindspore.from_numpy(np.stack([b.numpy() for b in batch]))
 
     return batch
@@ -81,6 +90,13 @@ def flat_reduce_data(self, batch: list[NestedTensors], *, pin_memory):
         first_shape = _expect_same_shape(batch[0])
 
         if all(_expect_same_shape(elem) == first_shape for elem in batch):
+            # A view of the multimodal arena when the inputs were placed in
+            # it back to back.
+            arena = get_mm_arena()
+            if arena is not None and self.dim == 0:
+                concatenated = arena.collate(batch, stack=False)
+                if concatenated is not None:
+                    return concatenated
             return mindspore.from_numpy(
                 np.concatenate([b.numpy() for b in batch], axis=self.dim))
 
@@ -129,4 +145,8 @@ def _try_stack(nested_tensors: NestedTensors,
         # The tensors have incompatible shapes and can't be stacked.
         return tensors_
 
+    arena = get_mm_arena()
+    stacked = None if arena is None else arena.collate(tensors_, stack=True)
+    if stacked is not None:
+        return stacked
     return mindspore.from_numpy(np.stack([t.numpy() for t in tensors_]))
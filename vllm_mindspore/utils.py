@@ -273,6 +273,11 @@ def register_connector():
         from vllm.distributed.kv_transfer.kv_connector.factory import (
             KVConnectorFactory)
 
+        # swap KV cache blocks out to host memory and back
+        KVConnectorFactory.register_connector(
+            "MsHostOffloadingConnector",
+            "vllm_mindspore.distributed.kv_transfer.host_offloading_connector",
+            "MsHostOffloadingConnector")
         # use D2H for KVtransfer
         KVConnectorFactory.register_connector(
             "DLLMDsConnector", "dllm.dkvc.v1.dllm_ds_connector",
@@ -225,7 +225,10 @@ class MsAttentionMetadataBuilder:
         max_seq_len = common_attn_metadata.max_seq_len
         seq_lens = common_attn_metadata.seq_lens
         block_table_tensor = common_attn_metadata.block_table_tensor
-        slot_mapping = ms.from_numpy(common_attn_metadata.slot_mapping_np)
+        # the drafter may hand over a slot mapping computed on device
+        slot_mapping = common_attn_metadata.slot_mapping
+        if slot_mapping is None:
+            slot_mapping = ms.from_numpy(common_attn_metadata.slot_mapping_np)
 
         seq_lens_np = common_attn_metadata.seq_lens_np
         num_computed_tokens_np = common_attn_metadata.num_computed_tokens_np
@@ -279,3 +282,12 @@ class MsCommonAttentionMetadata(CommonAttentionMetadata):
     num_computed_tokens_np: np.ndarray = None
     slot_mapping_np: np.ndarray = None
     query_start_loc_np: np.ndarray = None
+    # Host copies of the spec decode inputs of the step, for the drafter:
+    # draft tokens scheduled per request, and the partial prefill requests
+    # whose sampled token is discarded.
+    num_draft_tokens_np: np.ndarray = None
+    discard_mask_np: np.ndarray = None
+    # The indices to sample of the draft step, left by the custom op of
+    # prepare_next_token_ids_padded for prepare_inputs_padded, which the
+    # runner calls with this metadata.
+    token_indices_to_sample: Optional[ms.Tensor] = None
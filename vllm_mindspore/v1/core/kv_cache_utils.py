@@ -0,0 +1,155 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Adapted from
+# https://github.com/vllm-project/vllm/blob/v0.11.0/vllm/v1/core/kv_cache_utils.py
+#
+# Copyright 2025 Huawei Technologies Co., Ltd.
+# Copyright 2024-2025 The vLLM team.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Prefix caching block hashes computed natively, all the new full blocks of
+a request in one call instead of one hash_block_tokens per block."""
+import os
+import pickle
+from typing import Any, Callable, Optional
+
+from vllm.logger import init_logger
+from vllm.utils import sha256
+from vllm.v1.core import kv_cache_utils
+from vllm.v1.core.kv_cache_utils import (BlockHash,
+                                         generate_block_hash_extra_keys)
+from vllm.v1.request import Request
+
+try:
+    from vllm_mindspore._C_host import hash_request_blocks
+except ImportError:
+    hash_request_blocks = None
+
+logger = init_logger(__name__)
+
+# "compat": the prefix caching hash algorithm of vLLM, natively when it is
+# sha256, byte for byte, and by vLLM's hasher otherwise; "python": vLLM's
+# hasher always; "fast": a 128-bit non-cryptographic hash whatever the
+# algorithm, open to collisions crafted across requests and not understood
+# by KV connectors, only for trusted deployments without them
+_BLOCK_HASH = os.getenv("VLLM_MS_BLOCK_HASH", "compat")
+
+_vllm_get_request_block_hasher = kv_cache_utils.get_request_block_hasher
+
+# (b"", (0, 0, 0, 0), extra_keys) pickles to the frame header, b"" and the
+# token tuple, both memoized as the parent hash and the block token ids are,
+# then the pickle of extra_keys and the closing TUPLE3, MEMOIZE and STOP.
+_EXTRA_KEYS_START = len(pickle.dumps((b"", (0, 0, 0, 0), None),
+                                    protocol=5)) - len(b"N\x87\x94.")
+_EXTRA_KEYS_END = -len(b"\x87\x94.")
+
+
+def _pickled_extra_keys(extra_keys: tuple[Any, ...]) -> bytes:
+    """The pickle of extra_keys as it appears in the pickle of
+    (parent_block_hash, block_token_ids, extra_keys) that sha256 hashes."""
+    data = pickle.dumps((b"", (0, 0, 0, 0), extra_keys), protocol=5)
+    return data[_EXTRA_KEYS_START:_EXTRA_KEYS_END]
+
+
+def _block_extra_keys(request: Request, start_token_idx: int,
+                      num_blocks: int,
+                      block_size: int) -> Optional[list[Optional[bytes]]]:
+    """The pickled extra keys of each of the num_blocks blocks from
+    start_token_idx on, None when none has any."""
+    curr_mm_idx = -1 if start_token_idx > 0 else 0
+    if not request.mm_features:
+        # only the first block of the prompt may differ, by its cache salt
+        first_keys, _ = generate_block_hash_extra_keys(
+            request, start_token_idx, start_token_idx + block_size,
+            curr_mm_idx)
+        next_keys = first_keys
+        if start_token_idx == 0 and num_blocks > 1:
+            next_keys, _ = generate_block_hash_extra_keys(
+                request, block_size, 2 * block_size, -1)
+        if first_keys is None and next_keys is None:
+            return None
+        extra_keys = [first_keys] + [next_keys] * (num_blocks - 1)
+    else:
+        extra_keys = []
+        for start in range(start_token_idx,
+                           start_token_idx + num_blocks * block_size,
+                           block_size):
+            block_keys, curr_mm_idx = generate_block_hash_extra_keys(
+                request, start, start + block_size, curr_mm_idx)
+            extra_keys.append(block_keys)
+    pickled: dict[tuple[Any, ...], bytes] = {}
+    return [
+        None if keys is None else pickled.setdefault(
+            keys, _pickled_extra_keys(keys)) for keys in extra_keys
+    ]
+
+
+def _native_block_hash_algo(
+        caching_hash_fn: Callable[[Any], bytes]) -> Optional[str]:
+    if hash_request_blocks is None or _BLOCK_HASH == "python":
+        return None
+    hash_fn_name = getattr(caching_hash_fn, "__name__", caching_hash_fn)
+    if _BLOCK_HASH == "fast":
+        logger.warning(
+            "VLLM_MS_BLOCK_HASH=fast: prefix caching blocks are hashed with "
+            "a non-cryptographic hash instead of %s; their hashes may "
+            "collide and KV connectors do not share them.", hash_fn_name)
+        return "fast"
+    if _BLOCK_HASH != "compat":
+        logger.warning(
+            "Unknown VLLM_MS_BLOCK_HASH=%s, using the block hasher of "
+            "vLLM.", _BLOCK_HASH)
+        return None
+    if caching_hash_fn is sha256 and pickle.HIGHEST_PROTOCOL == 5:
+        return "sha256"
+    logger.debug("No native block hasher for %s, using the one of vLLM.",
+                 hash_fn_name)
+    return None
+
+
+def get_request_block_hasher(
+    block_size: int,
+    caching_hash_fn: Callable[[Any], bytes],
+) -> Callable[[Request], list[BlockHash]]:
+    """
+    Returns a function which computes the list of un-computed block hashes
+    of a request, as vLLM's does, hashing all the new full blocks in one
+    native call.
+    """
+    algo = _native_block_hash_algo(caching_hash_fn)
+    if algo is None:
+        return _vllm_get_request_block_hasher(block_size, caching_hash_fn)
+    vllm_request_block_hasher = _vllm_get_request_block_hasher(
+        block_size, caching_hash_fn)
+
+    def request_block_hasher(request: Request) -> list[BlockHash]:
+        start_token_idx = len(request.block_hashes) * block_size
+        num_blocks = (request.num_tokens - start_token_idx) // block_size
+        if num_blocks <= 0:
+            return []
+        parent_block_hash = (request.block_hashes[-1] if request.block_hashes
+                             else kv_cache_utils.NONE_HASH)
+        extra_keys = _block_extra_keys(request, start_token_idx, num_blocks,
+                                       block_size)
+        try:
+            return hash_request_blocks(request._all_token_ids,
+                                       block_size,
+                                       parent_block_hash,
+                                       extra_keys,
+                                       start=start_token_idx,
+                                       algo=algo)
+        except ValueError:
+            # blocks too large for the sha256 pickle to fit one frame
+            return vllm_request_block_hasher(request)
+
+    return request_block_hasher
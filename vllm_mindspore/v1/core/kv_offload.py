@@ -0,0 +1,156 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""The host tier of the KV cache: which prefix caching blocks are held in
+host memory and where, evicted least recently used first."""
+from collections import OrderedDict
+from collections.abc import Sequence
+
+from vllm.v1.core.kv_cache_utils import BlockHash
+
+try:
+    from vllm_mindspore._C_host import HostBlockPool
+except ImportError:
+    HostBlockPool = None
+
+
+class _HostBlock:
+    __slots__ = ("block_id", "ready", "ref_cnt")
+
+    def __init__(self, block_id: int):
+        self.block_id = block_id
+        # False until the store of its KV is done
+        self.ready = False
+        # loads in flight, the block is not evicted before they are done
+        self.ref_cnt = 0
+
+
+class HostKVCacheTier:
+    """
+    Host blocks keyed by the prefix caching hash of the KV they hold. Only
+    the scheduler side bookkeeping: block ids come from a HostBlockPool
+    without memory, the worker copies the KV into and out of a pool of the
+    same size, which mirrors its allocations and evictions.
+
+    A store or load is prepared when it is scheduled and completed once the
+    worker has done it: a block being stored is not found by lookup, a block
+    being loaded is not evicted.
+    """
+
+    def __init__(self, num_blocks: int):
+        self.pool = HostBlockPool(num_blocks, 0)
+        # least recently used first
+        self._blocks: OrderedDict[BlockHash, _HostBlock] = OrderedDict()
+        self.num_evicted = 0
+        # host block ids evicted since the last pop_evicted
+        self._evicted_ids: list[int] = []
+
+    @property
+    def num_blocks(self) -> int:
+        return self.pool.num_blocks
+
+    @property
+    def num_free_blocks(self) -> int:
+        return self.pool.num_free
+
+    def __contains__(self, block_hash: BlockHash) -> bool:
+        return block_hash in self._blocks
+
+    def lookup(self, block_hashes: Sequence[BlockHash]) -> int:
+        """Number of the leading block_hashes whose KV is in the tier."""
+        num_hits = 0
+        for block_hash in block_hashes:
+            block = self._blocks.get(block_hash)
+            if block is None or not block.ready:
+                break
+            num_hits += 1
+        return num_hits
+
+    def prepare_load(self, block_hashes: Sequence[BlockHash]) -> list[int]:
+        """Host block ids of block_hashes, all found by lookup, kept until
+        complete_load."""
+        block_ids = []
+        for block_hash in block_hashes:
+            block = self._blocks[block_hash]
+            assert block.ready
+            block.ref_cnt += 1
+            self._blocks.move_to_end(block_hash)
+            block_ids.append(block.block_id)
+        return block_ids
+
+    def complete_load(self, block_hashes: Sequence[BlockHash]) -> None:
+        for block_hash in block_hashes:
+            self._blocks[block_hash].ref_cnt -= 1
+
+    def prepare_store(
+            self,
+            block_hashes: Sequence[BlockHash]) -> tuple[list[int], list[int]]:
+        """
+        Take host blocks for the block_hashes not in the tier, evicting the
+        least recently used blocks if needed, and return the indices into
+        block_hashes of the blocks to store and their host block ids. Only
+        the hashes before the first block that cannot be stored are stored,
+        a block is found only after all the blocks of its prefix.
+        """
+        new_hashes = []
+        for block_hash in block_hashes:
+            if block_hash in self._blocks:
+                self._blocks.move_to_end(block_hash)
+            else:
+                new_hashes.append(block_hash)
+        if not new_hashes:
+            return [], []
+        num_free = self.pool.num_free
+        if num_free < len(new_hashes):
+            num_free += self._evict(len(new_hashes) - num_free)
+        block_ids = self.pool.allocate(min(num_free, len(new_hashes)))
+        indices = []
+        for i, block_hash in enumerate(block_hashes):
+            if len(indices) == len(block_ids):
+                break
+            if block_hash in self._blocks:
+                continue
+            self._blocks[block_hash] = _HostBlock(block_ids[len(indices)])
+            indices.append(i)
+        return indices, block_ids
+
+    def pop_evicted(self) -> list[int]:
+        """Host block ids evicted since the last call, for the worker pool
+        to free before the blocks of the stores prepared since."""
+        evicted_ids, self._evicted_ids = self._evicted_ids, []
+        return evicted_ids
+
+    def complete_store(self, block_hashes: Sequence[BlockHash]) -> None:
+        for block_hash in block_hashes:
+            self._blocks[block_hash].ready = True
+
+    def _evict(self, num_blocks: int) -> int:
+        """Free up to num_blocks ready blocks no load holds, least recently
+        used first, and return how many were freed."""
+        evicted = []
+        for block_hash, block in self._blocks.items():
+            if len(evicted) == num_blocks:
+                break
+            if block.ready and block.ref_cnt == 0:
+                evicted.append(block_hash)
+        if evicted:
+            evicted_ids = [
+                self._blocks.pop(block_hash).block_id
+                for block_hash in evicted
+            ]
+            self.pool.free(evicted_ids)
+            self._evicted_ids.extend(evicted_ids)
+            self.num_evicted += len(evicted)
+        return len(evicted)
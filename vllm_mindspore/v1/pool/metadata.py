@@ -18,24 +18,57 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from dataclasses import dataclass, field
+from typing import Optional
+
+import mindspore as ms
+import numpy as np
 import torch
 from vllm.v1.pool.metadata import PoolingCursor
 
 
+@dataclass
+class PartialPoolingState:
+    """What the CLS and MEAN pooling of the segment_pool op carry from one
+    chunked prefill step to the next, by position in the persistent batch."""
+    req_ids: list[str]
+    num_computed_tokens_np: np.ndarray  # before this step
+    num_scheduled_tokens_np: np.ndarray
+    prompt_lens_np: np.ndarray
+    # fp32 [hidden_size] rows of the prompts still in prefill, by request id;
+    # owned by the model runner
+    partial_sums: dict[str, ms.Tensor] = field(default_factory=dict)
+
+
+@dataclass
+class MsPoolingCursor(PoolingCursor):
+    partial_state: Optional[PartialPoolingState] = None
+
+    def __getitem__(self, indices: slice):
+        # `index` keeps the batch positions the state is looked up by
+        return MsPoolingCursor(
+            index=self.index[indices],
+            first_token_indices_gpu=self.first_token_indices_gpu[indices],
+            last_token_indices_gpu=self.last_token_indices_gpu[indices],
+            prompt_lens_cpu=self.prompt_lens_cpu[indices],
+            num_scheduled_tokens_cpu=self.num_scheduled_tokens_cpu[indices],
+            partial_state=self.partial_state)
+
+
 def build_pooling_cursor(num_scheduled_tokens: list[int],
                          prompt_lens: torch.Tensor, device: torch.device):
     assert len(prompt_lens) == len(num_scheduled_tokens)
 
     n_seq = len(num_scheduled_tokens)
     index = list(range(n_seq))
-    num_scheduled_tokens = torch.tensor(num_scheduled_tokens, device=device)
-    cumsum = torch.zeros(n_seq, dtype=torch.int64, device=device)
-    torch.cumsum(num_scheduled_tokens, dim=0, out=cumsum)
-    # Out is not support for slice.
-    cumsum = torch.cat((torch.tensor([0], dtype=torch.int64,
-                                     device=device), cumsum))
-    return PoolingCursor(index=index,
-                         first_token_indices_gpu=cumsum[:n_seq],
-                         last_token_indices_gpu=cumsum[1:] - 1,
-                         prompt_lens_cpu=prompt_lens,
-                         num_scheduled_tokens_cpu=num_scheduled_tokens)
+    # The offsets are known on the host, so they are built there rather than
+    # by a cumsum and a cat launched on device.
+    num_scheduled_tokens_np = np.array(num_scheduled_tokens, dtype=np.int32)
+    cu_num_tokens = np.zeros(n_seq + 1, dtype=np.int32)
+    np.cumsum(num_scheduled_tokens_np, out=cu_num_tokens[1:])
+    return MsPoolingCursor(
+        index=index,
+        first_token_indices_gpu=ms.from_numpy(cu_num_tokens[:n_seq]),
+        last_token_indices_gpu=ms.from_numpy(cu_num_tokens[1:] - 1),
+        prompt_lens_cpu=prompt_lens,
+        num_scheduled_tokens_cpu=ms.from_numpy(num_scheduled_tokens_np))
@@ -26,6 +26,8 @@ from vllm.logger import init_logger
 from vllm.v1.sample.metadata import SamplingMetadata
 from vllm.v1.sample.rejection_sampler import generate_uniform_probs
 
+from vllm_mindspore import _custom_ops as custom_ops
+
 logger = init_logger(__name__)
 
 PLACEHOLDER_TOKEN_ID = -1
@@ -104,6 +106,12 @@ def rejection_sample(
     assert bonus_token_ids.is_contiguous()
     assert target_probs.shape == (num_tokens, vocab_size)
 
+    if custom_ops.is_custom_op_available("rejection_sample"):
+        return _rejection_sample_native(draft_token_ids, num_draft_tokens,
+                                        max_spec_len, cu_num_draft_tokens,
+                                        draft_probs, target_probs,
+                                        bonus_token_ids, sampling_metadata)
+
     # Create output buffer.
     output_token_ids = mint.empty((batch_size, max_spec_len + 1),
                                   dtype=ms.int32)
@@ -141,18 +149,51 @@ def rejection_sample(
     return output_token_ids
 
 
-def sample_recovered_tokens(
-    max_spec_len: int,
+def _rejection_sample_native(
+    draft_token_ids: ms.Tensor,
     num_draft_tokens: list[int],
+    max_spec_len: int,
     cu_num_draft_tokens: ms.Tensor,
-    draft_token_ids: ms.Tensor,
     draft_probs: Optional[ms.Tensor],
     target_probs: ms.Tensor,
+    bonus_token_ids: ms.Tensor,
     sampling_metadata: SamplingMetadata,
 ) -> ms.Tensor:
-    # NOTE(woosuk): Create only one distribution for each request.
+    """Greedy and random requests in one custom op call. The random numbers
+    are drawn in the same order as the Python path, so seeded requests
+    sample the same tokens."""
     batch_size = len(num_draft_tokens)
+    num_tokens = draft_token_ids.shape[0]
     vocab_size = target_probs.shape[-1]
+    output_token_ids = mint.empty((batch_size, max_spec_len + 1),
+                                  dtype=ms.int32)
+    if sampling_metadata.all_greedy:
+        is_greedy = mint.ones(batch_size, dtype=ms.bool)
+        # not read for greedy requests
+        uniform_probs = mint.zeros(num_tokens, dtype=ms.float32)
+        recovery_noise = target_probs
+    else:
+        is_greedy = sampling_metadata.temperature == GREEDY_TEMPERATURE
+        uniform_probs = generate_uniform_probs(num_tokens, num_draft_tokens,
+                                               sampling_metadata.generators,
+                                               target_probs.device)
+        recovery_noise = generate_recovery_noise(batch_size, vocab_size,
+                                                 num_draft_tokens,
+                                                 sampling_metadata)
+    custom_ops.rejection_sample(output_token_ids, cu_num_draft_tokens,
+                                draft_token_ids, draft_probs, target_probs,
+                                bonus_token_ids, uniform_probs,
+                                recovery_noise, is_greedy, max_spec_len)
+    return output_token_ids
+
+
+def generate_recovery_noise(
+    batch_size: int,
+    vocab_size: int,
+    num_draft_tokens: list[int],
+    sampling_metadata: SamplingMetadata,
+) -> ms.Tensor:
+    # NOTE(woosuk): Create only one distribution for each request.
     q = mint.empty((batch_size, vocab_size), dtype=ms.float32)
     q.exponential_()
     for i, generator in sampling_metadata.generators.items():
@@ -160,6 +201,22 @@ def sample_recovered_tokens(
         # This can be important for reproducibility.
         if num_draft_tokens[i] > 0:
             q[i].exponential_(generator=generator)
+    return q
+
+
+def sample_recovered_tokens(
+    max_spec_len: int,
+    num_draft_tokens: list[int],
+    cu_num_draft_tokens: ms.Tensor,
+    draft_token_ids: ms.Tensor,
+    draft_probs: Optional[ms.Tensor],
+    target_probs: ms.Tensor,
+    sampling_metadata: SamplingMetadata,
+) -> ms.Tensor:
+    batch_size = len(num_draft_tokens)
+    vocab_size = target_probs.shape[-1]
+    q = generate_recovery_noise(batch_size, vocab_size, num_draft_tokens,
+                                sampling_metadata)
 
     recovered_token_ids = mint.empty_like(draft_token_ids)
     _sample_recovered_tokens(recovered_token_ids, cu_num_draft_tokens,
@@ -213,7 +270,9 @@ def _rejection_greedy_sample(
     is_greedy=None,
 ):
     batch_size = output_token_ids.shape[0]
-    if num_draft_tokens.count(1) == len(num_draft_tokens):
+    # the shortcut writes every row, so it only holds for all-greedy batches
+    if is_greedy is None and num_draft_tokens.count(1) == len(
+            num_draft_tokens):
         num_tokens = draft_token_ids.shape[0]
         assert batch_size == num_tokens
         output_token_ids[:, 0] = target_argmax
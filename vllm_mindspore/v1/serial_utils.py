@@ -7,6 +7,11 @@ import mindspore as ms
 import numpy as np
 from msgspec import msgpack
 
+try:
+    from vllm_mindspore._C_host import buffer_view
+except ImportError:
+    buffer_view = None
+
 np_bfloat16 = "bfloat16"
 
 mstype_str_to_np_type = {
@@ -27,14 +32,17 @@ mstype_str_to_np_type = {
 
 def _decode_tensor(self, arr: Any) -> ms.Tensor:
     dtype, shape, data = arr
-    # Copy from inline representation, to decouple the memory storage
-    # of the message from the original buffer. And also make Torch
-    # not complain about a readonly memoryview.
-    buffer = self.aux_buffers[data] if isinstance(data, int) \
-        else bytearray(data)
-    if not buffer:  # torch.frombuffer doesn't like empty buffers
+    buffer = self.aux_buffers[data] if isinstance(data, int) else data
+    if not buffer:  # np.frombuffer doesn't like empty buffers
         assert 0 in shape
         return ms.mint.empty(shape, dtype=dtype)
+    if not isinstance(data, int):
+        # Copy from inline representation, to decouple the memory storage
+        # of the message from the original buffer.
+        buffer = bytearray(buffer)
+    # Backing buffers belong to this message only: the tensor is built over
+    # them in place, read-only as they are, and the array keeps the frame
+    # alive as long as needed.
     # Create uint8 array
     arr = np.frombuffer(buffer, dtype=np.uint8)
     # Convert back to proper shape & type
@@ -51,14 +59,21 @@ def _encode_tensor(
     # NOTE: vLLM-MindSpore Plugin:
     # Currently mindspore does not support operating tensors in a
     # multi-threaded environment, so convert tensors to numpy.
-    arr = obj.numpy().flatten().view(dtype=np.uint8)
+    arr = obj.numpy()
+    if not arr.flags.c_contiguous:
+        arr = np.ascontiguousarray(arr)
     if obj.nbytes < self.size_threshold:
         # Smaller tensors are encoded inline, just like ndarrays.
         CUSTOM_TYPE_RAW_VIEW = 3
-        data = msgpack.Ext(CUSTOM_TYPE_RAW_VIEW, arr.data)
+        data = msgpack.Ext(CUSTOM_TYPE_RAW_VIEW,
+                           arr.reshape(-1).view(dtype=np.uint8).data)
     else:
-        # Otherwise encode index of backing buffer to avoid copy.
+        # Otherwise encode index of backing buffer to avoid copy. The array
+        # shares the host memory of the tensor, which has to outlive the
+        # send: the view holds the tensor until the frame is released.
         data = len(self.aux_buffers)
-        self.aux_buffers.append(arr.data)
+        self.aux_buffers.append(
+            memoryview(buffer_view(arr, owner=obj)) if buffer_view
+            is not None else arr.reshape(-1).view(dtype=np.uint8).data)
     dtype = str(obj.dtype).removeprefix("torch.")
     return dtype, obj.shape, data
@@ -22,6 +22,7 @@ import mindspore as ms
 import numpy as np
 import torch
 import torch.nn as nn
+from mindspore import mint
 from vllm.config import get_layers_from_vllm_config
 from vllm.logger import init_logger
 from vllm.model_executor.model_loader import get_model
@@ -31,6 +32,7 @@ from vllm.v1.attention.backends.utils import CommonAttentionMetadata
 from vllm.v1.spec_decode.metadata import SpecDecodeMetadata
 from vllm.v1.worker.gpu_input_batch import CachedRequestState, InputBatch
 
+from vllm_mindspore import _custom_ops as custom_ops
 from vllm_mindspore.model_executor.models.model_base import AttentionWrapper
 from vllm_mindspore.v1.attention.backends.ms_attn import (
     MsCommonAttentionMetadata)
@@ -151,6 +153,15 @@ def prepare_next_token_ids_padded(
     # vllm-mindspore end
     self.backup_next_token_ids.copy_to_gpu(num_reqs)
 
+    # vllm-mindspore begin:
+    # one custom op instead of the chain of device ops below.
+    if (getattr(common_attn_metadata, "discard_mask_np", None) is not None
+            and custom_ops.is_custom_op_available("eagle_prepare_inputs")):
+        return _prepare_next_token_ids_padded_native(
+            self, common_attn_metadata, sampled_token_ids, num_reqs,
+            gpu_input_batch.vocab_size)
+    # vllm-mindspore end
+
     # Mask out the sampled tokens indices that should not be sampled.
     discard_sampled_tokens_req_indices = \
         discard_request_indices[:num_discarded_requests]
@@ -190,6 +201,40 @@ def prepare_next_token_ids_padded(
     return next_token_ids, valid_sampled_tokens_count
 
 
+def _prepare_next_token_ids_padded_native(
+    self,
+    common_attn_metadata: MsCommonAttentionMetadata,
+    sampled_token_ids: ms.Tensor,
+    num_reqs: int,
+    vocab_size: int,
+) -> tuple[ms.Tensor, ms.Tensor]:
+    """`prepare_next_token_ids_padded` through the `eagle_prepare_inputs`
+    custom op. The draft token counts and the discard mask are taken from
+    the host copies in `common_attn_metadata`, without a sync; the indices
+    to sample the op computes too are left in it for
+    `prepare_inputs_padded`."""
+    num_draft_tokens_np = common_attn_metadata.num_draft_tokens_np
+    if num_draft_tokens_np is None:
+        cu_num_draft_tokens_np = np.zeros(num_reqs, dtype=np.int32)
+    else:
+        cu_num_draft_tokens_np = np.cumsum(num_draft_tokens_np[:num_reqs],
+                                           dtype=np.int32)
+    discard_mask_np = np.ascontiguousarray(
+        common_attn_metadata.discard_mask_np[:num_reqs], dtype=np.bool_)
+
+    next_token_ids = mint.empty(num_reqs, dtype=ms.int32)
+    valid_sampled_tokens_count = mint.empty(num_reqs, dtype=ms.int32)
+    token_indices_to_sample = mint.empty(num_reqs, dtype=ms.int32)
+    custom_ops.eagle_prepare_inputs(
+        next_token_ids, valid_sampled_tokens_count, token_indices_to_sample,
+        sampled_token_ids, ms.from_numpy(cu_num_draft_tokens_np),
+        ms.from_numpy(discard_mask_np),
+        self.backup_next_token_ids.gpu[:num_reqs],
+        common_attn_metadata.query_start_loc, vocab_size)
+    common_attn_metadata.token_indices_to_sample = token_indices_to_sample
+    return next_token_ids, valid_sampled_tokens_count
+
+
 def prepare_inputs_padded(
     self,
     common_attn_metadata: CommonAttentionMetadata,
@@ -206,25 +251,35 @@ def prepare_inputs_padded(
     """
     # `q_seq_lens_np`, `seq_lens_np`, `num_computed_tokens_np` and
     # `slot_mapping_np` is needed for MS-backend to prepare inputs.
-    num_draft_tokens_gpu = torch.cat([
-        spec_decode_metadata.cu_num_draft_tokens[0:1],
-        spec_decode_metadata.cu_num_draft_tokens[1:] -
-        spec_decode_metadata.cu_num_draft_tokens[:-1]
-    ])
-
-    num_rejected_tokens_gpu = torch.where(
-        num_draft_tokens_gpu > 0,
-        num_draft_tokens_gpu + 1 - valid_sampled_tokens_count,
-        torch.zeros_like(num_draft_tokens_gpu))
-
     # vllm-mindspore begin:
-    # use np.array instead of tensor to optimize performance
+    # query_start_loc[1:] - 1 less the rejected tokens, num_draft_tokens + 1
+    # - valid_sampled_tokens_count of the requests with draft tokens. The
+    # custom op of prepare_next_token_ids_padded computed them already;
+    # otherwise the host part comes from the host draft token counts, and
+    # the valid counts are added on device, so that nothing syncs.
     query_start_loc_np = common_attn_metadata.query_start_loc_np
+    token_indices_to_sample = getattr(common_attn_metadata,
+                                      "token_indices_to_sample", None)
+    if token_indices_to_sample is None:
+        num_draft_tokens_np = np.asarray(
+            spec_decode_metadata.num_draft_tokens, dtype=np.int32)
+        has_draft_np = (num_draft_tokens_np > 0).astype(np.int32)
+        token_indices_to_sample_np = (
+            query_start_loc_np[1:] - 1 - has_draft_np *
+            (num_draft_tokens_np + 1)).astype(np.int32)
+        token_indices_to_sample = ms.from_numpy(
+            token_indices_to_sample_np) + ms.from_numpy(
+                has_draft_np) * valid_sampled_tokens_count.astype(ms.int32)
+    # vllm-mindspore end
 
+    # vllm-mindspore begin:
+    # use np.array instead of tensor to optimize performance
     new_query_len_per_req = (query_start_loc_np[1:] - query_start_loc_np[:-1])
 
     total_num_tokens = query_start_loc_np[-1].item()
     token_indices = self.token_arange_np[:total_num_tokens]
+    slot_mapping, slot_mapping_np = _advance_draft_slot_mapping(
+        self, common_attn_metadata, new_query_len_per_req, total_num_tokens)
 
     spec_common_attn_metadata = MsCommonAttentionMetadata(
         query_start_loc=common_attn_metadata.query_start_loc,
@@ -241,18 +296,57 @@ def prepare_inputs_padded(
         max_query_len=new_query_len_per_req.max().item(),
         max_seq_len=common_attn_metadata.seq_lens_np.max().item(),
         block_table_tensor=common_attn_metadata.block_table_tensor,
-        slot_mapping=None,
-        slot_mapping_np=common_attn_metadata.slot_mapping_np[token_indices],
+        slot_mapping=slot_mapping,
+        slot_mapping_np=slot_mapping_np,
         causal=True,
     )
     # vllm-mindspore end
 
-    token_indices_to_sample = common_attn_metadata.query_start_loc_np[1:] - 1 \
-        - num_rejected_tokens_gpu
-
     return spec_common_attn_metadata, token_indices, token_indices_to_sample
 
 
+def _advance_draft_slot_mapping(self, common_attn_metadata, query_lens_np,
+                                total_num_tokens):
+    """The slot mapping of the padded draft inputs, `(slot_mapping,
+    slot_mapping_np)` with one of them None.
+
+    When every request has the same query length, e.g. a decode batch
+    where each request carries all its draft tokens, the batch is
+    `num_reqs x query_len`, sequence-major, which is the layout of
+    `advance_step_flashattn`: the slots are then computed on device from
+    the computed token counts and the block table, instead of gathered on
+    the host and copied to the device. Other batches keep the host path.
+    """
+    num_reqs = common_attn_metadata.num_reqs
+    if (num_reqs == 0 or (query_lens_np[:num_reqs] != query_lens_np[0]).any()
+            or not custom_ops.is_custom_op_available(
+                "advance_step_flashattn")):
+        token_indices = self.token_arange_np[:total_num_tokens]
+        return None, common_attn_metadata.slot_mapping_np[token_indices]
+
+    num_tokens_per_seq = int(query_lens_np[0])
+    # positions start at the computed tokens; the op advances this copy
+    seq_lens = ms.from_numpy(
+        np.ascontiguousarray(
+            common_attn_metadata.num_computed_tokens_np[:num_reqs],
+            dtype=np.int32))
+    token_ids = mint.zeros(total_num_tokens, dtype=ms.int32)
+    positions = mint.empty(total_num_tokens, dtype=ms.int32)
+    slot_mapping = mint.empty(total_num_tokens, dtype=ms.int32)
+    custom_ops.advance_step_flashattn(
+        num_seqs=num_reqs,
+        num_queries=num_reqs,
+        block_size=self.block_size,
+        input_tokens=token_ids,
+        sampled_token_ids=token_ids,
+        input_positions=positions,
+        seq_lens=seq_lens,
+        slot_mapping=slot_mapping,
+        block_tables=common_attn_metadata.block_table_tensor,
+        num_tokens_per_seq=num_tokens_per_seq)
+    return slot_mapping, None
+
+
 def prepare_inputs(
     self,
     common_attn_metadata: CommonAttentionMetadata,
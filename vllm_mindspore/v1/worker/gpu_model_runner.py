@@ -18,6 +18,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import os
 import time
 import traceback
 from typing import Any, Optional, Union, cast
@@ -60,14 +61,26 @@ from vllm_mindspore.model_executor.layers.rotary_embedding import (
     InferMRotaryEmbedding as MRotaryEmbedding)
 from vllm_mindspore.model_executor.models.model_base import AttentionWrapper
 from vllm_mindspore.model_executor.models.utils import is_use_ringmla
+from vllm_mindspore.multimodal.arena import init_mm_arena
 from vllm_mindspore.utils import (create_kv_cache, get_dtype_size,
                                   get_valid_dtype, is_310p)
 from vllm_mindspore.v1.attention.backends.ms_attn import (
     MsCommonAttentionMetadata)
 from vllm_mindspore.v1.kv_cache_interface import MLAQuantFullAttentionSpec
+from vllm_mindspore.v1.pool.metadata import PartialPoolingState
+
+try:
+    from vllm_mindspore._C_host import prepare_inputs as _native_prepare_inputs
+except ImportError:
+    _native_prepare_inputs = None
 
 logger = init_logger(__name__)
 
+# Threads of the host pool the native _prepare_inputs may split large batches
+# across, 0 for all of them.
+_PREPARE_INPUTS_THREADS = int(
+    os.getenv("VLLM_MS_PREPARE_INPUTS_THREADS", "1"))
+
 AttnMetadataDict: TypeAlias = dict[str, AttentionMetadata]
 # list when ubatching is enabled
 PerLayerAttnMetadata: TypeAlias = Union[list[AttnMetadataDict],
@@ -98,6 +111,9 @@ def gpu_model_runner_init(
         _original_init(self, vllm_config, device)
     finally:
         torch.cuda.Stream = real_stream
+    # The multimodal inputs of the requests are placed in a host arena as
+    # they arrive, so that the batches of the encoder are views of it.
+    self.mm_arena = init_mm_arena() if self.supports_mm_inputs else None
 
 
 def _to_list(self, sampled_token_ids: torch.Tensor) -> list[list[int]]:
@@ -107,35 +123,12 @@ def _to_list(self, sampled_token_ids: torch.Tensor) -> list[list[int]]:
     return sampled_token_ids.tolist()
 
 
-def _prepare_inputs(
-    self,
-    scheduler_output,
-) -> tuple[PerLayerAttnMetadata, Tensor, Optional[SpecDecodeMetadata],
-           np.ndarray, Optional[CommonAttentionMetadata], int,
-           Optional[UBatchSlices], Optional[Tensor]]:
-    """
-    :return: tuple[
-        attn_metadata: layer-to-attention_metadata mapping,
-        logits_indices, spec_decode_metadata
-    ]
-    """
+def _prepare_inputs_np(self, scheduler_output,
+                       num_scheduled_tokens: np.ndarray) -> np.ndarray:
+    """Fill input_ids, positions and the slot mappings with numpy, and
+    return cu_num_tokens."""
     total_num_scheduled_tokens = scheduler_output.total_num_scheduled_tokens
-    assert total_num_scheduled_tokens > 0
     num_reqs = self.input_batch.num_reqs
-    assert num_reqs > 0
-
-    # vllm-mindspore aclgraph only support pure decode
-    self.pure_decode = num_reqs == total_num_scheduled_tokens
-
-    # OPTIMIZATION: Start copying the block table first.
-    # This way, we can overlap the copy with the following CPU operations.
-    self.input_batch.block_table.commit_block_table(num_reqs)
-
-    # Get the number of scheduled tokens for each request.
-    req_ids = self.input_batch.req_ids
-    tokens = [scheduler_output.num_scheduled_tokens[i] for i in req_ids]
-    num_scheduled_tokens = np.array(tokens, dtype=np.int32)
-    max_num_scheduled_tokens = max(tokens)
 
     # Get request indices.
     # E.g., [2, 5, 3] -> [0, 0, 1, 1, 1, 1, 1, 2, 2, 2]
@@ -220,6 +213,70 @@ def _prepare_inputs(
     self.input_batch.block_table.commit_slot_mapping(
         total_num_scheduled_tokens)
 
+    return cu_num_tokens
+
+
+def _prepare_inputs(
+    self,
+    scheduler_output,
+) -> tuple[PerLayerAttnMetadata, Tensor, Optional[SpecDecodeMetadata],
+           np.ndarray, Optional[CommonAttentionMetadata], int,
+           Optional[UBatchSlices], Optional[Tensor]]:
+    """
+    :return: tuple[
+        attn_metadata: layer-to-attention_metadata mapping,
+        logits_indices, spec_decode_metadata
+    ]
+    """
+    total_num_scheduled_tokens = scheduler_output.total_num_scheduled_tokens
+    assert total_num_scheduled_tokens > 0
+    num_reqs = self.input_batch.num_reqs
+    assert num_reqs > 0
+
+    # vllm-mindspore aclgraph only support pure decode
+    self.pure_decode = num_reqs == total_num_scheduled_tokens
+
+    # OPTIMIZATION: Start copying the block table first.
+    # This way, we can overlap the copy with the following CPU operations.
+    self.input_batch.block_table.commit_block_table(num_reqs)
+
+    # Get the number of scheduled tokens for each request.
+    req_ids = self.input_batch.req_ids
+    tokens = [scheduler_output.num_scheduled_tokens[i] for i in req_ids]
+    num_scheduled_tokens = np.array(tokens, dtype=np.int32)
+
+    block_tables = self.input_batch.block_table.block_tables
+    use_native = (_native_prepare_inputs is not None
+                  and not self.enable_prompt_embeds and all(
+                      getattr(blk_table, "dcp_world_size", 1) == 1
+                      for blk_table in block_tables))
+    if use_native:
+        # Fill input_ids, positions, query_start_loc, seq_lens and the slot
+        # mappings of every KV cache group in one pass over the requests.
+        max_num_scheduled_tokens = _native_prepare_inputs(
+            num_scheduled_tokens,
+            self.input_batch.num_computed_tokens_cpu,
+            self.input_batch.token_ids_cpu,
+            self.input_ids.np,
+            self.positions.np,
+            self.query_start_loc.np,
+            self.seq_lens.np,
+            [blk_table.block_table.np for blk_table in block_tables],
+            [blk_table.slot_mapping.np for blk_table in block_tables],
+            [blk_table.block_size for blk_table in block_tables],
+            num_threads=_PREPARE_INPUTS_THREADS)
+        cu_num_tokens = self.query_start_loc.np[1:num_reqs + 1]
+        # Calculate M-RoPE positions.
+        # Only relevant for models using M-RoPE (e.g, Qwen2-VL)
+        if self.uses_mrope:
+            self._calc_mrope_positions(scheduler_output)
+        self.input_batch.block_table.commit_slot_mapping(
+            total_num_scheduled_tokens)
+    else:
+        max_num_scheduled_tokens = max(tokens)
+        cu_num_tokens = _prepare_inputs_np(self, scheduler_output,
+                                           num_scheduled_tokens)
+
     num_tokens_unpadded = scheduler_output.total_num_scheduled_tokens
     num_tokens_padded = num_tokens_unpadded
     num_reqs_padded = num_reqs
@@ -228,12 +285,13 @@ def _prepare_inputs(
             num_tokens_unpadded)
         num_reqs_padded = num_tokens_padded
 
-    # Prepare the attention metadata.
-    self.query_start_loc.np[0] = 0
-    self.query_start_loc.np[1:num_reqs + 1] = cu_num_tokens
-    # Note: pad query_start_loc to be non-decreasing, as kernels
-    # like FlashAttention requires that
-    self.query_start_loc.np[num_reqs + 1:].fill(cu_num_tokens[-1])
+    if not use_native:
+        # Prepare the attention metadata.
+        self.query_start_loc.np[0] = 0
+        self.query_start_loc.np[1:num_reqs + 1] = cu_num_tokens
+        # Note: pad query_start_loc to be non-decreasing, as kernels
+        # like FlashAttention requires that
+        self.query_start_loc.np[num_reqs + 1:].fill(cu_num_tokens[-1])
     q_seq_lens_np = np.diff(self.query_start_loc.np[:num_reqs_padded + 1])
     query_start_loc_np = self.query_start_loc.np[:num_reqs + 1]
     query_start_loc = ms.from_numpy(query_start_loc_np)
@@ -248,9 +306,10 @@ def _prepare_inputs(
                      uniform_decode=uniform_decode,
                      vllm_config=self.vllm_config)
 
-    self.seq_lens.np[:num_reqs] = (
-        self.input_batch.num_computed_tokens_cpu[:num_reqs] +
-        num_scheduled_tokens)
+    if not use_native:
+        self.seq_lens.np[:num_reqs] = (
+            self.input_batch.num_computed_tokens_cpu[:num_reqs] +
+            num_scheduled_tokens)
     # Fill unused with 0 for full cuda graph mode.
     self.seq_lens.np[num_reqs_padded:].fill(0)
     self.seq_lens.copy_to_gpu()
@@ -377,6 +436,8 @@ def _prepare_inputs(
             num_logits_indices=logits_indices.size(0),
             causal=True,
             encoder_seq_lens=encoder_seq_lens,
+            num_draft_tokens_np=num_draft_tokens,
+            discard_mask_np=discard_requests_mask,
         )
 
         if (self.speculative_config
@@ -882,6 +943,13 @@ def _update_states(self, scheduler_output) -> None:
             lora_request=new_req_data.lora_request,
         )
         self.requests[req_id] = req_state
+        # vllm-mindspore begin: Place the multimodal inputs in the arena once,
+        # rather than copy them into a new batch at every encoder step.
+        if self.mm_arena is not None:
+            for feature in req_state.mm_features:
+                if feature.data is not None:
+                    self.mm_arena.place_item(feature.data)
+        # vllm-mindspore end.
 
         # Only relevant for models using M-RoPE (e.g, Qwen2-VL)
         if self.uses_mrope:
@@ -1384,6 +1452,23 @@ def _pool(
     pooling_metadata = self.input_batch.get_pooling_metadata()
     pooling_metadata.build_pooling_cursor(num_scheduled_tokens_np.tolist(),
                                           device=hidden_states.device)
+    # vllm-mindspore begin: Carry the CLS rows and MEAN sums of prompts in
+    # chunked prefill to the next step.
+    input_batch = self.input_batch
+    num_reqs = input_batch.num_reqs
+    partial_sums = getattr(self, "pooling_partial_sums", {})
+    self.pooling_partial_sums = {
+        req_id: row
+        for req_id, row in partial_sums.items()
+        if req_id in input_batch.req_id_to_index
+    }
+    pooling_metadata.pooling_cursor.partial_state = PartialPoolingState(
+        req_ids=input_batch.req_ids,
+        num_computed_tokens_np=input_batch.num_computed_tokens_cpu[:num_reqs],
+        num_scheduled_tokens_np=num_scheduled_tokens_np[:num_reqs],
+        prompt_lens_np=input_batch.num_prompt_tokens[:num_reqs],
+        partial_sums=self.pooling_partial_sums)
+    # vllm-mindspore end.
     # vllm-mindspore begin: Use np Tensor for seq_lens to
     # fit mindspore cpu Tensor
     seq_lens_cpu = self.seq_lens.np[:self.input_batch.num_reqs]
@@ -0,0 +1,154 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# Copyright 2025 Huawei Technologies Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Swap KV cache blocks between the device caches and a pool of host
+blocks."""
+from concurrent.futures import Future, ThreadPoolExecutor
+
+import mindspore as ms
+import numpy as np
+from mindspore import Tensor, mint
+from vllm.logger import init_logger
+
+try:
+    from vllm_mindspore._C_host import HostBlockPool
+except ImportError:
+    HostBlockPool = None
+
+logger = init_logger(__name__)
+
+
+class KVSwapEngine:
+    """
+    Copies KV cache blocks between the device caches and a HostBlockPool.
+
+    A host block holds the device block of every cache tensor, one part
+    after the other. A swap out gathers the blocks of a tensor into one
+    contiguous device tensor, copies it to the host at once, and scatters
+    it into the host blocks on the swap thread, while the next tensor is
+    gathered. A swap in gathers the parts of a tensor from the host blocks
+    on the swap thread, ahead of the copy to the device and scatter into the
+    cache of the tensor before. The swap thread runs the copies in order: a
+    swap in of blocks still being swapped out reads what was written. The
+    host copies run on num_threads threads of the pool's own, so that a
+    swap out in the background does not hold up the host helpers of the
+    step, which share the host thread pool. The pool mirrors the
+    allocations of the scheduler's tier, claimed and freed in order on the
+    swap thread, so that a copy of a block not allocated raises.
+    """
+
+    def __init__(self,
+                 kv_caches: dict[str, tuple[Tensor, ...]],
+                 num_host_blocks: int,
+                 lock_memory: bool = False,
+                 num_threads: int = 4):
+        # every cache tensor once, in the order of the layer names, even if
+        # layers share it
+        self.caches: list[Tensor] = []
+        seen: set[int] = set()
+        for layer_name in sorted(kv_caches):
+            for cache in kv_caches[layer_name]:
+                if id(cache) not in seen:
+                    seen.add(id(cache))
+                    self.caches.append(cache)
+        self.part_shapes = [tuple(cache.shape[1:]) for cache in self.caches]
+        self.np_dtypes = [
+            ms.dtype_to_nptype(cache.dtype) for cache in self.caches
+        ]
+        self.part_bytes = [
+            int(np.prod(shape)) * np.dtype(dtype).itemsize
+            for shape, dtype in zip(self.part_shapes, self.np_dtypes)
+        ]
+        self.part_offsets = np.cumsum([0] + self.part_bytes[:-1]).tolist()
+        self.pool = HostBlockPool(num_host_blocks,
+                                  sum(self.part_bytes),
+                                  lock=lock_memory,
+                                  copy_threads=max(num_threads, 1))
+        self._executor = ThreadPoolExecutor(max_workers=1,
+                                            thread_name_prefix="kv_swap")
+        self._pending: list[Future] = []
+        logger.info(
+            "KV cache host tier of %d blocks of %d bytes, %.2f GiB",
+            num_host_blocks, self.pool.block_bytes,
+            num_host_blocks * self.pool.block_bytes / (1 << 30))
+
+    def free(self, host_block_ids: list[int]) -> None:
+        """Free the host blocks the scheduler evicted, on the swap thread
+        after the copies before."""
+        if host_block_ids:
+            self._pending.append(
+                self._executor.submit(self.pool.free, host_block_ids))
+
+    def swap_out(self, device_block_ids: list[int],
+                 host_block_ids: list[int]) -> None:
+        """Copy the device blocks into the host blocks, which the scheduler
+        allocated. The device blocks are read before this returns, the host
+        blocks are claimed and written on the swap thread."""
+        if not device_block_ids:
+            return
+        self._reap()
+        self._pending.append(
+            self._executor.submit(self.pool.claim, host_block_ids))
+        index = Tensor(np.array(device_block_ids, dtype=np.int32))
+        for cache, offset in zip(self.caches, self.part_offsets):
+            parts = mint.index_select(cache, 0, index).asnumpy()
+            self._pending.append(
+                self._executor.submit(self.pool.write,
+                                      host_block_ids,
+                                      parts,
+                                      offset=offset))
+
+    def swap_in(self, host_block_ids: list[int],
+                device_block_ids: list[int]) -> None:
+        """Copy the host blocks into the device blocks."""
+        if not host_block_ids:
+            return
+        num_blocks = len(host_block_ids)
+        reads = [
+            self._executor.submit(self._read, host_block_ids, i)
+            for i in range(len(self.caches))
+        ]
+        index = Tensor(np.array(device_block_ids, dtype=np.int32))
+        for cache, read in zip(self.caches, reads):
+            parts = read.result()
+            assert parts.shape[0] == num_blocks
+            cache[index] = ms.from_numpy(parts)
+
+    def wait(self) -> None:
+        """Wait for the host blocks of the swap outs so far to be
+        written."""
+        pending, self._pending = self._pending, []
+        for future in pending:
+            future.result()
+
+    def shutdown(self) -> None:
+        self.wait()
+        self._executor.shutdown()
+
+    def _reap(self) -> None:
+        """Drop the swap outs done, raising their errors."""
+        pending, self._pending = self._pending, []
+        for future in pending:
+            if future.done():
+                future.result()
+            else:
+                self._pending.append(future)
+
+    def _read(self, host_block_ids: list[int], i: int) -> np.ndarray:
+        parts = np.empty((len(host_block_ids), *self.part_shapes[i]),
+                         dtype=self.np_dtypes[i])
+        self.pool.read(host_block_ids, parts, offset=self.part_offsets[i])
+        return parts
+
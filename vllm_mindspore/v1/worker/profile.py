@@ -14,6 +14,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import json
 import os
 import subprocess
 import sys
@@ -24,9 +25,15 @@ from mindspore.profiler import ProfilerActivity, ProfilerLevel
 from mindspore.profiler.common.profiler_context import ProfilerContext
 from vllm.logger import init_logger
 
+from vllm_mindspore import _custom_ops
+
 logger = init_logger(__name__)
 
 PROFILE_ENV_NAME = "VLLM_TORCH_PROFILER_DIR"
+# Counters of the custom ops while profiling: 0 off, 1 calls, host latency,
+# casts and bytes, 2 also the kernel time, which waits for every kernel.
+OP_STATS_ENV_NAME = "VLLM_MS_OP_STATS"
+OP_STATS_FILE_NAME = "op_stats.json"
 
 
 def shell_analyse(path):
@@ -52,25 +59,58 @@ class AdapterProfiler:
             output_path=path,
             start_profile=False,
             mstx=mstx)
+        self.op_stats_level = int(os.getenv(OP_STATS_ENV_NAME, "0"))
+        self.op_stats: dict[str, dict] = {}
 
     def start(self):
+        if self.op_stats_level > 0:
+            _custom_ops.reset_op_stats()
+            _custom_ops.set_op_stats_enabled(
+                True, kernel_timing=self.op_stats_level > 1)
         self.profiler.start()
 
     def stop(self):
         self.profiler.stop()
         path = ProfilerContext().ascend_ms_dir
+        if self.op_stats_level > 0:
+            self.op_stats = _custom_ops.get_op_stats()
+            _custom_ops.set_op_stats_enabled(False)
+            if self.op_stats:
+                # next to the trace, to read them together
+                with open(os.path.join(path, OP_STATS_FILE_NAME), "w") as f:
+                    json.dump(self.op_stats, f, indent=2)
         shell_analyse(path)
 
     def key_averages(self):
+        op_stats = self.op_stats
 
         class _inner:
 
             def table(self, sort_by=None):
-                return ""
+                return format_op_stats(op_stats)
 
         return _inner()
 
 
+def format_op_stats(op_stats: dict[str, dict]) -> str:
+    """Table of the custom op counters, one row per op."""
+    if not op_stats:
+        return ""
+    header = (f"{'op':<24} {'calls':>8} {'host(us)':>12} {'p50(us)':>9} "
+              f"{'p99(us)':>9} {'casts':>7} {'cast(us)':>10} "
+              f"{'in(MB)':>9} {'out(MB)':>9} {'kernel(us)':>11}")
+    rows = [header, "-" * len(header)]
+    for name, s in sorted(op_stats.items(),
+                          key=lambda item: -item[1]["host_us"]):
+        rows.append(f"{name:<24} {s['calls']:>8} {s['host_us']:>12.1f} "
+                    f"{s['host_p50_us']:>9.1f} {s['host_p99_us']:>9.1f} "
+                    f"{s['casts']:>7} {s['cast_us']:>10.1f} "
+                    f"{s['bytes_in'] / 2**20:>9.2f} "
+                    f"{s['bytes_out'] / 2**20:>9.2f} "
+                    f"{s['kernel_us']:>11.1f}")
+    return "\n".join(rows)
+
+
 def wrapper_worker_init(fun):
 
     def new_fun(*arg, **kwarg):